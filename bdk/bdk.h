@@ -67,6 +67,7 @@
 #include <usb/usbd.h>
 #include <utils/aarch64_util.h>
 #include <utils/btn.h>
+#include <utils/btrace.h>
 #include <utils/dirlist.h>
 #include <utils/ini.h>
 #include <utils/list.h>
@@ -24,6 +24,7 @@
 #include <power/max7762x.h>
 #include <storage/sd.h>
 #include <utils/types.h>
+#include <utils/util.h>
 
 #include <gfx_utils.h>
 
@@ -35,20 +36,21 @@ extern heap_t _heap;
 void *elfBuf = NULL;
 void *fileBuf = NULL;
 
+static struct _bdkParams_t bdkParameters;
+
 static void _ianos_call_ep(moduleEntrypoint_t entrypoint, void *moduleConfig)
 {
-	bdkParams_t bdkParameters = (bdkParams_t)malloc(sizeof(struct _bdkParams_t));
-	bdkParameters->gfxCon = (void *)&gfx_con;
-	bdkParameters->gfxCtx = (void *)&gfx_ctxt;
-	bdkParameters->memcpy = (memcpy_t)&memcpy;
-	bdkParameters->memset = (memset_t)&memset;
-	bdkParameters->sharedHeap = &_heap;
+	bdkParameters.gfxCon = (void *)&gfx_con;
+	bdkParameters.gfxCtx = (void *)&gfx_ctxt;
+	bdkParameters.memcpy = (memcpy_t)&memcpy;
+	bdkParameters.memset = (memset_t)&memset;
+	bdkParameters.sharedHeap = &_heap;
 
 	// Extra functions.
-	bdkParameters->extension_magic = IANOS_EXT0;
-	bdkParameters->reg_voltage_set = (reg_voltage_set_t)&max7762x_regulator_set_voltage;
+	bdkParameters.extension_magic = IANOS_EXT0;
+	bdkParameters.reg_voltage_set = (reg_voltage_set_t)&max7762x_regulator_set_voltage;
 
-	entrypoint(moduleConfig, bdkParameters);
+	entrypoint(moduleConfig, &bdkParameters);
 }
 
 static void *_ianos_alloc_cb(el_ctx *ctx, Elf_Addr phys, Elf_Addr virt, Elf_Addr size)
@@ -68,16 +70,83 @@ static bool _ianos_read_cb(el_ctx *ctx, void *dest, size_t numberBytes, size_t o
 	return true;
 }
 
-//TODO: Support shared libraries.
-uintptr_t ianos_loader(char *path, elfType_t type, void *moduleConfig)
+static void *_ianos_lib_buf(elfType_t type, u32 size)
+{
+	// Set our relocated library's buffer.
+	switch (type & 0xFFFF)
+	{
+	case EXEC_ELF:
+	case AR64_ELF:
+		return (void *)DRAM_LIB_ADDR;
+	default:
+		return malloc(size); // Aligned to 0x10 by default.
+	}
+}
+
+static void _ianos_lib_buf_free(void *buf)
+{
+	if (buf != (void *)DRAM_LIB_ADDR)
+		free(buf);
+}
+
+static uintptr_t _ianos_load_prelinked(FIL *fp, ianos_prelink_hdr_t *hdr, elfType_t type)
+{
+	uintptr_t epaddr = 0;
+	u32 relocs_size = hdr->reloc_cnt * sizeof(u32);
+
+	if (hdr->version != IANOS_PRELINK_VERSION || hdr->image_size > hdr->mem_size || hdr->entry >= hdr->image_size ||
+		hdr->reloc_cnt > (hdr->mem_size / sizeof(u32)) ||
+		f_size(fp) != (sizeof(ianos_prelink_hdr_t) + hdr->image_size + relocs_size))
+		return 0;
+
+	u8 *buf = (u8 *)_ianos_lib_buf(type, hdr->mem_size);
+	u32 *relocs = (u32 *)malloc(relocs_size);
+
+	// Image is read straight to its place. No ELF parsing needed.
+	if (f_read(fp, buf, hdr->image_size, NULL) || f_read(fp, relocs, relocs_size, NULL))
+		goto out;
+
+	u32 crc = crc32_calc(0, (u8 *)hdr + IANOS_PRELINK_CRC_OFF, sizeof(ianos_prelink_hdr_t) - IANOS_PRELINK_CRC_OFF);
+	crc = crc32_calc(crc, buf, hdr->image_size);
+	crc = crc32_calc(crc, (u8 *)relocs, relocs_size);
+	if (crc != hdr->crc32)
+		goto out;
+
+	memset(buf + hdr->image_size, 0, hdr->mem_size - hdr->image_size);
+
+	// Rebase only if not loaded at the address it was relocated for.
+	u32 delta = (u32)buf - hdr->load_addr;
+	if (delta)
+	{
+		for (u32 i = 0; i < hdr->reloc_cnt; i++)
+		{
+			if (relocs[i] > (hdr->mem_size - sizeof(u32)))
+				goto out;
+
+			*(u32 *)(buf + relocs[i]) += delta;
+		}
+	}
+
+	epaddr = (uintptr_t)buf + hdr->entry;
+
+out:
+	if (!epaddr)
+		_ianos_lib_buf_free(buf);
+	free(relocs);
+
+	return epaddr;
+}
+
+static uintptr_t _ianos_load_elf(FIL *fp, elfType_t type)
 {
 	el_ctx ctx;
 	uintptr_t epaddr = 0;
 
 	// Read library.
-	fileBuf = sd_file_read(path, NULL);
-
-	if (!fileBuf)
+	u32 size = f_size(fp);
+	fileBuf = malloc(size);
+	f_lseek(fp, 0);
+	if (f_read(fp, fileBuf, size, NULL))
 		goto out;
 
 	ctx.pread = _ianos_read_cb;
@@ -85,39 +154,54 @@ uintptr_t ianos_loader(char *path, elfType_t type, void *moduleConfig)
 	if (el_init(&ctx))
 		goto out;
 
-	// Set our relocated library's buffer.
-	switch (type & 0xFFFF)
-	{
-	case EXEC_ELF:
-	case AR64_ELF:
-		elfBuf = (void *)DRAM_LIB_ADDR;
-		break;
-	default:
-		elfBuf = malloc(ctx.memsz); // Aligned to 0x10 by default.
-	}
-
+	elfBuf = _ianos_lib_buf(type, ctx.memsz);
 	if (!elfBuf)
 		goto out;
 
 	// Load and relocate library.
 	ctx.base_load_vaddr = ctx.base_load_paddr = (uintptr_t)elfBuf;
-	if (el_load(&ctx, _ianos_alloc_cb))
-		goto out_free;
-
-	if (el_relocate(&ctx))
-		goto out_free;
+	if (el_load(&ctx, _ianos_alloc_cb) || el_relocate(&ctx))
+	{
+		_ianos_lib_buf_free(elfBuf);
+		goto out;
+	}
 
-	// Launch.
 	epaddr = ctx.ehdr.e_entry + (uintptr_t)elfBuf;
-	moduleEntrypoint_t ep = (moduleEntrypoint_t)epaddr;
-
-	_ianos_call_ep(ep, moduleConfig);
 
-out_free:
+out:
 	free(fileBuf);
 	elfBuf = NULL;
 	fileBuf = NULL;
 
-out:
 	return epaddr;
-}
\ No newline at end of file
+}
+
+//TODO: Support shared libraries.
+uintptr_t ianos_loader(char *path, elfType_t type, void *moduleConfig)
+{
+	FIL fp;
+	UINT br = 0;
+	uintptr_t epaddr = 0;
+	ianos_prelink_hdr_t hdr;
+
+	if (!sd_get_card_mounted())
+		return 0;
+
+	if (f_open(&fp, path, FA_READ) != FR_OK)
+		return 0;
+
+	// Use prelinked image if available. Otherwise parse and relocate the ELF.
+	f_read(&fp, &hdr, sizeof(ianos_prelink_hdr_t), &br);
+	if (br == sizeof(ianos_prelink_hdr_t) && hdr.magic == IANOS_PRELINK_MAGIC)
+		epaddr = _ianos_load_prelinked(&fp, &hdr, type);
+	else
+		epaddr = _ianos_load_elf(&fp, type);
+
+	f_close(&fp);
+
+	// Launch.
+	if (epaddr)
+		_ianos_call_ep((moduleEntrypoint_t)epaddr, moduleConfig);
+
+	return epaddr;
+}
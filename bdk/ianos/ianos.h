@@ -20,6 +20,22 @@
 
 #include <utils/types.h>
 
+#define IANOS_PRELINK_MAGIC   0x4C504E49 // INPL.
+#define IANOS_PRELINK_VERSION 1
+#define IANOS_PRELINK_CRC_OFF 12
+
+typedef struct _ianos_prelink_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 crc32;      // Covers everything after it, including image and relocations.
+	u32 image_size; // Stored image size.
+	u32 mem_size;   // Loaded size. Anything after the stored image is zeroed.
+	u32 entry;      // Entrypoint offset.
+	u32 load_addr;  // Address the image is relocated for.
+	u32 reloc_cnt;  // Number of image offsets to rebase if loaded elsewhere.
+} ianos_prelink_hdr_t;
+
 typedef enum
 {
 	DRAM_LIB = 0, // DRAM library.
@@ -34,6 +34,8 @@
 // For disabling driver when logging is enabled.
 #include <libs/lv_conf.h>
 
+#define JC_RX_RING_SIZE 0x400
+
 #define JC_WIRED_CMD             0x91
 #define JC_WIRED_HID             0x92
 #define JC_WIRED_INIT_REPLY      0x94
@@ -314,6 +316,9 @@ typedef struct _jc_sio_hid_in_rpt_t
 typedef struct _joycon_ctxt_t
 {
 	u8  buf[0x100]; //FIXME: If heap is used, dumping breaks.
+	u8  rx_ring_buf[JC_RX_RING_SIZE];
+	uart_rx_ring_t rx_ring;
+	u32 rx_len; // Bytes of the current packet in buf when receiving from ring.
 	u8  uart;
 	u8  type;
 	u8  state;
@@ -431,6 +436,21 @@ static void _jc_detect()
 	}
 }
 
+static void _jc_rx_ring_enable(joycon_ctxt_t *jc)
+{
+	jc->rx_len = 0;
+
+	// Stay on polled rx if the IRQ could not be taken.
+	if (uart_rx_ring_enable(&jc->rx_ring, jc->uart, jc->rx_ring_buf, JC_RX_RING_SIZE))
+		jc->rx_ring.size = 0;
+}
+
+static void _jc_rx_ring_disable(joycon_ctxt_t *jc)
+{
+	uart_rx_ring_disable(&jc->rx_ring);
+	jc->rx_len = 0;
+}
+
 static void _jc_conn_check()
 {
 	_jc_detect();
@@ -441,6 +461,8 @@ static void _jc_conn_check()
 	// Check if a Joy-Con was disconnected.
 	if (!jc_l.detected)
 	{
+		_jc_rx_ring_disable(&jc_l);
+
 		if (jc_l.connected)
 			_jc_power_supply(UART_C, false);
 
@@ -458,6 +480,8 @@ static void _jc_conn_check()
 
 	if (!jc_r.detected)
 	{
+		_jc_rx_ring_disable(&jc_r);
+
 		if (jc_r.connected)
 			_jc_power_supply(UART_B, false);
 
@@ -771,12 +795,8 @@ static void _jc_sio_uart_pkt_parse(joycon_ctxt_t *jc, const jc_sio_in_rpt_t *pkt
 	jc->last_received_time = get_tmr_ms();
 }
 
-static void _jc_rcv_pkt(joycon_ctxt_t *jc)
+static void _jc_pkt_parse(joycon_ctxt_t *jc, u32 len)
 {
-	if (!jc->detected)
-		return;
-
-	u32 len = uart_recv(jc->uart, (u8 *)jc->buf, 0x100);
 	if (len < 8)
 		return;
 
@@ -799,6 +819,81 @@ static void _jc_rcv_pkt(joycon_ctxt_t *jc)
 	}
 }
 
+static u32 _jc_pkt_size(joycon_ctxt_t *jc)
+{
+	u32 size;
+
+	// Returns header size until that is received, then the full packet size. 0 if not a packet start.
+	if (!jc->sio_mode)
+	{
+		jc_uart_hdr_t *hdr = (jc_uart_hdr_t *)jc->buf;
+		if (jc->rx_len < sizeof(jc_uart_hdr_t))
+			return sizeof(jc_uart_hdr_t);
+		if (memcmp(hdr->magic, "\x19\x81\x03", 3))
+			return 0;
+
+		size = sizeof(jc_uart_hdr_t) + (hdr->total_size_lsb | (hdr->total_size_msb << 8));
+	}
+	else
+	{
+		jc_sio_in_rpt_t *hdr = (jc_sio_in_rpt_t *)jc->buf;
+		if (jc->rx_len < sizeof(jc_sio_in_rpt_t))
+			return sizeof(jc_sio_in_rpt_t);
+		if (hdr->cmd != JC_SIO_INPUT_RPT)
+			return 0;
+
+		size = sizeof(jc_sio_in_rpt_t) + hdr->payload_size;
+	}
+
+	return size <= sizeof(jc->buf) ? size : 0;
+}
+
+static void _jc_rcv_ring(joycon_ctxt_t *jc)
+{
+	// Frame and parse all packets the IRQ handler has received so far.
+	while (true)
+	{
+		u32 size = _jc_pkt_size(jc);
+		if (!size)
+		{
+			// Out of sync. Drop a byte and search for the next header.
+			jc->rx_len--;
+			memmove(jc->buf, jc->buf + 1, jc->rx_len);
+			continue;
+		}
+
+		if (jc->rx_len < size)
+		{
+			jc->rx_len += uart_rx_ring_recv(&jc->rx_ring, jc->buf + jc->rx_len, size - jc->rx_len);
+			if (jc->rx_len < size)
+				break;
+
+			// Header might be complete now, so get the real size.
+			continue;
+		}
+
+		_jc_pkt_parse(jc, size);
+		jc->rx_len = 0;
+	}
+}
+
+static void _jc_rcv_pkt(joycon_ctxt_t *jc)
+{
+	if (!jc->detected)
+		return;
+
+	// After init, data is received by the IRQ handler.
+	if (jc->rx_ring.size)
+	{
+		_jc_rcv_ring(jc);
+
+		return;
+	}
+
+	u32 len = uart_recv(jc->uart, (u8 *)jc->buf, 0x100);
+	_jc_pkt_parse(jc, len);
+}
+
 static bool _jc_send_init_rumble(joycon_ctxt_t *jc)
 {
 	// Send init rumble or request nx pad status report.
@@ -900,6 +995,10 @@ jc_gamepad_rpt_t *jc_get_bt_pairing_info(bool *is_l_hos, bool *is_r_hos)
 	bool jc_r_found = jc_r.connected ? false : true;
 	bool jc_l_found = jc_l.connected ? false : true;
 
+	// Replies are read directly from the fifo.
+	_jc_rx_ring_disable(&jc_l);
+	_jc_rx_ring_disable(&jc_r);
+
 	// Set mode to HW controlled RTS.
 	uart_set_mode(jc_l.uart, UART_AO_TX_HW_RX);
 	uart_set_mode(jc_r.uart, UART_AO_TX_HW_RX);
@@ -1001,6 +1100,11 @@ retry:
 	uart_set_mode(jc_l.uart, UART_AO_TX_MN_RX);
 	uart_set_mode(jc_r.uart, UART_AO_TX_MN_RX);
 
+	if (jc_l.connected)
+		_jc_rx_ring_enable(&jc_l);
+	if (jc_r.connected)
+		_jc_rx_ring_enable(&jc_r);
+
 	return &jc_gamepad;
 }
 
@@ -1026,6 +1130,7 @@ static void _jc_init_conn(joycon_ctxt_t *jc)
 		}
 
 		// Initialize uart to 1 megabaud and manual RTS.
+		_jc_rx_ring_disable(jc);
 		uart_init(jc->uart, 1000000, UART_AO_TX_MN_RX);
 
 		if (!jc->sio_mode)
@@ -1131,6 +1236,9 @@ static void _jc_init_conn(joycon_ctxt_t *jc)
 		// Initialization done.
 		jc->state = JC_STATE_INIT_DONE;
 
+		// Receive in the background from now on.
+		_jc_rx_ring_enable(jc);
+
 out:
 		jc->last_received_time = get_tmr_ms();
 
@@ -1216,6 +1324,9 @@ void jc_deinit()
 	if (!jc_init_done)
 		return;
 
+	_jc_rx_ring_disable(&jc_l);
+	_jc_rx_ring_disable(&jc_r);
+
 	// Disable power.
 	_jc_power_supply(UART_B, false);
 	_jc_power_supply(UART_C, false);
@@ -42,6 +42,7 @@ DRESULT disk_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count);
 DRESULT disk_write (BYTE pdrv, const BYTE* buff, DWORD sector, UINT count);
 DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
 DRESULT disk_set_info (BYTE pdrv, BYTE cmd, void *buff);
+void*   disk_get_ptr (BYTE pdrv, DWORD sector, UINT count);
 
 
 /* Disk Status Bits (DSTATUS) */
@@ -44,6 +44,13 @@
 #define EFSPRINTF(text, ...) print_error(); gfx_printf("%k"text"%k\n", 0xFFFFFF00, 0xFFFFFFFF);
 //#define EFSPRINTF(...)
 
+#ifndef FF_USE_MCACHE
+#define FF_USE_MCACHE	0
+#endif
+#ifndef FF_USE_DIRINDEX
+#define FF_USE_DIRINDEX	0
+#endif
+
 /*--------------------------------------------------------------------------
 
    Module Private Definitions
@@ -1065,6 +1072,276 @@ static void clear_lock (	/* Clear lock entries of the volume */
 
 
 
+#if FF_USE_MCACHE
+/*-----------------------------------------------------------------------*/
+/* Metadata cache - Set associative sector cache behind the window       */
+/*-----------------------------------------------------------------------*/
+
+#define MC_SETS		(FF_MCACHE_LINES / FF_MCACHE_WAYS)
+#define MC_LINE_SZ	(FF_MCACHE_LINE_SS * FF_MAX_SS)
+#define MC_LINE_ALL	((1 << FF_MCACHE_LINE_SS) - 1)
+
+typedef struct {
+	DWORD	sect;		/* Top sector of the line */
+	DWORD	age;		/* Last access stamp for LRU replacement */
+	BYTE	valid;		/* Valid sectors bitmap (0:Line is free) */
+	BYTE	dirty;		/* Dirty sectors bitmap */
+} MCLINE;
+
+typedef struct {
+	BYTE	buf[FF_MCACHE_LINES * MC_LINE_SZ];	/* Line buffers. Kept first for DMA alignment */
+	MCLINE	line[FF_MCACHE_LINES];
+	DWORD	age;		/* Access stamp counter */
+	UINT	ndirty;		/* Number of lines with dirty sectors */
+} MCACHE;
+
+static MCACHE* McCache[FF_VOLUMES];	/* Metadata cache of each physical drive */
+
+
+static void mc_init (	/* Allocate and invalidate the metadata cache of a volume */
+	FATFS* fs
+)
+{
+	MCACHE *mc;
+
+
+	if (!(FF_MCACHE_VOLUMES & (1 << fs->pdrv))) return;	/* Cache not enabled for this volume */
+	mc = McCache[fs->pdrv];
+	if (!mc) {
+		mc = ff_memalloc(sizeof (MCACHE));
+		if (!mc) return;	/* Run uncached if not enough memory */
+		McCache[fs->pdrv] = mc;
+	}
+	mem_set(mc->line, 0, sizeof mc->line);
+	mc->age = 0;
+	mc->ndirty = 0;
+}
+
+
+static MCLINE* mc_find (	/* Returns the line holding the sector or NULL */
+	MCACHE* mc,
+	DWORD sect			/* Top sector of the line */
+)
+{
+	UINT i = (sect / FF_MCACHE_LINE_SS) % MC_SETS * FF_MCACHE_WAYS;
+	UINT end = i + FF_MCACHE_WAYS;
+
+
+	for ( ; i < end; i++) {
+		if (mc->line[i].valid && mc->line[i].sect == sect) return &mc->line[i];
+	}
+	return 0;
+}
+
+
+static BYTE* mc_sect_buf (	/* Returns the buffer of a sector in a line */
+	MCACHE* mc,
+	MCLINE* line,
+	UINT ofs			/* Sector offset in the line */
+)
+{
+	return mc->buf + (UINT)(line - mc->line) * MC_LINE_SZ + ofs * FF_MAX_SS;
+}
+
+
+#if !FF_FS_READONLY
+static FRESULT mc_flush_line (	/* Write back dirty sectors of a line */
+	FATFS* fs,
+	MCACHE* mc,
+	MCLINE* line
+)
+{
+	UINT ofs, cnt;
+	DWORD sect;
+
+
+	if (!line->dirty) return FR_OK;
+
+	for (ofs = 0; ofs < FF_MCACHE_LINE_SS; ofs += cnt) {
+		for (cnt = 0; ofs + cnt < FF_MCACHE_LINE_SS && (line->dirty & (1 << (ofs + cnt))); cnt++) ;	/* Get dirty run */
+		if (!cnt) { cnt = 1; continue; }
+		sect = line->sect + ofs;
+		if (disk_write(fs->pdrv, mc_sect_buf(mc, line, ofs), sect, cnt) != RES_OK) return FR_DISK_ERR;
+		if (fs->n_fats == 2 && sect - fs->fatbase < fs->fsize) {	/* Is it in the 1st FAT? */
+			disk_write(fs->pdrv, mc_sect_buf(mc, line, ofs), sect + fs->fsize, cnt);	/* Reflect it to 2nd FAT */
+		}
+	}
+	line->dirty = 0;
+	mc->ndirty--;
+	return FR_OK;
+}
+
+
+static FRESULT mc_flush (	/* Write back all dirty lines of a volume */
+	FATFS* fs
+)
+{
+	MCACHE *mc = McCache[fs->pdrv];
+	UINT i;
+
+
+	for (i = 0; mc && mc->ndirty && i < FF_MCACHE_LINES; i++) {
+		if (mc_flush_line(fs, mc, &mc->line[i]) != FR_OK) return FR_DISK_ERR;
+	}
+	return FR_OK;
+}
+#endif
+
+
+static MCLINE* mc_alloc (	/* Get a free or the least recently used line of the set */
+	FATFS* fs,
+	MCACHE* mc,
+	DWORD sect			/* Top sector of the line */
+)
+{
+	UINT i = (sect / FF_MCACHE_LINE_SS) % MC_SETS * FF_MCACHE_WAYS;
+	UINT end = i + FF_MCACHE_WAYS;
+	MCLINE *line = &mc->line[i];
+
+
+	for ( ; i < end; i++) {
+		if (!mc->line[i].valid) { line = &mc->line[i]; break; }
+		if (mc->line[i].age < line->age) line = &mc->line[i];
+	}
+#if !FF_FS_READONLY
+	if (mc_flush_line(fs, mc, line) != FR_OK) return 0;	/* Evict it */
+#endif
+	line->sect = sect;
+	line->valid = 0;
+	return line;
+}
+
+
+static FRESULT mc_read (	/* Load a sector to the window through the cache */
+	FATFS* fs,
+	DWORD sector
+)
+{
+	MCACHE *mc = McCache[fs->pdrv];
+	MCLINE *line;
+	DWORD lsect;
+	UINT ofs;
+
+
+	if (!mc) return (disk_read(fs->pdrv, fs->win, sector, 1) == RES_OK) ? FR_OK : FR_DISK_ERR;
+
+	ofs = sector % FF_MCACHE_LINE_SS;
+	lsect = sector - ofs;
+	line = mc_find(mc, lsect);
+	if (!line || !(line->valid & (1 << ofs))) {
+		if (!line) {	/* Read ahead the whole line on a miss */
+			line = mc_alloc(fs, mc, lsect);
+			if (!line) return FR_DISK_ERR;
+			if (disk_read(fs->pdrv, mc_sect_buf(mc, line, 0), lsect, FF_MCACHE_LINE_SS) == RES_OK) {
+				line->valid = MC_LINE_ALL;
+			}
+		}
+		if (!(line->valid & (1 << ofs))) {	/* Partial line. Read only the requested sector */
+			if (disk_read(fs->pdrv, mc_sect_buf(mc, line, ofs), sector, 1) != RES_OK) return FR_DISK_ERR;
+			line->valid |= 1 << ofs;
+		}
+	}
+	line->age = ++mc->age;
+	mem_cpy(fs->win, mc_sect_buf(mc, line, ofs), FF_MAX_SS);
+	return FR_OK;
+}
+
+
+#if !FF_FS_READONLY
+static FRESULT mc_write (	/* Store the window to the cache */
+	FATFS* fs
+)
+{
+	MCACHE *mc = McCache[fs->pdrv];
+	MCLINE *line;
+	DWORD lsect;
+	UINT ofs;
+
+
+	ofs = fs->winsect % FF_MCACHE_LINE_SS;
+	lsect = fs->winsect - ofs;
+	line = mc_find(mc, lsect);
+	if (!line) {
+		line = mc_alloc(fs, mc, lsect);
+		if (!line) return FR_DISK_ERR;
+	}
+	mem_cpy(mc_sect_buf(mc, line, ofs), fs->win, FF_MAX_SS);
+	if (!line->dirty) mc->ndirty++;
+	line->valid |= 1 << ofs;
+	line->dirty |= 1 << ofs;
+	line->age = ++mc->age;
+	return FR_OK;
+}
+#endif
+
+
+static void mc_sync_io (	/* Keep cache coherent with direct sector transfers */
+	BYTE pdrv,
+	BYTE* buff,
+	DWORD sector,
+	UINT count,
+	int write			/* 0:Patch read data with dirty sectors, 1:Refresh cached sectors */
+)
+{
+	MCACHE *mc = McCache[pdrv];
+	MCLINE *line;
+	DWORD lsect, sect;
+	UINT ofs;
+
+
+	if (!mc || (!write && !mc->ndirty)) return;
+
+	for (lsect = sector - sector % FF_MCACHE_LINE_SS; lsect < sector + count; lsect += FF_MCACHE_LINE_SS) {
+		line = mc_find(mc, lsect);
+		if (!line) continue;
+		for (ofs = 0; ofs < FF_MCACHE_LINE_SS; ofs++) {
+			sect = lsect + ofs;
+			if (sect < sector || sect >= sector + count) continue;
+			if (write) {
+				mem_cpy(mc_sect_buf(mc, line, ofs), buff + (sect - sector) * FF_MAX_SS, FF_MAX_SS);
+				line->valid |= 1 << ofs;
+				if (line->dirty & (1 << ofs)) {
+					line->dirty &= ~(1 << ofs);
+					if (!line->dirty) mc->ndirty--;
+				}
+			} else if (line->dirty & (1 << ofs)) {
+				mem_cpy(buff + (sect - sector) * FF_MAX_SS, mc_sect_buf(mc, line, ofs), FF_MAX_SS);
+			}
+		}
+	}
+}
+
+
+static DRESULT mc_disk_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+	DRESULT res = disk_read(pdrv, buff, sector, count);
+
+	if (res == RES_OK) mc_sync_io(pdrv, buff, sector, count, 0);
+	return res;
+}
+
+
+#if !FF_FS_READONLY
+static DRESULT mc_disk_write (BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+	DRESULT res = disk_write(pdrv, buff, sector, count);
+
+	if (res == RES_OK) mc_sync_io(pdrv, (BYTE*)buff, sector, count, 1);
+	return res;
+}
+#endif
+
+/* Direct sector transfers from here on go through the metadata cache */
+#define disk_read(pdrv, buff, sector, count)	mc_disk_read(pdrv, (BYTE*)(buff), sector, count)
+#if !FF_FS_READONLY
+#define disk_write(pdrv, buff, sector, count)	mc_disk_write(pdrv, (const BYTE*)(buff), sector, count)
+#endif
+
+#endif	/* FF_USE_MCACHE */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Move/Flush disk access window in the filesystem object                */
 /*-----------------------------------------------------------------------*/
@@ -1077,6 +1354,13 @@ static FRESULT sync_window (	/* Returns FR_OK or FR_DISK_ERR */
 
 
 	if (fs->wflag) {	/* Is the disk access window dirty */
+#if FF_USE_MCACHE
+		if (McCache[fs->pdrv]) {	/* Write back the window to the cache. Disk gets updated on sync */
+			res = mc_write(fs);
+			if (res == FR_OK) fs->wflag = 0;
+			return res;
+		}
+#endif
 		if (disk_write(fs->pdrv, fs->win, fs->winsect, 1) == RES_OK) {	/* Write back the window */
 			fs->wflag = 0;	/* Clear window dirty flag */
 			if (fs->winsect - fs->fatbase < fs->fsize) {	/* Is it in the 1st FAT? */
@@ -1104,7 +1388,11 @@ static FRESULT move_window (	/* Returns FR_OK or FR_DISK_ERR */
 		res = sync_window(fs);		/* Write-back changes */
 #endif
 		if (res == FR_OK) {			/* Fill sector window with new data */
+#if FF_USE_MCACHE
+			if (mc_read(fs, sector) != FR_OK) {
+#else
 			if (disk_read(fs->pdrv, fs->win, sector, 1) != RES_OK) {
+#endif
 				sector = 0xFFFFFFFF;	/* Invalidate window if read data is not valid */
 				res = FR_DISK_ERR;
 			}
@@ -1144,6 +1432,9 @@ static FRESULT sync_fs (	/* Returns FR_OK or FR_DISK_ERR */
 			disk_write(fs->pdrv, fs->win, fs->winsect, 1);
 			fs->fsi_flag = 0;
 		}
+#if FF_USE_MCACHE
+		if (res == FR_OK) res = mc_flush(fs);	/* Write back metadata cache */
+#endif
 		/* Make sure that no pending write process in the lower layer */
 		if (disk_ioctl(fs->pdrv, CTRL_SYNC, 0) != RES_OK) res = FR_DISK_ERR;
 	}
@@ -1324,9 +1615,9 @@ static DWORD find_bitmap (	/* 0:Not found, 2..:Cluster block found, 0xFFFFFFFF:D
 	DWORD ncl	/* Number of contiguous clusters to find (1..) */
 )
 {
-	BYTE bm, bv;
-	UINT i;
-	DWORD val, scl, ctr;
+	BYTE bv;
+	UINT i, n;
+	DWORD val, scl, ctr, lim, w;
 
 
 	clst -= 2;	/* The first bit in the bitmap corresponds to cluster #2 */
@@ -1334,22 +1625,27 @@ static DWORD find_bitmap (	/* 0:Not found, 2..:Cluster block found, 0xFFFFFFFF:D
 	scl = val = clst; ctr = 0;
 	for (;;) {
 		if (move_window(fs, fs->bitbase + val / 8 / SS(fs)) != FR_OK) return 0xFFFFFFFF;
-		i = val / 8 % SS(fs); bm = 1 << (val % 8);
 		do {
-			do {
-				bv = fs->win[i] & bm; bm <<= 1;		/* Get bit value */
-				if (++val >= fs->n_fatent - 2) {	/* Next cluster (with wrap-around) */
-					val = 0; bm = 0; i = SS(fs);
-				}
-				if (bv == 0) {	/* Is it a free cluster? */
-					if (++ctr == ncl) return scl + 2;	/* Check if run length is sufficient for required */
-				} else {
-					scl = val; ctr = 0;		/* Encountered a cluster in-use, restart to scan */
+			i = val / 8 % SS(fs);
+			bv = (fs->win[i] >> (val % 8)) & 1; n = 1;	/* Get bit value */
+			if (val % 8 == 0) {	/* On a byte boundary, try to check a whole word/byte at once */
+				lim = (val < clst ? clst : fs->n_fatent - 2) - val;	/* Clusters left before wrap-around or scan end */
+				if (val % 32 == 0 && lim >= 32 && ((w = ld_dword(fs->win + i)) == 0 || w == 0xFFFFFFFF)) {
+					n = 32;
+				} else if (lim >= 8 && (fs->win[i] == 0 || fs->win[i] == 0xFF)) {
+					n = 8;
 				}
-				if (val == clst) return 0;	/* All cluster scanned? */
-			} while (bm != 0);
-			bm = 1;
-		} while (++i < SS(fs));
+			}
+			val += n;
+			if (val >= fs->n_fatent - 2) val = 0;	/* Next cluster (with wrap-around) */
+			if (bv == 0) {	/* Is it a free cluster? */
+				ctr += n;
+				if (ctr >= ncl) return scl + 2;	/* Check if run length is sufficient for required */
+			} else {
+				scl = val; ctr = 0;		/* Encountered a cluster in-use, restart to scan */
+			}
+			if (val == clst) return 0;	/* All cluster scanned? */
+		} while (val % (SS(fs) * 8));
 	}
 }
 
@@ -1617,6 +1913,7 @@ static DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:D
 		res = put_fat(fs, ncl, 0xFFFFFFFF);		/* Mark the new cluster 'EOC' */
 		if (res == FR_OK && clst != 0) {
 			res = put_fat(fs, clst, ncl);		/* Link it from the previous one if needed */
+			if (FF_FS_EXFAT && ncl != clst + 1) obj->stat = 0;	/* Is the chain got fragmented? */
 		}
 	}
 
@@ -2439,8 +2736,9 @@ static FRESULT dir_read (
 /* Directory handling - Find an object in the directory                  */
 /*-----------------------------------------------------------------------*/
 
-static FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
-	DIR* dp					/* Pointer to the directory object with the file name */
+static FRESULT dir_scan (	/* FR_OK(0):succeeded, !=0:error */
+	DIR* dp,				/* Pointer to the directory object with the file name */
+	int one					/* 0:Scan to end of the directory, 1:Check only the object at current position */
 )
 {
 	FRESULT res;
@@ -2450,15 +2748,13 @@ static FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
 	BYTE a, ord, sum;
 #endif
 
-	res = dir_sdi(dp, 0);			/* Rewind directory object */
-	if (res != FR_OK) return res;
 #if FF_FS_EXFAT
 	if (fs->fs_type == FS_EXFAT) {	/* On the exFAT volume */
 		BYTE nc;
-		UINT di, ni;
+		UINT di, ni, n;
 		WORD hash = xname_sum(fs->lfnbuf);		/* Hash value of the name to find */
 
-		while ((res = DIR_READ_FILE(dp)) == FR_OK) {	/* Read an item */
+		for (n = 0; (res = (one && n) ? FR_NO_FILE : DIR_READ_FILE(dp)) == FR_OK; n++) {	/* Read an item */
 #if FF_MAX_LFN < 255
 			if (fs->dirbuf[XDIR_NumName] > FF_MAX_LFN) continue;			/* Skip comparison if inaccessible object name */
 #endif
@@ -2500,6 +2796,7 @@ static FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
 				if (ord == 0 && sum == sum_sfn(dp->dir)) break;	/* LFN matched? */
 				if (!(dp->fn[NSFLAG] & NS_LOSS) && !mem_cmp(dp->dir, dp->fn, 11)) break;	/* SFN matched? */
 				ord = 0xFF; dp->blk_ofs = 0xFFFFFFFF;	/* Reset LFN sequence */
+				if (one) { res = FR_NO_FILE; break; }	/* Only one object to be checked */
 			}
 		}
 #else		/* Non LFN configuration */
@@ -2513,6 +2810,346 @@ static FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
 }
 
 
+#if FF_USE_DIRINDEX
+/*-----------------------------------------------------------------------*/
+/* Directory index - In-memory name hash index of large directories      */
+/*-----------------------------------------------------------------------*/
+
+#if !FF_USE_LFN
+#error FF_USE_DIRINDEX requires FF_USE_LFN
+#endif
+
+#define DIX_NONE		0xFFFFFFFF
+#define DIX_INIT_RECS	64		/* Initial number of records (power of 2) */
+
+typedef struct {
+	DWORD	hash;		/* Name hash */
+	DWORD	ofs;		/* Offset of the object's entry block in the directory */
+	DWORD	next;		/* Next record in the bucket chain or in the free list */
+} DIXREC;
+
+typedef struct {
+	FATFS*	fs;			/* Filesystem object (0:Slot is free) */
+	WORD	id;			/* Volume mount ID of the filesystem object */
+	DWORD	sclust;		/* Start cluster of the directory */
+	DWORD	age;		/* Last access stamp for LRU replacement */
+	DWORD	nrec;		/* Number of records and buckets (0:Directory is too small to be indexed) */
+	DWORD	nobj;		/* Number of objects of a small directory */
+	DWORD	free;		/* Head of the free record list */
+	DWORD*	bkt;		/* Bucket heads */
+	DIXREC*	rec;		/* Records */
+} DIXSLOT;
+
+static DIXSLOT DirIx[FF_DIRINDEX_DIRS];	/* Indexed directories */
+static DWORD DirIxAge;					/* Access stamp counter */
+
+
+static DWORD dix_hash (	/* FNV-1a hash step */
+	DWORD hash,
+	DWORD chr
+)
+{
+	return (hash ^ chr) * 0x01000193;
+}
+
+
+static DWORD dix_hash_lfn (	/* Get case-insensitive hash of an LFN */
+	const WCHAR* lfn
+)
+{
+	DWORD hash = 0x811C9DC5;
+
+
+	while (*lfn) hash = dix_hash(hash, ff_wtoupper(*lfn++));
+	return hash;
+}
+
+
+static DWORD dix_hash_sfn (	/* Get hash of an SFN */
+	const BYTE* sfn
+)
+{
+	DWORD hash = 0x811C9DC5;
+	UINT i;
+
+
+	for (i = 0; i < 11; i++) hash = dix_hash(hash, sfn[i]);
+	return hash;
+}
+
+
+#if FF_FS_EXFAT
+static DWORD dix_hash_xdir (	/* Get case-insensitive hash of the name in an exFAT entry block */
+	const BYTE* dirb
+)
+{
+	DWORD hash = 0x811C9DC5;
+	UINT nc, di;
+
+
+	for (nc = dirb[XDIR_NumName], di = SZDIRE * 2; nc; nc--, di += 2) {
+		if ((di % SZDIRE) == 0) di += 2;
+		hash = dix_hash(hash, ff_wtoupper(ld_word(dirb + di)));
+	}
+	return hash;
+}
+#endif
+
+
+static void dix_free (	/* Release a slot */
+	DIXSLOT* ix
+)
+{
+	ff_memfree(ix->bkt);
+	ff_memfree(ix->rec);
+	mem_set(ix, 0, sizeof (DIXSLOT));
+}
+
+
+static void dix_drop (	/* Discard the index of a directory */
+	FATFS* fs,			/* Filesystem object */
+	DWORD sclust		/* Start cluster of the directory (DIX_NONE:All directories of the volume) */
+)
+{
+	UINT i;
+
+
+	for (i = 0; i < FF_DIRINDEX_DIRS; i++) {
+		if (DirIx[i].fs == fs && (sclust == DIX_NONE || DirIx[i].sclust == sclust)) dix_free(&DirIx[i]);
+	}
+}
+
+
+static int dix_add (	/* 1:Added, 0:Not enough memory */
+	DIXSLOT* ix,
+	DWORD hash,			/* Name hash */
+	DWORD ofs			/* Offset of the entry block */
+)
+{
+	DWORD i, n, *bkt;
+	DIXREC *rec;
+
+
+	if (ix->free == DIX_NONE) {	/* Double the table if all records are in use */
+		n = ix->nrec ? ix->nrec * 2 : DIX_INIT_RECS;
+		rec = ff_memalloc(n * sizeof (DIXREC));
+		bkt = ff_memalloc(n * sizeof (DWORD));
+		if (!rec || !bkt) {
+			ff_memfree(rec); ff_memfree(bkt);
+			return 0;
+		}
+		if (ix->nrec) mem_cpy(rec, ix->rec, ix->nrec * sizeof (DIXREC));
+		for (i = 0; i < n; i++) bkt[i] = DIX_NONE;	/* Empty buckets (DWORD is not always 32-bit) */
+		for (i = 0; i < ix->nrec; i++) {	/* Rehash the records */
+			rec[i].next = bkt[rec[i].hash & (n - 1)];
+			bkt[rec[i].hash & (n - 1)] = i;
+		}
+		for ( ; i < n; i++) rec[i].next = (i + 1 < n) ? i + 1 : DIX_NONE;	/* Link new records to the free list */
+		ix->free = ix->nrec;
+		ff_memfree(ix->rec); ff_memfree(ix->bkt);
+		ix->rec = rec; ix->bkt = bkt; ix->nrec = n;
+	}
+	i = ix->free;
+	rec = &ix->rec[i];
+	ix->free = rec->next;
+	rec->hash = hash;
+	rec->ofs = ofs;
+	rec->next = ix->bkt[hash & (ix->nrec - 1)];
+	ix->bkt[hash & (ix->nrec - 1)] = i;
+	return 1;
+}
+
+
+static int dix_add_obj (	/* Add the object read/registered at dp to the index. 1:Added, 0:Not enough memory */
+	DIXSLOT* ix,
+	DIR* dp,
+	const BYTE* sfn,	/* SFN of the object (FAT only) */
+	DWORD ofs,			/* Offset of the entry block */
+	int lfn				/* The object has an LFN (FAT only) */
+)
+{
+#if FF_FS_EXFAT
+	if (dp->obj.fs->fs_type == FS_EXFAT) {
+		return dix_add(ix, dix_hash_xdir(dp->obj.fs->dirbuf), ofs);
+	}
+#endif
+	if (!dix_add(ix, dix_hash_sfn(sfn), ofs)) return 0;
+	return lfn ? dix_add(ix, dix_hash_lfn(dp->obj.fs->lfnbuf), ofs) : 1;
+}
+
+
+static FRESULT dix_build (	/* Index all objects in the directory */
+	DIR* dp,
+	DIXSLOT* ix
+)
+{
+	FRESULT res;
+	FATFS *fs = dp->obj.fs;
+	DIR dj;
+	WCHAR *name;
+	DWORD nobj;
+	UINT len;
+
+
+	for (len = 0; fs->lfnbuf[len]; len++) ;
+	name = ff_memalloc((len + 1) * sizeof (WCHAR));	/* Save the name to find as dir_read() overwrites it */
+	if (!name) return FR_NOT_ENOUGH_CORE;
+	mem_cpy(name, fs->lfnbuf, (len + 1) * sizeof (WCHAR));
+
+	ix->fs = fs; ix->id = fs->id; ix->sclust = dp->obj.sclust;
+	ix->age = ++DirIxAge; ix->free = DIX_NONE;
+	mem_cpy(&dj, dp, sizeof (DIR));
+	nobj = 0;
+	res = dir_sdi(&dj, 0);
+	while (res == FR_OK) {
+		res = DIR_READ_FILE(&dj);
+		if (res != FR_OK) break;
+		if (fs->fs_type == FS_EXFAT || dj.blk_ofs != 0xFFFFFFFF) {	/* Has the object an LFN? */
+			if (!dix_add_obj(ix, &dj, dj.dir, dj.blk_ofs, 1)) res = FR_NOT_ENOUGH_CORE;
+		} else {
+			if (!dix_add_obj(ix, &dj, dj.dir, dj.dptr, 0)) res = FR_NOT_ENOUGH_CORE;
+		}
+		if (res != FR_OK) break;
+		nobj++;
+		res = dir_next(&dj, 0);
+	}
+	if (res == FR_NO_FILE) res = FR_OK;	/* Reached end of the directory */
+
+	if (res != FR_OK) {
+		dix_free(ix);
+	} else if (nobj < FF_DIRINDEX_MIN) {	/* Small directory. Keep the slot to not rebuild it but search linearly */
+		ff_memfree(ix->bkt); ff_memfree(ix->rec);
+		ix->bkt = 0; ix->rec = 0; ix->nrec = 0; ix->nobj = nobj;
+	}
+	mem_cpy(fs->lfnbuf, name, (len + 1) * sizeof (WCHAR));
+	ff_memfree(name);
+	return res;
+}
+
+
+static DIXSLOT* dix_get (	/* Returns the index slot of the directory or NULL */
+	DIR* dp,
+	int create			/* Build the index if not exist */
+)
+{
+	FATFS *fs = dp->obj.fs;
+	DIXSLOT *ix, *lru = DirIx;
+	UINT i;
+
+
+	if (!(FF_DIRINDEX_VOLUMES & (1 << fs->pdrv))) return 0;	/* Index not enabled for this volume */
+	for (i = 0; i < FF_DIRINDEX_DIRS; i++) {
+		ix = &DirIx[i];
+		if (ix->fs == fs && ix->id == fs->id && ix->sclust == dp->obj.sclust) {
+			ix->age = ++DirIxAge;
+			return ix;
+		}
+		if (ix->age < lru->age) lru = ix;	/* Free slots have the lowest age */
+	}
+	if (!create) return 0;
+	dix_free(lru);
+	return (dix_build(dp, lru) == FR_OK) ? lru : 0;
+}
+
+
+static FRESULT dix_find (	/* FR_OK:Found, FR_NO_FILE:Not found, FR_NOT_ENABLED:Directory is not indexed, others:Error */
+	DIR* dp				/* Pointer to the directory object with the file name */
+)
+{
+	FRESULT res;
+	DIXSLOT *ix;
+	DWORD h, hl, hs, i;
+	UINT k;
+
+
+	if (dp->fn[NSFLAG] & NS_DOT) return FR_NOT_ENABLED;	/* Dot entries are not indexed */
+	ix = dix_get(dp, 1);
+	if (!ix || !ix->nrec) return FR_NOT_ENABLED;
+
+	hl = hs = dix_hash_lfn(dp->obj.fs->lfnbuf);		/* Hash of the LFN */
+	if (dp->obj.fs->fs_type != FS_EXFAT && !(dp->fn[NSFLAG] & NS_LOSS)) {
+		hs = dix_hash_sfn(dp->fn);					/* Hash of the SFN */
+		if (dp->fn[NSFLAG] & NS_NOLFN) hl = hs;		/* Find only SFN */
+	}
+	for (k = 0; k < 2; k++) {	/* Check the objects with LFN and then SFN hash matched */
+		h = k ? hs : hl;
+		if (k && hs == hl) break;
+		for (i = ix->bkt[h & (ix->nrec - 1)]; i != DIX_NONE; i = ix->rec[i].next) {
+			if (ix->rec[i].hash != h) continue;
+			res = dir_sdi(dp, ix->rec[i].ofs);
+			if (res == FR_OK) res = dir_scan(dp, 1);
+			if (res != FR_NO_FILE) return res;	/* Found or error */
+		}
+	}
+	return FR_NO_FILE;
+}
+
+
+#if !FF_FS_READONLY
+static void dix_register (	/* Add a new object to the index of its directory */
+	DIR* dp,			/* Directory object pointing the SFN entry (FAT) or with the entry block (exFAT) */
+	DWORD ofs			/* Offset of the entry block */
+)
+{
+	DIXSLOT *ix = dix_get(dp, 0);
+
+
+	if (!ix) return;
+	if (!ix->nrec) {	/* Small directory. Drop the slot when it grows enough, so the next lookup indexes it */
+		if (++ix->nobj >= FF_DIRINDEX_MIN) dix_free(ix);
+		return;
+	}
+	if (!dix_add_obj(ix, dp, dp->fn, ofs, dp->fn[NSFLAG] & NS_LFN)) dix_free(ix);	/* Drop the index if it cannot be kept coherent */
+}
+
+
+static void dix_unregister (	/* Remove an object from the index of its directory */
+	DIR* dp,			/* Directory object pointing the object */
+	DWORD ofs			/* Offset of the entry block */
+)
+{
+	DIXSLOT *ix = dix_get(dp, 0);
+	DWORD b, *p;
+
+
+	if (!ix || !ix->nrec) return;
+	for (b = 0; b < ix->nrec; b++) {	/* Unlink all records of the object */
+		p = &ix->bkt[b];
+		while (*p != DIX_NONE) {
+			if (ix->rec[*p].ofs == ofs) {
+				DWORD i = *p;
+
+				*p = ix->rec[i].next;
+				ix->rec[i].next = ix->free;
+				ix->free = i;
+			} else {
+				p = &ix->rec[*p].next;
+			}
+		}
+	}
+}
+#endif
+
+#endif	/* FF_USE_DIRINDEX */
+
+
+static FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
+	DIR* dp					/* Pointer to the directory object with the file name */
+)
+{
+	FRESULT res;
+
+
+#if FF_USE_DIRINDEX
+	res = dix_find(dp);				/* Look up the directory index */
+	if (res != FR_NOT_ENABLED) return res;
+#endif
+	res = dir_sdi(dp, 0);			/* Rewind directory object */
+	if (res != FR_OK) return res;
+	return dir_scan(dp, 0);
+}
+
+
 
 
 #if !FF_FS_READONLY
@@ -2562,6 +3199,9 @@ static FRESULT dir_register (	/* FR_OK:succeeded, FR_DENIED:no free entry or too
 		}
 
 		create_xdir(fs->dirbuf, fs->lfnbuf);	/* Create on-memory directory block to be written later */
+#if FF_USE_DIRINDEX
+		dix_register(dp, dp->blk_ofs);
+#endif
 		return FR_OK;
 	}
 #endif
@@ -2611,6 +3251,9 @@ static FRESULT dir_register (	/* FR_OK:succeeded, FR_DENIED:no free entry or too
 			dp->dir[DIR_NTres] = dp->fn[NSFLAG] & (NS_BODY | NS_EXT);	/* Put NT flag */
 #endif
 			fs->wflag = 1;
+#if FF_USE_DIRINDEX
+			dix_register(dp, dp->dptr - SZDIRE * ((sn[NSFLAG] & NS_LFN) ? (nlen + 12) / 13 : 0));
+#endif
 		}
 	}
 
@@ -2635,6 +3278,9 @@ static FRESULT dir_remove (	/* FR_OK:Succeeded, FR_DISK_ERR:A disk error */
 #if FF_USE_LFN		/* LFN configuration */
 	DWORD last = dp->dptr;
 
+#if FF_USE_DIRINDEX && !FF_FS_READONLY
+	dix_unregister(dp, (dp->blk_ofs == 0xFFFFFFFF) ? dp->dptr : dp->blk_ofs);
+#endif
 	res = (dp->blk_ofs == 0xFFFFFFFF) ? FR_OK : dir_sdi(dp, dp->blk_ofs);	/* Goto top of the entry block if LFN is exist */
 	if (res == FR_OK) {
 		do {
@@ -3293,6 +3939,12 @@ static FRESULT find_volume (	/* FR_OK(0): successful, !=0: an error occurred */
 	if (!FF_FS_READONLY && mode && (stat & STA_PROTECT)) { /* Check disk write protection if needed */
 		return FR_WRITE_PROTECTED;
 	}
+#if FF_USE_MCACHE
+	mc_init(fs);						/* Invalidate metadata cache */
+#endif
+#if FF_USE_DIRINDEX
+	dix_drop(fs, DIX_NONE);				/* Discard directory index */
+#endif
 #if FF_MAX_SS != FF_MIN_SS				/* Get sector size (multiple sector size cfg only) */
 	if (disk_ioctl(fs->pdrv, GET_SECTOR_SIZE, &SS(fs)) != RES_OK) return FR_DISK_ERR;
 	if (SS(fs) > FF_MAX_SS || SS(fs) < FF_MIN_SS || (SS(fs) & (SS(fs) - 1))) return FR_DISK_ERR;
@@ -3589,6 +4241,12 @@ FRESULT f_mount (
 #endif
 #if FF_FS_REENTRANT						/* Discard sync object of the current volume */
 		if (!ff_del_syncobj(cfs->sobj)) return FR_INT_ERR;
+#endif
+#if FF_USE_MCACHE && !FF_FS_READONLY
+		if (cfs->fs_type) mc_flush(cfs);	/* Write back metadata cache */
+#endif
+#if FF_USE_DIRINDEX
+		dix_drop(cfs, DIX_NONE);		/* Discard directory index */
 #endif
 		cfs->fs_type = 0;				/* Clear old fs object */
 	}
@@ -3751,6 +4409,7 @@ FRESULT f_open (
 			{
 				fp->obj.sclust = ld_clust(fs, dj.dir);					/* Get object allocation info */
 				fp->obj.objsize = ld_dword(dj.dir + DIR_FileSize);
+				if (FF_FS_EXFAT) fp->obj.stat = 0;						/* FAT: Contiguity is only known after f_expand */
 			}
 #if FF_USE_FASTSEEK
 			fp->cltbl = 0;			/* Disable fast seek mode */
@@ -3866,6 +4525,19 @@ FRESULT f_read (
 				if (csect + cc > fs->csize) {	/* Clip at cluster boundary */
 					cc = fs->csize - csect;
 				}
+				while (cc < btr / SS(fs)) {		/* Extend the transfer over the following contiguous clusters */
+#if FF_USE_FASTSEEK
+					if (fp->cltbl) {
+						clst = clmt_clust(fp, fp->fptr + (FSIZE_t)cc * SS(fs));
+					} else
+#endif
+					{
+						clst = get_fat(&fp->obj, fp->clust);
+					}
+					if (clst != fp->clust + 1) break;	/* Not contiguous or error. Next pass resolves it */
+					fp->clust = clst;
+					cc += (btr / SS(fs) - cc < fs->csize) ? btr / SS(fs) - cc : fs->csize;
+				}
 				if (disk_read(fs->pdrv, rbuff, sect, cc) != RES_OK) {
 					EFSPRINTF("RLIO");
 					ABORT(fs, FR_DISK_ERR);
@@ -3919,86 +4591,131 @@ FRESULT f_read (
 
 
 
-#if FF_FASTFS && FF_USE_FASTSEEK
+#if FF_FASTFS && FF_USE_FASTSEEK && FF_FS_EXFAT
 /*-----------------------------------------------------------------------*/
-/* Fast Read Aligned Sized File Without a Cache                         */
+/* Get Sector of a Range in a Contiguous File                            */
 /*-----------------------------------------------------------------------*/
 
-FRESULT f_read_fast (
-	FIL* fp,			/* Pointer to the file object */
-	const void* buff,	/* Pointer to the data to be written */
-	UINT btr			/* Number of bytes to read */
+static DWORD contig_sect (	/* 0:Not contiguous or not aligned, >=1:Sector# */
+	FIL* fp,		/* Pointer to the file object */
+	UINT btx		/* Number of bytes to transfer */
+)
+{
+	FATFS *fs = fp->obj.fs;
+
+
+	if (fp->obj.stat != 2 || fp->obj.sclust < 2 || !btx) return 0;	/* Is the chain not contiguous? */
+	if (fp->fptr % SS(fs) || fp->fptr + btx > fp->obj.objsize) return 0;	/* Is the range not allocated? */
+
+	return clst2sect(fs, fp->obj.sclust) + (DWORD)(fp->fptr / SS(fs));
+}
+#endif
+
+
+
+
+#if FF_FASTFS && FF_USE_FASTSEEK && FF_FS_EXFAT
+/*-----------------------------------------------------------------------*/
+/* Map a Contiguous File Range of a Memory Backed Drive                  */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_map_fast (
+	FIL* fp,		/* Pointer to the file object */
+	UINT btx,		/* Number of bytes to map */
+	BYTE mode,		/* Access mode (FA_READ or FA_WRITE) */
+	void** ptr		/* Pointer to return the data address. NULL if it can't be mapped */
 )
 {
 	FRESULT res;
 	FATFS *fs;
-	UINT csize_bytes;
-	DWORD clst;
-	UINT count = 0;
-	FSIZE_t work_sector = 0;
-	FSIZE_t sector_base = 0;
-	BYTE *wbuff = (BYTE*)buff;
+	DWORD sect;
+	UINT cc;
 
-	// TODO support sector reading inside a cluster
 
+	*ptr = 0;
 	res = validate(&fp->obj, &fs);			/* Check validity of the file object */
 	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK) {
 		EFSPRINTF("FOV");
 		LEAVE_FF(fs, res);	/* Check validity */
 	}
+	if (!(fp->flag & mode)) LEAVE_FF(fs, FR_DENIED); /* Check access mode */
 
-	if (!(fp->flag & FA_READ)) LEAVE_FF(fs, FR_DENIED); /* Check access mode */
-	FSIZE_t remain = fp->obj.objsize - fp->fptr;
-	if (btr > remain) btr = (UINT)remain;		/* Truncate btr by remaining bytes */
+	sect = contig_sect(fp, btx);
+	if (!sect) LEAVE_FF(fs, FR_OK);			/* Not contiguous or not allocated */
+	cc = (btx + SS(fs) - 1) / SS(fs);
+	*ptr = disk_get_ptr(fs->pdrv, sect, cc);
+	if (!*ptr) LEAVE_FF(fs, FR_OK);			/* Not a memory backed drive */
 
-	csize_bytes = fs->csize * SS(fs);
-
-	if (!fp->fptr) {	/* On the top of the file? */
-		clst = fp->obj.sclust;	/* Follow from the origin */
-	} else {
-		if (fp->cltbl) clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
-		else { EFSPRINTF("CLTBL"); ABORT(fs, FR_CLTBL_NO_INIT); }
+#if !FF_FS_READONLY && !FF_FS_TINY
+	if (fp->sect - sect < cc) {				/* Is the sector cache inside the range? */
+		if (fp->flag & FA_DIRTY) {			/* Write-back dirty sector cache */
+			if (disk_write(fs->pdrv, fp->buf, fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+			fp->flag &= (BYTE)~FA_DIRTY;
+		}
+		if (mode & FA_WRITE) fp->sect = 0;	/* Invalidate it since the caller changes the data */
 	}
-	if (clst < 2) { EFSPRINTF("CCHK"); ABORT(fs, FR_INT_ERR); }
-	else if (clst == 0xFFFFFFFF) { EFSPRINTF("DSKC"); ABORT(fs, FR_DISK_ERR); }
+	if (mode & FA_WRITE) fp->flag |= FA_MODIFIED;
+#endif
+	fp->fptr += btx;						/* Caller accesses the range directly */
+	fp->clust = fp->obj.sclust + (DWORD)((fp->fptr - 1) / ((DWORD)fs->csize * SS(fs)));
 
-	fp->clust = clst;	/* Set working cluster */
+	LEAVE_FF(fs, FR_OK);
+}
+#endif
 
-	sector_base = clst2sect(fs, fp->clust);
-	count += fs->csize;
-	btr -= csize_bytes;
-	fp->fptr += csize_bytes;
 
-	while (btr) {
-		clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
 
-		if (clst < 2) { EFSPRINTF("CCHK2"); ABORT(fs, FR_INT_ERR); }
-		else if (clst == 0xFFFFFFFF) { EFSPRINTF("DSKC"); ABORT(fs, FR_DISK_ERR); }
 
-		fp->clust = clst;
+#if FF_FASTFS && FF_USE_FASTSEEK
+/*-----------------------------------------------------------------------*/
+/* Fast Read File Directly to the Caller Buffer                          */
+/*-----------------------------------------------------------------------*/
 
-		work_sector = clst2sect(fs, fp->clust);
-		if ((work_sector - sector_base) == count) count += fs->csize;
-		else {
-			if (disk_read(fs->pdrv, wbuff, sector_base, count) != RES_OK) ABORT(fs, FR_DISK_ERR);
-			wbuff += count * SS(fs);
+FRESULT f_read_fast (
+	FIL* fp,			/* Pointer to the file object */
+	const void* buff,	/* Pointer to data buffer */
+	UINT btr			/* Number of bytes to read */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	UINT br;
+	BYTE *rbuff = (BYTE*)buff;
 
-			sector_base = work_sector;
-			count = fs->csize;
-		}
 
-		fp->fptr += MIN(btr, csize_bytes);
-		btr -= MIN(btr, csize_bytes);
+	res = validate(&fp->obj, &fs);			/* Check validity of the file object */
+	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK) {
+		EFSPRINTF("FOV");
+		LEAVE_FF(fs, res);	/* Check validity */
+	}
 
-		// TODO: what about if data is smaller than cluster?
-		// Must read-write back that cluster.
+	if (!(fp->flag & FA_READ)) LEAVE_FF(fs, FR_DENIED); /* Check access mode */
+	FSIZE_t remain = fp->obj.objsize - fp->fptr;
+	if (btr > remain) btr = (UINT)remain;		/* Truncate btr by remaining bytes */
 
-		if (!btr) {	/* Final cluster/sectors read. */
-			if (disk_read(fs->pdrv, wbuff, sector_base, count) != RES_OK) ABORT(fs, FR_DISK_ERR);
+#if FF_FS_EXFAT
+	DWORD sect = contig_sect(fp, btr);
+	UINT cc = btr / SS(fs);
+	if (sect && cc) {	/* Contiguous file? Read the whole sectors directly */
+		if (disk_read(fs->pdrv, rbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
+#if !FF_FS_READONLY && !FF_FS_TINY
+		if ((fp->flag & FA_DIRTY) && fp->sect - sect < cc) {	/* Replace the sector with the dirty cache */
+			mem_cpy(rbuff + ((fp->sect - sect) * SS(fs)), fp->buf, SS(fs));
 		}
+#endif
+		fp->fptr += (FSIZE_t)cc * SS(fs);
+		fp->clust = fp->obj.sclust + (DWORD)((fp->fptr - 1) / ((DWORD)fs->csize * SS(fs)));
+		rbuff += cc * SS(fs);
+		btr -= cc * SS(fs);
+		if (!btr) LEAVE_FF(fs, FR_OK);
 	}
+#endif
 
-	LEAVE_FF(fs, FR_OK);
+	/* Unaligned head and partial tail go through the sector cache. */
+	/* The aligned middle is read directly over contiguous clusters. */
+	res = f_read(fp, rbuff, btr, &br);
+
+	LEAVE_FF(fs, res);
 }
 #endif
 
@@ -4146,7 +4863,7 @@ FRESULT f_write (
 
 #if FF_FASTFS && FF_USE_FASTSEEK
 /*-----------------------------------------------------------------------*/
-/* Fast Write Aligned Sized File Without a Cache                         */
+/* Fast Write File Directly from the Caller Buffer                       */
 /*-----------------------------------------------------------------------*/
 
 FRESULT f_write_fast (
@@ -4159,12 +4876,11 @@ FRESULT f_write_fast (
 	FATFS *fs;
 	UINT csize_bytes;
 	DWORD clst;
-	UINT count = 0;
+	UINT run, wsize, bw;
 	FSIZE_t work_sector = 0;
 	FSIZE_t sector_base = 0;
 	const BYTE *wbuff = (const BYTE*)buff;
 
-	// TODO support sector writing inside a cluster
 
 	res = validate(&fp->obj, &fs);			/* Check validity of the file object */
 	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK) {
@@ -4180,55 +4896,92 @@ FRESULT f_write_fast (
 
 	csize_bytes = fs->csize * SS(fs);
 
-	if (!fp->fptr) {	/* On the top of the file? */
-		clst = fp->obj.sclust;	/* Follow from the origin */
-	} else {
-		if (fp->cltbl) clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
-		else { EFSPRINTF("CLTBL"); ABORT(fs, FR_CLTBL_NO_INIT); }
+#if FF_FS_EXFAT
+	work_sector = contig_sect(fp, btw);
+	wsize = btw / SS(fs);
+	if (work_sector && wsize) {	/* Contiguous file? Write the whole sectors directly */
+		if (disk_write(fs->pdrv, wbuff, work_sector, wsize) != RES_OK) ABORT(fs, FR_DISK_ERR);
+#if !FF_FS_TINY
+		if (fp->sect - work_sector < wsize) {	/* Refill sector cache if it gets invalidated by the direct write */
+			mem_cpy(fp->buf, wbuff + ((fp->sect - work_sector) * SS(fs)), SS(fs));
+			fp->flag &= (BYTE)~FA_DIRTY;
+		}
+#endif
+		fp->fptr += (FSIZE_t)wsize * SS(fs);
+		fp->clust = fp->obj.sclust + (DWORD)((fp->fptr - 1) / csize_bytes);
+		fp->flag |= FA_MODIFIED;	/* Set file change flag */
+		wbuff += wsize * SS(fs);
+		btw -= wsize * SS(fs);
 	}
+#endif
 
-	if (clst < 2) { EFSPRINTF("CCHK"); ABORT(fs, FR_INT_ERR); }
-	else if (clst == 0xFFFFFFFF) { EFSPRINTF("DERR"); ABORT(fs, FR_DISK_ERR); }
+	/* Whole sectors from a cluster boundary are written directly over the CLMT */
+	wsize = (fp->fptr % csize_bytes) ? 0 : btw - btw % SS(fs);
+	if (wsize) {
+		if (!fp->fptr) {	/* On the top of the file? */
+			clst = fp->obj.sclust;	/* Follow from the origin */
+		} else {
+			if (fp->cltbl) clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
+			else { EFSPRINTF("CLTBL"); ABORT(fs, FR_CLTBL_NO_INIT); }
+		}
 
-	fp->clust = clst;	/* Set working cluster */
+		if (clst < 2) { EFSPRINTF("CCHK"); ABORT(fs, FR_INT_ERR); }
+		else if (clst == 0xFFFFFFFF) { EFSPRINTF("DERR"); ABORT(fs, FR_DISK_ERR); }
+
+#if !FF_FS_TINY
+		if (fp->flag & FA_DIRTY) {	/* Write-back dirty sector cache, it gets invalidated below */
+			if (disk_write(fs->pdrv, fp->buf, fp->sect, 1) != RES_OK) ABORT(fs, FR_DISK_ERR);
+			fp->flag &= (BYTE)~FA_DIRTY;
+		}
+#endif
 
-	sector_base = clst2sect(fs, fp->clust);
-	count += fs->csize;
-	btw -= csize_bytes;
-	fp->fptr += csize_bytes;
+		fp->clust = clst;	/* Set working cluster */
 
-	while (btw) {
-		clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
+		sector_base = clst2sect(fs, fp->clust);
+		run = MIN(wsize, csize_bytes);	/* Bytes in the current run of sectors */
+		wsize -= run;
+		fp->fptr += run;
 
-		if (clst < 2) { EFSPRINTF("CCHK2"); ABORT(fs, FR_INT_ERR); }
-		else if (clst == 0xFFFFFFFF) { EFSPRINTF("DERR"); ABORT(fs, FR_DISK_ERR); }
+		while (wsize) {
+			clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
 
-		fp->clust = clst;
+			if (clst < 2) { EFSPRINTF("CCHK2"); ABORT(fs, FR_INT_ERR); }
+			else if (clst == 0xFFFFFFFF) { EFSPRINTF("DERR"); ABORT(fs, FR_DISK_ERR); }
 
-		work_sector = clst2sect(fs, fp->clust);
-		if ((work_sector - sector_base) == count) count += fs->csize;
-		else {
-			if (disk_write(fs->pdrv, wbuff, sector_base, count) != RES_OK) ABORT(fs, FR_DISK_ERR);
-			wbuff += count * SS(fs);
+			fp->clust = clst;
 
-			sector_base = work_sector;
-			count = fs->csize;
-		}
+			work_sector = clst2sect(fs, fp->clust);
+			if ((work_sector - sector_base) != run / SS(fs)) {	/* Fragmented? Write the current run */
+				if (disk_write(fs->pdrv, wbuff, sector_base, run / SS(fs)) != RES_OK) ABORT(fs, FR_DISK_ERR);
+				wbuff += run;
+				btw -= run;
 
-		fp->fptr += MIN(btw, csize_bytes);
-		btw -= MIN(btw, csize_bytes);
+				sector_base = work_sector;
+				run = 0;
+			}
 
-		// what about if data is smaller than cluster?
-		// Probably must read-write back that cluster.
-		if (!btw) {	/* Final cluster/sectors write. */
-			if (disk_write(fs->pdrv, wbuff, sector_base, count) != RES_OK) ABORT(fs, FR_DISK_ERR);
-			fp->flag &= (BYTE)~FA_DIRTY;
+			run += MIN(wsize, csize_bytes);
+			fp->fptr += MIN(wsize, csize_bytes);
+			wsize -= MIN(wsize, csize_bytes);
 		}
+
+		/* Final cluster/sectors write */
+		if (disk_write(fs->pdrv, wbuff, sector_base, run / SS(fs)) != RES_OK) ABORT(fs, FR_DISK_ERR);
+		wbuff += run;
+		btw -= run;
+#if !FF_FS_TINY
+		fp->sect = 0;	/* Invalidate sector cache, the direct writes may overlap it */
+#endif
+		fp->flag |= FA_MODIFIED;	/* Set file change flag */
 	}
 
-	fp->flag |= FA_MODIFIED;	/* Set file change flag */
+	/* Unaligned head and partial tail go through the sector cache */
+	if (btw) {
+		res = f_write(fp, wbuff, btw, &bw);
+		if (res == FR_OK && bw != btw) res = FR_DENIED;
+	}
 
-	LEAVE_FF(fs, FR_OK);
+	LEAVE_FF(fs, res);
 }
 #endif
 
@@ -4702,7 +5455,12 @@ DWORD *f_expand_cltbl (
 	FSIZE_t ofs		/* File pointer from top of file */
 )
 {
-	if (fp->flag & FA_WRITE) f_lseek(fp, ofs);	/* Expand file if write is enabled */
+	if (fp->flag & FA_WRITE) {	/* Expand file if write is enabled */
+#if FF_USE_EXPAND
+		if (!fp->obj.objsize && ofs) f_expand(fp, ofs, 1);	/* Try to allocate a contiguous block first */
+#endif
+		f_lseek(fp, ofs);
+	}
 	if (!fp->cltbl) {	/* Allocate memory for cluster link table */
 		fp->cltbl = (DWORD *)ff_memalloc(tblsz);
 		fp->cltbl[0] = tblsz;
@@ -4942,6 +5700,89 @@ FRESULT f_stat (
 
 
 #if !FF_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Count Free Clusters in FAT16/32 or exFAT Allocation Bitmap            */
+/*-----------------------------------------------------------------------*/
+
+static UINT count_bits (	/* Returns number of bits set in the word */
+	DWORD w
+)
+{
+	w = w - ((w >> 1) & 0x55555555);
+	w = (w & 0x33333333) + ((w >> 2) & 0x33333333);
+	return ((((w + (w >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24) & 0x3F;
+}
+
+
+static FRESULT count_free (	/* FR_OK(0):succeeded, !=0:error */
+	FATFS* fs,		/* Filesystem object */
+	DWORD* nfree	/* Pointer to return number of free clusters */
+)
+{
+	FRESULT res;
+	BYTE *buf;
+	UINT szb, ns, i, n;
+	DWORD nent, sect, cnt = 0;
+
+
+	res = sync_window(fs);	/* Flush the window as the FAT is read without it */
+	if (res != FR_OK) return res;
+	for (szb = MAX_MALLOC, buf = 0; szb > SS(fs) && (buf = ff_memalloc(szb)) == 0; szb /= 2) ;	/* Get a bulk buffer */
+	if (!buf) {	/* Use the window if no memory */
+		buf = fs->win; szb = SS(fs); fs->winsect = 0xFFFFFFFF;	/* Window is to be invalidated */
+	}
+#if FF_FS_EXFAT
+	if (fs->fs_type == FS_EXFAT) {
+		nent = fs->n_fatent - 2;	/* Number of clusters (bits) */
+		sect = fs->bitbase;			/* Bitmap sector */
+	} else
+#endif
+	{
+		nent = fs->n_fatent;		/* Number of entries */
+		sect = fs->fatbase;			/* Top of the FAT */
+	}
+	while (nent) {	/* Read the table in multiple sectors at a time */
+#if FF_FS_EXFAT
+		if (fs->fs_type == FS_EXFAT) {
+			ns = (nent + SS(fs) * 8 - 1) / (SS(fs) * 8);
+		} else
+#endif
+		{
+			ns = (nent * (fs->fs_type == FS_FAT16 ? 2 : 4) + SS(fs) - 1) / SS(fs);
+		}
+		if (ns > szb / SS(fs)) ns = szb / SS(fs);
+		if (disk_read(fs->pdrv, buf, sect, ns) != RES_OK) { res = FR_DISK_ERR; break; }
+		sect += ns;
+#if FF_FS_EXFAT
+		if (fs->fs_type == FS_EXFAT) {	/* Count zero bits a word at a time */
+			n = (nent < ns * SS(fs) * 8) ? nent : ns * SS(fs) * 8;
+			for (i = 0; i + 32 <= n; i += 32) cnt += 32 - count_bits(ld_dword(buf + i / 8));
+			for ( ; i < n; i++) {	/* Remaining bits in the last word */
+				if (!((buf[i / 8] >> (i % 8)) & 1)) cnt++;
+			}
+			nent -= n;
+			continue;
+		}
+#endif
+		if (fs->fs_type == FS_FAT16) {	/* Count zero entries */
+			n = (nent < ns * SS(fs) / 2) ? nent : ns * SS(fs) / 2;
+			for (i = 0; i < n; i++) {
+				if (ld_word(buf + i * 2) == 0) cnt++;
+			}
+		} else {
+			n = (nent < ns * SS(fs) / 4) ? nent : ns * SS(fs) / 4;
+			for (i = 0; i < n; i++) {
+				if ((ld_dword(buf + i * 4) & 0x0FFFFFFF) == 0) cnt++;
+			}
+		}
+		nent -= n;
+	}
+	if (buf != fs->win) ff_memfree(buf);
+	*nfree = cnt;
+	return res;
+}
+
+
 /*-----------------------------------------------------------------------*/
 /* Get Number of Free Clusters                                           */
 /*-----------------------------------------------------------------------*/
@@ -4954,8 +5795,7 @@ FRESULT f_getfree (
 {
 	FRESULT res;
 	FATFS *fs;
-	DWORD nfree, clst, sect, stat;
-	UINT i;
+	DWORD nfree, clst, stat;
 	FFOBJID obj;
 
 
@@ -4978,46 +5818,7 @@ FRESULT f_getfree (
 					if (stat == 0) nfree++;
 				} while (++clst < fs->n_fatent);
 			} else {
-#if FF_FS_EXFAT
-				if (fs->fs_type == FS_EXFAT) {	/* exFAT: Scan allocation bitmap */
-					BYTE bm;
-					UINT b;
-
-					clst = fs->n_fatent - 2;	/* Number of clusters */
-					sect = fs->bitbase;			/* Bitmap sector */
-					i = 0;						/* Offset in the sector */
-					do {	/* Counts numbuer of bits with zero in the bitmap */
-						if (i == 0) {
-							res = move_window(fs, sect++);
-							if (res != FR_OK) break;
-						}
-						for (b = 8, bm = fs->win[i]; b && clst; b--, clst--) {
-							if (!(bm & 1)) nfree++;
-							bm >>= 1;
-						}
-						i = (i + 1) % SS(fs);
-					} while (clst);
-				} else
-#endif
-				{	/* FAT16/32: Scan WORD/DWORD FAT entries */
-					clst = fs->n_fatent;	/* Number of entries */
-					sect = fs->fatbase;		/* Top of the FAT */
-					i = 0;					/* Offset in the sector */
-					do {	/* Counts numbuer of entries with zero in the FAT */
-						if (i == 0) {
-							res = move_window(fs, sect++);
-							if (res != FR_OK) break;
-						}
-						if (fs->fs_type == FS_FAT16) {
-							if (ld_word(fs->win + i) == 0) nfree++;
-							i += 2;
-						} else {
-							if ((ld_dword(fs->win + i) & 0x0FFFFFFF) == 0) nfree++;
-							i += 4;
-						}
-						i %= SS(fs);
-					} while (--clst);
-				}
+				res = count_free(fs, &nfree);	/* FAT16/32/exFAT: Bulk scan of FAT/bitmap */
 			}
 			*nclst = nfree;			/* Return the free clusters */
 			fs->free_clst = nfree;	/* Now free_clst is valid */
@@ -5156,6 +5957,9 @@ FRESULT f_unlink (
 			}
 			if (res == FR_OK) {
 				res = dir_remove(&dj);			/* Remove the directory entry */
+#if FF_USE_DIRINDEX
+				if (dclst != 0) dix_drop(fs, dclst);	/* Discard index of the removed sub-directory */
+#endif
 				if (res == FR_OK && dclst != 0) {	/* Remove the cluster chain if exist */
 #if FF_FS_EXFAT
 					res = remove_chain(&obj, dclst, 0);
@@ -6870,6 +7674,74 @@ int f_printf (
 	return putc_flush(&pb);
 }
 
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Buffered String Writer                                                */
+/*-----------------------------------------------------------------------*/
+/* Unlike f_puts, the buffer outlives the call, so many short strings    */
+/* end up in one f_write instead of one each.                            */
+
+void f_putbuf_init (
+	FPUTBUF* pb,	/* Pointer to the writer */
+	FIL* fp,		/* Pointer to the file object */
+	void* buf,		/* Pointer to the write buffer */
+	UINT size		/* Size of the write buffer (>= 2) */
+)
+{
+	pb->fp = fp;
+	pb->buf = (BYTE*)buf;
+	pb->size = size;
+	pb->idx = 0;
+	pb->err = 0;
+}
+
+
+int f_putbuf_flush (
+	FPUTBUF* pb		/* Pointer to the writer */
+)
+{
+	UINT nw;
+
+
+	if (!pb->err && pb->idx) {
+		if (f_write(pb->fp, pb->buf, pb->idx, &nw) != FR_OK || nw != pb->idx) pb->err = 1;
+		pb->idx = 0;
+	}
+	return pb->err ? EOF : 0;
+}
+
+
+int f_putbuf_puts (
+	FPUTBUF* pb,		/* Pointer to the writer */
+	const TCHAR* str	/* Pointer to the string to be output */
+)
+{
+	if (str == (void *)0 || pb->err) return EOF;
+
+#if FF_USE_LFN && FF_LFN_UNICODE
+	/* Strings need code conversion. Keep order and let f_puts do it */
+	if (f_putbuf_flush(pb) == EOF) return EOF;
+	return f_puts(str, pb->fp);
+#else
+	int nc = 0;
+
+	while (*str) {
+		if (pb->idx >= pb->size - 1) {	/* Keep room for a CRLF pair */
+			if (f_putbuf_flush(pb) == EOF) return EOF;
+		}
+		if (FF_USE_STRFUNC == 2 && *str == '\n') {	/* LF -> CRLF conversion */
+			pb->buf[pb->idx++] = '\r';
+			nc++;
+		}
+		pb->buf[pb->idx++] = (BYTE)*str++;
+		nc++;
+	}
+	return nc;
+#endif
+}
+
 #endif /* !FF_FS_READONLY */
 #endif /* FF_USE_STRFUNC */
 
@@ -225,6 +225,18 @@ typedef struct {
 
 
 
+/* Buffered string writer (FPUTBUF) */
+
+typedef struct {
+	FIL*	fp;				/* Pointer to the file object */
+	BYTE*	buf;			/* Pointer to the write buffer */
+	UINT	size;			/* Size of the write buffer */
+	UINT	idx;			/* Bytes in the write buffer */
+	int		err;			/* Write error flag */
+} FPUTBUF;
+
+
+
 /* File function return code (FRESULT) */
 
 typedef enum {
@@ -266,6 +278,7 @@ FRESULT f_read (FIL* fp, void* buff, UINT btr, UINT* br);			/* Read data from th
 FRESULT f_write (FIL* fp, const void* buff, UINT btw, UINT* bw);	/* Write data to the file */
 FRESULT f_read_fast (FIL* fp, const void* buff, UINT btr);			/* Fast read data from the file */
 FRESULT f_write_fast (FIL* fp, const void* buff, UINT btw);         /* Fast write data to the file */
+FRESULT f_map_fast (FIL* fp, UINT btx, BYTE mode, void** ptr);		/* Map a contiguous range of a memory backed file */
 FRESULT f_lseek (FIL* fp, FSIZE_t ofs);								/* Move file pointer of the file object */
 FRESULT f_truncate (FIL* fp);										/* Truncate the file */
 FRESULT f_sync (FIL* fp);											/* Flush cached data of the writing file */
@@ -297,6 +310,9 @@ int f_putc (TCHAR c, FIL* fp);										/* Put a character to the file */
 int f_puts (const TCHAR* str, FIL* cp);								/* Put a string to the file */
 int f_printf (FIL* fp, const TCHAR* str, ...);						/* Put a formatted string to the file */
 TCHAR* f_gets (TCHAR* buff, int len, FIL* fp);						/* Get a string from the file */
+void f_putbuf_init (FPUTBUF* pb, FIL* fp, void* buf, UINT size);	/* Set up a buffered string writer */
+int f_putbuf_puts (FPUTBUF* pb, const TCHAR* str);					/* Put a string to the buffered writer */
+int f_putbuf_flush (FPUTBUF* pb);									/* Write buffered strings to the file */
 
 #define f_eof(fp) ((int)((fp)->fptr == (fp)->obj.objsize))
 #define f_error(fp) ((fp)->err)
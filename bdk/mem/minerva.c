@@ -25,6 +25,8 @@
 #include <soc/fuse.h>
 #include <soc/hw_init.h>
 #include <soc/t210.h>
+#include <storage/sd.h>
+#include <thermal/tmp451.h>
 #include <utils/util.h>
 
 #define TABLE_FREQ_KHZ_OFFSET        0x40
@@ -32,10 +34,98 @@
 #define TABLE_LA_REGS_T210B01_OFFSET 0xFA4
 #define LA_SDMMC1_INDEX 6
 
+#define MTC_TRAIN_TEMP_DELTA 10 // Max SoC temperature difference in celsius.
+
 extern volatile nyx_storage_t *nyx_str;
 
 void (*minerva_cfg)(mtc_config_t *mtc_cfg, void *);
 
+// Rates trained by init. Others stay untrained in the saved tables.
+static bool _minerva_train_rate(u32 rate_khz)
+{
+	return rate_khz == FREQ_204 || rate_khz == FREQ_800 || rate_khz == FREQ_1600;
+}
+
+static void _minerva_train_cache_hdr(mtc_train_cache_t *hdr, mtc_config_t *mtc_cfg)
+{
+	memset(hdr, 0, sizeof(mtc_train_cache_t));
+
+	hdr->magic         = MTC_TRAIN_CACHE_MAGIC;
+	hdr->version       = MTC_TRAIN_CACHE_VERSION;
+	hdr->entry_size    = sizeof(emc_table_t);
+	hdr->table_entries = mtc_cfg->table_entries;
+	hdr->sdram_id      = mtc_cfg->sdram_id;
+
+	// Training results are only valid for the same SoC and DRAM.
+	hdr->chip_uid[0] = FUSE(FUSE_OPT_LOT_CODE_0);
+	hdr->chip_uid[1] = FUSE(FUSE_OPT_WAFER_ID);
+	hdr->chip_uid[2] = FUSE(FUSE_OPT_X_COORDINATE);
+	hdr->chip_uid[3] = FUSE(FUSE_OPT_Y_COORDINATE);
+
+	hdr->soc_temp = tmp451_get_soc_temp(true);
+}
+
+static bool _minerva_train_cache_load(mtc_config_t *mtc_cfg)
+{
+	mtc_train_cache_t hdr;
+	u32 size = 0;
+
+	_minerva_train_cache_hdr(&hdr, mtc_cfg);
+
+	u32 tables_size = hdr.entry_size * hdr.table_entries;
+	mtc_train_cache_t *cache = (mtc_train_cache_t *)sd_file_read(MTC_TRAIN_CACHE_PATH, &size);
+	if (!cache)
+		return false;
+
+	bool valid = size == (sizeof(mtc_train_cache_t) + tables_size) &&
+				 cache->crc32 == crc32_calc(0, (u8 *)cache + MTC_TRAIN_CACHE_CRC_OFF, size - MTC_TRAIN_CACHE_CRC_OFF);
+
+	// Check that it was trained on this console and in similar temperature.
+	if (valid)
+	{
+		u32 soc_temp = cache->soc_temp;
+		cache->crc32 = hdr.crc32 = 0;
+		cache->soc_temp = hdr.soc_temp;
+		u32 temp_diff = soc_temp > hdr.soc_temp ? soc_temp - hdr.soc_temp : hdr.soc_temp - soc_temp;
+		valid = !memcmp(cache, &hdr, sizeof(mtc_train_cache_t)) && temp_diff <= MTC_TRAIN_TEMP_DELTA;
+	}
+
+	// Check that tables match the ones Minerva generated and init rates are trained.
+	emc_table_t *tables = (emc_table_t *)((u8 *)cache + sizeof(mtc_train_cache_t));
+	for (u32 i = 0; valid && i < hdr.table_entries; i++)
+	{
+		if (tables[i].rev != mtc_cfg->mtc_table[i].rev ||
+			tables[i].rate_khz != mtc_cfg->mtc_table[i].rate_khz ||
+			(_minerva_train_rate(tables[i].rate_khz) && !tables[i].trained))
+			valid = false;
+	}
+
+	if (valid)
+		memcpy(mtc_cfg->mtc_table, tables, tables_size);
+
+	free(cache);
+
+	return valid;
+}
+
+static void _minerva_train_cache_save(mtc_config_t *mtc_cfg)
+{
+	if (!sd_get_card_mounted())
+		return;
+
+	u32 tables_size = sizeof(emc_table_t) * mtc_cfg->table_entries;
+	mtc_train_cache_t *cache = (mtc_train_cache_t *)malloc(sizeof(mtc_train_cache_t) + tables_size);
+
+	_minerva_train_cache_hdr(cache, mtc_cfg);
+	memcpy((u8 *)cache + sizeof(mtc_train_cache_t), mtc_cfg->mtc_table, tables_size);
+	cache->crc32 = crc32_calc(0, (u8 *)cache + MTC_TRAIN_CACHE_CRC_OFF,
+		sizeof(mtc_train_cache_t) + tables_size - MTC_TRAIN_CACHE_CRC_OFF);
+
+	sd_save_to_file(cache, sizeof(mtc_train_cache_t) + tables_size, MTC_TRAIN_CACHE_PATH);
+
+	free(cache);
+}
+
 u32 minerva_init()
 {
 	u32 tbl_idx = 0;
@@ -101,6 +191,9 @@ u32 minerva_init()
 	if (!minerva_cfg)
 		return 1;
 
+	// Reuse saved training results if they are valid.
+	bool train_cached = _minerva_train_cache_load(mtc_cfg);
+
 	// Get current frequency
 	u32 current_emc_clk_src = CLOCK(CLK_RST_CONTROLLER_CLK_SOURCE_EMC);
 	for (tbl_idx = 0; tbl_idx < mtc_cfg->table_entries; tbl_idx++)
@@ -127,6 +220,10 @@ u32 minerva_init()
 	mtc_cfg->rate_to = FREQ_1600;
 	minerva_cfg(mtc_cfg, NULL);
 
+	// Save training results for next boots.
+	if (!train_cached)
+		_minerva_train_cache_save(mtc_cfg);
+
 	return 0;
 }
 
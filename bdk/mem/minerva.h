@@ -23,6 +23,12 @@
 #define MTC_INIT_MAGIC 0x3043544D
 #define MTC_NEW_MAGIC  0x5243544D
 
+#define MTC_TRAIN_CACHE_PATH "bootloader/sys/minerva_train.bin"
+
+#define MTC_TRAIN_CACHE_MAGIC   0x4354544D // MTTC.
+#define MTC_TRAIN_CACHE_VERSION 1
+#define MTC_TRAIN_CACHE_CRC_OFF 12
+
 #define EMC_PERIODIC_TRAIN_MS 250
 
 typedef struct
@@ -59,6 +65,20 @@ typedef enum
 	FREQ_1600 = 1600000
 } minerva_freq_t;
 
+// Training cache file header. Trained tables follow.
+typedef struct _mtc_train_cache_t
+{
+	u32 magic;
+	u32 version;
+	u32 crc32; // Covers everything after it.
+	u32 entry_size;
+	u32 table_entries;
+	u32 sdram_id;
+	u32 chip_uid[4];
+	u32 soc_temp;
+	u32 rsvd[5];
+} mtc_train_cache_t;
+
 extern void (*minerva_cfg)(mtc_config_t *mtc_cfg, void *);
 u32  minerva_init();
 void minerva_change_freq(minerva_freq_t freq);
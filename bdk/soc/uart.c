@@ -17,11 +17,13 @@
 
 #include <soc/uart.h>
 #include <soc/clock.h>
+#include <soc/irq.h>
 #include <soc/timer.h>
 #include <soc/t210.h>
 
 /* UART A, B, C, D and E. */
 static const u16 _uart_base_offsets[5] = { 0, 0x40, 0x200, 0x300, 0x400 };
+static const u8  _uart_irqs[5] = { IRQ_UARTA, IRQ_UARTB, IRQ_UARTC, IRQ_UARTD, 0 };
 
 void uart_init(u32 idx, u32 baud, u32 mode)
 {
@@ -199,6 +201,102 @@ void uart_empty_fifo(u32 idx, u32 which)
 	}
 }
 
+static int _uart_rx_ring_irq(u32 irq, void *data)
+{
+	uart_rx_ring_t *ring = (uart_rx_ring_t *)data;
+	uart_t *uart = (uart_t *)(UART_BASE + (u32)_uart_base_offsets[ring->idx]);
+	u32 head = ring->head;
+
+	(void)irq;
+
+	// Drain the whole fifo. Reading it also clears rx data and timeout interrupts.
+	while (uart->UART_LSR & UART_LSR_RDR)
+	{
+		u8 data = uart->UART_THR_DLAB;
+		u32 next = (head + 1) & (ring->size - 1);
+		if (next == ring->tail)
+		{
+			ring->dropped++;
+			continue;
+		}
+
+		ring->buf[head] = data;
+		head = next;
+	}
+
+	// Publish new data to the reader.
+	ring->head = head;
+
+	return IRQ_HANDLED;
+}
+
+int uart_rx_ring_enable(uart_rx_ring_t *ring, u32 idx, u8 *buf, u32 size)
+{
+	uart_t *uart = (uart_t *)(UART_BASE + (u32)_uart_base_offsets[idx]);
+
+	if (!_uart_irqs[idx] || !size || (size & (size - 1)))
+		return 1;
+
+	// Mask rx interrupts while the ring is set up. Size is set last, as readers use it to tell if the ring gets filled.
+	uart->UART_IER_DLAB = 0;
+	(void)uart->UART_SPR;
+	ring->size = 0;
+	ring->idx  = idx;
+	ring->buf  = buf;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->dropped = 0;
+
+	if (irq_request(_uart_irqs[idx], _uart_rx_ring_irq, ring, IRQ_FLAG_REPLACEABLE) != IRQ_ENABLED)
+		return 1;
+
+	ring->size = size;
+
+	// Interrupt on 8 bytes or on rx timeout for the rest.
+	uart->UART_IIR_FCR = UART_IIR_FCR_EN_FIFO | UART_IIR_FCR_RX_TRIG_8;
+	uart->UART_IER_DLAB = UART_IER_DLAB_IE_RHR | UART_IER_DLAB_IE_RXS | UART_IER_DLAB_IE_RX_TIMEOUT;
+	(void)uart->UART_SPR;
+
+	// Let hardware control RTS, so data flows whenever there's fifo space.
+	uart_set_mode(idx, UART_AO_TX_HW_RX);
+
+	return 0;
+}
+
+void uart_rx_ring_disable(uart_rx_ring_t *ring)
+{
+	if (!ring->size)
+		return;
+
+	uart_t *uart = (uart_t *)(UART_BASE + (u32)_uart_base_offsets[ring->idx]);
+
+	uart_set_mode(ring->idx, UART_AO_TX_MN_RX);
+	uart->UART_IER_DLAB = 0;
+	(void)uart->UART_SPR;
+
+	irq_free(_uart_irqs[ring->idx]);
+
+	ring->size = 0;
+}
+
+u32 uart_rx_ring_recv(uart_rx_ring_t *ring, u8 *buf, u32 len)
+{
+	u32 tail = ring->tail;
+	u32 head = ring->head;
+	u32 i;
+
+	for (i = 0; i < len && tail != head; i++)
+	{
+		buf[i] = ring->buf[tail];
+		tail = (tail + 1) & (ring->size - 1);
+	}
+
+	// Release the space back to the IRQ handler.
+	ring->tail = tail;
+
+	return i;
+}
+
 #ifdef DEBUG_UART_PORT
 #include <stdarg.h>
 #include <string.h>
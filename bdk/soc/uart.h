@@ -39,7 +39,10 @@
 #define UART_INVERT_CTS BIT(2)
 #define UART_INVERT_RTS BIT(3)
 
-#define UART_IER_DLAB_IE_EORD BIT(5)
+#define UART_IER_DLAB_IE_RHR        BIT(0)
+#define UART_IER_DLAB_IE_RXS        BIT(2)
+#define UART_IER_DLAB_IE_RX_TIMEOUT BIT(4)
+#define UART_IER_DLAB_IE_EORD       BIT(5)
 
 #define UART_LCR_WORD_LENGTH_8 0x3
 #define UART_LCR_STOP BIT(2)
@@ -53,6 +56,7 @@
 #define UART_IIR_FCR_EN_FIFO BIT(0)
 #define UART_IIR_FCR_RX_CLR  BIT(1)
 #define UART_IIR_FCR_TX_CLR  BIT(2)
+#define UART_IIR_FCR_RX_TRIG_8 (2 << 6)
 
 #define UART_IIR_NO_INT   BIT(0)
 #define UART_IIR_INT_MASK 0xF
@@ -88,6 +92,16 @@ typedef struct _uart_t
 	/* 0x3C */ vu32 UART_ASR;
 } uart_t;
 
+typedef struct _uart_rx_ring_t
+{
+	u32 idx;
+	u8 *buf;
+	u32 size;          // Power of 2.
+	vu32 head;         // Written only by the IRQ handler.
+	vu32 tail;         // Written only by the reader.
+	vu32 dropped;      // Bytes lost because the ring was full.
+} uart_rx_ring_t;
+
 //! TODO: Commented out modes are not supported yet.
 typedef enum _uart_mode_t
 {
@@ -109,6 +123,9 @@ void uart_set_mode(u32 idx, u32 mode);
 u32  uart_get_IIR(u32 idx);
 void uart_set_IIR(u32 idx);
 void uart_empty_fifo(u32 idx, u32 which);
+int  uart_rx_ring_enable(uart_rx_ring_t *ring, u32 idx, u8 *buf, u32 size);
+void uart_rx_ring_disable(uart_rx_ring_t *ring);
+u32  uart_rx_ring_recv(uart_rx_ring_t *ring, u8 *buf, u32 len);
 #ifdef DEBUG_UART_PORT
 void uart_printf(const char *fmt, ...);
 #endif
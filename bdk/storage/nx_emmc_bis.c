@@ -131,12 +131,11 @@ static void _nx_emmc_bis_flush_cache()
 	if (!bis_cache->enabled || !bis_cache->dirty_cnt)
 		return;
 
+	// Write back clears the dirty flag and count.
 	for (u32 i = 0; i < bis_cache->top_idx && bis_cache->dirty_cnt; i++)
 	{
-		if (bis_cache->clusters[i].dirty) {
+		if (bis_cache->clusters[i].dirty)
 			nx_emmc_bis_write_block(bis_cache->clusters[i].cluster_idx * BIS_CLUSTER_SECTORS, BIS_CLUSTER_SECTORS, NULL, true);
-			bis_cache->dirty_cnt--;
-		}
 	}
 
 	_nx_emmc_bis_cluster_cache_init(true);
@@ -37,7 +37,8 @@ int ram_disk_init(void *ram_fs, u32 ramdisk_size)
 	// If ramdisk is not raw, format it.
 	if (ram_fs)
 	{
-		u8 *buf = malloc(0x400000);
+		// Use the end of the ramdisk as work buffer. It's free data area after format.
+		u8 *buf = (u8 *)(RAM_DISK_ADDR + ramdisk_size - RAMDISK_MKFS_BUF_SZ);
 
 		// Set ramdisk size.
 		ramdisk_size >>= 9;
@@ -47,13 +48,12 @@ int ram_disk_init(void *ram_fs, u32 ramdisk_size)
 		f_mount(NULL, "ram:", 1);
 
 		// Format as exFAT w/ 32KB cluster with no MBR.
-		res = f_mkfs("ram:", FM_EXFAT | FM_SFD, RAMDISK_CLUSTER_SZ, buf, 0x400000);
+		// Only the metadata regions get written. Data area is left as is.
+		res = f_mkfs("ram:", FM_EXFAT | FM_SFD, RAMDISK_CLUSTER_SZ, buf, RAMDISK_MKFS_BUF_SZ);
 
 		// Mount ramdisk.
 		if (!res)
 			res = f_mount(ram_fatfs, "ram:", 1);
-
-		free(buf);
 	}
 
 	return res;
@@ -84,3 +84,12 @@ int ram_disk_write(u32 sector, u32 sector_count, const void *buf)
 
 	return 0;
 }
+
+void *ram_disk_get_ptr(u32 sector, u32 sector_count)
+{
+	// Check that the whole range is inside the ramdisk.
+	if ((((u64)sector + sector_count) << 9) > disk_size)
+		return NULL;
+
+	return (void *)(RAM_DISK_ADDR + (sector << 9));
+}
@@ -21,10 +21,12 @@
 
 #include <utils/types.h>
 
-#define RAMDISK_CLUSTER_SZ 32768
+#define RAMDISK_CLUSTER_SZ  32768
+#define RAMDISK_MKFS_BUF_SZ 0x400000
 
 int ram_disk_init(void *ram_fs, u32 ramdisk_size);
 int ram_disk_read(u32 sector, u32 sector_count, void *buf);
 int ram_disk_write(u32 sector, u32 sector_count, const void *buf);
+void *ram_disk_get_ptr(u32 sector, u32 sector_count);
 
 #endif
\ No newline at end of file
@@ -201,24 +201,71 @@ int sdmmc_storage_vendor_sandisk_report(sdmmc_storage_t *storage, void *buf)
 	return 1;
 }
 
-static int _sdmmc_storage_readwrite_ex(sdmmc_storage_t *storage, u32 *blkcnt_out, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+static int _sdmmc_storage_set_write_blkcnt(sdmmc_storage_t *storage, u32 num_sectors)
 {
-	u32 tmp = 0;
-	sdmmc_cmd_t cmdbuf;
-	sdmmc_req_t reqbuf;
+	// eMMC: Set block count. Auto CMD23 can't be used since its argument register is the SDMA address.
+	if (storage->sdmmc->id == SDMMC_4)
+		return _sdmmc_storage_execute_cmd_type1(storage, MMC_SET_BLOCK_COUNT, num_sectors, 0, R1_STATE_TRAN);
+
+	// SD: Hint the card to pre-erase the blocks that are going to be written.
+	if (!_sdmmc_storage_execute_cmd_type1(storage, MMC_APP_CMD, storage->rca << 16, 0, R1_STATE_TRAN))
+		return 0;
+
+	return _sdmmc_storage_execute_cmd_type1(storage, SD_APP_SET_WR_BLK_ERASE_COUNT, num_sectors, 0, R1_STATE_TRAN);
+}
+
+static int _mmc_storage_switch(sdmmc_storage_t *storage, u32 arg)
+{
+	return _sdmmc_storage_execute_cmd_type1(storage, MMC_SWITCH, arg, 1, R1_SKIP_STATE_CHECK);
+}
 
+static int _mmc_storage_flush_cache(sdmmc_storage_t *storage)
+{
+	_mmc_storage_switch(storage, SDMMC_SWITCH(MMC_SWITCH_MODE_WRITE_BYTE, EXT_CSD_FLUSH_CACHE, 1));
+
+	// Flushing can take longer than busy wait timeout, so wait for card to get back to transfer state.
+	u32 timeout = get_tmr_ms() + 10000;
+	while (!_sdmmc_storage_check_status(storage))
+	{
+		if (get_tmr_ms() > timeout)
+			return 0;
+		msleep(1);
+	}
+
+	return 1;
+}
+
+static int _sdmmc_storage_readwrite_prep(sdmmc_storage_t *storage, sdmmc_cmd_t *cmdbuf, sdmmc_req_t *reqbuf, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
 	// If SDSC convert block address to byte address.
 	if (!storage->has_sector_access)
 		sector <<= 9;
 
-	sdmmc_init_cmd(&cmdbuf, is_write ? MMC_WRITE_MULTIPLE_BLOCK : MMC_READ_MULTIPLE_BLOCK, sector, SDMMC_RSP_TYPE_1, 0);
+	// Prepare card for a bulk write.
+	bool bulk_write = is_write && storage->bulk_write;
+	if (bulk_write && !_sdmmc_storage_set_write_blkcnt(storage, num_sectors))
+		return 0;
 
-	reqbuf.buf              = buf;
-	reqbuf.num_sectors      = num_sectors;
-	reqbuf.blksize          = SDMMC_DAT_BLOCKSIZE;
-	reqbuf.is_write         = is_write;
-	reqbuf.is_multi_block   = 1;
-	reqbuf.is_auto_stop_trn = 1;
+	sdmmc_init_cmd(cmdbuf, is_write ? MMC_WRITE_MULTIPLE_BLOCK : MMC_READ_MULTIPLE_BLOCK, sector, SDMMC_RSP_TYPE_1, 0);
+
+	reqbuf->buf              = buf;
+	reqbuf->num_sectors      = num_sectors;
+	reqbuf->blksize          = SDMMC_DAT_BLOCKSIZE;
+	reqbuf->is_write         = is_write;
+	reqbuf->is_multi_block   = 1;
+	reqbuf->is_auto_stop_trn = !bulk_write || storage->sdmmc->id != SDMMC_4; // eMMC stops on its own after CMD23.
+
+	return 1;
+}
+
+static int _sdmmc_storage_readwrite_ex(sdmmc_storage_t *storage, u32 *blkcnt_out, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
+	u32 tmp = 0;
+	sdmmc_cmd_t cmdbuf;
+	sdmmc_req_t reqbuf;
+
+	if (!_sdmmc_storage_readwrite_prep(storage, &cmdbuf, &reqbuf, sector, num_sectors, buf, is_write))
+		return 0;
 
 	if (!sdmmc_execute_cmd(storage->sdmmc, &cmdbuf, &reqbuf, blkcnt_out))
 	{
@@ -233,6 +280,12 @@ static int _sdmmc_storage_readwrite_ex(sdmmc_storage_t *storage, u32 *blkcnt_out
 
 int sdmmc_storage_end(sdmmc_storage_t *storage)
 {
+	// Commit eMMC cache. It's lost on power off.
+	int res = 1;
+	if (storage->initialized && storage->cache_enabled)
+		res = _mmc_storage_flush_cache(storage);
+	storage->cache_enabled = 0;
+
 	if (!_sdmmc_storage_go_idle_state(storage))
 		return 0;
 
@@ -240,7 +293,7 @@ int sdmmc_storage_end(sdmmc_storage_t *storage)
 
 	storage->initialized = 0;
 
-	return 1;
+	return res;
 }
 
 static int _sdmmc_storage_readwrite(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write)
@@ -275,7 +328,12 @@ reinit_try:
 		// Disk IO failure! Reinit SD/EMMC to a lower speed.
 		if (storage->sdmmc->id == SDMMC_1 || storage->sdmmc->id == SDMMC_4)
 		{
-			int res;
+			int res = 0;
+
+			// Reinit power cycles the card. Fail if cached writes can't be committed first.
+			bool bulk_write = storage->bulk_write;
+			if (storage->cache_enabled && !_mmc_storage_flush_cache(storage))
+				return 0;
 
 			if (storage->sdmmc->id == SDMMC_1)
 			{
@@ -312,6 +370,10 @@ reinit_try:
 			// If successful reinit, restart xfer.
 			if (res)
 			{
+				// Reinit cleared bulk write mode and eMMC cache. Apply them again.
+				if (bulk_write)
+					sdmmc_storage_set_bulk_write(storage, true);
+
 				bbuf = (u8 *)buf;
 				sct_off = sector;
 				sct_total = num_sectors;
@@ -338,16 +400,22 @@ int sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, vo
 	if (mc_client_has_access(buf) && !((u32)buf % 8))
 		return _sdmmc_storage_readwrite(storage, sector, num_sectors, buf, 0);
 
-	if (num_sectors > (SDMMC_UP_BUF_SZ / SDMMC_DAT_BLOCKSIZE))
-		return 0;
-
+	// Bounce through the upper buffer in chunks.
 	u8 *tmp_buf = (u8 *)SDMMC_UPPER_BUFFER;
-	if (_sdmmc_storage_readwrite(storage, sector, num_sectors, tmp_buf, 0))
+	u8 *bbuf = (u8 *)buf;
+	while (num_sectors)
 	{
-		memcpy(buf, tmp_buf, SDMMC_DAT_BLOCKSIZE * num_sectors);
-		return 1;
+		u32 blkcnt = MIN(num_sectors, SDMMC_UP_BUF_SZ / SDMMC_DAT_BLOCKSIZE);
+		if (!_sdmmc_storage_readwrite(storage, sector, blkcnt, tmp_buf, 0))
+			return 0;
+		memcpy(bbuf, tmp_buf, SDMMC_DAT_BLOCKSIZE * blkcnt);
+
+		sector += blkcnt;
+		num_sectors -= blkcnt;
+		bbuf += SDMMC_DAT_BLOCKSIZE * blkcnt;
 	}
-	return 0;
+
+	return 1;
 }
 
 int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
@@ -356,12 +424,60 @@ int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, v
 	if (mc_client_has_access(buf) && !((u32)buf % 8))
 		return _sdmmc_storage_readwrite(storage, sector, num_sectors, buf, 1);
 
-	if (num_sectors > (SDMMC_UP_BUF_SZ / SDMMC_DAT_BLOCKSIZE))
+	// Bounce through the upper buffer in chunks.
+	u8 *tmp_buf = (u8 *)SDMMC_UPPER_BUFFER;
+	u8 *bbuf = (u8 *)buf;
+	while (num_sectors)
+	{
+		u32 blkcnt = MIN(num_sectors, SDMMC_UP_BUF_SZ / SDMMC_DAT_BLOCKSIZE);
+		memcpy(tmp_buf, bbuf, SDMMC_DAT_BLOCKSIZE * blkcnt);
+		if (!_sdmmc_storage_readwrite(storage, sector, blkcnt, tmp_buf, 1))
+			return 0;
+
+		sector += blkcnt;
+		num_sectors -= blkcnt;
+		bbuf += SDMMC_DAT_BLOCKSIZE * blkcnt;
+	}
+
+	return 1;
+}
+
+int sdmmc_storage_xfer_start(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
+	u32 tmp = 0;
+	sdmmc_cmd_t cmdbuf;
+	sdmmc_req_t reqbuf;
+
+	// Only single command transfers from DMA accessible buffers are supported.
+	if (!storage->initialized || !num_sectors || num_sectors > 0xFFFF || !mc_client_has_access(buf) || ((u32)buf % 8))
 		return 0;
 
-	u8 *tmp_buf = (u8 *)SDMMC_UPPER_BUFFER;
-	memcpy(tmp_buf, buf, SDMMC_DAT_BLOCKSIZE * num_sectors);
-	return _sdmmc_storage_readwrite(storage, sector, num_sectors, tmp_buf, 1);
+	if (!_sdmmc_storage_readwrite_prep(storage, &cmdbuf, &reqbuf, sector, num_sectors, buf, is_write))
+		return 0;
+
+	if (!sdmmc_execute_cmd_async(storage->sdmmc, &cmdbuf, &reqbuf))
+	{
+		sdmmc_stop_transmission(storage->sdmmc, &tmp);
+		_sdmmc_storage_get_status(storage, &tmp, 0);
+
+		return 0;
+	}
+
+	return 1;
+}
+
+int sdmmc_storage_xfer_poll(sdmmc_storage_t *storage)
+{
+	u32 tmp = 0;
+
+	int res = sdmmc_execute_cmd_async_poll(storage->sdmmc, NULL);
+	if (res == SDMMC_XFER_ERROR)
+	{
+		sdmmc_stop_transmission(storage->sdmmc, &tmp);
+		_sdmmc_storage_get_status(storage, &tmp, 0);
+	}
+
+	return res;
 }
 
 /*
@@ -535,11 +651,6 @@ int mmc_storage_get_ext_csd(sdmmc_storage_t *storage, void *buf)
 	return _sdmmc_storage_check_card_status(tmp);
 }
 
-static int _mmc_storage_switch(sdmmc_storage_t *storage, u32 arg)
-{
-	return _sdmmc_storage_execute_cmd_type1(storage, MMC_SWITCH, arg, 1, R1_SKIP_STATE_CHECK);
-}
-
 static int _mmc_storage_switch_buswidth(sdmmc_storage_t *storage, u32 bus_width)
 {
 	if (bus_width == SDMMC_BUS_WIDTH_1)
@@ -666,6 +777,10 @@ static int _mmc_storage_enable_auto_bkops(sdmmc_storage_t *storage)
 
 int sdmmc_storage_init_mmc(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type)
 {
+	// Commit eMMC cache if storage is reinitialized without power cycle.
+	if (storage->initialized && storage->cache_enabled)
+		_mmc_storage_flush_cache(storage);
+
 	memset(storage, 0, sizeof(sdmmc_storage_t));
 	storage->sdmmc = sdmmc;
 	storage->rca = 2; // Set default device address. This could be a config item.
@@ -759,6 +874,39 @@ int sdmmc_storage_set_mmc_partition(sdmmc_storage_t *storage, u32 partition)
 	return 1;
 }
 
+int sdmmc_storage_set_bulk_write(sdmmc_storage_t *storage, bool enable)
+{
+	int res = 1;
+
+	if (!storage->initialized)
+		return 0;
+
+	if (enable)
+	{
+		// Enable eMMC volatile cache if supported (eMMC 4.5 and up).
+		if (storage->sdmmc->id == SDMMC_4 && storage->ext_csd.rev >= 6 && storage->ext_csd.cache_size && !storage->cache_enabled)
+		{
+			if (_mmc_storage_switch(storage, SDMMC_SWITCH(MMC_SWITCH_MODE_WRITE_BYTE, EXT_CSD_CACHE_CTRL, 1)) &&
+				_sdmmc_storage_check_status(storage))
+				storage->cache_enabled = 1;
+			DPRINTF("[MMC] cache %s\n", storage->cache_enabled ? "enabled" : "failed");
+		}
+	}
+	else if (storage->cache_enabled)
+	{
+		// Commit cached data and disable cache.
+		res = _mmc_storage_flush_cache(storage);
+		if (!_mmc_storage_switch(storage, SDMMC_SWITCH(MMC_SWITCH_MODE_WRITE_BYTE, EXT_CSD_CACHE_CTRL, 0)) ||
+			!_sdmmc_storage_check_status(storage))
+			res = 0;
+		storage->cache_enabled = 0;
+	}
+
+	storage->bulk_write = enable;
+
+	return res;
+}
+
 /*
  * SD specific functions.
  */
@@ -187,6 +187,8 @@ typedef struct _sdmmc_storage_t
 	int is_low_voltage;
 	u32 partition;
 	int initialized;
+	int bulk_write;
+	int cache_enabled;
 	u32 card_power_limit;
 	u8  raw_cid[0x10];
 	u8  raw_csd[0x10];
@@ -210,8 +212,11 @@ typedef struct _sd_func_modes_t
 int  sdmmc_storage_end(sdmmc_storage_t *storage);
 int  sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
 int  sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
+int  sdmmc_storage_xfer_start(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write);
+int  sdmmc_storage_xfer_poll(sdmmc_storage_t *storage);
 int  sdmmc_storage_init_mmc(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type);
 int  sdmmc_storage_set_mmc_partition(sdmmc_storage_t *storage, u32 partition);
+int  sdmmc_storage_set_bulk_write(sdmmc_storage_t *storage, bool enable);
 void sdmmc_storage_init_wait_sd();
 int  sdmmc_storage_init_sd(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type);
 int  sdmmc_storage_init_gc(sdmmc_storage_t *storage, sdmmc_t *sdmmc);
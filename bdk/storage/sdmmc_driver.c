@@ -38,6 +38,11 @@
 #define ERROR_EXTRA_PRINTING
 #endif
 
+/*! SDMMC async transfer states. */
+#define SDMMC_XFER_STATE_IDLE 0
+#define SDMMC_XFER_STATE_DATA 1
+#define SDMMC_XFER_STATE_BUSY 2
+
 /*! SCMMC controller base addresses. */
 static const u16 _sdmmc_base_offsets[4] = { 0x0, 0x200, 0x400, 0x600 };
 
@@ -1535,6 +1540,149 @@ int sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *b
 	return result;
 }
 
+static void _sdmmc_execute_cmd_async_end(sdmmc_t *sdmmc)
+{
+	sdmmc->xfer_state = SDMMC_XFER_STATE_IDLE;
+
+	usleep((8 * 1000 + sdmmc->card_clock - 1) / sdmmc->card_clock); // Wait 8 cycles.
+
+	if (sdmmc->xfer_disable_clock)
+		sdmmc->regs->clkcon &= ~SDHCI_CLOCK_CARD_EN;
+}
+
+int sdmmc_execute_cmd_async(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req)
+{
+	if (!sdmmc->card_clock_enabled || sdmmc->xfer_state != SDMMC_XFER_STATE_IDLE)
+		return 0;
+
+	// Recalibrate periodically for SDMMC1.
+	if (sdmmc->manual_cal && sdmmc->powersave_enabled)
+		_sdmmc_autocal_execute(sdmmc, sdmmc_get_io_power(sdmmc));
+
+	sdmmc->xfer_disable_clock = 0;
+	if (!(sdmmc->regs->clkcon & SDHCI_CLOCK_CARD_EN))
+	{
+		sdmmc->xfer_disable_clock = 1;
+		sdmmc->regs->clkcon |= SDHCI_CLOCK_CARD_EN;
+		_sdmmc_commit_changes(sdmmc);
+		usleep((8 * 1000 + sdmmc->card_clock - 1) / sdmmc->card_clock); // Wait 8 cycles.
+	}
+
+	// Same as a blocking transfer up to the command response. Data phase is then left to the DMA.
+	if (!_sdmmc_wait_cmd_data_inhibit(sdmmc, true) || !_sdmmc_config_sdma(sdmmc, &sdmmc->xfer_blkcnt, req))
+		goto error;
+
+	// Flush cache before starting the transfer.
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+
+	_sdmmc_enable_interrupts(sdmmc);
+
+	if (!_sdmmc_send_cmd(sdmmc, cmd, true) || !_sdmmc_wait_response(sdmmc))
+	{
+		_sdmmc_mask_interrupts(sdmmc);
+		goto error;
+	}
+
+	sdmmc->expected_rsp_type = cmd->rsp_type;
+	_sdmmc_cache_rsp(sdmmc, sdmmc->rsp, 0x10, cmd->rsp_type);
+
+	sdmmc->xfer_state = SDMMC_XFER_STATE_DATA;
+	sdmmc->xfer_blkcnt_left = sdmmc->xfer_blkcnt;
+	sdmmc->xfer_timeout = get_tmr_ms() + 1500;
+
+	return 1;
+
+error:
+	_sdmmc_execute_cmd_async_end(sdmmc);
+
+	return 0;
+}
+
+int sdmmc_execute_cmd_async_poll(sdmmc_t *sdmmc, u32 *blkcnt_out)
+{
+	if (sdmmc->xfer_state == SDMMC_XFER_STATE_DATA)
+	{
+		u16 intr = 0;
+		u32 result = _sdmmc_check_mask_interrupt(sdmmc, &intr, SDHCI_INT_DATA_END | SDHCI_INT_DMA_END);
+		if (result == SDMMC_MASKINT_ERROR)
+		{
+#ifdef ERROR_EXTRA_PRINTING
+			EPRINTFARGS("SDMMC%d: int error!", sdmmc->id + 1);
+#endif
+			_sdmmc_reset_cmd_data(sdmmc);
+			goto error;
+		}
+
+		// Timeout only if there was no progress.
+		u32 blkcnt = sdmmc->regs->blkcnt;
+		if (result == SDMMC_MASKINT_MASKED || blkcnt != sdmmc->xfer_blkcnt_left)
+		{
+			sdmmc->xfer_blkcnt_left = blkcnt;
+			sdmmc->xfer_timeout = get_tmr_ms() + 1500;
+		}
+		else if (get_tmr_ms() > sdmmc->xfer_timeout)
+		{
+#ifdef ERROR_EXTRA_PRINTING
+			EPRINTFARGS("SDMMC%d: DMA Update failed!", sdmmc->id + 1);
+#endif
+			_sdmmc_reset_cmd_data(sdmmc);
+			goto error;
+		}
+
+		if (!(intr & SDHCI_INT_DATA_END))
+		{
+			if (intr & SDHCI_INT_DMA_END)
+			{
+				// Update DMA.
+				sdmmc->regs->admaaddr = sdmmc->dma_addr_next;
+				sdmmc->regs->admaaddr_hi = 0;
+				sdmmc->dma_addr_next += SZ_512K;
+			}
+
+			return SDMMC_XFER_PENDING;
+		}
+
+		_sdmmc_mask_interrupts(sdmmc);
+
+		// Invalidate cache after transfer. Clean it too, since other buffers might have been changed meanwhile.
+		bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
+
+		sdmmc->rsp3 = sdmmc->regs->rspreg3;
+
+		sdmmc->xfer_state = SDMMC_XFER_STATE_BUSY;
+		sdmmc->xfer_timeout = get_tmr_ms() + 2000;
+	}
+
+	if (sdmmc->xfer_state == SDMMC_XFER_STATE_BUSY)
+	{
+		// Wait for card to exit busy.
+		if (!(sdmmc->regs->prnsts & SDHCI_DATA_0_LVL))
+		{
+			if (get_tmr_ms() <= sdmmc->xfer_timeout)
+				return SDMMC_XFER_PENDING;
+
+#ifdef ERROR_EXTRA_PRINTING
+			EPRINTFARGS("SDMMC%d: Busy timeout!", sdmmc->id + 1);
+#endif
+			_sdmmc_reset_cmd_data(sdmmc);
+			goto error;
+		}
+
+		_sdmmc_execute_cmd_async_end(sdmmc);
+
+		if (blkcnt_out)
+			*blkcnt_out = sdmmc->xfer_blkcnt;
+
+		return SDMMC_XFER_DONE;
+	}
+
+error:
+	_sdmmc_mask_interrupts(sdmmc);
+	_sdmmc_execute_cmd_async_end(sdmmc);
+
+	return SDMMC_XFER_ERROR;
+}
+
 int sdmmc_enable_low_voltage(sdmmc_t *sdmmc)
 {
 	if (sdmmc->id != SDMMC_1)
@@ -50,6 +50,11 @@
 #define SDMMC_MASKINT_NOERROR  1
 #define SDMMC_MASKINT_ERROR    2
 
+/*! SDMMC async transfer status. */
+#define SDMMC_XFER_PENDING 0
+#define SDMMC_XFER_DONE    1
+#define SDMMC_XFER_ERROR   2
+
 /*! SDMMC present state. 0x24. */
 #define SDHCI_CMD_INHIBIT      BIT(0)
 #define SDHCI_DATA_INHIBIT     BIT(1)
@@ -294,6 +299,13 @@ typedef struct _sdmmc_t
 	u32 rsp[4];
 	u32 rsp3;
 	int t210b01;
+
+	// Async transfer state.
+	u32 xfer_state;
+	u32 xfer_blkcnt;
+	u32 xfer_blkcnt_left;
+	u32 xfer_timeout;
+	int xfer_disable_clock;
 } sdmmc_t;
 
 /*! SDMMC command. */
@@ -331,6 +343,8 @@ int  sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type);
 void sdmmc_end(sdmmc_t *sdmmc);
 void sdmmc_init_cmd(sdmmc_cmd_t *cmdbuf, u16 cmd, u32 arg, u32 rsp_type, u32 check_busy);
 int  sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out);
+int  sdmmc_execute_cmd_async(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req);
+int  sdmmc_execute_cmd_async_poll(sdmmc_t *sdmmc, u32 *blkcnt_out);
 int  sdmmc_enable_low_voltage(sdmmc_t *sdmmc);
 
 #endif
@@ -509,6 +509,129 @@ static usb_cfg_hid_descr_t usb_configuration_descriptor_hid_touch =
 	.endpoint[1].bInterval        = 3    // 4ms on HS.
 };
 
+static usb_dev_descr_t usb_device_descriptor_dump =
+{
+	.bLength         = 18,
+	.bDescriptorType = USB_DESCRIPTOR_DEVICE,
+	.bcdUSB          = 0x210,
+	.bDeviceClass    = 0x00,
+	.bDeviceSubClass = 0x00,
+	.bDeviceProtocol = 0x00,
+	.bMaxPacketSize  = 0x40,
+	.idVendor        = 0x11EC, // Nintendo: 0x057E, Nvidia: 0x0955
+	.idProduct       = 0xA7E3, // Switch:   0x2000, usbd:   0x3000
+	.bcdDevice       = 0x0101,
+	.iManufacturer   = 1,
+	.iProduct        = 2,
+	.iSerialNumber   = 3,
+	.bNumConfigs     = 1
+};
+
+static usb_cfg_simple_descr_t usb_configuration_descriptor_dump =
+{
+	/* Configuration descriptor structure */
+	.config.bLength               = 9,
+	.config.bDescriptorType       = USB_DESCRIPTOR_CONFIGURATION,
+	.config.wTotalLength          = 0x20,
+	.config.bNumInterfaces        = 0x01,
+	.config.bConfigurationValue   = 0x01,
+	.config.iConfiguration        = 0x00,
+	.config.bmAttributes          = USB_ATTR_SELF_POWERED | USB_ATTR_BUS_POWERED_RSVD,
+	.config.bMaxPower             = 32 / 2,
+
+	/* Interface descriptor structure */
+	.interface.bLength            = 9,
+	.interface.bDescriptorType    = USB_DESCRIPTOR_INTERFACE,
+	.interface.bInterfaceNumber   = 0,
+	.interface.bAlternateSetting  = 0,
+	.interface.bNumEndpoints      = 2,
+	.interface.bInterfaceClass    = 0xFF, // Vendor Specific Class.
+	.interface.bInterfaceSubClass = 0x00,
+	.interface.bInterfaceProtocol = 0x00,
+	.interface.iInterface         = 0x00,
+
+	/* Endpoint descriptor structure EP1 IN */
+	.endpoint[0].bLength          = 7,
+	.endpoint[0].bDescriptorType  = USB_DESCRIPTOR_ENDPOINT,
+	.endpoint[0].bEndpointAddress = 0x81, // USB_EP_ADDR_BULK_IN.
+	.endpoint[0].bmAttributes     = USB_EP_TYPE_BULK,
+	.endpoint[0].wMaxPacketSize   = 0x200,
+	.endpoint[0].bInterval        = 0x00,
+
+	/* Endpoint descriptor structure EP1 OUT */
+	.endpoint[1].bLength          = 7,
+	.endpoint[1].bDescriptorType  = USB_DESCRIPTOR_ENDPOINT,
+	.endpoint[1].bEndpointAddress = 0x01, // USB_EP_ADDR_BULK_OUT.
+	.endpoint[1].bmAttributes     = USB_EP_TYPE_BULK,
+	.endpoint[1].wMaxPacketSize   = 0x200,
+	.endpoint[1].bInterval        = 0x00
+};
+
+static usb_cfg_simple_descr_t usb_other_speed_config_descriptor_dump =
+{
+	/* Other Speed Configuration descriptor structure */
+	.config.bLength               = 9,
+	.config.bDescriptorType       = USB_DESCRIPTOR_OTHER_SPEED_CONFIGURATION,
+	.config.wTotalLength          = 0x20,
+	.config.bNumInterfaces        = 0x01,
+	.config.bConfigurationValue   = 0x01,
+	.config.iConfiguration        = 0x00,
+	.config.bmAttributes          = USB_ATTR_SELF_POWERED | USB_ATTR_BUS_POWERED_RSVD,
+	.config.bMaxPower             = 32 / 2,
+
+	/* Interface descriptor structure */
+	.interface.bLength            = 9,
+	.interface.bDescriptorType    = USB_DESCRIPTOR_INTERFACE,
+	.interface.bInterfaceNumber   = 0x00,
+	.interface.bAlternateSetting  = 0x00,
+	.interface.bNumEndpoints      = 2,
+	.interface.bInterfaceClass    = 0xFF, // Vendor Specific Class.
+	.interface.bInterfaceSubClass = 0x00,
+	.interface.bInterfaceProtocol = 0x00,
+	.interface.iInterface         = 0x00,
+
+	/* Endpoint descriptor structure EP1 IN */
+	.endpoint[0].bLength          = 7,
+	.endpoint[0].bDescriptorType  = USB_DESCRIPTOR_ENDPOINT,
+	.endpoint[0].bEndpointAddress = 0x81, // USB_EP_ADDR_BULK_IN.
+	.endpoint[0].bmAttributes     = USB_EP_TYPE_BULK,
+	.endpoint[0].wMaxPacketSize   = 0x40,
+	.endpoint[0].bInterval        = 0,
+
+	/* Endpoint descriptor structure EP1 OUT */
+	.endpoint[1].bLength          = 7,
+	.endpoint[1].bDescriptorType  = USB_DESCRIPTOR_ENDPOINT,
+	.endpoint[1].bEndpointAddress = 0x01, // USB_EP_ADDR_BULK_OUT.
+	.endpoint[1].bmAttributes     = USB_EP_TYPE_BULK,
+	.endpoint[1].wMaxPacketSize   = 0x40,
+	.endpoint[1].bInterval        = 0
+};
+
+static u8 usb_product_string_descriptor_dump[22] =
+{
+	20, 0x03,
+	'F', 0, 'a', 0, 's', 0, 't', 0, ' ', 0,
+	'D', 0, 'u', 0, 'm', 0, 'p', 0
+};
+
+// WinUSB gets bound automatically to the vendor interface.
+static usb_ms_cid_descr_t usb_ms_cid_descriptor_dump =
+{
+	.dLength          = 0x28,
+	.wVersion         = 0x100,
+	.wCompatibilityId = USB_DESCRIPTOR_MS_COMPAT_ID,
+	.bSections        = 1,
+	.bInterfaceNumber = 0,
+	.bReserved1       = 1,
+
+	.bCompatibleId[0] = 'W',
+	.bCompatibleId[1] = 'I',
+	.bCompatibleId[2] = 'N',
+	.bCompatibleId[3] = 'U',
+	.bCompatibleId[4] = 'S',
+	.bCompatibleId[5] = 'B',
+};
+
 usb_desc_t usb_gadget_ums_descriptors =
 {
 	.dev       = &usb_device_descriptor_ums,
@@ -556,3 +679,19 @@ usb_desc_t usb_gadget_hid_touch_descriptors =
 	.ms_cid    = &usb_ms_cid_descriptor,
 	.mx_ext    = &usb_ms_ext_prop_descriptor_hid
 };
+
+usb_desc_t usb_gadget_dump_descriptors =
+{
+	.dev       = &usb_device_descriptor_dump,
+	.dev_qual  = &usb_device_qualifier_descriptor,
+	.cfg       = &usb_configuration_descriptor_dump,
+	.cfg_other = &usb_other_speed_config_descriptor_dump,
+	.dev_bot   = &usb_device_binary_object_descriptor,
+	.vendor    = usb_vendor_string_descriptor_hid,
+	.product   = usb_product_string_descriptor_dump,
+	.serial    = usb_serial_string_descriptor,
+	.lang_id   = usb_lang_id_string_descriptor,
+	.ms_os     = &usb_ms_os_descriptor,
+	.ms_cid    = &usb_ms_cid_descriptor_dump,
+	.mx_ext    = &usb_ms_ext_prop_descriptor_hid
+};
@@ -0,0 +1,380 @@
+/*
+ * USB Gadget Fast Dump driver for Tegra X1
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <usb/usbd.h>
+#include <usb/usb_gadget_dump.h>
+#include <gfx_utils.h>
+#include <mem/minerva.h>
+#include <sec/se.h>
+#include <sec/se_t210.h>
+#include <soc/hw_init.h>
+#include <soc/timer.h>
+#include <soc/t210.h>
+#include <storage/emmc.h>
+#include <storage/sd.h>
+#include <storage/sdmmc.h>
+#include <utils/btn.h>
+#include <utils/sprintf.h>
+
+#include <memory_map.h>
+
+//#define DPRINTF(...) gfx_printf(__VA_ARGS__)
+#define DPRINTF(...)
+
+#define FD_CHUNK_BUF ((u8 *)SDXC_BUF_ALIGNED) // 2 chunks. While one is sent the other is read.
+#define FD_HDR_BUF   ((u8 *)USB_EP_BULK_IN_BUF_ADDR)
+#define FD_CMD_BUF   ((u8 *)USB_EP_BULK_OUT_BUF_ADDR)
+
+#define FD_UI_UPDATE_MS 2000
+
+typedef struct _usbd_gadget_dump_t
+{
+	usb_ctxt_t *usbs;
+	bool xusb;
+	bool cmd_queued;
+
+	u32 queued;
+	u32 queued_max;
+
+	sdmmc_storage_t *storage;
+	u32 storage_sectors[FD_STORAGE_MAX];
+
+	u32 timer_dram;
+} usbd_gadget_dump_t;
+
+static usb_ops_t usb_ops;
+
+static int _fd_write_wait(usbd_gadget_dump_t *fd, u32 queued_max)
+{
+	if (fd->queued <= queued_max)
+		return USB_RES_OK;
+
+	fd->queued = queued_max;
+
+	return usb_ops.usb_device_ep1_in_writing_wait(queued_max, USB_XFER_SYNCED_DATA);
+}
+
+static int _fd_write(usbd_gadget_dump_t *fd, const void *buf, u32 size)
+{
+	const u8 *data = (const u8 *)buf;
+
+	// Split to max transfer size and keep as many queued as the controller allows.
+	while (size)
+	{
+		u32 len = MIN(size, USB_EP_BUFFER_MAX_SIZE);
+
+		int res = _fd_write_wait(fd, fd->queued_max - 1);
+		if (res)
+			return res;
+
+		res = usb_ops.usb_device_ep1_in_write((u8 *)data, len, NULL, USB_XFER_START);
+		if (res)
+			return res;
+		fd->queued++;
+
+		data += len;
+		size -= len;
+	}
+
+	return USB_RES_OK;
+}
+
+static int _fd_get_cmd(usbd_gadget_dump_t *fd, fd_cmd_t *cmd)
+{
+	int res;
+	u32 bytes = 0;
+
+	// On XUSB do not allow multiple requests for a command to be queued.
+	if (!fd->cmd_queued)
+		res = usb_ops.usb_device_ep1_out_read(FD_CMD_BUF, USB_EP_BUFFER_1_TD, &bytes, USB_XFER_SYNCED_CMD);
+	else
+		res = usb_ops.usb_device_ep1_out_reading_finish(&bytes, USB_XFER_SYNCED_CMD);
+
+	if (fd->xusb)
+		fd->cmd_queued = true;
+
+	if (res)
+		return res;
+
+	fd->cmd_queued = false;
+
+	memcpy(cmd, FD_CMD_BUF, sizeof(fd_cmd_t));
+	if (bytes != sizeof(fd_cmd_t) || cmd->magic != FD_MAGIC)
+		cmd->cmd = ~0;
+
+	return USB_RES_OK;
+}
+
+static void _fd_maintenance(usbd_gadget_dump_t *fd)
+{
+	// Train DRAM only when no USB transfer is in flight.
+	if (fd->timer_dram < get_tmr_ms())
+	{
+		_fd_write_wait(fd, 0);
+		minerva_periodic_training();
+		fd->timer_dram = get_tmr_ms() + EMC_PERIODIC_TRAIN_MS;
+	}
+}
+
+static int _fd_set_storage(usbd_gadget_dump_t *fd, u32 storage)
+{
+	if (storage >= FD_STORAGE_MAX || !fd->storage_sectors[storage])
+		return FD_STS_NO_STORAGE;
+
+	if (storage == FD_STORAGE_SD)
+	{
+		fd->storage = &sd_storage;
+		return FD_STS_OK;
+	}
+
+	// eMMC storage ids match partition ids.
+	fd->storage = &emmc_storage;
+	if (!emmc_set_partition(storage))
+		return FD_STS_IO_ERROR;
+
+	return FD_STS_OK;
+}
+
+static int _fd_send_info(usbd_gadget_dump_t *fd)
+{
+	fd_info_t *info = (fd_info_t *)FD_HDR_BUF;
+
+	memset(info, 0, sizeof(fd_info_t));
+	info->magic   = FD_MAGIC;
+	info->version = FD_VERSION;
+	info->status  = FD_STS_OK;
+	info->chunk_sectors_max = FD_CHUNK_SECTORS_MAX;
+	memcpy(info->sectors, fd->storage_sectors, sizeof(info->sectors));
+
+	int res = _fd_write(fd, info, sizeof(fd_info_t));
+	if (!res)
+		res = _fd_write_wait(fd, 0);
+
+	return res;
+}
+
+static int _fd_read(usbd_gadget_dump_t *fd, fd_cmd_t *cmd)
+{
+	static char txt_buf[128];
+	int res = USB_RES_OK;
+	u32 sts;
+
+	u32 sector = cmd->sector;
+	u32 sectors_left = cmd->count;
+	u32 chunk_sectors = cmd->chunk_sectors ? MIN(cmd->chunk_sectors, FD_CHUNK_SECTORS_MAX) : FD_CHUNK_SECTORS_MAX;
+
+	// Transfers needed per chunk. Data and header.
+	u32 chunk_xfers = (chunk_sectors * 512 + USB_EP_BUFFER_MAX_SIZE - 1) / USB_EP_BUFFER_MAX_SIZE + 1;
+
+	sts = _fd_set_storage(fd, cmd->storage);
+	if (!sts && (!sectors_left || sector >= fd->storage_sectors[cmd->storage] ||
+		sectors_left > (fd->storage_sectors[cmd->storage] - sector)))
+		sts = FD_STS_INVALID_ARG;
+
+	u32 idx = 0;
+	u32 timer_ui = get_tmr_ms() + FD_UI_UPDATE_MS;
+	do
+	{
+		fd_chunk_hdr_t *hdr = (fd_chunk_hdr_t *)(FD_HDR_BUF + idx * USB_EP_BUFFER_ALIGN);
+		u8 *buf = FD_CHUNK_BUF + idx * SZ_1M;
+		u32 count = MIN(sectors_left, chunk_sectors);
+
+		// Make sure the previous chunk in this buffer was sent. Only the last one can be pending.
+		res = _fd_write_wait(fd, chunk_xfers);
+		if (res)
+			break;
+
+		memset(hdr, 0, sizeof(fd_chunk_hdr_t));
+		hdr->magic  = FD_MAGIC;
+		hdr->sector = sector;
+
+		// Read chunk while the previous one is being sent.
+		if (!sts && !sdmmc_storage_read(fd->storage, sector, count, buf))
+			sts = FD_STS_IO_ERROR;
+
+		hdr->status = sts;
+		if (sts)
+		{
+			// Report error and its position. No data follows.
+			res = _fd_write(fd, hdr, sizeof(fd_chunk_hdr_t));
+			break;
+		}
+
+		hdr->count = count;
+		if (cmd->flags & FD_FLAG_SHA256)
+			se_calc_sha256_oneshot(hdr->sha256, buf, count * 512);
+
+		res = _fd_write(fd, hdr, sizeof(fd_chunk_hdr_t));
+		if (!res)
+			res = _fd_write(fd, buf, count * 512);
+		if (res)
+			break;
+
+		sector += count;
+		sectors_left -= count;
+		idx ^= 1;
+
+		if (timer_ui < get_tmr_ms())
+		{
+			s_printf(txt_buf, "#C7EA46 Status:# Sending %d/%d MiB",
+				(sector - cmd->sector) >> 11, cmd->count >> 11);
+			fd->usbs->set_text(fd->usbs->label, txt_buf);
+			timer_ui = get_tmr_ms() + FD_UI_UPDATE_MS;
+		}
+
+		_fd_maintenance(fd);
+	} while (sectors_left);
+
+	if (!res)
+		res = _fd_write_wait(fd, 0);
+
+	return res;
+}
+
+int usb_device_gadget_dump(usb_ctxt_t *usbs)
+{
+	int res = 0;
+	fd_cmd_t cmd;
+	usbd_gadget_dump_t fd = {0};
+
+	fd.usbs = usbs;
+
+	// Get USB Controller ops.
+	if (hw_get_chip_id() == GP_HIDREV_MAJOR_T210)
+	{
+		usb_device_get_ops(&usb_ops);
+		fd.queued_max = 1;
+	}
+	else
+	{
+		fd.xusb = true;
+		fd.queued_max = FD_XUSB_IN_QUEUE;
+		xusb_device_get_ops(&usb_ops);
+	}
+
+	usbs->set_text(usbs->label, "#C7EA46 Status:# Started USB");
+
+	if (usb_ops.usb_device_init())
+	{
+		usb_ops.usbd_end(false, true);
+		return 1;
+	}
+
+	// Initialize storage.
+	if (emmc_initialize(false))
+	{
+		u32 boot_sectors = (emmc_storage.ext_csd.boot_mult << 17) / EMMC_BLOCKSIZE;
+
+		fd.storage_sectors[FD_STORAGE_EMMC_GPP]   = emmc_storage.sec_cnt;
+		fd.storage_sectors[FD_STORAGE_EMMC_BOOT0] = boot_sectors;
+		fd.storage_sectors[FD_STORAGE_EMMC_BOOT1] = boot_sectors;
+	}
+	if (sd_mount())
+		fd.storage_sectors[FD_STORAGE_SD] = sd_storage.sec_cnt;
+
+	usbs->set_text(usbs->label, "#C7EA46 Status:# Waiting for connection");
+
+	// Initialize Control Endpoint.
+	if (usb_ops.usb_device_enumerate(USB_GADGET_DUMP))
+		goto error;
+
+	usbs->set_text(usbs->label, "#C7EA46 Status:# Waiting for host");
+
+	u32 timer_sys = get_tmr_ms() + 30000;
+	while (true)
+	{
+		// Check for cancel button combo and cable removal.
+		if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
+			break;
+
+		if (usb_ops.usb_device_get_suspended())
+			break;
+
+		if (usb_ops.usbd_handle_ep0_ctrl_setup())
+		{
+			// Bulk reset. Drop any queued request.
+			fd.cmd_queued = false;
+			continue;
+		}
+
+		if (timer_sys < get_tmr_ms())
+		{
+			usbs->system_maintenance(true);
+			timer_sys = get_tmr_ms() + 30000;
+		}
+		_fd_maintenance(&fd);
+
+		int usb_res = _fd_get_cmd(&fd, &cmd);
+		if (usb_res == USB_ERROR_TIMEOUT)
+			continue;
+		else if (usb_res)
+			goto error;
+
+		DPRINTF("fd cmd %d: %d %08X %08X\n", cmd.cmd, cmd.storage, cmd.sector, cmd.count);
+
+		switch (cmd.cmd)
+		{
+		case FD_CMD_INFO:
+			usb_res = _fd_send_info(&fd);
+			break;
+
+		case FD_CMD_READ:
+			usbs->set_text(usbs->label, "#C7EA46 Status:# Sending");
+			usb_res = _fd_read(&fd, &cmd);
+			usbs->set_text(usbs->label, "#C7EA46 Status:# Waiting for host");
+			break;
+
+		case FD_CMD_END:
+			usbs->set_text(usbs->label, "#C7EA46 Status:# Dump ended");
+			goto exit;
+
+		default:
+		{
+			// Invalid command. Reply with a header carrying the error.
+			fd_chunk_hdr_t *hdr = (fd_chunk_hdr_t *)FD_HDR_BUF;
+			memset(hdr, 0, sizeof(fd_chunk_hdr_t));
+			hdr->magic  = FD_MAGIC;
+			hdr->status = FD_STS_INVALID_CMD;
+			usb_res = _fd_write(&fd, hdr, sizeof(fd_chunk_hdr_t));
+			if (!usb_res)
+				usb_res = _fd_write_wait(&fd, 0);
+			break;
+		}
+		}
+
+		if (usb_res)
+			goto error;
+	}
+
+	usbs->set_text(usbs->label, "#C7EA46 Status:# Dump ended");
+	goto exit;
+
+error:
+	usbs->set_text(usbs->label, "#FFDD00 Error:# Timed out or canceled");
+	res = 1;
+
+exit:
+	if (fd.storage_sectors[FD_STORAGE_EMMC_GPP])
+		emmc_end();
+
+	usb_ops.usbd_end(true, false);
+
+	return res;
+}
@@ -0,0 +1,94 @@
+/*
+ * USB Gadget Fast Dump protocol
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _USB_GADGET_DUMP_H_
+#define _USB_GADGET_DUMP_H_
+
+// Also used by the host client, so only standard types.
+#include <stdint.h>
+
+/*
+ * Protocol (all fields little endian):
+ * Host sends a 32 byte command to Bulk OUT.
+ *  INFO: Device replies with fd_info_t.
+ *  READ: Device streams the requested range in chunks. Each chunk is a fd_chunk_hdr_t
+ *        followed by its data. Streaming stops after the last chunk or after a header
+ *        with an error status, which carries no data.
+ *  END:  Device exits. No reply.
+ * Resuming is done by issuing a new READ from the last sector received.
+ */
+
+#define FD_MAGIC   0x504D4446 // "FDMP".
+#define FD_VERSION 1
+
+#define FD_CMD_INFO 0
+#define FD_CMD_READ 1
+#define FD_CMD_END  2
+
+#define FD_STORAGE_EMMC_GPP   0
+#define FD_STORAGE_EMMC_BOOT0 1
+#define FD_STORAGE_EMMC_BOOT1 2
+#define FD_STORAGE_SD         3
+#define FD_STORAGE_MAX        4
+
+#define FD_FLAG_SHA256 (1 << 0) // Calculate SHA256 of each chunk.
+
+#define FD_STS_OK          0
+#define FD_STS_INVALID_CMD 1
+#define FD_STS_INVALID_ARG 2
+#define FD_STS_NO_STORAGE  3
+#define FD_STS_IO_ERROR    4
+
+#define FD_SECTOR_SIZE       512
+#define FD_CHUNK_SECTORS_MAX (0x100000 / FD_SECTOR_SIZE) // 1MB.
+
+// Device side. Chunks are sent in max sized USB transfers.
+#define FD_CHUNK_XFERS   (FD_CHUNK_SECTORS_MAX * FD_SECTOR_SIZE / USB_EP_BUFFER_MAX_SIZE + 1) // Data and header.
+#define FD_XUSB_IN_QUEUE (FD_CHUNK_XFERS * 2) // Max queued Bulk IN transfers on XUSB. One chunk sent, one queued.
+
+typedef struct _fd_cmd_t
+{
+	uint32_t magic;
+	uint32_t cmd;
+	uint32_t storage;
+	uint32_t flags;
+	uint32_t sector;
+	uint32_t count;
+	uint32_t chunk_sectors; // 0 for max.
+	uint32_t rsvd;
+} fd_cmd_t;
+
+typedef struct _fd_info_t
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t status;
+	uint32_t chunk_sectors_max;
+	uint32_t sectors[FD_STORAGE_MAX]; // 0 if not available.
+} fd_info_t;
+
+typedef struct _fd_chunk_hdr_t
+{
+	uint32_t magic;
+	uint32_t status;
+	uint32_t sector;
+	uint32_t count;
+	uint8_t  sha256[32]; // Zero if not requested.
+} fd_chunk_hdr_t;
+
+#endif
@@ -60,6 +60,8 @@
 
 #define UMS_EP_OUT_MAX_XFER (USB_EP_BULK_OUT_MAX_XFER)
 
+#define UMS_XUSB_IN_QUEUE 4 // Max queued Bulk IN transfers on XUSB.
+
 // Length of a SCSI Command Data Block.
 #define SCSI_MAX_CMD_SZ 16
 
@@ -399,6 +401,17 @@ static void _transfer_finish(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt, u32
 	}
 }
 
+static void _transfer_in_wait(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt, u32 queued_max)
+{
+	bulk_ctxt->bulk_in_status = usb_ops.usb_device_ep1_in_writing_wait(queued_max, USB_XFER_SYNCED);
+
+	if (bulk_ctxt->bulk_in_status == USB_ERROR_XFER_ERROR)
+	{
+		ums->set_text(ums->label, "#FFDD00 Error:# EP IN transfer!");
+		_flush_endpoint(bulk_ctxt->bulk_in);
+	}
+}
+
 static void _reset_buffer(bulk_ctxt_t *bulk_ctxt, u32 ep)
 {
 	if (ep == bulk_ctxt->bulk_in)
@@ -441,9 +454,12 @@ static void _reset_buffer(bulk_ctxt_t *bulk_ctxt, u32 ep)
 static int _scsi_read(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 {
 	u32 lba_offset;
-	bool first_read = true;
+	u32 queued = 0;
 	u8 *sdmmc_buf = (u8 *)SDXC_BUF_ALIGNED;
 
+	// XUSB keeps multiple USB transfers queued while the next SDMMC read runs.
+	u32 queued_max = ums->xusb ? UMS_XUSB_IN_QUEUE : 1;
+
 	// Get the starting LBA and check that it's not too big.
 	if (ums->cmnd[0] == SC_READ_6)
 		lba_offset = get_array_be_to_le24(&ums->cmnd[1]);
@@ -498,9 +514,12 @@ static int _scsi_read(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		if (!sdmmc_storage_read(ums->lun.storage, ums->lun.offset + lba_offset, amount, sdmmc_buf))
 			amount = 0;
 
-		// Wait for the async USB transfer to finish.
-		if (!first_read)
-			_transfer_finish(ums, bulk_ctxt, bulk_ctxt->bulk_in, USB_XFER_SYNCED);
+		// Wait for the oldest async USB transfer to finish if queue is full.
+		if (queued == queued_max)
+		{
+			_transfer_in_wait(ums, bulk_ctxt, queued_max - 1);
+			queued--;
+		}
 
 		lba_offset   += amount;
 		amount_left  -= amount;
@@ -526,7 +545,7 @@ static int _scsi_read(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 
 		// Start the USB transfer.
 		_transfer_start(ums, bulk_ctxt, bulk_ctxt->bulk_in, USB_XFER_START);
-		first_read = false;
+		queued++;
 
 		// Increment our buffer to read new data.
 		sdmmc_buf += amount << UMS_DISK_LBA_SHIFT;
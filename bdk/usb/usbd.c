@@ -113,6 +113,7 @@ extern u32 hid_report_descriptor_touch_size;
 extern usb_desc_t usb_gadget_hid_jc_descriptors;
 extern usb_desc_t usb_gadget_hid_touch_descriptors;
 extern usb_desc_t usb_gadget_ums_descriptors;
+extern usb_desc_t usb_gadget_dump_descriptors;
 
 usbd_t *usbdaemon;
 
@@ -510,7 +511,7 @@ static void _usbd_initialize_ep_ctrl(u32 endpoint)
 	{
 		u32 endpoint_type = usbd_otg->regs->endptctrl[actual_ep] & ~USB2D_ENDPTCTRL_TX_EP_TYPE_MASK;
 		if (actual_ep)
-			endpoint_type |= usbd_otg->gadget ? USB2D_ENDPTCTRL_TX_EP_TYPE_INTR : USB2D_ENDPTCTRL_TX_EP_TYPE_BULK;
+			endpoint_type |= USB_GADGET_IS_HID(usbd_otg->gadget) ? USB2D_ENDPTCTRL_TX_EP_TYPE_INTR : USB2D_ENDPTCTRL_TX_EP_TYPE_BULK;
 		else
 			endpoint_type |= USB2D_ENDPTCTRL_TX_EP_TYPE_CTRL;
 
@@ -527,7 +528,7 @@ static void _usbd_initialize_ep_ctrl(u32 endpoint)
 	{
 		u32 endpoint_type = usbd_otg->regs->endptctrl[actual_ep] & ~USB2D_ENDPTCTRL_RX_EP_TYPE_MASK;
 		if (actual_ep)
-			endpoint_type |= usbd_otg->gadget ? USB2D_ENDPTCTRL_RX_EP_TYPE_INTR : USB2D_ENDPTCTRL_RX_EP_TYPE_BULK;
+			endpoint_type |= USB_GADGET_IS_HID(usbd_otg->gadget) ? USB2D_ENDPTCTRL_RX_EP_TYPE_INTR : USB2D_ENDPTCTRL_RX_EP_TYPE_BULK;
 		else
 			endpoint_type |= USB2D_ENDPTCTRL_RX_EP_TYPE_CTRL;
 
@@ -931,7 +932,7 @@ static void _usbd_handle_get_descriptor(bool *transmit_data, void **descriptor,
 		return;
 		}
 	case USB_DESCRIPTOR_CONFIGURATION:
-		if (usbd_otg->gadget == USB_GADGET_UMS)
+		if (!USB_GADGET_IS_HID(usbd_otg->gadget))
 		{
 			if (usbd_otg->port_speed == USB_HIGH_SPEED) // High speed. 512 bytes.
 			{
@@ -1187,7 +1188,7 @@ static int _usbd_handle_ep0_control_transfer()
 			memset(descriptor, 0, _wLength);
 			size = _wLength;
 		}
-		else if (_bRequest == USB_REQUEST_GET_DESCRIPTOR && (_wValue >> 8) == USB_DESCRIPTOR_HID_REPORT && usbd_otg->gadget > USB_GADGET_UMS)
+		else if (_bRequest == USB_REQUEST_GET_DESCRIPTOR && (_wValue >> 8) == USB_DESCRIPTOR_HID_REPORT && USB_GADGET_IS_HID(usbd_otg->gadget))
 		{
 			if (usbd_otg->gadget == USB_GADGET_HID_GAMEPAD)
 			{
@@ -1380,6 +1381,9 @@ int usb_device_enumerate(usb_gadget_type gadget)
 	case USB_GADGET_HID_TOUCHPAD:
 		usbd_otg->desc = &usb_gadget_hid_touch_descriptors;
 		break;
+	case USB_GADGET_DUMP:
+		usbd_otg->desc = &usb_gadget_dump_descriptors;
+		break;
 	}
 
 	usbd_otg->gadget = gadget;
@@ -1545,6 +1549,17 @@ int usb_device_ep1_in_writing_finish(u32 *pending_bytes, u32 sync_timeout)
 	return USB_ERROR_XFER_ERROR;
 }
 
+int usb_device_ep1_in_writing_wait(u32 queued_max, u32 sync_timeout)
+{
+	u32 pending_bytes;
+
+	// Only one transfer can be queued.
+	if (queued_max)
+		return USB_RES_OK;
+
+	return usb_device_ep1_in_writing_finish(&pending_bytes, sync_timeout);
+}
+
 bool usb_device_get_suspended()
 {
 	bool suspended = (usbd_otg->regs->portsc1 & USB2D_PORTSC1_SUSP) == USB2D_PORTSC1_SUSP;
@@ -1608,5 +1623,6 @@ void usb_device_get_ops(usb_ops_t *ops)
 	ops->usb_device_ep1_out_reading_finish = usb_device_ep1_out_reading_finish;
 	ops->usb_device_ep1_in_write           = usb_device_ep1_in_write;
 	ops->usb_device_ep1_in_writing_finish  = usb_device_ep1_in_writing_finish;
+	ops->usb_device_ep1_in_writing_wait    = usb_device_ep1_in_writing_wait;
 }
 
@@ -48,8 +48,11 @@ typedef enum _usb_gadget_type
 	USB_GADGET_UMS          = 0,
 	USB_GADGET_HID_GAMEPAD  = 1,
 	USB_GADGET_HID_TOUCHPAD = 2,
+	USB_GADGET_DUMP         = 3,
 } usb_gadget_type;
 
+#define USB_GADGET_IS_HID(g) ((g) == USB_GADGET_HID_GAMEPAD || (g) == USB_GADGET_HID_TOUCHPAD)
+
 typedef enum {
 	USB_DIR_OUT = 0,
 	USB_DIR_IN  = 1,
@@ -179,6 +182,7 @@ typedef struct _usb_ops_t
 	int  (*usb_device_ep1_out_reading_finish)(u32 *, u32);
 	int  (*usb_device_ep1_in_write)(u8 *, u32, u32 *, u32);
 	int  (*usb_device_ep1_in_writing_finish)(u32 *, u32);
+	int  (*usb_device_ep1_in_writing_wait)(u32, u32); // Waits until at most N transfers are queued.
 	bool (*usb_device_get_suspended)();
 	bool (*usb_device_get_port_in_sleep)();
 } usb_ops_t;
@@ -200,5 +204,6 @@ void xusb_device_get_ops(usb_ops_t *ops);
 
 int  usb_device_gadget_ums(usb_ctxt_t *usbs);
 int  usb_device_gadget_hid(usb_ctxt_t *usbs);
+int  usb_device_gadget_dump(usb_ctxt_t *usbs);
 
 #endif
\ No newline at end of file
@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <assert.h>
 #include <string.h>
 
 #include <usb/usbd.h>
@@ -34,9 +35,27 @@
 
 #include <memory_map.h>
 
-#define XUSB_TRB_SLOTS 16 //! TODO: Consider upping it.
+#define XUSB_TRB_SLOTS 16
 #define XUSB_LINK_TRB_IDX (XUSB_TRB_SLOTS - 1)
-#define XUSB_LAST_TRB_IDX (XUSB_TRB_SLOTS - 1)
+
+// Bulk rings fit multiple queued transfers made of chained TRBs.
+#define XUSB_BULK_TRB_SLOTS      64
+#define XUSB_BULK_LINK_TRB_IDX   (XUSB_BULK_TRB_SLOTS - 1)
+#define XUSB_BULK_TD_TRBS_MAX    16
+#define XUSB_TRB_MAX_SIZE        SZ_64K // Also a TRB buffer must not cross a 64KB boundary.
+#define XUSB_BULK_TD_MAX_SIZE    (XUSB_BULK_TD_TRBS_MAX * XUSB_TRB_MAX_SIZE)
+
+/*
+ * Event ring is made of 2 segments. All normal TRBs interrupt on short packet, so every
+ * queued bulk TRB can post an event before any gets handled. Ring must fit them all,
+ * plus control ring ones and port change/setup events, or the controller stalls.
+ */
+#define XUSB_EVENT_TRB_SLOTS     128 // Per segment.
+#define XUSB_EVENT_LAST_TRB_IDX  (XUSB_EVENT_TRB_SLOTS - 1)
+#define XUSB_BULK_TRBS_QUEUED    (XUSB_BULK_TRB_SLOTS - 2) // Minus link TRB and the one kept empty.
+#define XUSB_EVENTS_MAX          (XUSB_BULK_TRBS_QUEUED * 2 + XUSB_TRB_SLOTS + 8) // 8 for port change and setup.
+
+static_assert(XUSB_EVENTS_MAX <= XUSB_EVENT_TRB_SLOTS * 2 - 1, "XUSB event ring can't fit all completions!");
 
 #define EP_DONT_RING     0
 #define EP_RING_DOORBELL 1
@@ -391,18 +410,21 @@ extern u8 hid_report_descriptor_touch[];
 extern usb_desc_t usb_gadget_hid_jc_descriptors;
 extern usb_desc_t usb_gadget_hid_touch_descriptors;
 extern usb_desc_t usb_gadget_ums_descriptors;
+extern usb_desc_t usb_gadget_dump_descriptors;
 
 // All rings and EP context must be aligned to 0x10.
 typedef struct _xusbd_event_queues_t
 {
-	event_trb_t xusb_event_ring_seg0[XUSB_TRB_SLOTS];
-	event_trb_t xusb_event_ring_seg1[XUSB_TRB_SLOTS];
+	event_trb_t xusb_event_ring_seg0[XUSB_EVENT_TRB_SLOTS];
+	event_trb_t xusb_event_ring_seg1[XUSB_EVENT_TRB_SLOTS];
 	data_trb_t  xusb_cntrl_event_queue[XUSB_TRB_SLOTS];
-	data_trb_t  xusb_bulkin_event_queue[XUSB_TRB_SLOTS];
-	data_trb_t  xusb_bulkout_event_queue[XUSB_TRB_SLOTS];
+	data_trb_t  xusb_bulkin_event_queue[XUSB_BULK_TRB_SLOTS];
+	data_trb_t  xusb_bulkout_event_queue[XUSB_BULK_TRB_SLOTS];
 	volatile xusb_ep_ctx_t xusb_ep_ctxt[4];
 } xusbd_event_queues_t;
 
+static_assert(sizeof(xusbd_event_queues_t) <= SECMON_MIN_START - XUSB_RING_ADDR, "XUSB rings don't fit in IRAM!");
+
 // Set event queues context to a 0x10 aligned address.
 xusbd_event_queues_t *xusb_evtq = (xusbd_event_queues_t *)XUSB_RING_ADDR;
 
@@ -440,7 +462,7 @@ static void _xusbd_ep_init_event_ring()
 	XUSB_DEV_XHCI(XUSB_DEV_XHCI_ERST1BAHI) = 0;
 
 	// Set Event Ring Segment sizes.
-	XUSB_DEV_XHCI(XUSB_DEV_XHCI_ERSTSZ) = (XUSB_TRB_SLOTS << 16) | XUSB_TRB_SLOTS;
+	XUSB_DEV_XHCI(XUSB_DEV_XHCI_ERSTSZ) = (XUSB_EVENT_TRB_SLOTS << 16) | XUSB_EVENT_TRB_SLOTS;
 
 	// Set Enqueue and Dequeue pointers.
 	usbd_xotg->event_enqueue_ptr = xusb_evtq->xusb_event_ring_seg0;
@@ -510,6 +532,7 @@ static void _xusb_ep_set_type_and_metrics(u32 ep_idx, volatile xusb_ep_ctx_t *ep
 		switch (usbd_xotg->gadget)
 		{
 		case USB_GADGET_UMS:
+		case USB_GADGET_DUMP:
 			ep_ctxt->avg_trb_len = 3072;
 			break;
 		case USB_GADGET_HID_GAMEPAD:
@@ -599,6 +622,7 @@ static void _xusb_ep_set_type_and_metrics(u32 ep_idx, volatile xusb_ep_ctx_t *ep
 		switch (usbd_xotg->gadget)
 		{
 		case USB_GADGET_UMS:
+		case USB_GADGET_DUMP:
 			ep_ctxt->avg_trb_len = 3072;
 			break;
 		case USB_GADGET_HID_GAMEPAD:
@@ -692,6 +716,7 @@ static int _xusb_ep_init_context(u32 ep_idx)
 		break;
 
 	case USB_EP_BULK_OUT:
+		memset(xusb_evtq->xusb_bulkout_event_queue, 0, sizeof(xusb_evtq->xusb_bulkout_event_queue));
 		usbd_xotg->bulkout_producer_cycle = 1;
 		usbd_xotg->bulkout_epenqueue_ptr  = xusb_evtq->xusb_bulkout_event_queue;
 		usbd_xotg->bulkout_epdequeue_ptr  = xusb_evtq->xusb_bulkout_event_queue;
@@ -701,7 +726,7 @@ static int _xusb_ep_init_context(u32 ep_idx)
 		ep_ctxt->trd_dequeueptr_lo = (u32)xusb_evtq->xusb_bulkout_event_queue >> 4;
 		ep_ctxt->trd_dequeueptr_hi = 0;
 
-		link_trb = (link_trb_t *)&xusb_evtq->xusb_bulkout_event_queue[XUSB_LINK_TRB_IDX];
+		link_trb = (link_trb_t *)&xusb_evtq->xusb_bulkout_event_queue[XUSB_BULK_LINK_TRB_IDX];
 		link_trb->toggle_cycle   = 1;
 		link_trb->ring_seg_ptrlo = (u32)xusb_evtq->xusb_bulkout_event_queue >> 4;
 		link_trb->ring_seg_ptrhi = 0;
@@ -709,6 +734,7 @@ static int _xusb_ep_init_context(u32 ep_idx)
 		break;
 
 	case USB_EP_BULK_IN:
+		memset(xusb_evtq->xusb_bulkin_event_queue, 0, sizeof(xusb_evtq->xusb_bulkin_event_queue));
 		usbd_xotg->bulkin_producer_cycle = 1;
 		usbd_xotg->bulkin_epenqueue_ptr  = xusb_evtq->xusb_bulkin_event_queue;
 		usbd_xotg->bulkin_epdequeue_ptr  = xusb_evtq->xusb_bulkin_event_queue;
@@ -718,7 +744,7 @@ static int _xusb_ep_init_context(u32 ep_idx)
 		ep_ctxt->trd_dequeueptr_lo = (u32)xusb_evtq->xusb_bulkin_event_queue >> 4;
 		ep_ctxt->trd_dequeueptr_hi = 0;
 
-		link_trb = (link_trb_t *)&xusb_evtq->xusb_bulkin_event_queue[XUSB_LINK_TRB_IDX];
+		link_trb = (link_trb_t *)&xusb_evtq->xusb_bulkin_event_queue[XUSB_BULK_LINK_TRB_IDX];
 		link_trb->toggle_cycle   = 1;
 		link_trb->ring_seg_ptrlo = (u32)xusb_evtq->xusb_bulkin_event_queue >> 4;
 		link_trb->ring_seg_ptrhi = 0;
@@ -1005,6 +1031,18 @@ static void _xusb_device_power_down()
 	CLOCK(CLK_RST_CONTROLLER_CLK_ENB_W_CLR) = BIT(CLK_W_XUSB);
 }
 
+static void _xusb_ring_doorbell(u32 ep_idx)
+{
+	// Flush data before transfer.
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+
+	u32 target_id = (ep_idx << 8) & 0xFFFF;
+	if (ep_idx == XUSB_EP_CTRL_IN)
+		target_id |= usbd_xotg->ctrl_seq_num << 16;
+
+	XUSB_DEV_XHCI(XUSB_DEV_XHCI_DB) = target_id;
+}
+
 static int _xusb_queue_trb(u32 ep_idx, void *trb, bool ring_doorbell)
 {
 	int res = USB_RES_OK;
@@ -1024,8 +1062,9 @@ static int _xusb_queue_trb(u32 ep_idx, void *trb, bool ring_doorbell)
 			link_trb = (link_trb_t *)next_trb;
 			link_trb->cycle = usbd_xotg->cntrl_producer_cycle & 1;
 			link_trb->toggle_cycle = 1;
+			link_trb->chain = ((data_trb_t *)trb)->chain; // Keep TD intact when wrapping.
 
-			next_trb = (data_trb_t *)(link_trb->ring_seg_ptrlo << 4);
+			next_trb = (data_trb_t *)((u32)link_trb->ring_seg_ptrlo << 4);
 
 			usbd_xotg->cntrl_producer_cycle ^= 1;
 		}
@@ -1042,8 +1081,9 @@ static int _xusb_queue_trb(u32 ep_idx, void *trb, bool ring_doorbell)
 			link_trb = (link_trb_t *)next_trb;
 			link_trb->cycle = usbd_xotg->bulkout_producer_cycle & 1;
 			link_trb->toggle_cycle = 1;
+			link_trb->chain = ((data_trb_t *)trb)->chain; // Keep TD intact when wrapping.
 
-			next_trb = (data_trb_t *)(link_trb->ring_seg_ptrlo << 4);
+			next_trb = (data_trb_t *)((u32)link_trb->ring_seg_ptrlo << 4);
 
 			usbd_xotg->bulkout_producer_cycle ^= 1;
 		}
@@ -1060,8 +1100,9 @@ static int _xusb_queue_trb(u32 ep_idx, void *trb, bool ring_doorbell)
 			link_trb = (link_trb_t *)next_trb;
 			link_trb->cycle = usbd_xotg->bulkin_producer_cycle & 1;
 			link_trb->toggle_cycle = 1;
+			link_trb->chain = ((data_trb_t *)trb)->chain; // Keep TD intact when wrapping.
 
-			next_trb = (data_trb_t *)(link_trb->ring_seg_ptrlo << 4);
+			next_trb = (data_trb_t *)((u32)link_trb->ring_seg_ptrlo << 4);
 
 			usbd_xotg->bulkin_producer_cycle ^= 1;
 		}
@@ -1076,16 +1117,7 @@ static int _xusb_queue_trb(u32 ep_idx, void *trb, bool ring_doorbell)
 
 	// Ring doorbell.
 	if (ring_doorbell)
-	{
-		// Flush data before transfer.
-		bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
-
-		u32 target_id = (ep_idx << 8) & 0xFFFF;
-		if (ep_idx == XUSB_EP_CTRL_IN)
-			target_id |= usbd_xotg->ctrl_seq_num << 16;
-
-		XUSB_DEV_XHCI(XUSB_DEV_XHCI_DB) = target_id;
-	}
+		_xusb_ring_doorbell(ep_idx);
 
 	return res;
 }
@@ -1107,7 +1139,7 @@ static void _xusb_create_normal_trb(normal_trb_t *trb, u8 *buf, u32 len, usb_dir
 
 	trb->trb_tx_len = len;
 
-	// Single TRB transfer.
+	// Single TRB transfer. Changed by caller if chained.
 	trb->td_size = 0;
 	trb->chain   = 0;
 
@@ -1156,20 +1188,96 @@ static int _xusb_issue_status_trb(usb_dir_t direction)
 	return res;
 }
 
+static int _xusb_ep_operation(u32 tries);
+
+static u32 _xusb_td_trbs(u8 *buf, u32 len)
+{
+	// Zero length transfers still need a TRB.
+	if (!len)
+		return 1;
+
+	// Count 64KB boundaries crossed.
+	u32 start = (u32)buf;
+	u32 end   = start + len - 1;
+
+	return (end / XUSB_TRB_MAX_SIZE) - (start / XUSB_TRB_MAX_SIZE) + 1;
+}
+
+static u32 _xusb_bulk_ring_free_trbs(u32 ep_idx)
+{
+	data_trb_t *enqueue_ptr;
+	data_trb_t *dequeue_ptr;
+	const u32 usable = XUSB_BULK_TRB_SLOTS - 1; // Link TRB.
+
+	if (ep_idx == USB_EP_BULK_IN)
+	{
+		enqueue_ptr = usbd_xotg->bulkin_epenqueue_ptr;
+		dequeue_ptr = usbd_xotg->bulkin_epdequeue_ptr;
+	}
+	else
+	{
+		enqueue_ptr = usbd_xotg->bulkout_epenqueue_ptr;
+		dequeue_ptr = usbd_xotg->bulkout_epdequeue_ptr;
+	}
+
+	// One slot is kept empty so a full ring is distinguishable from an empty one.
+	return (dequeue_ptr - enqueue_ptr + usable - 1) % usable;
+}
+
 static int _xusb_issue_normal_trb(u8 *buf, u32 len, usb_dir_t direction)
 {
-	normal_trb_t trb = {0};
+	normal_trb_t trb;
 
-	_xusb_create_normal_trb(&trb, buf, len, direction);
 	u32 ep_idx = USB_EP_BULK_IN;
 	if (direction == USB_DIR_OUT)
 		ep_idx = USB_EP_BULK_OUT;
 
-	int res = _xusb_queue_trb(ep_idx, &trb, EP_RING_DOORBELL);
-	if (!res)
-		usbd_xotg->wait_for_event_trb = XUSB_TRB_NORMAL;
+	u32 trbs = _xusb_td_trbs(buf, len);
+	if (trbs > XUSB_BULK_TD_TRBS_MAX)
+		return USB_ERROR_XFER_ERROR;
 
-	return res;
+	// Process completions until the whole TD fits. This also bounds pending events to XUSB_EVENTS_MAX.
+	while (_xusb_bulk_ring_free_trbs(ep_idx) < trbs)
+	{
+		int res = _xusb_ep_operation(USB_XFER_SYNCED_DATA);
+		if (res)
+			return res;
+	}
+
+	u32 max_packet_size = xusb_evtq->xusb_ep_ctxt[ep_idx].max_packet_size;
+	normal_trb_t *first_trb = (normal_trb_t *)(ep_idx == USB_EP_BULK_IN ?
+		usbd_xotg->bulkin_epenqueue_ptr : usbd_xotg->bulkout_epenqueue_ptr);
+
+	// Split transfer into chained TRBs. Only the last one interrupts on completion.
+	u32 len_left = len;
+	for (u32 i = 0; i < trbs; i++)
+	{
+		u32 trb_len = MIN(len_left, XUSB_TRB_MAX_SIZE - ((u32)buf & (XUSB_TRB_MAX_SIZE - 1)));
+		len_left -= trb_len;
+
+		memset(&trb, 0, sizeof(normal_trb_t));
+		_xusb_create_normal_trb(&trb, buf, trb_len, direction);
+		trb.td_size = MIN((len_left + max_packet_size - 1) / max_packet_size, 31);
+		trb.chain   = len_left ? 1 : 0;
+		trb.ioc     = !trb.chain;
+
+		// Hide the TD from the controller until all of it is in place.
+		if (!i)
+			trb.cycle ^= 1;
+
+		_xusb_queue_trb(ep_idx, &trb, EP_DONT_RING);
+		buf += trb_len;
+	}
+
+	// Flush chained TRBs first and then hand the TD over.
+	if (trbs > 1)
+		bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+	first_trb->cycle ^= 1;
+
+	_xusb_ring_doorbell(ep_idx);
+	usbd_xotg->wait_for_event_trb = XUSB_TRB_NORMAL;
+
+	return USB_RES_OK;
 }
 
 static int _xusb_issue_data_trb(u8 *buf, u32 len, usb_dir_t direction)
@@ -1220,29 +1328,49 @@ static int _xusb_wait_ep_stopped(u32 endpoint)
 	return USB_RES_OK;
 }
 
+static data_trb_t *_xusb_next_trb(data_trb_t *trb)
+{
+	// Advance and if Link TRB, go to the start of the ring.
+	data_trb_t *next_trb = &trb[1];
+	if (next_trb->trb_type == XUSB_TRB_LINK)
+		next_trb = (data_trb_t *)(next_trb->databufptr_lo & 0xFFFFFFF0);
+
+	return next_trb;
+}
+
+static data_trb_t *_xusb_bulk_td_end(transfer_event_trb_t *trb, data_trb_t *dequeue_ptr, u32 *residue)
+{
+	data_trb_t *curr_trb = (data_trb_t *)(trb->trb_pointer_lo & 0xFFFFFFF0);
+	*residue = trb->trb_tx_len;
+
+	// No TRB reported. Advance by one.
+	if (!curr_trb)
+		return _xusb_next_trb(dequeue_ptr);
+
+	// A short packet ends the TD early. Skip and account the rest of its TRBs.
+	while (curr_trb->chain)
+	{
+		curr_trb = _xusb_next_trb(curr_trb);
+		*residue += curr_trb->trb_tx_len;
+	}
+
+	return _xusb_next_trb(curr_trb);
+}
+
 static int _xusb_handle_transfer_event(transfer_event_trb_t *trb)
 {
 	// Advance dequeue list.
-	data_trb_t *next_trb;
+	u32 residue = trb->trb_tx_len;
 	switch (trb->ep_id)
 	{
 	case XUSB_EP_CTRL_IN:
-		next_trb = &usbd_xotg->cntrl_epdequeue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-			next_trb = (data_trb_t *)(next_trb->databufptr_lo & 0xFFFFFFF0);
-		usbd_xotg->cntrl_epdequeue_ptr = next_trb;
+		usbd_xotg->cntrl_epdequeue_ptr = _xusb_next_trb(usbd_xotg->cntrl_epdequeue_ptr);
 		break;
 	case USB_EP_BULK_OUT:
-		next_trb = &usbd_xotg->bulkout_epdequeue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-			next_trb = (data_trb_t *)(next_trb->databufptr_lo & 0xFFFFFFF0);
-		usbd_xotg->bulkout_epdequeue_ptr = next_trb;
+		usbd_xotg->bulkout_epdequeue_ptr = _xusb_bulk_td_end(trb, usbd_xotg->bulkout_epdequeue_ptr, &residue);
 		break;
 	case USB_EP_BULK_IN:
-		next_trb = &usbd_xotg->bulkin_epdequeue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-			next_trb = (data_trb_t *)(next_trb->databufptr_lo & 0xFFFFFFF0);
-		usbd_xotg->bulkin_epdequeue_ptr = next_trb;
+		usbd_xotg->bulkin_epdequeue_ptr = _xusb_bulk_td_end(trb, usbd_xotg->bulkin_epdequeue_ptr, &residue);
 		break;
 	default:
 		// Should never happen.
@@ -1280,18 +1408,18 @@ static int _xusb_handle_transfer_event(transfer_event_trb_t *trb)
 			break;
 
 		case USB_EP_BULK_IN:
-			usbd_xotg->tx_bytes[USB_DIR_IN] -= trb->trb_tx_len;
+			usbd_xotg->tx_bytes[USB_DIR_IN] -= residue;
 			if (usbd_xotg->tx_count[USB_DIR_IN])
 				usbd_xotg->tx_count[USB_DIR_IN]--;
 
 			// If bytes remaining for a Bulk IN transfer, return error.
-			if (trb->trb_tx_len)
+			if (residue)
 				return XUSB_ERROR_XFER_BULK_IN_RESIDUE;
 			break;
 
 		case USB_EP_BULK_OUT:
 			// If short packet and Bulk OUT, it's not an error because we prime EP for 4KB.
-			usbd_xotg->tx_bytes[USB_DIR_OUT] -= trb->trb_tx_len;
+			usbd_xotg->tx_bytes[USB_DIR_OUT] -= residue;
 			if (usbd_xotg->tx_count[USB_DIR_OUT])
 				usbd_xotg->tx_count[USB_DIR_OUT]--;
 			break;
@@ -1512,7 +1640,7 @@ static int _xusb_handle_get_descriptor(usb_ctrl_setup_t *ctrl_setup)
 		break;
 	case USB_DESCRIPTOR_CONFIGURATION:
 		//! TODO USB3: Provide a super speed descriptor.
-		if (usbd_xotg->gadget == USB_GADGET_UMS)
+		if (!USB_GADGET_IS_HID(usbd_xotg->gadget))
 		{
 			if (usbd_xotg->port_speed == XUSB_HIGH_SPEED) // High speed. 512 bytes.
 			{
@@ -1768,7 +1896,7 @@ static int _xusbd_handle_ep0_control_transfer(usb_ctrl_setup_t *ctrl_setup)
 			size = sizeof(xusb_status_descriptor);
 			transmit_data = true;
 		}
-		else if (_bRequest == USB_REQUEST_GET_DESCRIPTOR && (_wValue >> 8) == USB_DESCRIPTOR_HID_REPORT && usbd_xotg->gadget > USB_GADGET_UMS)
+		else if (_bRequest == USB_REQUEST_GET_DESCRIPTOR && (_wValue >> 8) == USB_DESCRIPTOR_HID_REPORT && USB_GADGET_IS_HID(usbd_xotg->gadget))
 		{
 			if (usbd_xotg->gadget == USB_GADGET_HID_GAMEPAD)
 			{
@@ -1905,7 +2033,7 @@ static int _xusb_ep_operation(u32 tries)
 		}
 
 		// Check if last event TRB and reset to first one.
-		if (usbd_xotg->event_dequeue_ptr == &xusb_evtq->xusb_event_ring_seg1[XUSB_LAST_TRB_IDX])
+		if (usbd_xotg->event_dequeue_ptr == &xusb_evtq->xusb_event_ring_seg1[XUSB_EVENT_LAST_TRB_IDX])
 		{
 			usbd_xotg->event_dequeue_ptr = xusb_evtq->xusb_event_ring_seg0;
 			usbd_xotg->event_ccs ^= 1;
@@ -1943,6 +2071,9 @@ int xusb_device_enumerate(usb_gadget_type gadget)
 	case USB_GADGET_HID_TOUCHPAD:
 		usbd_xotg->desc = &usb_gadget_hid_touch_descriptors;
 		break;
+	case USB_GADGET_DUMP:
+		usbd_xotg->desc = &usb_gadget_dump_descriptors;
+		break;
 	}
 
 	usbd_xotg->gadget = gadget;
@@ -2058,24 +2189,40 @@ int xusb_device_ep1_out_read_big(u8 *buf, u32 len, u32 *bytes_read)
 	if (len > USB_EP_BULK_OUT_MAX_XFER)
 		len = USB_EP_BULK_OUT_MAX_XFER;
 
-	u32 bytes = 0;
+	int res = USB_RES_OK;
 	*bytes_read = 0;
-	u8 *buf_curr = buf;
 
+	// Read in big chained TDs so the controller does not stall between 64KB chunks.
 	while (len)
 	{
-		u32 len_ep = MIN(len, USB_EP_BUFFER_MAX_SIZE);
+		// Keep 64KB alignment so the TD fits in its max TRBs.
+		u32 len_td = XUSB_BULK_TD_MAX_SIZE - ((u32)buf & (XUSB_TRB_MAX_SIZE - 1));
+		len_td = MIN(len, len_td);
+
+		usbd_xotg->tx_count[USB_DIR_OUT] = 1;
+		usbd_xotg->tx_bytes[USB_DIR_OUT] = len_td;
 
-		int res = xusb_device_ep1_out_read(buf_curr, len_ep, &bytes, USB_XFER_SYNCED_DATA);
+		res = _xusb_issue_normal_trb(buf, len_td, USB_DIR_OUT);
+		while (!res && usbd_xotg->tx_count[USB_DIR_OUT])
+			res = _xusb_ep_operation(USB_XFER_SYNCED_DATA);
 		if (res)
-			return res;
+			break;
 
-		len -= len_ep;
-		buf_curr += len_ep;
-		*bytes_read = *bytes_read + bytes;
+		u32 bytes = usbd_xotg->tx_bytes[USB_DIR_OUT];
+		*bytes_read += bytes;
+
+		// Short packet. Transfer ended.
+		if (bytes != len_td)
+			break;
+
+		len -= len_td;
+		buf += len_td;
 	}
 
-	return USB_RES_OK;
+	// Invalidate data after transfer.
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_INVALID_WAY, false);
+
+	return res;
 }
 
 int xusb_device_ep1_out_reading_finish(u32 *pending_bytes, u32 sync_tries)
@@ -2101,12 +2248,15 @@ int xusb_device_ep1_in_write(u8 *buf, u32 len, u32 *bytes_written, u32 sync_trie
 	// Flush data before transfer.
 	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
 
-	int res = USB_RES_OK;
-	usbd_xotg->tx_count[USB_DIR_IN] = 0;
-	usbd_xotg->tx_bytes[USB_DIR_IN] = len;
+	// Transfers are queued behind any still in progress.
+	if (!usbd_xotg->tx_count[USB_DIR_IN])
+		usbd_xotg->tx_bytes[USB_DIR_IN] = 0;
 
-	_xusb_issue_normal_trb(buf, len, USB_DIR_IN);
+	int res = _xusb_issue_normal_trb(buf, len, USB_DIR_IN);
+	if (res)
+		return res;
 	usbd_xotg->tx_count[USB_DIR_IN]++;
+	usbd_xotg->tx_bytes[USB_DIR_IN] += len;
 
 	if (sync_tries)
 	{
@@ -2130,6 +2280,15 @@ int xusb_device_ep1_in_write(u8 *buf, u32 len, u32 *bytes_written, u32 sync_trie
 	return res;
 }
 
+int xusb_device_ep1_in_writing_wait(u32 queued_max, u32 sync_tries)
+{
+	int res = USB_RES_OK;
+	while (!res && usbd_xotg->tx_count[USB_DIR_IN] > queued_max)
+		res = _xusb_ep_operation(sync_tries);
+
+	return res;
+}
+
 int xusb_device_ep1_in_writing_finish(u32 *pending_bytes, u32 sync_tries)
 {
 	int res = USB_RES_OK;
@@ -2206,4 +2365,5 @@ void xusb_device_get_ops(usb_ops_t *ops)
 	ops->usb_device_ep1_out_reading_finish = xusb_device_ep1_out_reading_finish;
 	ops->usb_device_ep1_in_write           = xusb_device_ep1_in_write;
 	ops->usb_device_ep1_in_writing_finish  = xusb_device_ep1_in_writing_finish;
+	ops->usb_device_ep1_in_writing_wait    = xusb_device_ep1_in_writing_wait;
 }
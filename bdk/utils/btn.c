@@ -51,6 +51,11 @@ u8 btn_read_home()
 }
 
 u8 btn_wait()
+{
+	return btn_wait_idle(NULL);
+}
+
+u8 btn_wait_idle(bool (*idle)())
 {
 	u8 res = 0, btn = btn_read();
 	bool pwr = false;
@@ -70,6 +75,10 @@ u8 btn_wait()
 			pwr = false;
 		else if (pwr) //Power button still down.
 			res &= ~BTN_POWER;
+
+		// Run idle work until there's nothing left.
+		if (idle && btn == res && !idle())
+			idle = NULL;
 	} while (btn == res);
 
 	return res;
@@ -30,6 +30,7 @@ u8 btn_read();
 u8 btn_read_vol();
 u8 btn_read_home();
 u8 btn_wait();
+u8 btn_wait_idle(bool (*idle)());
 u8 btn_wait_timeout(u32 time_ms, u8 mask);
 u8 btn_wait_timeout_single(u32 time_ms, u8 mask);
 
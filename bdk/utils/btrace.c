@@ -0,0 +1,216 @@
+/*
+ * Boot phase tracer
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <mem/heap.h>
+#include <soc/timer.h>
+#include <storage/sd.h>
+#include <utils/btrace.h>
+#include <utils/util.h>
+
+#define BTRACE_EVT_JSON_MAX 112
+
+extern volatile nyx_storage_t *nyx_str;
+
+static u8 btrace_stage = BTRACE_STAGE_HEKATE;
+
+static const char *btrace_stage_names[] = { "hekate", "nyx" };
+
+void btrace_init(btrace_stage_t stage, bool reset)
+{
+	btrace_t *trace = (btrace_t *)&nyx_str->trace;
+
+	btrace_stage = stage;
+
+	// Keep events of the previous stage if buffer is valid.
+	if (!reset && trace->magic == BTRACE_MAGIC && trace->idx < BTRACE_MAX_EVENTS)
+		return;
+
+	trace->magic   = BTRACE_MAGIC;
+	trace->idx     = 0;
+	trace->cnt     = 0;
+	trace->enabled = 0;
+}
+
+void btrace_set_export(bool enable)
+{
+	btrace_t *trace = (btrace_t *)&nyx_str->trace;
+
+	trace->enabled = enable;
+}
+
+void btrace_event(btrace_type_t type, const char *name, u32 ts)
+{
+	btrace_t *trace = (btrace_t *)&nyx_str->trace;
+
+	if (trace->magic != BTRACE_MAGIC)
+		return;
+
+	btrace_evt_t *evt = &trace->evt[trace->idx];
+
+	evt->ts    = ts;
+	evt->type  = type;
+	evt->stage = btrace_stage;
+	strncpy(evt->name, name, BTRACE_NAME_LEN - 1);
+	evt->name[BTRACE_NAME_LEN - 1] = 0;
+
+	// Ring buffer. Oldest events get overwritten.
+	trace->idx = (trace->idx + 1) % BTRACE_MAX_EVENTS;
+	if (trace->cnt < BTRACE_MAX_EVENTS)
+		trace->cnt++;
+}
+
+void btrace_begin(const char *name)
+{
+	btrace_event(BTRACE_BEGIN, name, get_tmr_us());
+}
+
+void btrace_end(const char *name)
+{
+	btrace_event(BTRACE_END, name, get_tmr_us());
+}
+
+void btrace_mark(const char *name)
+{
+	btrace_event(BTRACE_MARK, name, get_tmr_us());
+}
+
+void btrace_end_open()
+{
+	btrace_t *trace = (btrace_t *)&nyx_str->trace;
+	char names[BTRACE_OPEN_MAX][BTRACE_NAME_LEN];
+	u32 open = 0;
+	u32 depth = 0;
+
+	if (trace->magic != BTRACE_MAGIC)
+		return;
+
+	// Walk from newest to oldest and collect unmatched spans of this stage.
+	u32 idx = trace->idx;
+	for (u32 i = 0; i < trace->cnt && open < BTRACE_OPEN_MAX; i++)
+	{
+		idx = (idx + BTRACE_MAX_EVENTS - 1) % BTRACE_MAX_EVENTS;
+		btrace_evt_t *evt = &trace->evt[idx];
+
+		if (evt->stage != btrace_stage)
+			continue;
+
+		if (evt->type == BTRACE_END)
+			depth++;
+		else if (evt->type == BTRACE_BEGIN)
+		{
+			if (depth)
+				depth--;
+			else
+				strcpy(names[open++], evt->name);
+		}
+	}
+
+	// Close them innermost first.
+	u32 ts = get_tmr_us();
+	for (u32 i = 0; i < open; i++)
+		btrace_event(BTRACE_END, names[i], ts);
+}
+
+static char *_btrace_put_str(char *pos, const char *str)
+{
+	u32 len = strlen(str);
+	memcpy(pos, str, len);
+
+	return pos + len;
+}
+
+static char *_btrace_put_num(char *pos, u32 num)
+{
+	char tmp[10];
+	u32 len = 0;
+
+	do
+	{
+		tmp[len++] = '0' + (num % 10);
+		num /= 10;
+	} while (num);
+
+	while (len)
+		*pos++ = tmp[--len];
+
+	return pos;
+}
+
+static char *_btrace_put_evt(char *pos, const char *name, char type, u32 ts, u32 stage)
+{
+	pos = _btrace_put_str(pos, "{\"name\":\"");
+	pos = _btrace_put_str(pos, name);
+	pos = _btrace_put_str(pos, "\",\"ph\":\"");
+	*pos++ = type;
+	pos = _btrace_put_str(pos, "\",\"ts\":");
+	pos = _btrace_put_num(pos, ts);
+	pos = _btrace_put_str(pos, ",\"pid\":1,\"tid\":");
+	pos = _btrace_put_num(pos, stage);
+	if (type == BTRACE_MARK)
+		pos = _btrace_put_str(pos, ",\"s\":\"t\"");
+	pos = _btrace_put_str(pos, "}");
+
+	return pos;
+}
+
+int btrace_save(const char *path)
+{
+	btrace_t *trace = (btrace_t *)&nyx_str->trace;
+
+	if (trace->magic != BTRACE_MAGIC || !trace->enabled || !trace->cnt)
+		return 1;
+
+	// Events plus thread name metadata and header/footer.
+	char *buf = (char *)malloc((trace->cnt + ARRAY_SIZE(btrace_stage_names) + 2) * BTRACE_EVT_JSON_MAX);
+	if (!buf)
+		return 1;
+
+	char *pos = _btrace_put_str(buf, "{\"traceEvents\":[\n");
+
+	// Name the timeline of each stage.
+	for (u32 i = 0; i < ARRAY_SIZE(btrace_stage_names); i++)
+	{
+		pos = _btrace_put_str(pos, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+		pos = _btrace_put_num(pos, i);
+		pos = _btrace_put_str(pos, ",\"args\":{\"name\":\"");
+		pos = _btrace_put_str(pos, btrace_stage_names[i]);
+		pos = _btrace_put_str(pos, "\"}},\n");
+	}
+
+	// Export from oldest to newest event.
+	u32 idx = (trace->idx + BTRACE_MAX_EVENTS - trace->cnt) % BTRACE_MAX_EVENTS;
+	for (u32 i = 0; i < trace->cnt; i++)
+	{
+		btrace_evt_t *evt = &trace->evt[idx];
+
+		pos = _btrace_put_evt(pos, evt->name, evt->type, evt->ts, evt->stage);
+		pos = _btrace_put_str(pos, (i + 1) < trace->cnt ? ",\n" : "\n");
+
+		idx = (idx + 1) % BTRACE_MAX_EVENTS;
+	}
+
+	pos = _btrace_put_str(pos, "],\"displayTimeUnit\":\"ms\"}\n");
+
+	int res = sd_save_to_file(buf, pos - buf, path);
+
+	free(buf);
+
+	return res;
+}
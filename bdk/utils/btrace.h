@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BTRACE_H_
+#define _BTRACE_H_
+
+#include <utils/types.h>
+
+#define BTRACE_MAGIC      0x43525442 // "BTRC".
+#define BTRACE_MAX_EVENTS 1024
+#define BTRACE_NAME_LEN   24
+#define BTRACE_OPEN_MAX   8  // Max nested spans closed by btrace_end_open.
+
+#define BTRACE_FILE_PATH  "bootloader/boot_trace.json"
+
+typedef enum _btrace_stage_t
+{
+	BTRACE_STAGE_HEKATE = 0,
+	BTRACE_STAGE_NYX    = 1,
+} btrace_stage_t;
+
+// Values match Chrome trace event phases.
+typedef enum _btrace_type_t
+{
+	BTRACE_BEGIN = 'B',
+	BTRACE_END   = 'E',
+	BTRACE_MARK  = 'i',
+} btrace_type_t;
+
+typedef struct _btrace_evt_t
+{
+	u32  ts;
+	u8   type;
+	u8   stage;
+	u16  rsvd;
+	char name[BTRACE_NAME_LEN];
+} btrace_evt_t;
+
+typedef struct _btrace_t
+{
+	u32 magic;
+	u32 idx;
+	u32 cnt;
+	u32 enabled;
+	btrace_evt_t evt[BTRACE_MAX_EVENTS];
+} btrace_t;
+
+void btrace_init(btrace_stage_t stage, bool reset);
+void btrace_set_export(bool enable);
+void btrace_event(btrace_type_t type, const char *name, u32 ts);
+void btrace_begin(const char *name);
+void btrace_end(const char *name);
+void btrace_mark(const char *name);
+void btrace_end_open();
+int  btrace_save(const char *path);
+
+#endif
@@ -17,84 +17,195 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include "dirlist.h"
 #include <libs/fatfs/ff.h>
 #include <mem/heap.h>
 #include <utils/types.h>
 
-#define MAX_ENTRIES 64
+#define DIRLIST_POOL_SZ  SZ_4K
+#define DIRLIST_INDEX_SZ 64
 
-char *dirlist(const char *directory, const char *pattern, bool includeHiddenFiles, bool parse_dirs)
+typedef struct _dirlist_pool_t
 {
-	int res = 0;
-	u32 i = 0, j = 0, k = 0;
-	DIR dir;
-	FILINFO fno;
+	char *data;
+	u32  *offset;
+	u32   used;
+	u32   size;
+	u32   count;
+	u32   max;
+} dirlist_pool_t;
+
+static void *_dirlist_grow(void *buf, u32 used, u32 size)
+{
+	void *new_buf = malloc(size);
+	memcpy(new_buf, buf, used);
+	free(buf);
+
+	return new_buf;
+}
+
+static void _dirlist_add(dirlist_pool_t *pool, const char *name)
+{
+	u32 len = strlen(name) + 1;
 
-	char *dir_entries = (char *)zalloc(MAX_ENTRIES * 256);
-	char *temp = (char *)zalloc(256);
+	if (pool->used + len > pool->size)
+	{
+		pool->size = MAX(pool->size * 2, pool->used + len);
+		pool->data = _dirlist_grow(pool->data, pool->used, pool->size);
+	}
 
-	if (!pattern && !f_opendir(&dir, directory))
+	if (pool->count == pool->max)
 	{
-		for (;;)
+		pool->max *= 2;
+		pool->offset = _dirlist_grow(pool->offset, pool->count * sizeof(u32), pool->max * sizeof(u32));
+	}
+
+	memcpy(pool->data + pool->used, name, len);
+	pool->offset[pool->count++] = pool->used;
+	pool->used += len;
+}
+
+static inline bool _dirlist_is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static int _dirlist_cmp(const char *a, const char *b, bool natural)
+{
+	if (!natural)
+		return strcmp(a, b);
+
+	while (*a && *b)
+	{
+		if (_dirlist_is_digit(*a) && _dirlist_is_digit(*b))
 		{
-			res = f_readdir(&dir, &fno);
-			if (res || !fno.fname[0])
-				break;
-
-			bool curr_parse = parse_dirs ? (fno.fattrib & AM_DIR) : !(fno.fattrib & AM_DIR);
-
-			if (curr_parse)
-			{
-				if ((fno.fname[0] != '.') && (includeHiddenFiles || !(fno.fattrib & AM_HID)))
-				{
-					strcpy(dir_entries + (k * 256), fno.fname);
-					k++;
-					if (k > (MAX_ENTRIES - 1))
-						break;
-				}
-			}
+			// Skip leading zeros and compare digit runs by length first.
+			while (*a == '0')
+				a++;
+			while (*b == '0')
+				b++;
+
+			u32 len_a = 0;
+			u32 len_b = 0;
+			while (_dirlist_is_digit(a[len_a]))
+				len_a++;
+			while (_dirlist_is_digit(b[len_b]))
+				len_b++;
+
+			if (len_a != len_b)
+				return len_a < len_b ? -1 : 1;
+
+			int res = memcmp(a, b, len_a);
+			if (res)
+				return res;
+
+			a += len_a;
+			b += len_b;
+		}
+		else
+		{
+			if (*a != *b)
+				return (u8)*a - (u8)*b;
+			a++;
+			b++;
 		}
-		f_closedir(&dir);
 	}
-	else if (pattern && !f_findfirst(&dir, &fno, directory, pattern) && fno.fname[0])
+
+	return (u8)*a - (u8)*b;
+}
+
+static void _dirlist_sift(char **name, u32 root, u32 count, bool natural)
+{
+	for (;;)
 	{
-		do
-		{
-			if (!(fno.fattrib & AM_DIR) && (fno.fname[0] != '.') && (includeHiddenFiles || !(fno.fattrib & AM_HID)))
-			{
-				strcpy(dir_entries + (k * 256), fno.fname);
-				k++;
-				if (k > (MAX_ENTRIES - 1))
-					break;
-			}
-			res = f_findnext(&dir, &fno);
-		} while (fno.fname[0] && !res);
-		f_closedir(&dir);
+		u32 child = root * 2 + 1;
+		if (child >= count)
+			break;
+
+		if (child + 1 < count && _dirlist_cmp(name[child], name[child + 1], natural) < 0)
+			child++;
+
+		if (_dirlist_cmp(name[root], name[child], natural) >= 0)
+			break;
+
+		char *tmp = name[root];
+		name[root] = name[child];
+		name[child] = tmp;
+		root = child;
 	}
+}
+
+static void _dirlist_sort(char **name, u32 count, bool natural)
+{
+	// Heap sort. O(n log n) without extra memory.
+	for (u32 i = count / 2; i > 0; i--)
+		_dirlist_sift(name, i - 1, count, natural);
 
-	if (!k)
+	for (u32 end = count - 1; end > 0; end--)
 	{
-		free(temp);
-		free(dir_entries);
+		char *tmp = name[0];
+		name[0] = name[end];
+		name[end] = tmp;
+		_dirlist_sift(name, 0, end, natural);
+	}
+}
 
+dirlist_t *dirlist(const char *directory, const char *pattern, u32 flags)
+{
+	int res;
+	DIR dir;
+	FILINFO fno;
+
+	// Pattern matching lists only files.
+	bool parse_dirs = !pattern && (flags & DIR_SHOW_DIRS);
+
+	res = pattern ? f_findfirst(&dir, &fno, directory, pattern) : f_opendir(&dir, directory);
+	if (res)
 		return NULL;
-	}
 
-	// Reorder ini files by ASCII ordering.
-	for (i = 0; i < k - 1 ; i++)
+	if (!pattern)
+		res = f_readdir(&dir, &fno);
+
+	dirlist_pool_t pool;
+	pool.data   = (char *)malloc(DIRLIST_POOL_SZ);
+	pool.offset = (u32 *)malloc(DIRLIST_INDEX_SZ * sizeof(u32));
+	pool.used   = 0;
+	pool.size   = DIRLIST_POOL_SZ;
+	pool.count  = 0;
+	pool.max    = DIRLIST_INDEX_SZ;
+
+	// Stream entries into the string pool.
+	while (!res && fno.fname[0])
 	{
-		for (j = i + 1; j < k; j++)
-		{
-			if (strcmp(&dir_entries[i * 256], &dir_entries[j * 256]) > 0)
-			{
-				strcpy(temp, &dir_entries[i * 256]);
-				strcpy(&dir_entries[i * 256], &dir_entries[j * 256]);
-				strcpy(&dir_entries[j * 256], temp);
-			}
-		}
+		bool is_dir = !!(fno.fattrib & AM_DIR);
+		if (is_dir == parse_dirs && (fno.fname[0] != '.') && ((flags & DIR_SHOW_HIDDEN) || !(fno.fattrib & AM_HID)))
+			_dirlist_add(&pool, fno.fname);
+
+		res = pattern ? f_findnext(&dir, &fno) : f_readdir(&dir, &fno);
 	}
+	f_closedir(&dir);
+
+	dirlist_t *list = NULL;
+	if (!pool.count)
+		goto out;
+
+	// Pack list, index and names in one allocation.
+	u32 index_size = (pool.count + 1) * sizeof(char *);
+	list = (dirlist_t *)malloc(sizeof(dirlist_t) + index_size + pool.used);
+	list->name  = (char **)(list + 1);
+	list->count = pool.count;
+
+	char *names = (char *)list->name + index_size;
+	memcpy(names, pool.data, pool.used);
+	for (u32 i = 0; i < pool.count; i++)
+		list->name[i] = names + pool.offset[i];
+	list->name[pool.count] = NULL;
+
+	_dirlist_sort(list->name, list->count, flags & DIR_NATURAL_ORDER);
 
-	free(temp);
+out:
+	free(pool.data);
+	free(pool.offset);
 
-	return dir_entries;
+	return list;
 }
@@ -14,6 +14,22 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef _DIRLIST_H_
+#define _DIRLIST_H_
+
 #include <utils/types.h>
 
-char *dirlist(const char *directory, const char *pattern, bool includeHiddenFiles, bool parse_dirs);
+#define DIR_SHOW_HIDDEN   BIT(0) // Include hidden entries.
+#define DIR_SHOW_DIRS     BIT(1) // List folders instead of files. Ignored with a pattern.
+#define DIR_NATURAL_ORDER BIT(2) // Compare digit runs by value (2 < 10). Default is ASCII.
+
+typedef struct _dirlist_t
+{
+	char **name; // Sorted entry names. NULL terminated.
+	u32  count;
+} dirlist_t;
+
+// Returns a single allocation that gets released with free(). NULL if no entries.
+dirlist_t *dirlist(const char *directory, const char *pattern, u32 flags);
+
+#endif
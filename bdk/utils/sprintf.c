@@ -18,29 +18,95 @@
 #include <stdarg.h>
 #include <string.h>
 
+#include <utils/sprintf.h>
 #include <utils/types.h>
 
-char **sout_buf;
+#define S_PUTN_MAX 64 // Max number length with padding.
 
-static void _s_putc(char c)
+typedef struct _s_out_t
 {
-	**sout_buf = c;
-	*sout_buf += 1;
+	char *buf;
+	u32   left; // Chars that fit, without the terminator.
+} s_out_t;
+
+static const char _hex_digits[] = "0123456789ABCDEF";
+static const char _hex_digits_lc[] = "0123456789abcdef";
+
+// Two decimal digits per entry. Halves the divisions, which are a libcall on ARMv4.
+static const char _dec_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static void _s_put(s_out_t *out, const char *s, u32 len)
+{
+	if (len > out->left)
+		len = out->left;
+
+	memcpy(out->buf, s, len);
+	out->buf  += len;
+	out->left -= len;
 }
 
-static void _s_puts(char *s)
+static void _s_fill(s_out_t *out, char c, u32 len)
 {
-	for (; *s; s++)
-		_s_putc(*s);
+	if (len > out->left)
+		len = out->left;
+
+	memset(out->buf, c, len);
+	out->buf  += len;
+	out->left -= len;
 }
 
-static void _s_putn(u32 v, int base, char fill, int fcnt)
+// Writes digits backwards from end. Returns the first digit.
+static char *_s_utoa(char *end, u32 v, int base)
 {
-	static const char digits[] = "0123456789ABCDEF";
+	char *p = end;
+
+	if (base == 16)
+	{
+		do
+		{
+			*--p = _hex_digits[v & 0xF];
+			v >>= 4;
+		} while (v);
+
+		return p;
+	}
+
+	while (v >= 100)
+	{
+		u32 idx = (v % 100) * 2;
+		v /= 100;
+
+		p -= 2;
+		p[0] = _dec_pairs[idx];
+		p[1] = _dec_pairs[idx + 1];
+	}
 
-	char *p;
-	char buf[65]; // Number char size + leftover for padding.
-	int c = fcnt;
+	if (v >= 10)
+	{
+		p -= 2;
+		p[0] = _dec_pairs[v * 2];
+		p[1] = _dec_pairs[v * 2 + 1];
+	}
+	else
+		*--p = '0' + v;
+
+	return p;
+}
+
+static void _s_putn(s_out_t *out, u32 v, int base, char fill, int fcnt)
+{
+	char buf[11];
+	char *end = buf + sizeof(buf);
 	bool negative = false;
 
 	if (base != 10 && base != 16)
@@ -51,208 +117,179 @@ static void _s_putn(u32 v, int base, char fill, int fcnt)
 	{
 		negative = true;
 		v = (int)v * -1;
-		c--;
 	}
 
-	p = buf + 64;
-	*p = 0;
-	do
-	{
-		c--;
-		*--p = digits[v % base];
-		v /= base;
-	} while (v);
+	char *p = _s_utoa(end, v, base);
+	u32 len = (end - p) + negative;
 
-	if (negative)
-		*--p = '-';
+	// Padding goes before the sign.
+	if (fill != 0 && fcnt > (int)len)
+		_s_fill(out, fill, MIN((u32)fcnt, S_PUTN_MAX) - len);
 
-	if (fill != 0)
-	{
-		while (c > 0 && p > buf)
-		{
-			*--p = fill;
-			c--;
-		}
-	}
+	if (negative)
+		_s_put(out, "-", 1);
 
-	_s_puts(p);
+	_s_put(out, p, end - p);
 }
 
-void s_printf(char *out_buf, const char *fmt, ...)
+static u32 _s_vformat(char *out_buf, u32 size, const char *fmt, va_list ap)
 {
-	va_list ap;
+	s_out_t out;
 	int fill, fcnt;
 
-	sout_buf = &out_buf;
+	out.buf  = out_buf;
+	out.left = size - 1;
 
-	va_start(ap, fmt);
 	while (*fmt)
 	{
-		if (*fmt == '%')
+		// Copy plain text up to the next specifier at once.
+		const char *text = fmt;
+		while (*fmt && *fmt != '%')
+			fmt++;
+		if (fmt != text)
+			_s_put(&out, text, fmt - text);
+
+		if (!*fmt)
+			break;
+
+		fmt++;
+		fill = 0;
+		fcnt = 0;
+
+		// Check for padding. Number or space based.
+		if ((*fmt >= '0' && *fmt <= '9') || *fmt == ' ')
 		{
+			fcnt = *fmt; // Padding size or padding type.
 			fmt++;
-			fill = 0;
-			fcnt = 0;
 
-			// Check for padding. Number or space based.
-			if ((*fmt >= '0' && *fmt <= '9') || *fmt == ' ')
+			if (*fmt >= '0' && *fmt <= '9')
 			{
-				fcnt = *fmt; // Padding size or padding type.
+				// Padding size exists. Previous char was type.
+				fill = fcnt;
+				fcnt = *fmt - '0';
 				fmt++;
 
-				if (*fmt >= '0' && *fmt <= '9')
+				// Parse padding size extra digits.
+				while (*fmt >= '0' && *fmt <= '9')
 				{
-					// Padding size exists. Previous char was type.
-					fill = fcnt;
-					fcnt = *fmt - '0';
+					fcnt = fcnt * 10 + *fmt - '0';
 					fmt++;
-parse_padding_dec:
-					// Parse padding size extra digits.
-					if (*fmt >= '0' && *fmt <= '9')
-					{
-						fcnt = fcnt * 10 + *fmt - '0';
-						fmt++;
-						goto parse_padding_dec;
-					}
-				}
-				else
-				{
-					// No padding type, use space. (Max padding size is 9).
-					fill = ' ';
-					fcnt -= '0';
 				}
 			}
+			else
+			{
+				// No padding type, use space. (Max padding size is 9).
+				fill = ' ';
+				fcnt -= '0';
+			}
+		}
 
-			switch (*fmt)
+		switch (*fmt)
+		{
+		case 'c':
 			{
-			case 'c':
 				char c = va_arg(ap, u32);
 				if (c != '\0')
-					_s_putc(c);
-				break;
-
-			case 's':
-				_s_puts(va_arg(ap, char *));
-				break;
-
-			case 'd':
-				_s_putn(va_arg(ap, u32), 10, fill, fcnt);
-				break;
-
-			case 'p':
-			case 'P':
-			case 'x':
-			case 'X':
-				_s_putn(va_arg(ap, u32), 16, fill, fcnt);
-				break;
-
-			case '%':
-				_s_putc('%');
-				break;
-
-			case '\0':
-				goto out;
-
-			default:
-				_s_putc('%');
-				_s_putc(*fmt);
-				break;
+					_s_put(&out, &c, 1);
 			}
+			break;
+
+		case 's':
+			{
+				const char *s = va_arg(ap, char *);
+				_s_put(&out, s, strlen(s));
+			}
+			break;
+
+		case 'd':
+			_s_putn(&out, va_arg(ap, u32), 10, fill, fcnt);
+			break;
+
+		case 'p':
+		case 'P':
+		case 'x':
+		case 'X':
+			_s_putn(&out, va_arg(ap, u32), 16, fill, fcnt);
+			break;
+
+		case '%':
+			_s_put(&out, "%", 1);
+			break;
+
+		case '\0':
+			goto out;
+
+		default:
+			_s_put(&out, "%", 1);
+			_s_put(&out, fmt, 1);
+			break;
 		}
-		else
-			_s_putc(*fmt);
 		fmt++;
 	}
 
 out:
-	**sout_buf = '\0';
+	*out.buf = '\0';
+
+	return out.buf - out_buf;
+}
+
+void s_printf(char *out_buf, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	_s_vformat(out_buf, 0xFFFFFFFF, fmt, ap);
 	va_end(ap);
 }
 
 void s_vprintf(char *out_buf, const char *fmt, va_list ap)
 {
-	int fill, fcnt;
+	_s_vformat(out_buf, 0xFFFFFFFF, fmt, ap);
+}
 
-	sout_buf = &out_buf;
+int s_snprintf(char *out_buf, u32 size, const char *fmt, ...)
+{
+	va_list ap;
 
-	while (*fmt)
-	{
-		if (*fmt == '%')
-		{
-			fmt++;
-			fill = 0;
-			fcnt = 0;
+	if (!size)
+		return 0;
 
-			// Check for padding. Number or space based.
-			if ((*fmt >= '0' && *fmt <= '9') || *fmt == ' ')
-			{
-				fcnt = *fmt; // Padding size or padding type.
-				fmt++;
+	va_start(ap, fmt);
+	int len = _s_vformat(out_buf, size, fmt, ap);
+	va_end(ap);
 
-				if (*fmt >= '0' && *fmt <= '9')
-				{
-					// Padding size exists. Previous char was type.
-					fill = fcnt;
-					fcnt = *fmt - '0';
-					fmt++;
-parse_padding_dec:
-					// Parse padding size extra digits.
-					if (*fmt >= '0' && *fmt <= '9')
-					{
-						fcnt = fcnt * 10 + *fmt - '0';
-						fmt++;
-						goto parse_padding_dec;
-					}
-				}
-				else
-				{
-					// No padding type, use space. (Max padding size is 9).
-					fill = ' ';
-					fcnt -= '0';
-				}
-			}
+	return len;
+}
 
-			switch (*fmt)
-			{
-			case 'c':
-				char c = va_arg(ap, u32);
-				if (c != '\0')
-					_s_putc(c);
-				break;
-
-			case 's':
-				_s_puts(va_arg(ap, char *));
-				break;
-
-			case 'd':
-				_s_putn(va_arg(ap, u32), 10, fill, fcnt);
-				break;
-
-			case 'p':
-			case 'P':
-			case 'x':
-			case 'X':
-				_s_putn(va_arg(ap, u32), 16, fill, fcnt);
-				break;
-
-			case '%':
-				_s_putc('%');
-				break;
-
-			case '\0':
-				goto out;
-
-			default:
-				_s_putc('%');
-				_s_putc(*fmt);
-				break;
-			}
-		}
-		else
-			_s_putc(*fmt);
-		fmt++;
-	}
+int s_vsnprintf(char *out_buf, u32 size, const char *fmt, va_list ap)
+{
+	if (!size)
+		return 0;
 
-out:
-	**sout_buf = '\0';
+	return _s_vformat(out_buf, size, fmt, ap);
+}
+
+u32 s_putn(char *out_buf, u32 v, int base, char fill, int fcnt)
+{
+	s_out_t out;
+
+	out.buf  = out_buf;
+	out.left = S_PUTN_MAX;
+
+	_s_putn(&out, v, base, fill, fcnt);
+	*out.buf = '\0';
+
+	return out.buf - out_buf;
+}
+
+void s_hexstr(char *out_buf, const void *data, u32 size)
+{
+	const u8 *src = (const u8 *)data;
+
+	for (u32 i = 0; i < size; i++)
+	{
+		*out_buf++ = _hex_digits_lc[src[i] >> 4];
+		*out_buf++ = _hex_digits_lc[src[i] & 0xF];
+	}
+	*out_buf = '\0';
 }
@@ -23,5 +23,12 @@
 
 void s_printf(char *out_buf, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
 void s_vprintf(char *out_buf, const char *fmt, va_list ap);
+// Bounded variants. Output is always terminated. Returns the chars written.
+int  s_snprintf(char *out_buf, u32 size, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+int  s_vsnprintf(char *out_buf, u32 size, const char *fmt, va_list ap);
+// Formats a single number like %d/%X with padding. out_buf must fit 65 chars. Returns length.
+u32  s_putn(char *out_buf, u32 v, int base, char fill, int fcnt);
+// Lowercase hex of data. out_buf must fit size * 2 + 1 chars.
+void s_hexstr(char *out_buf, const void *data, u32 size);
 
 #endif
\ No newline at end of file
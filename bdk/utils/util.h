@@ -20,6 +20,7 @@
 
 #include <utils/types.h>
 #include <mem/minerva.h>
+#include <utils/btrace.h>
 
 #define CFG_SIZE(array) (sizeof(array) / sizeof(cfg_op_t))
 
@@ -75,7 +76,8 @@ typedef struct _nyx_storage_t
 	u32 cfg;
 	u8  irama[0x8000];
 	u8  hekate[0x30000];
-	u8  rsvd[SZ_8M - sizeof(nyx_info_t)];
+	btrace_t trace;
+	u8  rsvd[SZ_8M - sizeof(nyx_info_t) - sizeof(btrace_t)];
 	nyx_info_t info;
 	mtc_config_t mtc_cfg;
 	emc_table_t mtc_table[11]; // 10 + 1.
@@ -25,6 +25,9 @@ gfx_con_t gfx_con;
 
 static bool gfx_con_init_done = false;
 
+// Expanded font rows. Each byte value maps to 8 pixel masks, bit 0 being the leftmost.
+static u32 *_gfx_font_masks = NULL;
+
 static const u8 _gfx_font[] = {
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Char 032 ( )
 	0x00, 0x30, 0x30, 0x18, 0x18, 0x00, 0x0C, 0x00, // Char 033 (!)
@@ -147,8 +150,21 @@ void gfx_init_ctxt(u32 *fb, u32 width, u32 height, u32 stride)
 	gfx_ctxt.stride = stride;
 }
 
+static void _gfx_font_masks_init()
+{
+	if (_gfx_font_masks)
+		return;
+
+	_gfx_font_masks = (u32 *)malloc(256 * 8 * sizeof(u32));
+	for (u32 v = 0; v < 256; v++)
+		for (u32 j = 0; j < 8; j++)
+			_gfx_font_masks[v * 8 + j] = (v & BIT(j)) ? 0xFFFFFFFF : 0;
+}
+
 void gfx_con_init()
 {
+	_gfx_font_masks_init();
+
 	gfx_con.gfx_ctxt = &gfx_ctxt;
 	gfx_con.fntsz = 16;
 	gfx_con.x = 0;
@@ -184,6 +200,10 @@ void gfx_con_setpos(u32 x, u32 y)
 
 void gfx_putc(char c)
 {
+	u32 fgcol = gfx_con.fgcol;
+	u32 bgcol = gfx_con.bgcol;
+	u32 diff  = fgcol ^ bgcol;
+
 	// Duplicate code for performance reasons.
 	switch (gfx_con.fntsz)
 	{
@@ -193,34 +213,37 @@ void gfx_putc(char c)
 			u8 *cbuf = (u8 *)&_gfx_font[8 * (c - 32)];
 			u32 *fb = gfx_ctxt.fb + gfx_con.x + gfx_con.y * gfx_ctxt.stride;
 
-			for (u32 i = 0; i < 16; i += 2)
+			for (u32 i = 0; i < 8; i++)
 			{
-				u8 v = *cbuf;
-				for (u32 k = 0; k < 2; k++)
+				const u32 *mask = &_gfx_font_masks[*cbuf++ * 8];
+				u32 *fb2 = fb + gfx_ctxt.stride;
+
+				// Each font pixel is 2x2.
+				if (gfx_con.fillbg)
 				{
 					for (u32 j = 0; j < 8; j++)
 					{
-						if (v & 1)
-						{
-							*fb = gfx_con.fgcol;
-							fb++;
-							*fb = gfx_con.fgcol;
-						}
-						else if (gfx_con.fillbg)
+						u32 col = bgcol ^ (diff & mask[j]);
+						fb[2 * j]      = col;
+						fb[2 * j + 1]  = col;
+						fb2[2 * j]     = col;
+						fb2[2 * j + 1] = col;
+					}
+				}
+				else
+				{
+					for (u32 j = 0; j < 8; j++)
+					{
+						if (mask[j])
 						{
-							*fb = gfx_con.bgcol;
-							fb++;
-							*fb = gfx_con.bgcol;
+							fb[2 * j]      = fgcol;
+							fb[2 * j + 1]  = fgcol;
+							fb2[2 * j]     = fgcol;
+							fb2[2 * j + 1] = fgcol;
 						}
-						else
-							fb++;
-						v >>= 1;
-						fb++;
 					}
-					fb += gfx_ctxt.stride - 16;
-					v = *cbuf;
 				}
-				cbuf++;
+				fb += gfx_ctxt.stride * 2;
 			}
 			gfx_con.x += 16;
 		}
@@ -240,17 +263,19 @@ void gfx_putc(char c)
 			u32 *fb = gfx_ctxt.fb + gfx_con.x + gfx_con.y * gfx_ctxt.stride;
 			for (u32 i = 0; i < 8; i++)
 			{
-				u8 v = *cbuf++;
-				for (u32 j = 0; j < 8; j++)
+				const u32 *mask = &_gfx_font_masks[*cbuf++ * 8];
+				if (gfx_con.fillbg)
 				{
-					if (v & 1)
-						*fb = gfx_con.fgcol;
-					else if (gfx_con.fillbg)
-						*fb = gfx_con.bgcol;
-					v >>= 1;
-					fb++;
+					for (u32 j = 0; j < 8; j++)
+						fb[j] = bgcol ^ (diff & mask[j]);
 				}
-				fb += gfx_ctxt.stride - 8;
+				else
+				{
+					for (u32 j = 0; j < 8; j++)
+						if (mask[j])
+							fb[j] = fgcol;
+				}
+				fb += gfx_ctxt.stride;
 			}
 			gfx_con.x += 8;
 		}
@@ -276,46 +301,10 @@ void gfx_puts(const char *s)
 
 static void _gfx_putn(u32 v, int base, char fill, int fcnt)
 {
-	static const char digits[] = "0123456789ABCDEF";
-
-	char *p;
 	char buf[65];
-	int c = fcnt;
-	bool negative = false;
-
-	if (base != 10 && base != 16)
-		return;
-
-	// Account for negative numbers.
-	if (base == 10 && v & 0x80000000)
-	{
-		negative = true;
-		v = (int)v * -1;
-		c--;
-	}
-
-	p = buf + 64;
-	*p = 0;
-	do
-	{
-		c--;
-		*--p = digits[v % base];
-		v /= base;
-	} while (v);
-
-	if (negative)
-		*--p = '-';
-
-	if (fill != 0)
-	{
-		while (c > 0 && p > buf)
-		{
-			*--p = fill;
-			c--;
-		}
-	}
 
-	gfx_puts(p);
+	s_putn(buf, v, base, fill, fcnt);
+	gfx_puts(buf);
 }
 
 void gfx_put_small_sep()
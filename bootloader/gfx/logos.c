@@ -19,6 +19,7 @@
 #include <bdk.h>
 #include <libs/compr/blz.h>
 #include "logos.h"
+#include "../hos/hos_prefetch.h"
 
 // 68 x 192 @8bpp Grayscale RAW.
 #define BOOTLOGO_WIDTH    68
@@ -344,6 +345,17 @@ u8 *render_static_bootlogo()
 	return logo_buf;
 }
 
+static void _ticker_wait(u32 tick_end_us)
+{
+	// Prefetch boot files while waiting.
+	if ((int)(tick_end_us - get_tmr_us()) > 0)
+		hos_prefetch_step();
+
+	int remaining_us = tick_end_us - get_tmr_us();
+	if (remaining_us > 0)
+		usleep(remaining_us);
+}
+
 bool render_ticker_logo(u32 boot_wait, u32 backlight)
 {
 	u32 btn = 0;
@@ -362,6 +374,7 @@ bool render_ticker_logo(u32 boot_wait, u32 backlight)
 
 	// Enable backlight to show first frame.
 	display_backlight_brightness(backlight, 1000);
+	u32 ticker_start_us = get_tmr_us();
 
 	// Animated line as ticker.
 	for (u32 i = 1; i <= BOOTLOGO_HEIGHT; i++)
@@ -372,7 +385,7 @@ bool render_ticker_logo(u32 boot_wait, u32 backlight)
 			break;
 
 		// Wait before setting next tick.
-		usleep(ticker_step_us);
+		_ticker_wait(ticker_start_us + ticker_step_us * i);
 
 		// Set next ticker progress.
 		gfx_set_rect_grey(logo_buf + BOOTLOGO_WIDTH * (BOOTLOGO_HEIGHT - i) + 36, 6, 1, 362, BOOTLOGO_Y + BOOTLOGO_HEIGHT - i);
@@ -399,6 +412,7 @@ bool render_ticker(u32 boot_wait, u32 backlight, bool no_ticker)
 
 	// Enable backlight to show first frame.
 	display_backlight_brightness(backlight, 1000);
+	u32 ticker_start_us = get_tmr_us();
 
 	// Animated line as ticker.
 	for (u32 i = 1280; i >= 1; i--)
@@ -409,7 +423,7 @@ bool render_ticker(u32 boot_wait, u32 backlight, bool no_ticker)
 			break;
 
 		// Wait before setting next tick.
-		usleep(ticker_step_us);
+		_ticker_wait(ticker_start_us + ticker_step_us * (1281 - i));
 
 		// Set bottom lines ticker progress.
 		if (!no_ticker)
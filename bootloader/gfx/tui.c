@@ -19,6 +19,7 @@
 
 #include "tui.h"
 #include "../config.h"
+#include "../hos/hos_prefetch.h"
 
 extern hekate_config h_cfg;
 
@@ -84,18 +85,50 @@ void tui_pbar(int x, int y, u32 val, u32 fgcol, u32 bgcol)
 	tui_sbar(false);
 }
 
+static void _tui_draw_ment(menu_t *menu, int idx, bool selected)
+{
+	ment_t *ent = &menu->ents[idx];
+
+	// Entries start after the caption and an empty line.
+	gfx_con_setpos(0, menu->y + (idx + 2) * gfx_con.fntsz);
+
+	if (selected)
+		gfx_con_setcol(TXT_CLR_BG, 1, TXT_CLR_DEFAULT);
+	else
+		gfx_con_setcol(TXT_CLR_DEFAULT, 1, TXT_CLR_BG);
+
+	// Cut caption to one line, so entries keep their row. Leading and trailing space and menu dots excluded.
+	u32 len_max = gfx_ctxt.width / gfx_con.fntsz - 2;
+	if (ent->type == MENT_MENU)
+		len_max -= 3;
+
+	if (ent->type == MENT_CAPTION)
+		gfx_printf("%k ", ent->color);
+	else if (ent->type != MENT_CHGLINE)
+		gfx_putc(' ');
+	if (ent->type != MENT_CHGLINE)
+	{
+		for (u32 i = 0; i < len_max && ent->caption[i]; i++)
+			gfx_putc(ent->caption[i]);
+	}
+	if (ent->type == MENT_MENU)
+		gfx_printf("%k...", TXT_CLR_CYAN_L);
+	gfx_printf(" \n");
+}
+
 void *tui_do_menu(menu_t *menu)
 {
-	int idx = 0, prev_idx = 0, cnt = 0x7FFFFFFF;
+	int idx = 0, prev_idx = 0, cnt = 0;
+	int drawn_idx = 0;
+	bool redraw = true;
 
 	gfx_clear_partial_grey(0x1B, 0, 1256);
 	tui_sbar(true);
 
 	while (true)
 	{
-		gfx_con_setcol(TXT_CLR_DEFAULT, 1, TXT_CLR_BG);
-		gfx_con_setpos(menu->x, menu->y);
-		gfx_printf("[%s]\n\n", menu->caption);
+		for (cnt = 0; menu->ents[cnt].type != MENT_END; cnt++)
+			;
 
 		// Skip caption or seperator lines selection.
 		while (menu->ents[idx].type == MENT_CAPTION ||
@@ -122,34 +155,39 @@ void *tui_do_menu(menu_t *menu)
 		}
 		prev_idx = idx;
 
-		// Draw the menu.
-		for (cnt = 0; menu->ents[cnt].type != MENT_END; cnt++)
+		if (redraw)
 		{
-			if (cnt == idx)
-				gfx_con_setcol(TXT_CLR_BG, 1, TXT_CLR_DEFAULT);
-			else
-				gfx_con_setcol(TXT_CLR_DEFAULT, 1, TXT_CLR_BG);
-			if (menu->ents[cnt].type == MENT_CAPTION)
-				gfx_printf("%k %s", menu->ents[cnt].color, menu->ents[cnt].caption);
-			else if (menu->ents[cnt].type != MENT_CHGLINE)
-				gfx_printf(" %s", menu->ents[cnt].caption);
-			if (menu->ents[cnt].type == MENT_MENU)
-				gfx_printf("%k...", TXT_CLR_CYAN_L);
-			gfx_printf(" \n");
+			// Draw the menu.
+			gfx_con_setcol(TXT_CLR_DEFAULT, 1, TXT_CLR_BG);
+			gfx_con_setpos(menu->x, menu->y);
+			gfx_printf("[%s]\n\n", menu->caption);
+
+			for (int i = 0; i < cnt; i++)
+				_tui_draw_ment(menu, i, i == idx);
+			gfx_con_setcol(TXT_CLR_DEFAULT, 1, TXT_CLR_BG);
+			gfx_putc('\n');
+
+			// Print errors and help.
+			gfx_con_setpos(0,  1127);
+			gfx_printf("%k Warning: %kNyx is missing!", TXT_CLR_RED_D, TXT_CLR_GREY_M);
+			gfx_con_setpos(0,  1191);
+			gfx_printf("%k VOL: Move up/down\n PWR: Select option%k", TXT_CLR_GREY_M, TXT_CLR_DEFAULT);
+
+			redraw = false;
 		}
-		gfx_con_setcol(TXT_CLR_DEFAULT, 1, TXT_CLR_BG);
-		gfx_putc('\n');
-
-		// Print errors, help and battery status.
-		gfx_con_setpos(0,  1127);
-		gfx_printf("%k Warning: %kNyx is missing!", TXT_CLR_RED_D, TXT_CLR_GREY_M);
-		gfx_con_setpos(0,  1191);
-		gfx_printf("%k VOL: Move up/down\n PWR: Select option%k", TXT_CLR_GREY_M, TXT_CLR_DEFAULT);
+		else if (drawn_idx != idx)
+		{
+			// Only redraw the previously and newly selected entries.
+			_tui_draw_ment(menu, drawn_idx, false);
+			_tui_draw_ment(menu, idx, true);
+			gfx_con_setcol(TXT_CLR_DEFAULT, 1, TXT_CLR_BG);
+		}
+		drawn_idx = idx;
 
 		display_backlight_brightness(h_cfg.backlight, 1000);
 
-		// Wait for user command.
-		u32 btn = btn_wait();
+		// Wait for user command. Prefetch boot files meanwhile.
+		u32 btn = btn_wait_idle(hos_prefetch_step);
 
 		if (btn & BTN_VOL_DOWN && idx < (cnt - 1))
 			idx++;
@@ -192,6 +230,7 @@ void *tui_do_menu(menu_t *menu)
 			}
 			gfx_con.fntsz = 16;
 			gfx_clear_partial_grey(0x1B, 0, 1256);
+			redraw = true;
 		}
 		tui_sbar(false);
 	}
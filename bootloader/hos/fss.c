@@ -22,6 +22,7 @@
 
 #include "fss.h"
 #include "hos.h"
+#include "hos_prefetch.h"
 #include "../config.h"
 #include <libs/fatfs/ff.h>
 #include "../storage/emummc.h"
@@ -38,6 +39,9 @@ extern bool is_ipl_updated(void *buf, char *path, bool force);
 #define FSS0_META_OFFSET 0x4
 #define FSS0_VERSION_0_17_0 0x110000
 
+// Max unused gap to read through, instead of seeking.
+#define FSS0_READ_GAP_MAX SZ_64K
+
 // FSS0 Content Types.
 #define CNT_TYPE_FSP 0
 #define CNT_TYPE_EXO 1  // Exosphere (Secure Monitor).
@@ -91,9 +95,21 @@ static void _fss_update_r2p()
 	free(r2p_payload);
 }
 
+static void _fss_read_range(FIL *fp, void *fss, u32 start, u32 end)
+{
+	// Skip if already loaded.
+	if (!fp || end <= start)
+		return;
+
+	if (f_tell(fp) != start)
+		f_lseek(fp, start);
+	f_read(fp, fss + start, end - start, NULL);
+}
+
 int parse_fss(launch_ctxt_t *ctxt, const char *path)
 {
 	FIL fp;
+	FIL *fss_fp = &fp;
 
 	bool stock = false;
 	bool experimental = false;
@@ -121,14 +137,22 @@ int parse_fss(launch_ctxt_t *ctxt, const char *path)
 		return 1;
 #endif
 
-	// Try to open FSS0.
-	if (f_open(&fp, path, FA_READ) != FR_OK)
-		return 0;
+	// Use prefetched FSS0 if valid.
+	u32 fss_size;
+	void *fss = hos_prefetch_get_fss0(path, &fss_size);
+	if (fss)
+		fss_fp = NULL;
+	else
+	{
+		// Try to open FSS0.
+		if (f_open(&fp, path, FA_READ) != FR_OK)
+			return 0;
 
-	void *fss = malloc(f_size(&fp));
+		fss = malloc(f_size(&fp));
 
-	// Read first 1024 bytes of the FSS0 file.
-	f_read(&fp, fss, 1024, NULL);
+		// Read first 1024 bytes of the FSS0 file.
+		f_read(&fp, fss, 1024, NULL);
+	}
 
 	// Get FSS0 Meta header offset.
 	u32 fss_meta_addr = *(u32 *)(fss + FSS0_META_OFFSET);
@@ -149,6 +173,8 @@ int parse_fss(launch_ctxt_t *ctxt, const char *path)
 		// Parse FSS0 contents.
 		fss_content_t *curr_fss_cnt = (fss_content_t *)(fss + fss_meta->cnt_off);
 		void *content;
+		u32 rd_start = 0;
+		u32 rd_end = 0;
 		for (u32 i = 0; i < fss_meta->cnt_count; i++)
 		{
 			content = (void *)(fss + curr_fss_cnt[i].offset);
@@ -201,13 +227,27 @@ int parse_fss(launch_ctxt_t *ctxt, const char *path)
 				continue;
 			}
 
-			// Load content to launch context.
-			f_lseek(&fp, curr_fss_cnt[i].offset);
-			f_read(&fp, content, curr_fss_cnt[i].size, NULL);
+			// Merge with previous contents if close enough. Contents are stored back to back.
+			u32 cnt_start = curr_fss_cnt[i].offset;
+			u32 cnt_end   = cnt_start + curr_fss_cnt[i].size;
+			if (rd_end && cnt_start >= rd_start && cnt_start <= (rd_end + FSS0_READ_GAP_MAX))
+			{
+				rd_end = MAX(rd_end, cnt_end);
+				continue;
+			}
+
+			// Load previous contents to launch context.
+			_fss_read_range(fss_fp, fss, rd_start, rd_end);
+			rd_start = cnt_start;
+			rd_end   = cnt_end;
 		}
 
+		// Load remaining contents to launch context.
+		_fss_read_range(fss_fp, fss, rd_start, rd_end);
+
 		gfx_printf("Done!\n");
-		f_close(&fp);
+		if (fss_fp)
+			f_close(fss_fp);
 
 		ctxt->fss0 = fss;
 
@@ -217,7 +257,8 @@ int parse_fss(launch_ctxt_t *ctxt, const char *path)
 		return 1;
 	}
 
-	f_close(&fp);
+	if (fss_fp)
+		f_close(fss_fp);
 	free(fss);
 
 	return 0;
@@ -24,6 +24,8 @@
 
 #include "hos.h"
 #include "hos_config.h"
+#include "hos_prefetch.h"
+#include "pkg2_cache.h"
 #include "secmon_exo.h"
 #include "../frontend/fe_tools.h"
 #include "../config.h"
@@ -600,12 +602,19 @@ static int _read_emmc_pkg1(launch_ctxt_t *ctxt)
 {
 	const u32 pk1_offset = h_cfg.t210b01 ? sizeof(bl_hdr_t210b01_t) : 0; // Skip T210B01 OEM header.
 	u32 bootloader_offset = PKG1_BOOTLOADER_MAIN_OFFSET;
-	ctxt->pkg1 = (void *)malloc(PKG1_BOOTLOADER_SIZE);
+
+	// Use prefetched package1 if valid.
+	ctxt->pkg1 = hos_prefetch_get_pkg1();
+	bool pkg1_prefetched = ctxt->pkg1 != NULL;
+	if (!pkg1_prefetched)
+		ctxt->pkg1 = (void *)malloc(PKG1_BOOTLOADER_SIZE);
 
 try_load:
 	// Read package1.
 	emummc_storage_set_mmc_partition(EMMC_BOOT0);
-	emummc_storage_read(bootloader_offset / EMMC_BLOCKSIZE, PKG1_BOOTLOADER_SIZE / EMMC_BLOCKSIZE, ctxt->pkg1);
+	if (!pkg1_prefetched)
+		emummc_storage_read(bootloader_offset / EMMC_BLOCKSIZE, PKG1_BOOTLOADER_SIZE / EMMC_BLOCKSIZE, ctxt->pkg1);
+	pkg1_prefetched = false;
 
 	ctxt->pkg1_id = pkg1_identify(ctxt->pkg1 + pk1_offset);
 	if (!ctxt->pkg1_id)
@@ -656,7 +665,7 @@ try_load:
 	return 1;
 }
 
-static u8 *_read_emmc_pkg2(launch_ctxt_t *ctxt)
+u8 *hos_read_emmc_pkg2(launch_ctxt_t *ctxt)
 {
 	u8 *bctBuf = NULL;
 
@@ -758,6 +767,8 @@ int hos_launch(ini_sec_t *cfg)
 	tsec_ctxt_t tsec_ctxt = {0};
 	volatile secmon_mailbox_t *secmon_mailbox;
 
+	btrace_begin("hos_launch");
+
 	minerva_change_freq(FREQ_1600);
 	list_init(&ctxt.kip1_list);
 
@@ -770,6 +781,7 @@ int hos_launch(ini_sec_t *cfg)
 	gfx_puts("Initializing...\n\n");
 
 	// Initialize eMMC/emuMMC.
+	btrace_begin("emummc_init");
 	int res = emummc_storage_init_mmc();
 	if (res)
 	{
@@ -780,6 +792,7 @@ int hos_launch(ini_sec_t *cfg)
 
 		goto error;
 	}
+	btrace_end("emummc_init");
 
 	// Check if SD Card is GPT.
 	if (sd_is_gpt())
@@ -789,13 +802,16 @@ int hos_launch(ini_sec_t *cfg)
 	}
 
 	// Try to parse config if present.
+	btrace_begin("hos_config");
 	if (ctxt.cfg && !parse_boot_config(&ctxt))
 	{
 		_hos_crit_error("Wrong ini cfg or missing/corrupt files!");
 		goto error;
 	}
+	btrace_end("hos_config");
 
 	// Read package1 and the correct keyblob.
+	btrace_begin("pkg1_read");
 	if (!_read_emmc_pkg1(&ctxt))
 	{
 		// Check if stock is enabled and device can boot in OFW.
@@ -810,6 +826,7 @@ int hos_launch(ini_sec_t *cfg)
 		}
 		goto error;
 	}
+	btrace_end("pkg1_read");
 
 	kb = ctxt.pkg1_id->kb;
 
@@ -876,13 +893,17 @@ int hos_launch(ini_sec_t *cfg)
 	tsec_ctxt.pkg11_off = ctxt.pkg1_id->pkg11_off;
 
 	// Generate keys.
+	btrace_begin("hos_keygen");
 	if (!hos_keygen(ctxt.keyblob, kb, &tsec_ctxt, ctxt.stock, is_exo))
 		goto error;
 	gfx_puts("Generated keys\n");
+	btrace_end("hos_keygen");
 
 	// Decrypt and unpack package1 if we require parts of it.
 	if (!ctxt.warmboot || !ctxt.secmon)
 	{
+		btrace_begin("pkg1_unpack");
+
 		// Decrypt PK1 or PK11.
 		if (kb <= HOS_KB_VERSION_600 || h_cfg.t210b01)
 		{
@@ -917,6 +938,7 @@ int hos_launch(ini_sec_t *cfg)
 				ctxt.pkg1_id, ctxt.pkg1 + pk1_offset);
 
 			gfx_puts("Decrypted & unpacked pkg1\n");
+			btrace_end("pkg1_unpack");
 		}
 		else
 		{
@@ -962,16 +984,40 @@ int hos_launch(ini_sec_t *cfg)
 	gfx_puts("Loaded warmboot and secmon\n");
 
 	// Read package2.
-	u8 *bootConfigBuf = _read_emmc_pkg2(&ctxt);
+	btrace_begin("pkg2_read");
+	u8 *bootConfigBuf = hos_prefetch_get_pkg2(&ctxt);
+	if (!bootConfigBuf)
+		bootConfigBuf = hos_read_emmc_pkg2(&ctxt);
+	hos_prefetch_end();
 	if (!bootConfigBuf)
 	{
 		_hos_crit_error("Pkg2 read failed!");
 		goto error;
 	}
+	btrace_end("pkg2_read");
 
 	gfx_puts("Read pkg2\n");
 
+	LIST_INIT(kip1_info);
+
+	// Use cached patched kernel and kips if all inputs match.
+	u8 pkg2_cache_key[SE_SHA_256_SIZE];
+	if (ctxt.pkg2_cache)
+	{
+		btrace_begin("pkg2_cache_load");
+		pkg2_cache_get_key(pkg2_cache_key, &ctxt, is_exo);
+		bool pkg2_cached = pkg2_cache_load(&ctxt, &kip1_info, pkg2_cache_key, is_exo);
+		btrace_end("pkg2_cache_load");
+
+		if (pkg2_cached)
+		{
+			gfx_puts("Loaded cached pkg2\n");
+			goto pkg2_build;
+		}
+	}
+
 	// Decrypt package2 and parse KIP1 blobs in INI1 section.
+	btrace_begin("pkg2_decrypt");
 	pkg2_hdr_t *pkg2_hdr = pkg2_decrypt(ctxt.pkg2, kb, is_exo);
 	if (!pkg2_hdr)
 	{
@@ -981,17 +1027,20 @@ int hos_launch(ini_sec_t *cfg)
 		hos_eks_clear(kb);
 		goto error;
 	}
+	btrace_end("pkg2_decrypt");
 
-	LIST_INIT(kip1_info);
+	btrace_begin("kip1_parse");
 	if (!pkg2_parse_kips(&kip1_info, pkg2_hdr, &ctxt.new_pkg2))
 	{
 		_hos_crit_error("INI1 parsing failed!");
 		goto error;
 	}
+	btrace_end("kip1_parse");
 
 	gfx_puts("Parsed ini1\n");
 
 	// Use the kernel included in package2 in case we didn't load one already.
+	btrace_begin("kernel_patch");
 	if (!ctxt.kernel)
 	{
 		ctxt.kernel = pkg2_hdr->data;
@@ -1040,14 +1089,18 @@ int hos_launch(ini_sec_t *cfg)
 		}
 	}
 
+	btrace_end("kernel_patch");
+
 	// Merge extra KIP1s into loaded ones.
+	btrace_begin("kip1_patch");
 	LIST_FOREACH_ENTRY(merge_kip_t, mki, &ctxt.kip1_list, link)
 		pkg2_merge_kip(&kip1_info, (pkg2_kip1_t *)mki->kip1);
 
 	// Check if FS is compatible with exFAT and if 5.1.0.
+	bool exfat_compat = true;
 	if (!ctxt.stock && (sd_fs.fs_type == FS_EXFAT || kb == HOS_KB_VERSION_500 || ctxt.pkg1_id->fuses == 13))
 	{
-		bool exfat_compat = _get_fs_exfat_compatible(&kip1_info, &ctxt.exo_ctx.hos_revision);
+		exfat_compat = _get_fs_exfat_compatible(&kip1_info, &ctxt.exo_ctx.hos_revision);
 
 		if (sd_fs.fs_type == FS_EXFAT && !exfat_compat)
 		{
@@ -1074,13 +1127,30 @@ int hos_launch(ini_sec_t *cfg)
 			goto error; // MUST stop here, because if user requests 'nogc' but it's not applied, their GC controller gets updated!
 	}
 
+	btrace_end("kip1_patch");
+
+	// Save patched kernel and kips. Only if all patches were applied.
+	if (ctxt.pkg2_cache && !failed_patch)
+	{
+		btrace_begin("pkg2_cache_save");
+		pkg2_cache_save(&ctxt, &kip1_info, pkg2_cache_key, exfat_compat);
+		btrace_end("pkg2_cache_save");
+	}
+
+pkg2_build:
 	// Rebuild and encrypt package2.
+	btrace_begin("pkg2_build");
 	pkg2_build_encrypt((void *)PKG2_LOAD_ADDR, &ctxt, &kip1_info, is_exo);
+	btrace_end("pkg2_build");
 
 	// Configure Exosphere if secmon is replaced.
 	if (is_exo)
 		config_exosphere(&ctxt, warmboot_base);
 
+	// Save boot trace if enabled.
+	btrace_end("hos_launch");
+	btrace_save(BTRACE_FILE_PATH);
+
 	// Unmount SD card and eMMC.
 	sd_end();
 	emmc_end();
@@ -1188,7 +1258,12 @@ int hos_launch(ini_sec_t *cfg)
 		bpmp_halt();
 
 error:
+	// Close the failed phase and hos_launch spans and save boot trace.
+	btrace_end_open();
+	btrace_save(BTRACE_FILE_PATH);
+
 	_free_launch_components(&ctxt);
+	hos_prefetch_end();
 	emmc_end();
 
 	EPRINTF("\nFailed to launch HOS!");
@@ -109,6 +109,7 @@ typedef struct _launch_ctxt_t
 	bool debugmode;
 	bool stock;
 	bool emummc_forced;
+	bool pkg2_cache;
 
 	void *fss0;
 	u32   fss0_hosver;
@@ -129,6 +130,7 @@ typedef struct _merge_kip_t
 
 void hos_eks_clear(u32 kb);
 int  hos_launch(ini_sec_t *cfg);
+u8  *hos_read_emmc_pkg2(launch_ctxt_t *ctxt);
 int  hos_keygen(void *keyblob, u32 kb, tsec_ctxt_t *tsec_ctxt, bool stock, bool is_exo);
 
 #endif
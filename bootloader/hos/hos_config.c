@@ -65,7 +65,7 @@ static int _config_kip1(launch_ctxt_t *ctxt, const char *value)
 
 		u32 dirlen = 0;
 		dir[strlen(dir) - 2] = 0;
-		char *filelist = dirlist(dir, "*.kip*", false, false);
+		dirlist_t *filelist = dirlist(dir, "*.kip*", 0);
 
 		strcat(dir, "/");
 		dirlen = strlen(dir);
@@ -75,10 +75,10 @@ static int _config_kip1(launch_ctxt_t *ctxt, const char *value)
 		{
 			while (true)
 			{
-				if (!filelist[i * 256])
+				if (!filelist->name[i])
 					break;
 
-				strcpy(dir + dirlen, &filelist[i * 256]);
+				strcpy(dir + dirlen, filelist->name[i]);
 
 				merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
 				mkip1->kip1 = sd_file_read(dir, &size);
@@ -178,6 +178,16 @@ static int _config_stock(launch_ctxt_t *ctxt, const char *value)
 	return 1;
 }
 
+static int _config_pkg2_cache(launch_ctxt_t *ctxt, const char *value)
+{
+	if (*value == '1')
+	{
+		DPRINTF("Enabled pkg2 cache\n");
+		ctxt->pkg2_cache = true;
+	}
+	return 1;
+}
+
 static int _config_emummc_forced(launch_ctxt_t *ctxt, const char *value)
 {
 	if (*value == '1')
@@ -305,6 +315,7 @@ static const cfg_handler_t _config_handlers[] = {
 	{ "cal0blank",        _config_exo_cal0_blanking },
 	{ "cal0writesys",     _config_exo_cal0_writes_enable },
 	{ "ucid",             _config_ucid },
+	{ "pkg2cache",        _config_pkg2_cache },
 	{ NULL, NULL },
 };
 
@@ -0,0 +1,308 @@
+/*
+ * HOS boot files prefetcher
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <bdk.h>
+
+#include "hos.h"
+#include "hos_prefetch.h"
+#include "../config.h"
+#include <libs/fatfs/ff.h>
+#include "../storage/emummc.h"
+
+//#define DPRINTF(...) gfx_printf(__VA_ARGS__)
+#define DPRINTF(...)
+
+extern hekate_config h_cfg;
+
+typedef enum _prefetch_state_t
+{
+	PREFETCH_IDLE = 0,
+	PREFETCH_PKG1 = 1,
+	PREFETCH_PKG2 = 2,
+	PREFETCH_FSS0 = 3,
+	PREFETCH_DONE = 4
+} prefetch_state_t;
+
+typedef struct _prefetch_blob_t
+{
+	void *buf;
+	u32   size;
+	u8    hash[SE_SHA_256_SIZE];
+} prefetch_blob_t;
+
+typedef struct _hos_prefetch_t
+{
+	u32   state;
+	u8    storage_id[SE_SHA_256_SIZE];
+	char *fss0_path;
+	u32   fss0_time;
+	prefetch_blob_t pkg1;
+	prefetch_blob_t bct;
+	prefetch_blob_t pkg2;
+	prefetch_blob_t fss0;
+} hos_prefetch_t;
+
+static hos_prefetch_t prefetch = { 0 };
+
+static void _prefetch_get_storage_id(u8 *id)
+{
+	struct _prefetch_storage_t
+	{
+		u64  sector;
+		u32  enabled;
+		char path[128];
+	} storage;
+
+	// Identify eMMC or emuMMC that blobs are read from.
+	memset(&storage, 0, sizeof(storage));
+	storage.enabled = emu_cfg.enabled && !h_cfg.emummc_force_disable;
+	if (storage.enabled)
+	{
+		storage.sector = emu_cfg.sector;
+		if (emu_cfg.path)
+			strncpy(storage.path, emu_cfg.path, sizeof(storage.path) - 1);
+	}
+
+	se_calc_sha256_oneshot(id, &storage, sizeof(storage));
+}
+
+static bool _prefetch_storage_valid()
+{
+	u8 storage_id[SE_SHA_256_SIZE];
+
+	_prefetch_get_storage_id(storage_id);
+
+	return !memcmp(storage_id, prefetch.storage_id, SE_SHA_256_SIZE);
+}
+
+static bool _prefetch_storage_init()
+{
+	// Storage might have been deinitialized from a menu action.
+	if (emmc_storage.initialized)
+		return true;
+
+	return !emummc_storage_init_mmc();
+}
+
+static void _prefetch_blob_set(prefetch_blob_t *blob, void *buf, u32 size)
+{
+	blob->buf  = buf;
+	blob->size = size;
+	se_calc_sha256_oneshot(blob->hash, buf, size);
+}
+
+static void *_prefetch_blob_get(prefetch_blob_t *blob)
+{
+	u8 hash[SE_SHA_256_SIZE];
+	void *buf = blob->buf;
+
+	// Ownership goes to the caller.
+	blob->buf = NULL;
+	if (!buf)
+		return NULL;
+
+	// Validate that the staged copy is intact.
+	se_calc_sha256_oneshot(hash, buf, blob->size);
+	if (memcmp(hash, blob->hash, SE_SHA_256_SIZE))
+	{
+		free(buf);
+		return NULL;
+	}
+
+	return buf;
+}
+
+static void _prefetch_blob_free(prefetch_blob_t *blob)
+{
+	free(blob->buf);
+	blob->buf = NULL;
+}
+
+void hos_prefetch_start(ini_sec_t *cfg)
+{
+	hos_prefetch_end();
+
+	if (!cfg)
+		return;
+
+	// Get the FSS0 path of the entry.
+	LIST_FOREACH_ENTRY(ini_kv_t, kv, &cfg->kvs, link)
+	{
+		if (!strcmp("fss0", kv->key))
+		{
+			free(prefetch.fss0_path);
+			prefetch.fss0_path = (char *)malloc(strlen(kv->val) + 1);
+			strcpy(prefetch.fss0_path, kv->val);
+		}
+	}
+
+	_prefetch_get_storage_id(prefetch.storage_id);
+
+	prefetch.state = PREFETCH_PKG1;
+}
+
+bool hos_prefetch_step()
+{
+	FILINFO fno;
+
+	if (prefetch.state == PREFETCH_IDLE || prefetch.state == PREFETCH_DONE)
+		return false;
+
+	// Do not print storage errors over the menu.
+	bool mute = gfx_con.mute;
+	gfx_con.mute = true;
+
+	switch (prefetch.state)
+	{
+	case PREFETCH_PKG1:
+		if (!_prefetch_storage_init())
+		{
+			// Skip eMMC/emuMMC blobs.
+			prefetch.state = PREFETCH_FSS0;
+			break;
+		}
+
+		void *pkg1 = malloc(PKG1_BOOTLOADER_SIZE);
+		emummc_storage_set_mmc_partition(EMMC_BOOT0);
+		if (emummc_storage_read(PKG1_BOOTLOADER_MAIN_OFFSET / EMMC_BLOCKSIZE, PKG1_BOOTLOADER_SIZE / EMMC_BLOCKSIZE, pkg1))
+			_prefetch_blob_set(&prefetch.pkg1, pkg1, PKG1_BOOTLOADER_SIZE);
+		else
+			free(pkg1);
+DPRINTF("Prefetched pkg1\n");
+
+		prefetch.state = PREFETCH_PKG2;
+		break;
+
+	case PREFETCH_PKG2:
+		if (_prefetch_storage_init())
+		{
+			launch_ctxt_t *ctxt = (launch_ctxt_t *)zalloc(sizeof(launch_ctxt_t));
+			u8 *bct = hos_read_emmc_pkg2(ctxt);
+			if (bct && ctxt->pkg2)
+			{
+				_prefetch_blob_set(&prefetch.bct, bct, SZ_16K);
+				_prefetch_blob_set(&prefetch.pkg2, ctxt->pkg2, ctxt->pkg2_size);
+			}
+			else
+			{
+				free(bct);
+				free(ctxt->pkg2);
+			}
+			free(ctxt);
+DPRINTF("Prefetched pkg2\n");
+
+			// eMMC gets initialized again on launch.
+			emmc_end();
+		}
+
+		prefetch.state = PREFETCH_FSS0;
+		break;
+
+	case PREFETCH_FSS0:
+		if (prefetch.fss0_path && !f_stat(prefetch.fss0_path, &fno))
+		{
+			u32 size;
+			void *fss0 = sd_file_read(prefetch.fss0_path, &size);
+			if (fss0)
+			{
+				_prefetch_blob_set(&prefetch.fss0, fss0, size);
+				prefetch.fss0_time = (fno.fdate << 16) | fno.ftime;
+			}
+DPRINTF("Prefetched fss0\n");
+		}
+
+		prefetch.state = PREFETCH_DONE;
+		break;
+	}
+
+	gfx_con.mute = mute;
+
+	return true;
+}
+
+void hos_prefetch_end()
+{
+	_prefetch_blob_free(&prefetch.pkg1);
+	_prefetch_blob_free(&prefetch.bct);
+	_prefetch_blob_free(&prefetch.pkg2);
+	_prefetch_blob_free(&prefetch.fss0);
+
+	free(prefetch.fss0_path);
+	prefetch.fss0_path = NULL;
+
+	prefetch.state = PREFETCH_IDLE;
+}
+
+void *hos_prefetch_get_pkg1()
+{
+	if (!_prefetch_storage_valid())
+	{
+		_prefetch_blob_free(&prefetch.pkg1);
+		return NULL;
+	}
+
+	return _prefetch_blob_get(&prefetch.pkg1);
+}
+
+u8 *hos_prefetch_get_pkg2(launch_ctxt_t *ctxt)
+{
+	if (!_prefetch_storage_valid())
+	{
+		_prefetch_blob_free(&prefetch.bct);
+		_prefetch_blob_free(&prefetch.pkg2);
+		return NULL;
+	}
+
+	u32 pkg2_size = prefetch.pkg2.size;
+	u8 *bct   = _prefetch_blob_get(&prefetch.bct);
+	void *pkg2 = _prefetch_blob_get(&prefetch.pkg2);
+	if (!bct || !pkg2)
+	{
+		free(bct);
+		free(pkg2);
+		return NULL;
+	}
+
+	ctxt->pkg2 = pkg2;
+	ctxt->pkg2_size = pkg2_size;
+
+	return bct;
+}
+
+void *hos_prefetch_get_fss0(const char *path, u32 *size)
+{
+	FILINFO fno;
+
+	if (!prefetch.fss0.buf)
+		return NULL;
+
+	// Check that the file is the same and was not modified.
+	if (!prefetch.fss0_path || strcmp(path, prefetch.fss0_path) ||
+		f_stat(path, &fno) || fno.fsize != prefetch.fss0.size ||
+		(u32)((fno.fdate << 16) | fno.ftime) != prefetch.fss0_time)
+	{
+		_prefetch_blob_free(&prefetch.fss0);
+		return NULL;
+	}
+
+	*size = prefetch.fss0.size;
+
+	return _prefetch_blob_get(&prefetch.fss0);
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOS_PREFETCH_H_
+#define _HOS_PREFETCH_H_
+
+#include "hos.h"
+
+void  hos_prefetch_start(ini_sec_t *cfg);
+bool  hos_prefetch_step();
+void  hos_prefetch_end();
+void *hos_prefetch_get_pkg1();
+u8   *hos_prefetch_get_pkg2(launch_ctxt_t *ctxt);
+void *hos_prefetch_get_fss0(const char *path, u32 *size);
+
+#endif
@@ -180,7 +180,7 @@ const pkg2_kernel_id_t *pkg2_identify(u8 *hash)
 	return NULL;
 }
 
-static u32 _pkg2_calc_kip1_size(pkg2_kip1_t *kip1)
+u32 pkg2_calc_kip1_size(pkg2_kip1_t *kip1)
 {
 	u32 size = sizeof(pkg2_kip1_t);
 	for (u32 j = 0; j < KIP1_NUM_SECTIONS; j++)
@@ -259,7 +259,7 @@ bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2)
 		pkg2_kip1_t *kip1 = (pkg2_kip1_t *)ptr;
 		pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)malloc(sizeof(pkg2_kip1_info_t));
 		ki->kip1 = kip1;
-		ki->size = _pkg2_calc_kip1_size(kip1);
+		ki->size = pkg2_calc_kip1_size(kip1);
 		list_append(info, &ki->link);
 		ptr += ki->size;
 DPRINTF(" kip1 %d:%s @ %08X (%08X)\n", i, kip1->name, (u32)kip1, ki->size);
@@ -283,7 +283,7 @@ void pkg2_replace_kip(link_t *info, u64 tid, pkg2_kip1_t *kip1)
 		if (ki->kip1->tid == tid)
 		{
 			ki->kip1 = kip1;
-			ki->size = _pkg2_calc_kip1_size(kip1);
+			ki->size = pkg2_calc_kip1_size(kip1);
 DPRINTF("replaced kip %s (new size %08X)\n", kip1->name, ki->size);
 			return;
 		}
@@ -294,7 +294,7 @@ void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1)
 {
 	pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)malloc(sizeof(pkg2_kip1_info_t));
 	ki->kip1 = kip1;
-	ki->size = _pkg2_calc_kip1_size(kip1);
+	ki->size = pkg2_calc_kip1_size(kip1);
 DPRINTF("added kip %s (size %08X)\n", kip1->name, ki->size);
 	list_append(info, &ki->link);
 }
@@ -694,18 +694,8 @@ static const u8 mkey_vector_7xx[SE_KEY_128_SIZE] =
 	{ 0xEA, 0x60, 0xB3, 0xEA, 0xCE, 0x8F, 0x24, 0x46, 0x7D, 0x33, 0x9C, 0xD1, 0xBC, 0x24, 0x98, 0x29 };
 
 u8 pkg2_keyslot;
-pkg2_hdr_t *pkg2_decrypt(void *data, u8 kb, bool is_exo)
+void pkg2_set_keyslot(u8 kb, bool is_exo)
 {
-	u8 *pdata = (u8 *)data;
-
-	// Skip signature.
-	pdata += 0x100;
-
-	pkg2_hdr_t *hdr = (pkg2_hdr_t *)pdata;
-
-	// Skip header.
-	pdata += sizeof(pkg2_hdr_t);
-
 	// Set pkg2 key slot to default. If 7.0.0 it will change to 9.
 	pkg2_keyslot = 8;
 
@@ -723,6 +713,21 @@ pkg2_hdr_t *pkg2_decrypt(void *data, u8 kb, bool is_exo)
 
 		pkg2_keyslot = 9;
 	}
+}
+
+pkg2_hdr_t *pkg2_decrypt(void *data, u8 kb, bool is_exo)
+{
+	u8 *pdata = (u8 *)data;
+
+	// Skip signature.
+	pdata += 0x100;
+
+	pkg2_hdr_t *hdr = (pkg2_hdr_t *)pdata;
+
+	// Skip header.
+	pdata += sizeof(pkg2_hdr_t);
+
+	pkg2_set_keyslot(kb, is_exo);
 
 	// Decrypt header.
 	se_aes_crypt_ctr(pkg2_keyslot, hdr, sizeof(pkg2_hdr_t), hdr, sizeof(pkg2_hdr_t), hdr);
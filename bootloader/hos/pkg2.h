@@ -150,6 +150,7 @@ typedef struct _kip1_id_t
 	kip1_patchset_t *patchset;
 } kip1_id_t;
 
+u32  pkg2_calc_kip1_size(pkg2_kip1_t *kip1);
 void pkg2_get_newkern_info(u8 *kern_data);
 bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2);
 int  pkg2_has_kip(link_t *info, u64 tid);
@@ -160,6 +161,7 @@ void pkg2_get_ids(kip1_id_t **ids, u32 *entries);
 const char *pkg2_patch_kips(link_t *info, char *patch_names);
 
 const pkg2_kernel_id_t *pkg2_identify(u8 *hash);
+void pkg2_set_keyslot(u8 kb, bool is_exo);
 pkg2_hdr_t *pkg2_decrypt(void *data, u8 kb, bool is_exo);
 void pkg2_build_encrypt(void *dst, void *hos_ctxt, link_t *kips_info, bool is_exo);
 
@@ -0,0 +1,321 @@
+/*
+ * Package2 launch cache
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <bdk.h>
+
+#include "hos.h"
+#include "pkg2.h"
+#include "pkg2_cache.h"
+
+#include "../config.h"
+#include "../storage/emummc.h"
+#include <libs/fatfs/ff.h>
+
+//#define DPRINTF(...) gfx_printf(__VA_ARGS__)
+#define DPRINTF(...)
+
+// Cached blobs get invalidated on any hekate update, since patches are built-in.
+#define PKG2_CACHE_FORMAT  1
+#define PKG2_CACHE_VERSION ((PKG2_CACHE_FORMAT << 24) | (BL_VER_MJ << 16) | (BL_VER_MN << 8) | BL_VER_HF)
+
+extern hekate_config h_cfg;
+
+typedef struct _pkg2_cache_cfg_t
+{
+	u32 version;
+	u8  kb;
+	u8  is_exo;
+	u8  t210b01;
+	u8  fs_type;
+	u8  svcperm;
+	u8  debugmode;
+	u8  stock;
+	u8  atmosphere;
+} pkg2_cache_cfg_t;
+
+static void _pkg2_cache_get_path(char *path, const void *key)
+{
+	const u8 *k = (const u8 *)key;
+	static const char hex[] = "0123456789ABCDEF";
+
+	strcpy(path, PKG2_CACHE_DIR "/pkg2_");
+	char *pos = path + strlen(path);
+	for (u32 i = 0; i < 4; i++)
+	{
+		*pos++ = hex[k[i] >> 4];
+		*pos++ = hex[k[i] & 0xF];
+	}
+	strcpy(pos, ".bin");
+}
+
+static void _pkg2_cache_hash_file(u8 *hash, const char *path)
+{
+	u32 size;
+	void *buf = sd_file_read(path, &size);
+	if (buf)
+	{
+		se_calc_sha256_oneshot(hash, buf, size);
+		free(buf);
+	}
+}
+
+static bool _pkg2_cache_emummc_enabled()
+{
+	return emu_cfg.enabled && !h_cfg.emummc_force_disable;
+}
+
+// Returns kip size if it fits in the remaining payload, 0 otherwise.
+static u32 _pkg2_cache_kip_size(const u8 *ptr, u32 left)
+{
+	if (left < sizeof(pkg2_kip1_t))
+		return 0;
+
+	// Sum in 64-bit so corrupt section sizes can't wrap around.
+	const pkg2_kip1_t *kip1 = (const pkg2_kip1_t *)ptr;
+	u64 size = sizeof(pkg2_kip1_t);
+	for (u32 i = 0; i < KIP1_NUM_SECTIONS; i++)
+		size += kip1->sections[i].size_comp;
+
+	if (size > left)
+		return 0;
+
+	return size;
+}
+
+void pkg2_cache_get_key(void *key, launch_ctxt_t *ctxt, bool is_exo)
+{
+	u32 kip_cnt = 0;
+	LIST_FOREACH_ENTRY(merge_kip_t, mki, &ctxt->kip1_list, link)
+		kip_cnt++;
+
+	// Config, pkg2, kernel, patch list, patches.ini, emuMMC kipm and extra kips.
+	u32 buf_size = sizeof(pkg2_cache_cfg_t) + (5 + kip_cnt) * SE_SHA_256_SIZE;
+	u8 *buf = (u8 *)zalloc(buf_size);
+
+	pkg2_cache_cfg_t *cfg = (pkg2_cache_cfg_t *)buf;
+	cfg->version    = PKG2_CACHE_VERSION;
+	cfg->kb         = ctxt->pkg1_id->kb;
+	cfg->is_exo     = is_exo;
+	cfg->t210b01    = h_cfg.t210b01;
+	cfg->fs_type    = sd_fs.fs_type;
+	cfg->svcperm    = ctxt->svcperm;
+	cfg->debugmode  = ctxt->debugmode;
+	cfg->stock      = ctxt->stock;
+	cfg->atmosphere = ctxt->atmosphere;
+
+	u8 *hash = buf + sizeof(pkg2_cache_cfg_t);
+
+	// Encrypted package2 as read from eMMC.
+	se_calc_sha256_oneshot(hash, ctxt->pkg2, ctxt->pkg2_size);
+	hash += SE_SHA_256_SIZE;
+
+	// Kernel replacement.
+	if (ctxt->kernel)
+		se_calc_sha256_oneshot(hash, ctxt->kernel, ctxt->kernel_size);
+	hash += SE_SHA_256_SIZE;
+
+	// Requested kip patches.
+	if (ctxt->kip1_patches)
+		se_calc_sha256_oneshot(hash, ctxt->kip1_patches, strlen(ctxt->kip1_patches));
+	hash += SE_SHA_256_SIZE;
+
+	// External kip patches.
+	_pkg2_cache_hash_file(hash, "bootloader/patches.ini");
+	hash += SE_SHA_256_SIZE;
+
+	// emuMMC FS patches.
+	_pkg2_cache_hash_file(hash, "bootloader/sys/emummc.kipm");
+	hash += SE_SHA_256_SIZE;
+
+	// Extra kips.
+	LIST_FOREACH_ENTRY(merge_kip_t, mki, &ctxt->kip1_list, link)
+	{
+		se_calc_sha256_oneshot(hash, mki->kip1, pkg2_calc_kip1_size((pkg2_kip1_t *)mki->kip1));
+		hash += SE_SHA_256_SIZE;
+	}
+
+	se_calc_sha256_oneshot(key, buf, buf_size);
+
+	free(buf);
+}
+
+bool pkg2_cache_load(launch_ctxt_t *ctxt, link_t *kips_info, const void *key, bool is_exo)
+{
+	char path[64];
+	u32 size = 0;
+	u8 hash[SE_SHA_256_SIZE];
+
+	_pkg2_cache_get_path(path, key);
+
+	u8 *buf = sd_file_read(path, &size);
+	if (!buf)
+		return false;
+
+	pkg2_cache_hdr_t *hdr = (pkg2_cache_hdr_t *)buf;
+	u8 *payload = buf + sizeof(pkg2_cache_hdr_t);
+
+	// Validate header and inputs.
+	if (size < sizeof(pkg2_cache_hdr_t) ||
+		hdr->magic != PKG2_CACHE_MAGIC ||
+		hdr->version != PKG2_CACHE_VERSION ||
+		hdr->size != (size - sizeof(pkg2_cache_hdr_t)) ||
+		hdr->kernel_size > hdr->size ||
+		ALIGN(hdr->kernel_size, 0x10) > hdr->size ||
+		memcmp(hdr->key, key, SE_SHA_256_SIZE))
+		goto error;
+
+	// FS must have had emuMMC injected if it's enabled.
+	bool emummc_enabled = _pkg2_cache_emummc_enabled();
+	if (emummc_enabled != !!(hdr->flags & PKG2_CACHE_FLAG_EMUMMC))
+		goto error;
+
+	// Let the normal path report an exFAT incompatible FS.
+	if (sd_fs.fs_type == FS_EXFAT && !(hdr->flags & PKG2_CACHE_FLAG_EXFAT))
+		goto error;
+
+	// Validate payload.
+	se_calc_sha256_oneshot(hash, payload, hdr->size);
+	if (memcmp(hdr->hash, hash, SE_SHA_256_SIZE))
+		goto error;
+
+	// Validate that all kips fit in the payload.
+	u8 *kips = payload + ALIGN(hdr->kernel_size, 0x10);
+	u8 *end  = payload + hdr->size;
+	u8 *ptr  = kips;
+	for (u32 i = 0; i < hdr->kip_num; i++)
+	{
+		u32 kip_size = _pkg2_cache_kip_size(ptr, end - ptr);
+		if (!kip_size)
+			goto error;
+
+		ptr += kip_size;
+	}
+	if (ptr != end)
+		goto error;
+
+	// Set patched kernel.
+	ctxt->kernel      = payload;
+	ctxt->kernel_size = hdr->kernel_size;
+	ctxt->new_pkg2    = hdr->new_pkg2;
+	ctxt->exo_ctx.hos_revision = hdr->hos_revision;
+
+	pkg2_newkern_ini1_info  = hdr->ini1_info;
+	pkg2_newkern_ini1_start = hdr->ini1_start;
+	pkg2_newkern_ini1_end   = hdr->ini1_end;
+
+	// Restore the FS ID that kip patching sets.
+	if (emummc_enabled)
+		emu_cfg.fs_ver = hdr->emummc_fs_ver;
+
+	// Set patched kips.
+	ptr = kips;
+	for (u32 i = 0; i < hdr->kip_num; i++)
+	{
+		pkg2_kip1_t *kip1 = (pkg2_kip1_t *)ptr;
+		pkg2_add_kip(kips_info, kip1);
+		ptr += pkg2_calc_kip1_size(kip1);
+	}
+
+	// Package2 was not decrypted, so set its keyslot here.
+	pkg2_set_keyslot(ctxt->pkg1_id->kb, is_exo);
+
+DPRINTF("pkg2 cache hit: %s\n", path);
+
+	return true;
+
+error:
+	free(buf);
+
+	return false;
+}
+
+void pkg2_cache_save(launch_ctxt_t *ctxt, link_t *kips_info, const void *key, bool exfat_compat)
+{
+	char path[64];
+	u32 kip_num = 0;
+	u32 kips_size = 0;
+
+	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, kips_info, link)
+	{
+		kip_num++;
+		kips_size += ki->size;
+	}
+
+	u32 kernel_size = ALIGN(ctxt->kernel_size, 0x10);
+	u32 payload_size = kernel_size + kips_size;
+	u8 *buf = (u8 *)zalloc(sizeof(pkg2_cache_hdr_t) + payload_size);
+
+	pkg2_cache_hdr_t *hdr = (pkg2_cache_hdr_t *)buf;
+	u8 *payload = buf + sizeof(pkg2_cache_hdr_t);
+
+	// Serialize kernel and kips.
+	memcpy(payload, ctxt->kernel, ctxt->kernel_size);
+	u8 *ptr = payload + kernel_size;
+	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, kips_info, link)
+	{
+		memcpy(ptr, ki->kip1, ki->size);
+		ptr += ki->size;
+	}
+
+	hdr->magic        = PKG2_CACHE_MAGIC;
+	hdr->version      = PKG2_CACHE_VERSION;
+	hdr->size         = payload_size;
+	hdr->kernel_size  = ctxt->kernel_size;
+	hdr->kip_num      = kip_num;
+	hdr->new_pkg2     = ctxt->new_pkg2;
+	hdr->ini1_info    = pkg2_newkern_ini1_info;
+	hdr->ini1_start   = pkg2_newkern_ini1_start;
+	hdr->ini1_end     = pkg2_newkern_ini1_end;
+	hdr->hos_revision = ctxt->exo_ctx.hos_revision;
+	if (exfat_compat)
+		hdr->flags |= PKG2_CACHE_FLAG_EXFAT;
+	if (_pkg2_cache_emummc_enabled())
+	{
+		hdr->flags |= PKG2_CACHE_FLAG_EMUMMC;
+		hdr->emummc_fs_ver = emu_cfg.fs_ver;
+	}
+	memcpy(hdr->key, key, SE_SHA_256_SIZE);
+	se_calc_sha256_oneshot(hdr->hash, payload, payload_size);
+
+	// Keep cache size in check. Remove all old entries if limit is reached.
+	f_mkdir(PKG2_CACHE_DIR);
+	dirlist_t *filelist = dirlist(PKG2_CACHE_DIR, "pkg2_*.bin", 0);
+	if (filelist)
+	{
+		if (filelist->count >= PKG2_CACHE_MAX_CNT)
+		{
+			for (u32 i = 0; i < filelist->count; i++)
+			{
+				strcpy(path, PKG2_CACHE_DIR "/");
+				strcat(path, filelist->name[i]);
+				f_unlink(path);
+			}
+		}
+
+		free(filelist);
+	}
+
+	_pkg2_cache_get_path(path, key);
+	sd_save_to_file(buf, sizeof(pkg2_cache_hdr_t) + payload_size, path);
+
+DPRINTF("pkg2 cache saved: %s\n", path);
+
+	free(buf);
+}
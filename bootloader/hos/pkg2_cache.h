@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PKG2_CACHE_H_
+#define _PKG2_CACHE_H_
+
+#include "hos.h"
+
+#define PKG2_CACHE_MAGIC   0x43324B50 // "PK2C".
+#define PKG2_CACHE_DIR     "bootloader/cache"
+#define PKG2_CACHE_MAX_CNT 4
+
+#define PKG2_CACHE_FLAG_EMUMMC BIT(0) // emuMMC code was injected in FS.
+#define PKG2_CACHE_FLAG_EXFAT  BIT(1) // FS supports exFAT.
+
+typedef struct _pkg2_cache_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u8  key[SE_SHA_256_SIZE];  // Hash of all inputs.
+	u8  hash[SE_SHA_256_SIZE]; // Hash of payload.
+	u32 size;                  // Payload size.
+	u32 kernel_size;
+	u32 kip_num;
+	u32 new_pkg2;
+	u32 ini1_info;
+	u32 ini1_start;
+	u32 ini1_end;
+	u32 hos_revision;
+	u32 flags;
+	u32 emummc_fs_ver;         // emuMMC FS ID for exosphere.
+	u32 rsvd[2];
+} pkg2_cache_hdr_t;
+
+void pkg2_cache_get_key(void *key, launch_ctxt_t *ctxt, bool is_exo);
+bool pkg2_cache_load(launch_ctxt_t *ctxt, link_t *kips_info, const void *key, bool is_exo);
+void pkg2_cache_save(launch_ctxt_t *ctxt, link_t *kips_info, const void *key, bool exfat_compat);
+
+#endif
@@ -249,6 +249,7 @@ typedef struct _l4t_fw_t
 {
 	u32   addr;
 	char *name;
+	char *error;
 } l4t_fw_t;
 
 typedef struct _l4t_ctxt_t
@@ -281,14 +282,14 @@ static const u8 mtc_table_idx_t210b01[] = {
 };
 
 static const l4t_fw_t l4t_fw[] = {
-	{ TZDRAM_BASE,               "bl31.bin"        },
-	{ BL33_LOAD_BASE,            "bl33.bin"        },
-	{ SC7ENTRY_BASE,             "sc7entry.bin"    },
-	{ SC7EXIT_BASE,              "sc7exit.bin"     },
-	{ SC7EXIT_B01_BASE,          "sc7exit_b01.bin" },
-	{ BPMPFW_BASE,               "bpmpfw.bin"      },
-	{ BPMPFW_B01_BASE,           "bpmpfw_b01.bin"  },
-	{ BPMPFW_B01_MTC_TABLE_BASE, "mtc_tbl_b01.bin" },
+	{ TZDRAM_BASE,               "bl31.bin",        "BL31 missing"         },
+	{ BL33_LOAD_BASE,            "bl33.bin",        "BL33 missing"         },
+	{ SC7ENTRY_BASE,             "sc7entry.bin",    "loading SC7-Entry"    },
+	{ SC7EXIT_BASE,              "sc7exit.bin",     "loading SC7-Exit"     },
+	{ SC7EXIT_B01_BASE,          "sc7exit_b01.bin", "loading SC7-Exit"     },
+	{ BPMPFW_BASE,               "bpmpfw.bin",      "loading BPMP-FW"      },
+	{ BPMPFW_B01_BASE,           "bpmpfw_b01.bin",  "loading BPMP-FW"      },
+	{ BPMPFW_B01_MTC_TABLE_BASE, "mtc_tbl_b01.bin", "loading BPMP-FW MTC"  },
 };
 
 enum {
@@ -302,6 +303,10 @@ enum {
 	BPMPFW_B01_MTC_TBL = 7
 };
 
+// Bootloader firmware goes first. They are small and most likely to be outdated.
+static const u8 l4t_fw_t210[]    = { SC7ENTRY_FW, BPMPFW_FW, SC7EXIT_FW, BL31_FW, BL33_FW };
+static const u8 l4t_fw_t210b01[] = { BPMPFW_B01_FW, BPMPFW_B01_MTC_TBL, SC7EXIT_B01_FW, BL31_FW, BL33_FW };
+
 static void _l4t_crit_error(const char *text, bool needs_update)
 {
 	gfx_con.mute = false;
@@ -309,26 +314,33 @@ static void _l4t_crit_error(const char *text, bool needs_update)
 		TXT_CLR_ERROR, text, needs_update ? "\nUpdate bootloader folder!\n\n" : "\n\n", TXT_CLR_DEFAULT);
 }
 
-char *sd_path;
-u32 sd_path_len;
-static int _l4t_sd_load(u32 idx)
+static int _l4t_sd_load(const char *path, u32 idx)
 {
 	FIL fp;
+	char sd_path[512];
 	void *load_address = (void *)l4t_fw[idx].addr;
 
 	if (idx == SC7EXIT_B01_FW)
 		load_address -= sizeof(u32);
 
-	strcpy(sd_path + sd_path_len, l4t_fw[idx].name);
+	// Bootloader firmware is in sys folder.
+	strcpy(sd_path, idx >= SC7ENTRY_FW ? "bootloader/sys/l4t/" : path);
+	strcat(sd_path, l4t_fw[idx].name);
 
 	if (f_open(&fp, sd_path, FA_READ) != FR_OK)
 		return 0;
 
+	// Read whole file straight to its load address.
+	btrace_begin(l4t_fw[idx].name);
 	u32 size = f_size(&fp);
 	if (f_read(&fp, load_address, size, NULL) != FR_OK)
 		size = 0;
 
 	f_close(&fp);
+	btrace_end(l4t_fw[idx].name);
+
+	if (size < sizeof(u32))
+		return 0;
 
 	u32 rev = *(u32 *)(load_address + size - sizeof(u32));
 	if (idx >= SC7ENTRY_FW && rev != L4T_FIRMWARE_REV)
@@ -337,6 +349,28 @@ static int _l4t_sd_load(u32 idx)
 	return size;
 }
 
+static bool _l4t_load_firmware(l4t_ctxt_t *ctxt, bool t210b01)
+{
+	const u8 *fw_list = !t210b01 ? l4t_fw_t210 : l4t_fw_t210b01;
+	u32 fw_cnt = !t210b01 ? ARRAY_SIZE(l4t_fw_t210) : ARRAY_SIZE(l4t_fw_t210b01);
+
+	for (u32 i = 0; i < fw_cnt; i++)
+	{
+		u32 idx = fw_list[i];
+		u32 size = _l4t_sd_load(ctxt->path, idx);
+		if (!size)
+		{
+			_l4t_crit_error(l4t_fw[idx].error, idx >= SC7ENTRY_FW);
+			return false;
+		}
+
+		if (idx == SC7ENTRY_FW)
+			ctxt->sc7entry_size = size;
+	}
+
+	return true;
+}
+
 static void _l4t_sdram_lp0_save_params(bool t210b01)
 {
 	struct tegra_pmc_regs *pmc = (struct tegra_pmc_regs *)PMC_BASE;
@@ -914,11 +948,6 @@ static void _l4t_set_config(l4t_ctxt_t *ctxt, const ini_sec_t *ini_sec, int entr
 
 	// Enable BL33 memory env import.
 	*(u32 *)(BL33_ENV_MAGIC_OFFSET) = BL33_ENV_MAGIC;
-
-	// Set boot path.
-	sd_path = (char *)malloc(512);
-	sd_path_len = strlen(ctxt->path);
-	strcpy(sd_path, ctxt->path);
 }
 
 void launch_l4t(const ini_sec_t *ini_sec, int entry_idx, int is_list, bool t210b01)
@@ -928,6 +957,8 @@ void launch_l4t(const ini_sec_t *ini_sec, int entry_idx, int is_list, bool t210b
 	plat_params_from_bl2_t plat_params = {0};
 	entry_point_info_t bl33_ep_info    = {0};
 
+	btrace_begin("l4t_launch");
+
 	gfx_con_setpos(0, 0);
 
 	// Parse config.
@@ -936,7 +967,7 @@ void launch_l4t(const ini_sec_t *ini_sec, int entry_idx, int is_list, bool t210b
 	if (!ctxt.path)
 	{
 		_l4t_crit_error("Path missing", false);
-		return;
+		goto error;
 	}
 
 	// Get MTC table.
@@ -944,71 +975,20 @@ void launch_l4t(const ini_sec_t *ini_sec, int entry_idx, int is_list, bool t210b
 	if (!t210b01 && !ctxt.mtc_table)
 	{
 		_l4t_crit_error("Minerva missing", true);
-		return;
+		goto error;
 	}
 
-	// Load BL31 (ATF/TrustZone fw).
-	if (!_l4t_sd_load(BL31_FW))
-	{
-		_l4t_crit_error("BL31 missing", false);
-		return;
-	}
-
-	// Load BL33 (U-BOOT/CBOOT).
-	if (!_l4t_sd_load(BL33_FW))
-	{
-		_l4t_crit_error("BL33 missing", false);
-		return;
-	}
-
-	// Set firmware path.
-	strcpy(sd_path, "bootloader/sys/l4t/");
-	sd_path_len = strlen(sd_path);
-
-	if (!t210b01)
-	{
-		// Load SC7-Entry firmware.
-		ctxt.sc7entry_size = _l4t_sd_load(SC7ENTRY_FW);
-		if (!ctxt.sc7entry_size)
-		{
-			_l4t_crit_error("loading SC7-Entry", true);
-			return;
-		}
-
-		// Load BPMP-FW. Does power management.
-		if (!_l4t_sd_load(BPMPFW_FW))
-		{
-			_l4t_crit_error("loading BPMP-FW", true);
-			return;
-		}
-	}
-	else
-	{
-		// Load BPMP-FW. Manages SC7-Entry also.
-		if (!_l4t_sd_load(BPMPFW_B01_FW))
-		{
-			_l4t_crit_error("loading BPMP-FW", true);
-			return;
-		}
-
-		// Load BPMP-FW MTC table.
-		if (!_l4t_sd_load(BPMPFW_B01_MTC_TBL))
-		{
-			_l4t_crit_error("loading BPMP-FW MTC", true);
-			return;
-		}
-	}
-
-	// Load SC7-Exit firmware.
-	if (!_l4t_sd_load(!t210b01 ? SC7EXIT_FW : SC7EXIT_B01_FW))
-	{
-		_l4t_crit_error("loading SC7-Exit", true);
-		return;
-	}
+	// Load SC7-Entry, BPMP-FW, SC7-Exit, BL31 (ATF/TrustZone fw) and BL33 (U-BOOT/CBOOT).
+	if (!_l4t_load_firmware(&ctxt, t210b01))
+		goto error;
 
 	// Set SC7-Exit firmware address to PMC for bootrom and do further setup.
 	if (!_l4t_sc7_exit_config(t210b01))
-		return;
+		goto error;
+
+	// Save boot trace if enabled.
+	btrace_end("l4t_launch");
+	btrace_save(BTRACE_FILE_PATH);
 
 	// Done loading bootloaders/firmware.
 	sd_end();
@@ -1180,4 +1160,9 @@ void launch_l4t(const ini_sec_t *ini_sec, int entry_idx, int is_list, bool t210b
 	// Halt BPMP.
 	while (true)
 		bpmp_halt();
+
+error:
+	// Close the failed phase and l4t_launch spans and save boot trace.
+	btrace_end_open();
+	btrace_save(BTRACE_FILE_PATH);
 }
@@ -240,6 +240,27 @@
 / System Configurations
 /---------------------------------------------------------------------------*/
 
+#define FF_USE_MCACHE		1
+#define FF_MCACHE_VOLUMES	0x01
+#define FF_MCACHE_LINES		64
+#define FF_MCACHE_WAYS		4
+#define FF_MCACHE_LINE_SS	8
+/* FF_USE_MCACHE switches the metadata cache. (0:Disable or 1:Enable)
+/  FAT, directory and exFAT bitmap sectors get cached in lines of FF_MCACHE_LINE_SS
+/  sectors (max 8), read ahead on a miss and written back on sync. FF_MCACHE_VOLUMES
+/  is a bitmap of the physical drives that use it. The cache is allocated on mount
+/  with ff_memalloc() and takes FF_MCACHE_LINES * FF_MCACHE_LINE_SS * FF_MAX_SS bytes. */
+
+#define FF_USE_DIRINDEX		0
+#define FF_DIRINDEX_VOLUMES	0x00
+#define FF_DIRINDEX_DIRS	4
+#define FF_DIRINDEX_MIN		64
+/* FF_USE_DIRINDEX switches the directory name hash index. (0:Disable or 1:Enable)
+/  A directory gets indexed on its first lookup and later lookups only check the
+/  objects with a matching name hash. Up to FF_DIRINDEX_DIRS directories with at
+/  least FF_DIRINDEX_MIN objects are kept indexed, on the physical drives set in the
+/  FF_DIRINDEX_VOLUMES bitmap. Each object takes up to 64 bytes from ff_memalloc(). */
+
 #define FF_FS_TINY		0
 /* This option switches tiny buffer configuration. (0:Normal or 1:Tiny)
 /  At the tiny configuration, size of file object (FIL) is shrinked FF_MAX_SS bytes.
@@ -25,6 +25,7 @@
 #include "gfx/logos.h"
 #include "gfx/tui.h"
 #include "hos/hos.h"
+#include "hos/hos_prefetch.h"
 #include "hos/secmon_exo.h"
 #include "l4t/l4t.h"
 #include <ianos/ianos.h>
@@ -292,7 +293,7 @@ out:
 static void _launch_payloads()
 {
 	u8 max_entries = 61;
-	char *filelist = NULL;
+	dirlist_t *filelist = NULL;
 	char *file_sec = NULL;
 	char *dir = NULL;
 
@@ -310,7 +311,7 @@ static void _launch_payloads()
 	dir = (char *)malloc(256);
 	memcpy(dir, "bootloader/payloads", 20);
 
-	filelist = dirlist(dir, NULL, false, false);
+	filelist = dirlist(dir, NULL, DIR_NATURAL_ORDER);
 
 	u32 i = 0;
 
@@ -324,11 +325,11 @@ static void _launch_payloads()
 
 		while (true)
 		{
-			if (i > max_entries || !filelist[i * 256])
+			if (i > max_entries || !filelist->name[i])
 				break;
 			ments[i + 2].type    = INI_CHOICE;
-			ments[i + 2].caption = &filelist[i * 256];
-			ments[i + 2].data    = &filelist[i * 256];
+			ments[i + 2].caption = filelist->name[i];
+			ments[i + 2].data    = filelist->name[i];
 
 			i++;
 		}
@@ -647,7 +648,9 @@ out:
 
 static void _nyx_load_run()
 {
+	btrace_begin("nyx_load");
 	u8 *nyx = sd_file_read("bootloader/sys/nyx.bin", NULL);
+	btrace_end("nyx_load");
 	if (!nyx)
 		return;
 
@@ -709,6 +712,8 @@ static void _nyx_load_run()
 	// Some cards (Sandisk U1), do not like a fast power cycle.
 	sdmmc_storage_init_wait_sd();
 
+	btrace_mark("nyx_jump");
+
 	void (*nyx_ptr)() = (void *)nyx;
 	(*nyx_ptr)();
 }
@@ -809,7 +814,10 @@ static void _auto_launch()
 	emummc_load_cfg();
 
 	// Parse hekate main configuration.
-	if (!ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false))
+	btrace_begin("ini_parse");
+	bool ini_parsed = ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false);
+	btrace_end("ini_parse");
+	if (!ini_parsed)
 		goto out; // Can't load hekate_ipl.ini.
 
 	// Load configuration.
@@ -841,6 +849,8 @@ static void _auto_launch()
 						h_cfg.updater2p   = atoi(kv->val);
 					else if (!strcmp("bootprotect",   kv->key))
 						h_cfg.bootprotect = atoi(kv->val);
+					else if (!strcmp("boottrace",     kv->key))
+						h_cfg.boottrace   = atoi(kv->val);
 				}
 				boot_entry_id++;
 
@@ -884,6 +894,9 @@ static void _auto_launch()
 		}
 	}
 
+	// Enable boot trace saving if requested.
+	btrace_set_export(h_cfg.boottrace);
+
 	if (h_cfg.autohosoff && !(b_cfg.boot_cfg & BOOT_CFG_AUTOBOOT_EN))
 		check_power_off_from_hos();
 
@@ -938,6 +951,10 @@ skip_list:
 	// Check if entry is payload or l4t special case.
 	char *special_path = ini_check_special_section(cfg_sec);
 
+	// Prefetch HOS boot files during boot wait or menu.
+	if (!special_path && !(b_cfg.boot_cfg & BOOT_CFG_FROM_LAUNCH))
+		hos_prefetch_start(cfg_sec);
+
 	if ((!(b_cfg.boot_cfg & BOOT_CFG_FROM_LAUNCH) && boot_wait) || // Conditional for HOS/Payload.
 		(special_path && special_path == (char *)-1))              // Always show for L4T.
 	{
@@ -997,6 +1014,8 @@ skip_list:
 		if (boot_wait > 20)
 			boot_wait = 3;
 
+		btrace_mark("bootlogo");
+
 		// Render boot logo.
 		if (bootlogoFound)
 		{
@@ -1484,6 +1503,10 @@ extern void pivot_stack(u32 stack_top);
 
 void ipl_main()
 {
+	// Get boot timestamp. Stack gets pivoted, so keep it static.
+	static u32 boot_ts;
+	boot_ts = get_tmr_us();
+
 	// Do initial HW configuration. This is compatible with consecutive reruns without a reset.
 	hw_init();
 
@@ -1493,6 +1516,11 @@ void ipl_main()
 	// Tegra/Horizon configuration goes to 0x80000000+, package2 goes to 0xA9800000, we place our heap in between.
 	heap_init((void *)IPL_HEAP_START);
 
+	// Initialize boot trace. DRAM is now available.
+	btrace_init(BTRACE_STAGE_HEKATE, true);
+	btrace_event(BTRACE_BEGIN, "hw_init", boot_ts);
+	btrace_end("hw_init");
+
 #ifdef DEBUG_UART_PORT
 	uart_send(DEBUG_UART_PORT, (u8 *)"hekate: Hello!\r\n", 16);
 	uart_wait_xfer(DEBUG_UART_PORT, UART_TX_IDLE);
@@ -1511,35 +1539,47 @@ void ipl_main()
 	display_init();
 
 	// Mount SD Card.
+	btrace_begin("sd_mount");
 	h_cfg.errors |= !sd_mount() ? ERR_SD_BOOT_EN : 0;
+	btrace_end("sd_mount");
 
 	// Check if watchdog was fired previously.
 	if (watchdog_fired())
+	{
+		// Saved DRAM training might be the cause. Force a full training next time.
+		f_unlink(MTC_TRAIN_CACHE_PATH);
 		goto skip_lp0_minerva_config;
+	}
 
 	// Enable watchdog protection to avoid SD corruption based hanging in LP0/Minerva config.
 	watchdog_start(5000000 / 2, TIMER_FIQENABL_EN); // 5 seconds.
 
 	// Save sdram lp0 config.
+	btrace_begin("lp0_config");
 	void *sdram_params = h_cfg.t210b01 ? sdram_get_params_t210b01() : sdram_get_params_patched();
 	if (!ianos_loader("bootloader/sys/libsys_lp0.bso", DRAM_LIB, sdram_params))
 		h_cfg.errors |= ERR_LIBSYS_LP0;
+	btrace_end("lp0_config");
 
 	// Train DRAM and switch to max frequency.
+	btrace_begin("minerva_init");
 	if (minerva_init()) //!TODO: Add Tegra210B01 support to minerva.
 		h_cfg.errors |= ERR_LIBSYS_MTC;
+	btrace_end("minerva_init");
 
 	// Disable watchdog protection.
 	watchdog_end();
 
 skip_lp0_minerva_config:
 	// Initialize display window, backlight and gfx console.
+	btrace_begin("display_init");
 	u32 *fb = display_init_framebuffer_pitch();
 	gfx_init_ctxt(fb, 720, 1280, 720);
 	gfx_con_init();
 
 	display_backlight_pwm_init();
 	//display_backlight_brightness(h_cfg.backlight, 1000);
+	btrace_end("display_init");
 
 	// Overclock BPMP.
 	bpmp_clk_rate_set(h_cfg.t210b01 ? BPMP_CLK_DEFAULT_BOOST : BPMP_CLK_LOWER_BOOST);
@@ -1558,6 +1598,8 @@ skip_lp0_minerva_config:
 	// Failed to launch Nyx, unmount SD Card.
 	sd_end();
 
+	btrace_mark("tui_menu");
+
 	// Set ram to a freq that doesn't need periodic training.
 	minerva_change_freq(FREQ_800);
 
@@ -38,6 +38,7 @@ void set_default_configuration()
 	h_cfg.autonogc      = 1;
 	h_cfg.updater2p     = 0;
 	h_cfg.bootprotect   = 0;
+	h_cfg.boottrace     = 0;
 
 	h_cfg.errors = 0;
 	h_cfg.eks = NULL;
@@ -136,6 +137,10 @@ int create_config_entry()
 	itoa(h_cfg.bootprotect, lbuf, 10);
 	f_puts(lbuf, &fp);
 
+	// Developer option. Only keep it if enabled.
+	if (h_cfg.boottrace)
+		f_puts("\nboottrace=1", &fp);
+
 	f_puts("\n", &fp);
 
 	if (mainIniFound)
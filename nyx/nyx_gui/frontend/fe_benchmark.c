@@ -0,0 +1,331 @@
+/*
+ * Storage benchmark suite
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <bdk.h>
+
+#include "fe_benchmark.h"
+#include <libs/fatfs/ff.h>
+
+//#define DPRINTF(...) gfx_printf(__VA_ARGS__)
+#define DPRINTF(...)
+
+#define BENCH_TMP_DIR  "bootloader/benchmarks/tmp"
+#define BENCH_TMP_FILE BENCH_TMP_DIR"/append.tmp"
+
+const bench_workload_t bench_workloads[] = {
+	// Name               Type               Flags         Chunk   Total     Write%
+	{ "Seq Read 16M",     BENCH_RAW,         0,            0x8000, 0x200000,   0 }, // 1GB.
+	{ "Seq Read 4K",      BENCH_RAW,         0,                 8, 0x100000,   0 }, // 512MB.
+	{ "Rnd Read 4K",      BENCH_RAW,         BENCH_RANDOM,      8, 0x100000,   0 }, // 512MB.
+	{ "Seq Write 16M",    BENCH_RAW,         0,            0x8000,  0x40000, 100 }, // 128MB.
+	{ "Bulk Write 16M",   BENCH_RAW,         BENCH_BULK,   0x8000,  0x40000, 100 }, // 128MB.
+	{ "Rnd Write 4K",     BENCH_RAW,         BENCH_RANDOM,      8,   0x8000, 100 }, // 16MB.
+	{ "Mixed 4K 70/30",   BENCH_RAW,         BENCH_RANDOM,      8,  0x20000,  30 }, // 64MB.
+	{ "File Create 4K",   BENCH_FILE_CREATE, BENCH_FATFS,       8,    0x800, 100 }, // 256 files.
+	{ "File Append 128K", BENCH_FILE_APPEND, BENCH_FATFS,   0x100,  0x20000, 100 }, // 64MB.
+	{ "File Read 128K",   BENCH_FILE_READ,   BENCH_FATFS,   0x100,  0x20000,   0 }, // 64MB.
+	{ NULL }
+};
+
+static u32 _bench_hist_index(u32 us)
+{
+	if (us < BENCH_HIST_SUB * 2)
+		return us;
+
+	// Power of 2 group and linear sub-bucket inside it.
+	u32 msb = 31 - __builtin_clz(us);
+	return BENCH_HIST_SUB * (msb - 2) + ((us >> (msb - 3)) & (BENCH_HIST_SUB - 1));
+}
+
+static u32 _bench_hist_value(u32 idx)
+{
+	if (idx < BENCH_HIST_SUB * 2)
+		return idx;
+
+	// Return the middle of the bucket.
+	u32 shift = idx / BENCH_HIST_SUB - 1;
+	return ((BENCH_HIST_SUB + (idx % BENCH_HIST_SUB)) << shift) + ((1 << shift) >> 1);
+}
+
+static void _bench_hist_add(bench_hist_t *hist, u32 us)
+{
+	hist->bucket[_bench_hist_index(us)]++;
+	hist->count++;
+	hist->time_us += us;
+	if (us > hist->max_us)
+		hist->max_us = us;
+}
+
+static u32 _bench_hist_percentile(bench_hist_t *hist, u32 pct)
+{
+	u32 rank = MAX((hist->count * pct + 99) / 100, 1);
+	u32 cnt = 0;
+
+	for (u32 i = 0; i < BENCH_HIST_BUCKETS; i++)
+	{
+		cnt += hist->bucket[i];
+		if (cnt >= rank)
+			return MIN(_bench_hist_value(i), hist->max_us);
+	}
+
+	return hist->max_us;
+}
+
+static int _bench_progress(bench_ctxt_t *ctxt, u32 done, u32 total)
+{
+	if (!ctxt->progress)
+		return 0;
+
+	return ctxt->progress(ctxt->progress_data, (done * 100) / total);
+}
+
+static int _bench_raw(bench_ctxt_t *ctxt, const bench_workload_t *wl)
+{
+	int error = 0;
+	u32 ops = wl->total_sectors / wl->chunk_sectors;
+	u32 chunks = ctxt->area_sectors / wl->chunk_sectors;
+	u32 *random = NULL;
+
+	// Generate random numbers beforehand to not affect timings.
+	if ((wl->flags & BENCH_RANDOM) || (wl->write_pct && wl->write_pct < 100))
+	{
+		random = (u32 *)malloc(ALIGN(ops, 4) * sizeof(u32));
+		for (u32 i = 0; i < ops; i += 4)
+			while (!se_gen_prng128(&random[i]))
+				;
+	}
+
+	if (wl->write_pct)
+		sdmmc_storage_set_bulk_write(ctxt->storage, wl->flags & BENCH_BULK);
+
+	for (u32 i = 0; i < ops; i++)
+	{
+		u32 sector = ctxt->sector + ((wl->flags & BENCH_RANDOM) ? random[i] % chunks : i) * wl->chunk_sectors;
+
+		// Offset uses the low bits, so take the read/write choice from the high ones.
+		bool write = wl->write_pct == 100 || (wl->write_pct && ((random[i] >> 20) % 100) < wl->write_pct);
+
+		// Write back the same data, so the benchmark is not destructive.
+		if (write && !sdmmc_storage_read(ctxt->storage, sector, wl->chunk_sectors, ctxt->buf))
+		{
+			error = 1;
+			break;
+		}
+
+		u32 time_taken = get_tmr_us();
+		if (write)
+			error = !sdmmc_storage_write(ctxt->storage, sector, wl->chunk_sectors, ctxt->buf);
+		else
+			error = !sdmmc_storage_read(ctxt->storage, sector, wl->chunk_sectors, ctxt->buf);
+		_bench_hist_add(&ctxt->hist, get_tmr_us() - time_taken);
+
+		if (!error)
+			error = _bench_progress(ctxt, i + 1, ops);
+		if (error)
+			break;
+	}
+
+	// Flush time is part of the workload.
+	if (wl->write_pct)
+	{
+		u32 time_taken = get_tmr_us();
+		if (!sdmmc_storage_set_bulk_write(ctxt->storage, false) && !error)
+			error = 1;
+		ctxt->hist.time_us += get_tmr_us() - time_taken;
+	}
+
+	free(random);
+
+	return error;
+}
+
+static int _bench_file_create(bench_ctxt_t *ctxt, const bench_workload_t *wl)
+{
+	FIL fp;
+	UINT bw;
+	int error = 0;
+	char path[64];
+	u32 size = wl->chunk_sectors * SD_BLOCKSIZE;
+	u32 files = wl->total_sectors / wl->chunk_sectors;
+	u32 created = 0;
+
+	f_mkdir("bootloader/benchmarks");
+	f_mkdir(BENCH_TMP_DIR);
+
+	for (; created < files; created++)
+	{
+		s_printf(path, BENCH_TMP_DIR"/f%04d.tmp", created);
+
+		u32 time_taken = get_tmr_us();
+		error = f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE);
+		if (!error)
+		{
+			error = f_write(&fp, ctxt->buf, size, &bw);
+			if (f_close(&fp) && !error)
+				error = 1;
+		}
+		_bench_hist_add(&ctxt->hist, get_tmr_us() - time_taken);
+
+		if (!error)
+			error = _bench_progress(ctxt, created + 1, files);
+		if (error)
+			break;
+	}
+
+	// Remove all created files.
+	for (u32 i = 0; i <= created && i < files; i++)
+	{
+		s_printf(path, BENCH_TMP_DIR"/f%04d.tmp", i);
+		f_unlink(path);
+	}
+	f_unlink(BENCH_TMP_DIR);
+
+	return error;
+}
+
+static int _bench_file_stream(bench_ctxt_t *ctxt, const bench_workload_t *wl)
+{
+	FIL fp;
+	UINT bx;
+	int error = 0;
+	u32 size = wl->chunk_sectors * SD_BLOCKSIZE;
+	u32 ops = wl->total_sectors / wl->chunk_sectors;
+	bool append = wl->type == BENCH_FILE_APPEND;
+
+	if (append)
+	{
+		f_mkdir("bootloader/benchmarks");
+		f_mkdir(BENCH_TMP_DIR);
+	}
+
+	// Reading uses the file of the append workload.
+	error = f_open(&fp, BENCH_TMP_FILE, append ? (FA_CREATE_ALWAYS | FA_WRITE) : FA_READ);
+	if (error)
+		goto out;
+
+	for (u32 i = 0; i < ops; i++)
+	{
+		u32 time_taken = get_tmr_us();
+		if (append)
+			error = f_write(&fp, ctxt->buf, size, &bx);
+		else
+			error = f_read(&fp, ctxt->buf, size, &bx);
+		if (!error && bx != size)
+			error = FR_DENIED;
+		_bench_hist_add(&ctxt->hist, get_tmr_us() - time_taken);
+
+		if (!error)
+			error = _bench_progress(ctxt, i + 1, ops);
+		if (error)
+			break;
+	}
+
+	// Closing commits the FAT and directory entry.
+	u32 time_taken = get_tmr_us();
+	if (f_close(&fp) && !error)
+		error = 1;
+	ctxt->hist.time_us += get_tmr_us() - time_taken;
+
+out:
+	// Keep the appended file for the read workload.
+	if (!append || error)
+	{
+		f_unlink(BENCH_TMP_FILE);
+		f_unlink(BENCH_TMP_DIR);
+	}
+
+	return error;
+}
+
+int bench_run(bench_ctxt_t *ctxt, const bench_workload_t *wl, bench_result_t *res)
+{
+	int error;
+
+	memset(&ctxt->hist, 0, sizeof(bench_hist_t));
+	memset(res, 0, sizeof(bench_result_t));
+	res->name = wl->name;
+
+	DPRINTF("Bench: %s\n", wl->name);
+
+	switch (wl->type)
+	{
+	case BENCH_FILE_CREATE:
+		error = _bench_file_create(ctxt, wl);
+		break;
+
+	case BENCH_FILE_APPEND:
+	case BENCH_FILE_READ:
+		error = _bench_file_stream(ctxt, wl);
+		break;
+
+	case BENCH_RAW:
+	default:
+		// Raw writes go to live storage. Caller must opt in.
+		if (wl->write_pct && !ctxt->raw_write)
+			return 1;
+
+		error = _bench_raw(ctxt, wl);
+		break;
+	}
+
+	bench_hist_t *hist = &ctxt->hist;
+	if (error || !hist->count || !hist->time_us)
+		return error ? error : 1;
+
+	res->ops     = hist->count;
+	res->bytes   = (u64)hist->count * wl->chunk_sectors * SD_BLOCKSIZE;
+	res->time_us = hist->time_us;
+	res->rate_1k = ((res->bytes * 1000000 / hist->time_us) * 1000) >> 20;
+	res->iops    = ((u64)hist->count * 1000000) / hist->time_us;
+	res->p50_us  = _bench_hist_percentile(hist, 50);
+	res->p99_us  = _bench_hist_percentile(hist, 99);
+	res->max_us  = hist->max_us;
+
+	return 0;
+}
+
+char *bench_csv_create(const char *storage_name, const bench_result_t *res, u32 count)
+{
+	char *buf = (char *)malloc(BENCH_CSV_LINE_SZ * (count + 1));
+
+	strcpy(buf, "storage,test,kib,ops,time_us,mib_s,iops,p50_us,p99_us,max_us\n");
+	for (u32 i = 0; i < count; i++)
+	{
+		s_printf(buf + strlen(buf), "%s,%s,%d,%d,%d,%d.%03d,%d,%d,%d,%d\n",
+			storage_name, res[i].name, (u32)(res[i].bytes >> 10), res[i].ops, res[i].time_us,
+			res[i].rate_1k / 1000, res[i].rate_1k % 1000, res[i].iops,
+			res[i].p50_us, res[i].p99_us, res[i].max_us);
+	}
+
+	return buf;
+}
+
+int bench_save_csv(const char *path, const char *storage_name, const bench_result_t *res, u32 count)
+{
+	char *buf = bench_csv_create(storage_name, res, count);
+
+	f_mkdir("bootloader/benchmarks");
+	int error = sd_save_to_file(buf, strlen(buf), path);
+
+	free(buf);
+
+	return error;
+}
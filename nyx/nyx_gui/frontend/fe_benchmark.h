@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FE_BENCHMARK_H_
+#define _FE_BENCHMARK_H_
+
+#include <storage/sdmmc.h>
+#include <utils/types.h>
+
+// Latency histogram has 8 sub-buckets per power of 2 (12.5% resolution).
+#define BENCH_HIST_SUB     8
+#define BENCH_HIST_BUCKETS (BENCH_HIST_SUB * 30)
+
+#define BENCH_CSV_LINE_SZ 128
+
+#define BENCH_RANDOM BIT(0) // Random chunk offsets inside the test area.
+#define BENCH_BULK   BIT(1) // Writes in bulk write mode.
+#define BENCH_FATFS  BIT(2) // File workload on a mounted SD.
+
+typedef enum _bench_type_t
+{
+	BENCH_RAW         = 0,
+	BENCH_FILE_CREATE = 1,
+	BENCH_FILE_APPEND = 2,
+	BENCH_FILE_READ   = 3
+} bench_type_t;
+
+typedef struct _bench_workload_t
+{
+	const char *name;
+	u32 type;
+	u32 flags;
+	u32 chunk_sectors;
+	u32 total_sectors;
+	u32 write_pct; // Percentage of operations that are writes.
+} bench_workload_t;
+
+typedef struct _bench_hist_t
+{
+	u32 bucket[BENCH_HIST_BUCKETS];
+	u32 count;
+	u32 time_us;
+	u32 max_us;
+} bench_hist_t;
+
+typedef struct _bench_result_t
+{
+	const char *name;
+	u64 bytes;
+	u32 ops;
+	u32 time_us; // Sum of operation times.
+	u32 rate_1k; // MiB/s * 1000.
+	u32 iops;
+	u32 p50_us;
+	u32 p99_us;
+	u32 max_us;
+} bench_result_t;
+
+typedef struct _bench_ctxt_t
+{
+	sdmmc_storage_t *storage;
+	u32  sector;       // Start of the test area.
+	u32  area_sectors; // Size of the test area.
+	u8  *buf;
+	bool raw_write;    // Allow raw writes. Test area is rewritten in place.
+
+	// Called after each operation. Returning non zero aborts the workload.
+	int (*progress)(void *data, u32 pct);
+	void *progress_data;
+
+	bench_hist_t hist;
+} bench_ctxt_t;
+
+extern const bench_workload_t bench_workloads[];
+
+int   bench_run(bench_ctxt_t *ctxt, const bench_workload_t *wl, bench_result_t *res);
+// Returns an allocated CSV of the results. Caller frees it.
+char *bench_csv_create(const char *storage_name, const bench_result_t *res, u32 count);
+int   bench_save_csv(const char *path, const char *storage_name, const bench_result_t *res, u32 count);
+
+#endif
@@ -141,11 +141,12 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 {
 	FIL fp;
 	FIL hashFp;
+	FPUTBUF hashPb;
+	u8 hashPbBuf[512];
 	u8 sparseShouldVerify = 4;
 	u32 prevPct = 200;
 	u32 sdFileSector = 0;
 	int res = 0;
-	const char hexa[] = "0123456789abcdef";
 	DWORD *clmt = NULL;
 
 	u8 hashEm[SE_SHA_256_SIZE];
@@ -177,9 +178,10 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 			itoa(NUM_SECTORS_PER_ITER * EMMC_BLOCKSIZE, chunkSizeAscii, 10);
 			chunkSizeAscii[9] = '\0';
 
-			f_puts("# chunksize: ", &hashFp);
-			f_puts(chunkSizeAscii, &hashFp);
-			f_puts("\n", &hashFp);
+			f_putbuf_init(&hashPb, &hashFp, hashPbBuf, sizeof(hashPbBuf));
+			f_putbuf_puts(&hashPb, "# chunksize: ");
+			f_putbuf_puts(&hashPb, chunkSizeAscii);
+			f_putbuf_puts(&hashPb, "\n");
 		}
 
 		u32 totalSectorsVer = (u32)((u64)f_size(&fp) >> (u64)9);
@@ -219,7 +221,10 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 					free(clmt);
 					f_close(&fp);
 					if (n_cfg.verification == 3)
+					{
+						f_putbuf_flush(&hashPb);
 						f_close(&hashFp);
+					}
 
 					return 1;
 				}
@@ -239,7 +244,10 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 					free(clmt);
 					f_close(&fp);
 					if (n_cfg.verification == 3)
+					{
+						f_putbuf_flush(&hashPb);
 						f_close(&hashFp);
+					}
 
 					return 1;
 				}
@@ -260,25 +268,23 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 					free(clmt);
 					f_close(&fp);
 					if (n_cfg.verification == 3)
+					{
+						f_putbuf_flush(&hashPb);
 						f_close(&hashFp);
+					}
 
 					return 1;
 				}
 
 				if (n_cfg.verification == 3)
 				{
-					// Transform computed hash to readable hexadecimal
-					char hashStr[SE_SHA_256_SIZE * 2 + 1];
-					char *hashStrPtr = hashStr;
-					for (int i = 0; i < SE_SHA_256_SIZE; i++)
-					{
-						*(hashStrPtr++) = hexa[hashSd[i] >> 4];
-						*(hashStrPtr++) = hexa[hashSd[i] & 0x0F];
-					}
-					hashStr[SE_SHA_256_SIZE * 2] = '\0';
+					// Transform computed hash to readable hexadecimal.
+					char hashStr[SE_SHA_256_SIZE * 2 + 2];
+					s_hexstr(hashStr, hashSd, SE_SHA_256_SIZE);
+					hashStr[SE_SHA_256_SIZE * 2]     = '\n';
+					hashStr[SE_SHA_256_SIZE * 2 + 1] = '\0';
 
-					f_puts(hashStr, &hashFp);
-					f_puts("\n", &hashFp);
+					f_putbuf_puts(&hashPb, hashStr);
 				}
 			}
 
@@ -310,14 +316,22 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 
 				free(clmt);
 				f_close(&fp);
-				f_close(&hashFp);
+				if (n_cfg.verification == 3)
+				{
+					f_putbuf_flush(&hashPb);
+					f_close(&hashFp);
+				}
 
 				return 0;
 			}
 		}
 		free(clmt);
 		f_close(&fp);
-		f_close(&hashFp);
+		if (n_cfg.verification == 3)
+		{
+			f_putbuf_flush(&hashPb);
+			f_close(&hashFp);
+		}
 
 		lv_bar_set_value(gui->bar, pct);
 		s_printf(gui->txt_buf, " "SYMBOL_DOT" %d%%", pct);
@@ -1196,6 +1210,10 @@ multipart_not_allowed:
 		sd_sector_off = sector_start + (0x2000 * active_part);
 	}
 
+	// Use block count, pre-erase and cache for the writes.
+	sdmmc_storage_t *storage_out = !gui->raw_emummc ? storage : &sd_storage;
+	sdmmc_storage_set_bulk_write(storage_out, true);
+
 	lv_obj_set_opa_scale(gui->bar, LV_OPA_COVER);
 	lv_obj_set_opa_scale(gui->label_pct, LV_OPA_COVER);
 	while (totalSectors > 0)
@@ -1218,6 +1236,7 @@ multipart_not_allowed:
 					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
 					manual_system_maintenance(true);
 
+					sdmmc_storage_set_bulk_write(storage_out, false);
 					return 0;
 				}
 			}
@@ -1242,6 +1261,7 @@ multipart_not_allowed:
 				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
 				manual_system_maintenance(true);
 
+				sdmmc_storage_set_bulk_write(storage_out, false);
 				return 0;
 			}
 			fileSize = (u64)f_size(&fp);
@@ -1266,6 +1286,7 @@ multipart_not_allowed:
 
 			f_close(&fp);
 			free(clmt);
+			sdmmc_storage_set_bulk_write(storage_out, false);
 			return 0;
 		}
 		if (!gui->raw_emummc)
@@ -1295,6 +1316,7 @@ multipart_not_allowed:
 
 				f_close(&fp);
 				free(clmt);
+				sdmmc_storage_set_bulk_write(storage_out, false);
 				return 0;
 			}
 			else
@@ -1331,6 +1353,16 @@ multipart_not_allowed:
 	f_close(&fp);
 	free(clmt);
 
+	// Commit cached data before verification.
+	if (!sdmmc_storage_set_bulk_write(storage_out, false))
+	{
+		s_printf(gui->txt_buf, "\n#FF0000 Failed to flush storage cache!#\n#FFDD00 Please try again...#\n");
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+
+		return 0;
+	}
+
 	if (n_cfg.verification && !gui->raw_emummc)
 	{
 		// Verify restored data.
@@ -33,6 +33,31 @@
 #define NAND_PATROL_SECTOR 0xC20
 #define NUM_SECTORS_PER_ITER 8192 // 4MB Cache.
 
+#define ALLOC_FAT_ENTRIES_PER_ITER (SZ_4M / sizeof(u32))
+#define ALLOC_MIN_SKIP_SECTORS     0x800 // 1MB. Smaller free gaps are copied.
+#define ALLOC_RAW_ALIGN            0x20  // 16KB BIS cluster.
+
+#define CLONE_RING_SLOTS  4
+#define CLONE_RING_BUF(i) ((u8 *)MIXD_BUF_ALIGNED + (i) * NUM_SECTORS_PER_ITER * EMMC_BLOCKSIZE)
+
+typedef struct _emummc_alloc_part_t
+{
+	u32 data_start; // GPP sector of the first data cluster.
+	u32 data_end;
+	u32 csize;
+	u32 free_sectors;
+	u32 *used;      // Bitmap of clusters that must be copied.
+} emummc_alloc_part_t;
+
+typedef struct _emummc_clone_slot_t
+{
+	u32 lba;
+	u32 num;
+} emummc_clone_slot_t;
+
+static u32 emummc_alloc_cnt = 0;
+static emummc_alloc_part_t emummc_alloc[2];
+
 extern hekate_config h_cfg;
 extern volatile boot_cfg_t *b_cfg;
 
@@ -143,6 +168,248 @@ void update_emummc_base_folder(char *outFilename, u32 sdPathLen, u32 currPartIdx
 		itoa(currPartIdx, &outFilename[sdPathLen], 10);
 }
 
+static void _emummc_alloc_mark_used(u32 *bitmap, u32 clst, u32 count)
+{
+	for (u32 i = clst; i < clst + count; i++)
+		bitmap[i >> 5] |= BIT(i & 31);
+}
+
+static int _emummc_alloc_map_part(emmc_part_t *part, emummc_alloc_part_t *map)
+{
+	int res = 0;
+	u8 *buf = (u8 *)MIXD_BUF_ALIGNED;
+	FATFS *fs = (FATFS *)malloc(sizeof(FATFS));
+
+	// Mount the decrypted partition to get its FAT layout.
+	nx_emmc_bis_init(part, false, 0);
+	if (f_mount(fs, "bis:", 1) || fs->fs_type != FS_FAT32)
+		goto out;
+
+	u32 clusters = fs->n_fatent - 2;
+	map->csize = fs->csize;
+	map->data_start = part->lba_start + fs->database - fs->volbase;
+	map->data_end = MIN(map->data_start + clusters * fs->csize, part->lba_end + 1);
+	map->used = (u32 *)zalloc(ALIGN(clusters, 32) / 8);
+
+	// Scan the first FAT. Free clusters have a zero entry.
+	u32 sector = fs->fatbase - fs->volbase;
+	for (u32 entry = 0; entry < fs->n_fatent; entry += ALLOC_FAT_ENTRIES_PER_ITER)
+	{
+		u32 num = MIN(fs->n_fatent - entry, ALLOC_FAT_ENTRIES_PER_ITER);
+		if (!nx_emmc_bis_read(sector, ALIGN(num * sizeof(u32), EMMC_BLOCKSIZE) / EMMC_BLOCKSIZE, buf))
+		{
+			free(map->used);
+			map->used = NULL;
+			goto out;
+		}
+
+		u32 *fat = (u32 *)buf;
+		for (u32 i = (entry ? 0 : 2); i < num; i++)
+			if (fat[i] & 0x0FFFFFFF)
+				_emummc_alloc_mark_used(map->used, entry + i - 2, 1);
+
+		sector += ALLOC_FAT_ENTRIES_PER_ITER * sizeof(u32) / EMMC_BLOCKSIZE;
+		manual_system_maintenance(false);
+	}
+
+	// Copy small free gaps anyway, so transfers stay large.
+	u32 min_skip = ALLOC_MIN_SKIP_SECTORS / map->csize;
+	u32 free_cnt = 0;
+	map->free_sectors = 0;
+	for (u32 clst = 0; clst <= clusters; clst++)
+	{
+		if (clst < clusters && !(map->used[clst >> 5] & BIT(clst & 31)))
+		{
+			free_cnt++;
+			continue;
+		}
+
+		if (free_cnt < min_skip)
+			_emummc_alloc_mark_used(map->used, clst - free_cnt, free_cnt);
+		else
+			map->free_sectors += free_cnt * map->csize;
+		free_cnt = 0;
+	}
+
+	res = 1;
+
+out:
+	f_mount(NULL, "bis:", 1);
+	nx_emmc_bis_end();
+	free(fs);
+
+	return res;
+}
+
+static void _emummc_alloc_map_init(emmc_tool_gui_t *gui, bool map_user)
+{
+	static const char *part_names[] = { "SYSTEM", "USER" };
+
+	emummc_alloc_cnt = 0;
+	if (!gui->alloc_only)
+		return;
+
+	s_printf(gui->txt_buf, "Mapping used data... ");
+	lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+	manual_system_maintenance(true);
+
+	LIST_INIT(gpt);
+	emmc_gpt_parse(&gpt);
+
+	// Partitions that fail to map are copied whole.
+	u32 free_sectors = 0;
+	for (u32 i = 0; i < (map_user ? 2 : 1); i++)
+	{
+		emmc_part_t *part = emmc_part_find(&gpt, part_names[i]);
+		emummc_alloc_part_t *map = &emummc_alloc[emummc_alloc_cnt];
+		if (part && _emummc_alloc_map_part(part, map))
+		{
+			free_sectors += map->free_sectors;
+			emummc_alloc_cnt++;
+		}
+	}
+
+	emmc_gpt_free(&gpt);
+
+	s_printf(gui->txt_buf, "%d MiB free\n", free_sectors >> 11);
+	lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+	manual_system_maintenance(true);
+}
+
+static void _emummc_alloc_map_end()
+{
+	for (u32 i = 0; i < emummc_alloc_cnt; i++)
+		free(emummc_alloc[i].used);
+	emummc_alloc_cnt = 0;
+}
+
+static bool _emummc_alloc_free(u32 lba, u32 count)
+{
+	for (u32 i = 0; i < emummc_alloc_cnt; i++)
+	{
+		emummc_alloc_part_t *map = &emummc_alloc[i];
+		if (lba < map->data_start || (lba + count) > map->data_end)
+			continue;
+
+		u32 clst_end = (lba + count - 1 - map->data_start) / map->csize;
+		for (u32 clst = (lba - map->data_start) / map->csize; clst <= clst_end; clst++)
+			if (map->used[clst >> 5] & BIT(clst & 31))
+				return false;
+
+		return true;
+	}
+
+	return false;
+}
+
+static u32 _emummc_alloc_run(u32 lba, u32 count, u32 align, bool *used)
+{
+	*used = true;
+	if (!emummc_alloc_cnt)
+		return count;
+
+	// Check in aligned blocks, so skipped areas keep the destination alignment.
+	u32 run = 0;
+	bool free_run = _emummc_alloc_free(lba, MIN(align - (lba % align), count));
+	while (run < count)
+	{
+		u32 block = MIN(align - ((lba + run) % align), count - run);
+		if (_emummc_alloc_free(lba + run, block) != free_run)
+			break;
+		run += block;
+	}
+
+	*used = !free_run;
+
+	return run;
+}
+
+static int _emummc_derive_bis_keys(emmc_tool_gui_t *gui, bool required)
+{
+	if (!required)
+		return 1;
+
+	bool error = false;
+
+	char *txt_buf = (char *)malloc(SZ_16K);
+	txt_buf[0] = 0;
+
+	// Generate BIS keys.
+	hos_bis_keygen();
+
+	u8 *cal0_buf = malloc(SZ_64K);
+
+	// Read and decrypt CAL0 for validation of working BIS keys.
+	emmc_set_partition(EMMC_GPP);
+	LIST_INIT(gpt);
+	emmc_gpt_parse(&gpt);
+	emmc_part_t *cal0_part = emmc_part_find(&gpt, "PRODINFO");
+	if (!cal0_part)
+	{
+		strcpy(txt_buf, "#FFDD00 PRODINFO partition not found!#\n");
+		error = true;
+	}
+	else
+	{
+		nx_emmc_bis_init(cal0_part, false, 0);
+		if (!nx_emmc_bis_read(0, 0x40, cal0_buf))
+		{
+			strcpy(txt_buf, "#FFDD00 Failed to read PRODINFO!#\n");
+			error = true;
+		}
+		nx_emmc_bis_end();
+	}
+	emmc_gpt_free(&gpt);
+
+	nx_emmc_cal0_t *cal0 = (nx_emmc_cal0_t *)cal0_buf;
+
+	// Check keys validity.
+	if (!error && memcmp(&cal0->magic, "CAL0", 4))
+	{
+		// Clear EKS keys.
+		hos_eks_clear(HOS_KB_VERSION_MAX);
+
+		strcpy(txt_buf, "#FFDD00 BIS keys validation failed!#\n");
+		error = true;
+	}
+
+	free(cal0_buf);
+
+	if (error)
+	{
+		lv_obj_t *dark_bg = lv_obj_create(lv_scr_act(), NULL);
+		lv_obj_set_style(dark_bg, &mbox_darken);
+		lv_obj_set_size(dark_bg, LV_HOR_RES, LV_VER_RES);
+
+		static const char * mbox_btn_map[] = { "\251", "\222Close", "\251", "" };
+		lv_obj_t * mbox = lv_mbox_create(dark_bg, NULL);
+		lv_mbox_set_recolor_text(mbox, true);
+		lv_obj_set_width(mbox, LV_HOR_RES / 9 * 5);
+
+		lv_mbox_set_text(mbox, "#C7EA46 BIS Keys Generation#");
+
+		lv_obj_t * lb_desc = lv_label_create(mbox, NULL);
+		lv_label_set_long_mode(lb_desc, LV_LABEL_LONG_BREAK);
+		lv_label_set_recolor(lb_desc, true);
+		lv_label_set_style(lb_desc, &monospace_text);
+		lv_obj_set_width(lb_desc, LV_HOR_RES / 9 * 4);
+
+		lv_label_set_text(lb_desc, txt_buf);
+		lv_mbox_add_btns(mbox, mbox_btn_map, mbox_action);
+
+		lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
+		lv_obj_set_top(mbox, true);
+
+		free(txt_buf);
+
+		return 0;
+	}
+
+	free(txt_buf);
+
+	return 1;
+}
+
 static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_storage_t *storage, emmc_part_t *part)
 {
 	static const u32 FAT32_FILESIZE_LIMIT = 0xFFFFFFFF;
@@ -273,7 +540,11 @@ static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_sto
 		retryCount = 0;
 		num = MIN(totalSectors, NUM_SECTORS_PER_ITER);
 
-		while (!sdmmc_storage_read(storage, lba_curr, num, buf))
+		// Whole chunks of free space are skipped to keep the file cluster alignment.
+		bool used;
+		num = _emummc_alloc_run(lba_curr, num, NUM_SECTORS_PER_ITER, &used);
+
+		while (used && !sdmmc_storage_read(storage, lba_curr, num, buf))
 		{
 			s_printf(gui->txt_buf,
 				"\n#FFDD00 Error reading %d blocks @ LBA %08X,#\n"
@@ -305,7 +576,11 @@ static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_sto
 
 		manual_system_maintenance(false);
 
-		res = f_write_fast(&fp, buf, EMMC_BLOCKSIZE * num);
+		// Free space is left as is, since its clusters are already allocated.
+		if (used)
+			res = f_write_fast(&fp, buf, EMMC_BLOCKSIZE * num);
+		else
+			res = f_lseek(&fp, f_tell(&fp) + EMMC_BLOCKSIZE * num);
 
 		manual_system_maintenance(false);
 
@@ -389,6 +664,14 @@ void dump_emummc_file(emmc_tool_gui_t *gui)
 		goto out;
 	}
 
+	if (!_emummc_derive_bis_keys(gui, gui->alloc_only))
+	{
+		s_printf(gui->txt_buf, "#FFDD00 For copying only used data,#\n#FFDD00 BIS keys are needed!#\n");
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		emmc_end();
+		goto out;
+	}
+
 	int i = 0;
 	char sdPath[OUT_FILENAME_SZ];
 	// Create Restore folders, if they do not exist.
@@ -464,11 +747,15 @@ void dump_emummc_file(emmc_tool_gui_t *gui)
 	s_printf(txt_buf, "#00DDFF %02d: %s#\n#00DDFF Range: 0x%08X - 0x%08X#\n\n",
 		i, rawPart.name, rawPart.lba_start, rawPart.lba_end);
 	lv_label_set_text(gui->label_info, txt_buf);
+
+	_emummc_alloc_map_init(gui, true);
+
 	s_printf(txt_buf, "%02d: %s... ", i, rawPart.name);
 	lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, txt_buf);
 	manual_system_maintenance(true);
 
 	res = _dump_emummc_file_part(gui, sdPath, &emmc_storage, &rawPart);
+	_emummc_alloc_map_end();
 
 	if (!res)
 		s_printf(txt_buf, "#FFDD00 Failed!#\n");
@@ -482,6 +769,9 @@ out_failed:
 	timer = get_tmr_s() - timer;
 	emmc_end();
 
+	if (gui->alloc_only)
+		hos_bis_keys_clear();
+
 	if (res)
 	{
 		s_printf(txt_buf, "Time taken: %dm %ds.\nFinished!", timer / 60, timer % 60);
@@ -506,12 +796,85 @@ out:
 	sd_unmount();
 }
 
+static int _emummc_raw_read(emmc_tool_gui_t *gui, u32 lba, u32 num, u8 *buf)
+{
+	int retryCount = 0;
+
+	while (!sdmmc_storage_read(&emmc_storage, lba, num, buf))
+	{
+		s_printf(gui->txt_buf,
+			"\n#FFDD00 Error reading %d blocks @LBA %08X,#\n"
+			"#FFDD00 from eMMC (try %d). #",
+			num, lba, ++retryCount);
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+
+		msleep(150);
+		if (retryCount >= 3)
+		{
+			s_printf(gui->txt_buf, "#FF0000 Aborting...#\nPlease try again...\n");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			return 0;
+		}
+		else
+		{
+			s_printf(gui->txt_buf, "#FFDD00 Retrying...#\n");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+		}
+	}
+
+	return 1;
+}
+
+static int _emummc_raw_write(emmc_tool_gui_t *gui, u32 sd_sector_off, u32 lba, u32 num, u8 *buf)
+{
+	int retryCount = 0;
+
+	while (!sdmmc_storage_write(&sd_storage, sd_sector_off + lba, num, buf))
+	{
+		s_printf(gui->txt_buf,
+			"\n#FFDD00 Error writing %d blocks @LBA %08X,#\n"
+			"#FFDD00 to SD (try %d). #",
+			num, lba, ++retryCount);
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+
+		msleep(150);
+		if (retryCount >= 3)
+		{
+			s_printf(gui->txt_buf, "#FF0000 Aborting...#\nPlease try again...\n");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			return 0;
+		}
+		else
+		{
+			s_printf(gui->txt_buf, "#FFDD00 Retrying...#\n");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+		}
+	}
+
+	return 1;
+}
+
+static void _emummc_raw_drain(bool rd_busy, bool wr_busy)
+{
+	// Let in-flight transfers finish before leaving.
+	while (rd_busy && sdmmc_storage_xfer_poll(&emmc_storage) == SDMMC_XFER_PENDING)
+		;
+	while (wr_busy && sdmmc_storage_xfer_poll(&sd_storage) == SDMMC_XFER_PENDING)
+		;
+}
+
 static int _dump_emummc_raw_part(emmc_tool_gui_t *gui, int active_part, int part_idx, u32 sd_part_off, emmc_part_t *part, u32 resized_count)
 {
-	u32 num = 0;
 	u32 pct = 0;
 	u32 prevPct = 200;
-	int retryCount = 0;
 	u32 sd_sector_off = sd_part_off + (0x2000 * active_part);
 	u32 lba_curr = part->lba_start;
 	u8 *buf = (u8 *)MIXD_BUF_ALIGNED;
@@ -554,12 +917,21 @@ static int _dump_emummc_raw_part(emmc_tool_gui_t *gui, int active_part, int part
 		emmc_gpt_free(&gpt_parsed);
 	}
 
-	u32 totalSectors = part->lba_end - part->lba_start + 1;
-	while (totalSectors > 0)
+	// eMMC reads fill a ring of buffers while SD writes drain it. Both controllers work in parallel.
+	emummc_clone_slot_t slots[CLONE_RING_SLOTS];
+	u32 lba_end = part->lba_end + 1;
+	u32 rd_idx = 0;
+	u32 wr_idx = 0;
+	u32 filled = 0;
+	bool rd_busy = false;
+	bool wr_busy = false;
+	while (lba_curr < lba_end || filled || rd_busy)
 	{
 		// Check for cancellation combo.
 		if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
 		{
+			_emummc_raw_drain(rd_busy, wr_busy);
+
 			s_printf(gui->txt_buf, "\n#FFDD00 The emuMMC was cancelled!#\n");
 			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
 			manual_system_maintenance(true);
@@ -569,69 +941,94 @@ static int _dump_emummc_raw_part(emmc_tool_gui_t *gui, int active_part, int part
 			return 0;
 		}
 
-		retryCount = 0;
-		num = MIN(totalSectors, NUM_SECTORS_PER_ITER);
-
 		// Read data from eMMC.
-		while (!sdmmc_storage_read(&emmc_storage, lba_curr, num, buf))
+		bool rd_done = false;
+		if (rd_busy)
 		{
-			s_printf(gui->txt_buf,
-				"\n#FFDD00 Error reading %d blocks @LBA %08X,#\n"
-				"#FFDD00 from eMMC (try %d). #",
-				num, lba_curr, ++retryCount);
-			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-			manual_system_maintenance(true);
-
-			msleep(150);
-			if (retryCount >= 3)
+			int res = sdmmc_storage_xfer_poll(&emmc_storage);
+			if (res != SDMMC_XFER_PENDING)
 			{
-				s_printf(gui->txt_buf, "#FF0000 Aborting...#\nPlease try again...\n");
-				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-				manual_system_maintenance(true);
+				rd_busy = false;
 
-				return 0;
+				// Retry failed transfers with the full error handling.
+				emummc_clone_slot_t *slot = &slots[rd_idx];
+				if (res == SDMMC_XFER_ERROR && !_emummc_raw_read(gui, slot->lba, slot->num, CLONE_RING_BUF(rd_idx)))
+				{
+					_emummc_raw_drain(false, wr_busy);
+					return 0;
+				}
+				rd_done = true;
 			}
-			else
+		}
+		else if (lba_curr < lba_end && filled < CLONE_RING_SLOTS)
+		{
+			// Skip free space of SYSTEM and USER.
+			bool used;
+			u32 num = _emummc_alloc_run(lba_curr, MIN(lba_end - lba_curr, NUM_SECTORS_PER_ITER), ALLOC_RAW_ALIGN, &used);
+			if (used)
 			{
-				s_printf(gui->txt_buf, "#FFDD00 Retrying...#\n");
-				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-				manual_system_maintenance(true);
+				slots[rd_idx].lba = lba_curr;
+				slots[rd_idx].num = num;
+				rd_busy = sdmmc_storage_xfer_start(&emmc_storage, lba_curr, num, CLONE_RING_BUF(rd_idx), 0);
+				if (!rd_busy)
+				{
+					if (!_emummc_raw_read(gui, lba_curr, num, CLONE_RING_BUF(rd_idx)))
+					{
+						_emummc_raw_drain(false, wr_busy);
+						return 0;
+					}
+					rd_done = true;
+				}
 			}
+			lba_curr += num;
 		}
 
-		manual_system_maintenance(false);
+		if (rd_done)
+		{
+			rd_idx = (rd_idx + 1) % CLONE_RING_SLOTS;
+			filled++;
+		}
 
 		// Write data to SD card.
-		retryCount = 0;
-		while (!sdmmc_storage_write(&sd_storage, sd_sector_off + lba_curr, num, buf))
+		bool wr_done = false;
+		emummc_clone_slot_t *slot = &slots[wr_idx];
+		if (wr_busy)
 		{
-			s_printf(gui->txt_buf,
-				"\n#FFDD00 Error writing %d blocks @LBA %08X,#\n"
-				"#FFDD00 to SD (try %d). #",
-				num, lba_curr, ++retryCount);
-			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-			manual_system_maintenance(true);
-
-			msleep(150);
-			if (retryCount >= 3)
+			int res = sdmmc_storage_xfer_poll(&sd_storage);
+			if (res != SDMMC_XFER_PENDING)
 			{
-				s_printf(gui->txt_buf, "#FF0000 Aborting...#\nPlease try again...\n");
-				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-				manual_system_maintenance(true);
+				wr_busy = false;
 
-				return 0;
+				// Retry failed transfers with the full error handling.
+				if (res == SDMMC_XFER_ERROR && !_emummc_raw_write(gui, sd_sector_off, slot->lba, slot->num, CLONE_RING_BUF(wr_idx)))
+				{
+					_emummc_raw_drain(rd_busy, false);
+					return 0;
+				}
+				wr_done = true;
 			}
-			else
+		}
+		else if (filled)
+		{
+			wr_busy = sdmmc_storage_xfer_start(&sd_storage, sd_sector_off + slot->lba, slot->num, CLONE_RING_BUF(wr_idx), 1);
+			if (!wr_busy)
 			{
-				s_printf(gui->txt_buf, "#FFDD00 Retrying...#\n");
-				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-				manual_system_maintenance(true);
+				if (!_emummc_raw_write(gui, sd_sector_off, slot->lba, slot->num, CLONE_RING_BUF(wr_idx)))
+				{
+					_emummc_raw_drain(rd_busy, false);
+					return 0;
+				}
+				wr_done = true;
 			}
 		}
 
-		manual_system_maintenance(false);
+		if (!wr_done)
+			continue;
 
-		pct = (u64)((u64)(lba_curr - part->lba_start) * 100u) / (u64)(part->lba_end - part->lba_start);
+		wr_idx = (wr_idx + 1) % CLONE_RING_SLOTS;
+		filled--;
+
+		pct = (u64)((u64)(slot->lba - part->lba_start) * 100u) / (u64)(part->lba_end - part->lba_start);
 		if (pct != prevPct)
 		{
 			lv_bar_set_value(gui->bar, pct);
@@ -641,9 +1038,8 @@ static int _dump_emummc_raw_part(emmc_tool_gui_t *gui, int active_part, int part
 
 			prevPct = pct;
 		}
-
-		lba_curr += num;
-		totalSectors -= num;
+		else
+			manual_system_maintenance(false);
 	}
 	lv_bar_set_value(gui->bar, 100);
 	lv_label_set_text(gui->label_pct, " "SYMBOL_DOT" 100%");
@@ -766,80 +1162,6 @@ static int _dump_emummc_raw_part(emmc_tool_gui_t *gui, int active_part, int part
 	return 1;
 }
 
-static int _emummc_raw_derive_bis_keys(emmc_tool_gui_t *gui, u32 resized_count)
-{
-	if (!resized_count)
-		return 1;
-
-	bool error = false;
-
-	char *txt_buf = (char *)malloc(SZ_16K);
-	txt_buf[0] = 0;
-
-	// Generate BIS keys.
-	hos_bis_keygen();
-
-	u8 *cal0_buf = malloc(SZ_64K);
-
-	// Read and decrypt CAL0 for validation of working BIS keys.
-	emmc_set_partition(EMMC_GPP);
-	LIST_INIT(gpt);
-	emmc_gpt_parse(&gpt);
-	emmc_part_t *cal0_part = emmc_part_find(&gpt, "PRODINFO"); // check if null
-	nx_emmc_bis_init(cal0_part, false, 0);
-	nx_emmc_bis_read(0, 0x40, cal0_buf);
-	nx_emmc_bis_end();
-	emmc_gpt_free(&gpt);
-
-	nx_emmc_cal0_t *cal0 = (nx_emmc_cal0_t *)cal0_buf;
-
-	// Check keys validity.
-	if (memcmp(&cal0->magic, "CAL0", 4))
-	{
-		// Clear EKS keys.
-		hos_eks_clear(HOS_KB_VERSION_MAX);
-
-		strcpy(txt_buf, "#FFDD00 BIS keys validation failed!#\n");
-		error = true;
-	}
-
-	free(cal0_buf);
-
-	if (error)
-	{
-		lv_obj_t *dark_bg = lv_obj_create(lv_scr_act(), NULL);
-		lv_obj_set_style(dark_bg, &mbox_darken);
-		lv_obj_set_size(dark_bg, LV_HOR_RES, LV_VER_RES);
-
-		static const char * mbox_btn_map[] = { "\251", "\222Close", "\251", "" };
-		lv_obj_t * mbox = lv_mbox_create(dark_bg, NULL);
-		lv_mbox_set_recolor_text(mbox, true);
-		lv_obj_set_width(mbox, LV_HOR_RES / 9 * 5);
-
-		lv_mbox_set_text(mbox, "#C7EA46 BIS Keys Generation#");
-
-		lv_obj_t * lb_desc = lv_label_create(mbox, NULL);
-		lv_label_set_long_mode(lb_desc, LV_LABEL_LONG_BREAK);
-		lv_label_set_recolor(lb_desc, true);
-		lv_label_set_style(lb_desc, &monospace_text);
-		lv_obj_set_width(lb_desc, LV_HOR_RES / 9 * 4);
-
-		lv_label_set_text(lb_desc, txt_buf);
-		lv_mbox_add_btns(mbox, mbox_btn_map, mbox_action);
-
-		lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
-		lv_obj_set_top(mbox, true);
-
-		free(txt_buf);
-
-		return 0;
-	}
-
-	free(txt_buf);
-
-	return 1;
-}
-
 void dump_emummc_raw(emmc_tool_gui_t *gui, int part_idx, u32 sector_start, u32 resized_count)
 {
 	int res = 0;
@@ -866,9 +1188,12 @@ void dump_emummc_raw(emmc_tool_gui_t *gui, int part_idx, u32 sector_start, u32 r
 		goto out;
 	}
 
-	if (!_emummc_raw_derive_bis_keys(gui, resized_count))
+	if (!_emummc_derive_bis_keys(gui, resized_count || gui->alloc_only))
 	{
-		s_printf(gui->txt_buf, "#FFDD00 For formatting USER partition,#\n#FFDD00 BIS keys are needed!#\n");
+		if (resized_count)
+			s_printf(gui->txt_buf, "#FFDD00 For formatting USER partition,#\n#FFDD00 BIS keys are needed!#\n");
+		else
+			s_printf(gui->txt_buf, "#FFDD00 For copying only used data,#\n#FFDD00 BIS keys are needed!#\n");
 		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
 		emmc_end();
 		goto out;
@@ -941,11 +1266,16 @@ void dump_emummc_raw(emmc_tool_gui_t *gui, int part_idx, u32 sector_start, u32 r
 		s_printf(txt_buf, "#00DDFF %02d: %s#\n#00DDFF Range: 0x%08X - 0x%08X#\n\n",
 			i, rawPart.name, rawPart.lba_start, rawPart.lba_end);
 		lv_label_set_text(gui->label_info, txt_buf);
+
+		// USER gets formatted when resized, so only SYSTEM is mapped.
+		_emummc_alloc_map_init(gui, !resized_count);
+
 		s_printf(txt_buf, "%02d: %s... ", i, rawPart.name);
 		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, txt_buf);
 		manual_system_maintenance(true);
 
 		res = _dump_emummc_raw_part(gui, 2, part_idx, sector_start, &rawPart, resized_count);
+		_emummc_alloc_map_end();
 
 		if (!res)
 			s_printf(txt_buf, "#FFDD00 Failed!#\n");
@@ -960,6 +1290,9 @@ out_failed:
 	timer = get_tmr_s() - timer;
 	emmc_end();
 
+	if (gui->alloc_only)
+		hos_bis_keys_clear();
+
 	if (res)
 	{
 		s_printf(txt_buf, "Time taken: %dm %ds.\nFinished!", timer / 60, timer % 60);
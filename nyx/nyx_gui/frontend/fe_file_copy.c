@@ -0,0 +1,427 @@
+/*
+ * File copy engine
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <bdk.h>
+
+#include "gui.h"
+#include "fe_file_copy.h"
+#include <libs/fatfs/ff.h>
+
+//#define DPRINTF(...) gfx_printf(__VA_ARGS__)
+#define DPRINTF(...)
+
+// Small files are gathered in the lower half and large files stream through the upper.
+#define COPY_BATCH_BUF      ((u8 *)SDXC_BUF_ALIGNED)
+#define  COPY_BATCH_BUF_SZ  SZ_8M
+#define COPY_CHUNK_BUF      ((u8 *)SDXC_BUF_ALIGNED + COPY_BATCH_BUF_SZ)
+#define  COPY_CHUNK_SZ      SZ_8M
+
+#define COPY_BATCH_FILES    128
+#define COPY_BATCH_FILE_MAX SZ_256K
+#define COPY_CLTBL_SZ       SZ_64K
+#define COPY_UI_UPDATE_MS   100
+
+static void _file_copy_ui_update(file_copy_ctxt_t *ctxt, const char *dir, const char *file, bool force)
+{
+	if (!ctxt->labels)
+		return;
+
+	// Throttle label updates and redraws.
+	u32 time = get_tmr_ms();
+	if (!force && (time - ctxt->ui_time) < COPY_UI_UPDATE_MS)
+		return;
+	ctxt->ui_time = time;
+
+	if (dir)
+		lv_label_set_text(ctxt->labels[0], dir);
+	if (file)
+		lv_label_set_text(ctxt->labels[1], file);
+	manual_system_maintenance(true);
+}
+
+static int _file_copy_batch_flush(file_copy_ctxt_t *ctxt)
+{
+	FIL fp;
+	UINT bw;
+	int res = FR_OK;
+
+	if (!ctxt->batch_cnt)
+		return FR_OK;
+
+	// Write all gathered files in one go.
+	f_chdrive(ctxt->dst);
+	for (u32 i = 0; i < ctxt->batch_cnt; i++)
+	{
+		file_copy_batch_t *entry = &ctxt->batch[i];
+
+		// Nothing more fits once destination is full.
+		if (res == FR_DENIED)
+		{
+			ctxt->failed_files++;
+			free(entry->path);
+			continue;
+		}
+
+		res = f_open(&fp, entry->path, FA_CREATE_ALWAYS | FA_WRITE);
+		if (res == FR_OK)
+		{
+			res = f_write(&fp, COPY_BATCH_BUF + entry->offset, entry->size, &bw);
+			if (res == FR_OK && bw != entry->size)
+				res = FR_DENIED;
+			f_close(&fp);
+			f_chmod(entry->path, entry->attr, 0xFF);
+		}
+		if (res != FR_OK)
+			ctxt->failed_files++;
+
+		free(entry->path);
+	}
+	f_chdrive(ctxt->src);
+
+DPRINTF("Flushed %d files (%d KB)\n", ctxt->batch_cnt, ctxt->batch_size >> 10);
+
+	ctxt->batch_cnt  = 0;
+	ctxt->batch_size = 0;
+
+	// Other errors are counted per file.
+	return res == FR_DENIED ? FR_DENIED : FR_OK;
+}
+
+static int _file_copy_small(file_copy_ctxt_t *ctxt, const char *path, u32 size, u8 attr)
+{
+	FIL fp;
+	UINT br;
+	int res;
+
+	// Keep buffers DMA aligned.
+	u32 size_aligned = ALIGN(size, 64);
+	if (ctxt->batch_cnt == COPY_BATCH_FILES || (ctxt->batch_size + size_aligned) > COPY_BATCH_BUF_SZ)
+	{
+		res = _file_copy_batch_flush(ctxt);
+		if (res)
+			return res;
+	}
+
+	res = f_open(&fp, path, FA_READ);
+	if (res)
+		return res;
+	res = f_read(&fp, COPY_BATCH_BUF + ctxt->batch_size, size, &br);
+	f_close(&fp);
+	if (res == FR_OK && br != size)
+		res = FR_DENIED;
+	if (res)
+		return res;
+
+	file_copy_batch_t *entry = &ctxt->batch[ctxt->batch_cnt];
+	entry->path   = (char *)malloc(strlen(path) + 1);
+	entry->offset = ctxt->batch_size;
+	entry->size   = size;
+	entry->attr   = attr;
+	strcpy(entry->path, path);
+
+	ctxt->batch_cnt++;
+	ctxt->batch_size += size_aligned;
+
+	return FR_OK;
+}
+
+static int _file_copy_mapped(FIL *fp_src, FIL *fp_dst, u32 size, bool fast_dst, void **data)
+{
+	UINT bytes;
+
+	// Ramdisk files get accessed in place, so data is copied only once.
+	int res = f_map_fast(fp_dst, size, FA_WRITE, data);
+	if (res)
+		return res;
+	if (*data)
+		return f_read_fast(fp_src, *data, size);
+
+	res = f_map_fast(fp_src, size, FA_READ, data);
+	if (res || !*data)
+		return res;
+
+	if (fast_dst)
+		return f_write_fast(fp_dst, *data, size);
+
+	res = f_write(fp_dst, *data, size, &bytes);
+	if (!res && bytes != size)
+		res = FR_DENIED;
+
+	return res;
+}
+
+static int _file_copy_large(file_copy_ctxt_t *ctxt, const char *path, u32 size, u8 attr)
+{
+	FIL fp_src;
+	FIL fp_dst;
+	UINT bytes;
+	int res;
+
+	res = f_open(&fp_src, path, FA_READ);
+	if (res)
+		return res;
+
+	f_chdrive(ctxt->dst);
+	res = f_open(&fp_dst, path, FA_CREATE_ALWAYS | FA_WRITE);
+	f_chdrive(ctxt->src);
+	if (res)
+	{
+		f_close(&fp_src);
+		return res;
+	}
+
+	// Allocate all destination clusters at once and get cluster tables for fast transfers.
+	DWORD *clmt_src = f_expand_cltbl(&fp_src, COPY_CLTBL_SZ, 0);
+	DWORD *clmt_dst = f_expand_cltbl(&fp_dst, COPY_CLTBL_SZ, size);
+	if (f_size(&fp_dst) != size)
+	{
+		res = FR_DENIED;
+		goto out;
+	}
+
+	u32 csize_src = fp_src.obj.fs->csize * SD_BLOCKSIZE;
+	u32 csize_dst = fp_dst.obj.fs->csize * SD_BLOCKSIZE;
+	u32 bytes_left = size;
+	while (bytes_left)
+	{
+		u32 chunk_size = MIN(bytes_left, COPY_CHUNK_SZ);
+		void *data = NULL;
+
+		res = _file_copy_mapped(&fp_src, &fp_dst, chunk_size, clmt_dst && chunk_size > csize_dst, &data);
+		if (!res && !data)
+		{
+			// Fast transfers need whole clusters. Tails smaller than a cluster go through the file cache.
+			if (clmt_src && clmt_dst && chunk_size > csize_src && chunk_size > csize_dst)
+			{
+				res = f_read_fast(&fp_src, COPY_CHUNK_BUF, chunk_size);
+				if (!res)
+					res = f_write_fast(&fp_dst, COPY_CHUNK_BUF, chunk_size);
+			}
+			else
+			{
+				res = f_read(&fp_src, COPY_CHUNK_BUF, chunk_size, &bytes);
+				if (!res && bytes != chunk_size)
+					res = FR_DENIED;
+				if (!res)
+					res = f_write(&fp_dst, COPY_CHUNK_BUF, chunk_size, &bytes);
+				if (!res && bytes != chunk_size)
+					res = FR_DENIED;
+			}
+		}
+		if (res)
+			break;
+
+		bytes_left -= chunk_size;
+
+		_file_copy_ui_update(ctxt, NULL, NULL, false);
+	}
+
+out:
+	f_close(&fp_dst);
+	f_close(&fp_src);
+	free(clmt_src);
+	free(clmt_dst);
+
+	if (res == FR_OK)
+	{
+		f_chdrive(ctxt->dst);
+		f_chmod(path, attr, 0xFF);
+		f_chdrive(ctxt->src);
+	}
+
+	return res;
+}
+
+static int _file_copy(file_copy_ctxt_t *ctxt, const char *path, u32 size, u8 attr)
+{
+	int res;
+
+	if (size <= COPY_BATCH_FILE_MAX)
+		res = _file_copy_small(ctxt, path, size, attr);
+	else
+		res = _file_copy_large(ctxt, path, size, attr);
+
+	// Short writes and failed allocations mean destination is full. Only that stops the copy.
+	if (res == FR_DENIED)
+		return res;
+
+	if (res != FR_OK)
+		ctxt->failed_files++;
+
+	return FR_OK;
+}
+
+static int _file_copy_account(file_copy_ctxt_t *ctxt, u32 size)
+{
+	u32 file_size = MAX(size, ctxt->min_file_size);
+
+	// Check for overflow.
+	if ((file_size + ctxt->total_size) < ctxt->total_size)
+	{
+		// Set size to > 1GB, skip next folders and return.
+		ctxt->total_size = SZ_2G;
+		return -1;
+	}
+
+	ctxt->total_size += file_size;
+	ctxt->total_files++;
+
+	return 0;
+}
+
+void file_copy_init(file_copy_ctxt_t *ctxt, const char *src, const char *dst, lv_obj_t **labels)
+{
+	memset(ctxt, 0, sizeof(file_copy_ctxt_t));
+
+	ctxt->src    = src;
+	ctxt->dst    = dst;
+	ctxt->labels = labels;
+
+	if (dst)
+		ctxt->batch = (file_copy_batch_t *)malloc(sizeof(file_copy_batch_t) * COPY_BATCH_FILES);
+}
+
+int file_copy_dir(file_copy_ctxt_t *ctxt, char *path)
+{
+	FRESULT res;
+	DIR dir;
+	u32 dirLength = 0;
+	static FILINFO fno;
+
+	f_chdrive(ctxt->src);
+
+	// Open directory.
+	res = f_opendir(&dir, path);
+	if (res != FR_OK)
+		return res;
+
+	_file_copy_ui_update(ctxt, path, NULL, false);
+
+	dirLength = strlen(path);
+
+	// Hard limit path to 1024 characters. Do not result to error.
+	if (dirLength > 1024)
+		goto out;
+
+	for (;;)
+	{
+		// Clear file path.
+		path[dirLength] = 0;
+
+		// Read a directory item.
+		res = f_readdir(&dir, &fno);
+
+		// Break on error or end of dir.
+		if (res != FR_OK || fno.fname[0] == 0)
+			break;
+
+		// Set new directory or file.
+		memcpy(&path[dirLength], "/", 1);
+		strcpy(&path[dirLength + 1], fno.fname);
+
+		_file_copy_ui_update(ctxt, NULL, fno.fname, false);
+
+		// Copy file to destination disk.
+		if (!(fno.fattrib & AM_DIR))
+		{
+			res = _file_copy_account(ctxt, fno.fsize);
+			if (res)
+				break;
+
+			if (ctxt->dst)
+			{
+				res = _file_copy(ctxt, path, fno.fsize, fno.fattrib);
+				if (res)
+					break;
+			}
+
+			// If total is over the limit exit.
+			if (ctxt->max_total_size && ctxt->total_size > ctxt->max_total_size)
+			{
+				// Skip next folders and return.
+				res = -1;
+				break;
+			}
+		}
+		else // It's a directory.
+		{
+			if (!memcmp("System Volume Information", fno.fname, 25))
+				continue;
+
+			// Create folder to destination.
+			if (ctxt->dst)
+			{
+				f_chdrive(ctxt->dst);
+				f_mkdir(path);
+				f_chmod(path, fno.fattrib, 0xFF);
+				f_chdrive(ctxt->src);
+			}
+
+			// Enter the directory. Folders that fail to open or list count as one failed file.
+			res = file_copy_dir(ctxt, path);
+			if (res == FR_DENIED || (int)res == -1)
+				break;
+			if (res != FR_OK)
+			{
+				ctxt->failed_files++;
+				res = FR_OK;
+			}
+
+			// Clear folder path.
+			path[dirLength] = 0;
+			_file_copy_ui_update(ctxt, path, NULL, false);
+		}
+	}
+
+out:
+	f_closedir(&dir);
+
+	return res;
+}
+
+int file_copy_file(file_copy_ctxt_t *ctxt, const char *path)
+{
+	FILINFO fno;
+
+	f_chdrive(ctxt->src);
+	int res = f_stat(path, &fno);
+	if (res)
+		return res;
+
+	res = _file_copy_account(ctxt, fno.fsize);
+	if (res || !ctxt->dst)
+		return res;
+
+	return _file_copy(ctxt, path, fno.fsize, fno.fattrib);
+}
+
+int file_copy_end(file_copy_ctxt_t *ctxt)
+{
+	int res = FR_OK;
+
+	if (ctxt->dst)
+		res = _file_copy_batch_flush(ctxt);
+
+	free(ctxt->batch);
+	ctxt->batch = NULL;
+
+	return res;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FE_FILE_COPY_H_
+#define _FE_FILE_COPY_H_
+
+#include <libs/lvgl/lvgl.h>
+#include <utils/types.h>
+
+typedef struct _file_copy_batch_t
+{
+	char *path;
+	u32   offset;
+	u32   size;
+	u8    attr;
+} file_copy_batch_t;
+
+typedef struct _file_copy_ctxt_t
+{
+	const char *src;    // Source drive.
+	const char *dst;    // Destination drive. NULL only gathers stats.
+	lv_obj_t  **labels; // Current folder and file labels. Optional.
+
+	u32 min_file_size;  // Minimum size a file accounts for.
+	u32 max_total_size; // Copy stops with -1 when exceeded. 0 for no limit.
+	u32 total_files;
+	u32 total_size;
+	u32 failed_files;   // Files that failed to copy. Copy goes on, unless destination is full.
+
+	u32 ui_time;
+	file_copy_batch_t *batch;
+	u32 batch_cnt;
+	u32 batch_size;
+} file_copy_ctxt_t;
+
+void file_copy_init(file_copy_ctxt_t *ctxt, const char *src, const char *dst, lv_obj_t **labels);
+int  file_copy_dir(file_copy_ctxt_t *ctxt, char *path);
+int  file_copy_file(file_copy_ctxt_t *ctxt, const char *path);
+int  file_copy_end(file_copy_ctxt_t *ctxt);
+
+#endif
@@ -36,6 +36,7 @@ typedef struct _mbr_ctxt_t
 } mbr_ctxt_t;
 
 static bool emummc_backup;
+static bool emummc_alloc_only;
 static mbr_ctxt_t mbr_ctx;
 static lv_obj_t *emummc_manage_window;
 static lv_res_t (*emummc_tools)(lv_obj_t *btn);
@@ -131,6 +132,7 @@ static void _create_window_emummc()
 	lv_obj_set_style(label_finish, lv_theme_get_current()->label.prim);
 	lv_obj_align(label_finish, bar, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI * 9 / 20);
 	emmc_tool_gui_ctxt.label_finish = label_finish;
+	emmc_tool_gui_ctxt.alloc_only = emummc_alloc_only;
 
 	if (!mbr_ctx.part_idx)
 		dump_emummc_file(&emmc_tool_gui_ctxt);
@@ -334,6 +336,15 @@ static lv_res_t _create_emummc_action(lv_obj_t * btns, const char * txt)
 	return LV_RES_INV;
 }
 
+static lv_res_t _emummc_alloc_only_toggle(lv_obj_t *btn)
+{
+	nyx_generic_onoff_toggle(btn);
+
+	emummc_alloc_only = lv_btn_get_state(btn) & LV_BTN_STATE_TGL_REL ? 1 : 0;
+
+	return LV_RES_OK;
+}
+
 static lv_res_t _create_mbox_emummc_create(lv_obj_t *btn)
 {
 	if (!nyx_emmc_check_battery_enough())
@@ -352,7 +363,18 @@ static lv_res_t _create_mbox_emummc_create(lv_obj_t *btn)
 		"Welcome to #C7EA46 emuMMC# creation tool!\n\n"
 		"Please choose what type of emuMMC you want to create.\n"
 		"#FF8000 SD File# is saved as files in the FAT partition.\n"
-		"#FF8000 SD Partition# is saved as raw image in an available partition.");
+		"#FF8000 SD Partition# is saved as raw image in an available partition.\n"
+		"#FF8000 Used Data Only# skips the free space of SYSTEM and USER.");
+
+	// Create used data only button.
+	lv_obj_t *btn_alloc_only = lv_btn_create(mbox, NULL);
+	nyx_create_onoff_button(lv_theme_get_current(), mbox,
+		btn_alloc_only, SYMBOL_COPY" Used Data Only", _emummc_alloc_only_toggle, false);
+	if (emummc_alloc_only)
+	{
+		lv_btn_set_state(btn_alloc_only, LV_BTN_STATE_TGL_REL);
+		nyx_generic_onoff_toggle(btn_alloc_only);
+	}
 
 	lv_mbox_add_btns(mbox, mbox_btn_map, _create_emummc_action);
 
@@ -749,7 +771,7 @@ static lv_res_t _create_emummc_migrate_action(lv_obj_t * btns, const char * txt)
 
 typedef struct _emummc_images_t
 {
-	char *dirlist;
+	dirlist_t *dirlist;
 	u32 part_sector[3];
 	u32 part_type[3];
 	u32 part_end[3];
@@ -999,7 +1021,7 @@ static lv_res_t _create_change_emummc_window(lv_obj_t *btn_caller)
 	}
 	free(mbr);
 
-	emummc_img->dirlist = dirlist("emuMMC", NULL, false, true);
+	emummc_img->dirlist = dirlist("emuMMC", NULL, DIR_SHOW_DIRS);
 
 	if (!emummc_img->dirlist)
 		goto out0;
@@ -1009,9 +1031,9 @@ static lv_res_t _create_change_emummc_window(lv_obj_t *btn_caller)
 	FIL fp;
 
 	// Check for sd raw partitions, based on the folders in /emuMMC.
-	while (emummc_img->dirlist[emummc_idx * 256])
+	while (emummc_img->dirlist->name[emummc_idx])
 	{
-		s_printf(path, "emuMMC/%s/raw_based", &emummc_img->dirlist[emummc_idx * 256]);
+		s_printf(path, "emuMMC/%s/raw_based", emummc_img->dirlist->name[emummc_idx]);
 
 		if (!f_stat(path, NULL))
 		{
@@ -1024,21 +1046,21 @@ static lv_res_t _create_change_emummc_window(lv_obj_t *btn_caller)
 			if ((curr_list_sector == 2) || (emummc_img->part_sector[0] && curr_list_sector >= emummc_img->part_sector[0] &&
 				curr_list_sector < emummc_img->part_end[0] && emummc_img->part_type[0] != 0x83))
 			{
-				s_printf(&emummc_img->part_path[0], "emuMMC/%s", &emummc_img->dirlist[emummc_idx * 256]);
+				s_printf(&emummc_img->part_path[0], "emuMMC/%s", emummc_img->dirlist->name[emummc_idx]);
 				emummc_img->part_sector[0] = curr_list_sector;
 				emummc_img->part_end[0] = 0;
 			}
 			else if (emummc_img->part_sector[1] && curr_list_sector >= emummc_img->part_sector[1] &&
 				curr_list_sector < emummc_img->part_end[1] && emummc_img->part_type[1] != 0x83)
 			{
-				s_printf(&emummc_img->part_path[1 * 128], "emuMMC/%s", &emummc_img->dirlist[emummc_idx * 256]);
+				s_printf(&emummc_img->part_path[1 * 128], "emuMMC/%s", emummc_img->dirlist->name[emummc_idx]);
 				emummc_img->part_sector[1] = curr_list_sector;
 				emummc_img->part_end[1] = 0;
 			}
 			else if (emummc_img->part_sector[2] && curr_list_sector >= emummc_img->part_sector[2] &&
 				curr_list_sector < emummc_img->part_end[2] && emummc_img->part_type[2] != 0x83)
 			{
-				s_printf(&emummc_img->part_path[2 * 128], "emuMMC/%s", &emummc_img->dirlist[emummc_idx * 256]);
+				s_printf(&emummc_img->part_path[2 * 128], "emuMMC/%s", emummc_img->dirlist->name[emummc_idx]);
 				emummc_img->part_sector[2] = curr_list_sector;
 				emummc_img->part_end[2] = 0;
 			}
@@ -1050,19 +1072,19 @@ static lv_res_t _create_change_emummc_window(lv_obj_t *btn_caller)
 	u32 file_based_idx = 0;
 
 	// Sanitize the directory list with sd file based ones.
-	while (emummc_img->dirlist[emummc_idx * 256])
+	while (emummc_img->dirlist->name[emummc_idx])
 	{
-		s_printf(path, "emuMMC/%s/file_based", &emummc_img->dirlist[emummc_idx * 256]);
+		s_printf(path, "emuMMC/%s/file_based", emummc_img->dirlist->name[emummc_idx]);
 
 		if (!f_stat(path, NULL))
 		{
-			char *tmp = &emummc_img->dirlist[emummc_idx * 256];
-			memcpy(&emummc_img->dirlist[file_based_idx * 256], tmp, strlen(tmp) + 1);
+			emummc_img->dirlist->name[file_based_idx] = emummc_img->dirlist->name[emummc_idx];
 			file_based_idx++;
 		}
 		emummc_idx++;
 	}
-	emummc_img->dirlist[file_based_idx * 256] = 0;
+	emummc_img->dirlist->name[file_based_idx] = NULL;
+	emummc_img->dirlist->count = file_based_idx;
 
 out0:;
 	static lv_style_t h_style;
@@ -1179,9 +1201,9 @@ out0:;
 	emummc_idx = 0;
 
 	// Add file based to the list.
-	while (emummc_img->dirlist[emummc_idx * 256])
+	while (emummc_img->dirlist->name[emummc_idx])
 	{
-		s_printf(path, "emuMMC/%s", &emummc_img->dirlist[emummc_idx * 256]);
+		s_printf(path, "emuMMC/%s", emummc_img->dirlist->name[emummc_idx]);
 
 		lv_list_add(list_sd_based, NULL, path, _save_file_emummc_cfg_action);
 
@@ -19,6 +19,7 @@
 #include <bdk.h>
 
 #include "gui.h"
+#include "fe_benchmark.h"
 #include "../config.h"
 #include "../hos/hos.h"
 #include "../hos/pkg1.h"
@@ -1282,7 +1283,34 @@ out:
 	return LV_RES_OK;
 }
 
-static lv_res_t _create_mbox_benchmark(bool sd_bench)
+typedef struct _benchmark_ui_t
+{
+	lv_obj_t *bar;
+	u32 render_timer;
+	u32 prev_pct;
+} benchmark_ui_t;
+
+static int _benchmark_progress(void *data, u32 pct)
+{
+	benchmark_ui_t *ui = (benchmark_ui_t *)data;
+
+	manual_system_maintenance(false);
+
+	if (pct == ui->prev_pct || ui->render_timer > get_tmr_ms())
+		return 0;
+
+	lv_bar_set_value(ui->bar, pct);
+	manual_system_maintenance(true);
+	ui->render_timer = get_tmr_ms() + 66;
+	ui->prev_pct = pct;
+
+	if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
+		return -1;
+
+	return 0;
+}
+
+static lv_res_t _create_mbox_benchmark(bool sd_bench, bool raw_write)
 {
 	sdmmc_storage_t *storage;
 
@@ -1297,8 +1325,9 @@ static lv_res_t _create_mbox_benchmark(bool sd_bench)
 
 	char *txt_buf = (char *)malloc(SZ_16K);
 
-	s_printf(txt_buf, "#FF8000 %s Benchmark#\n[Raw Reads] Abort: VOL- & VOL+",
-		sd_bench ? "SD Card" : "eMMC");
+	s_printf(txt_buf, "#FF8000 %s Benchmark#\n[%s] Abort: VOL- & VOL+",
+		sd_bench ? "SD Card" : "eMMC", sd_bench ? (raw_write ? "Raw & File Workloads" : "Raw Read & File Workloads") :
+		(raw_write ? "Raw Workloads" : "Raw Read Workloads"));
 
 	lv_mbox_set_text(mbox, txt_buf);
 	txt_buf[0] = 0;
@@ -1348,194 +1377,105 @@ static lv_res_t _create_mbox_benchmark(bool sd_bench)
 	}
 
 	int error = 0;
-	u32 iters = 3;
-	u32 offset_chunk_start = ALIGN_DOWN(storage->sec_cnt / 3, 0x8000); // Align to 16MB.
-	if (storage->sec_cnt < 0xC00000)
-		iters -= 2; // 4GB card.
-
-	for (u32 iter_curr = 0; iter_curr < iters; iter_curr++)
-	{
-		u32 pct = 0;
-		u32 prevPct = 200;
-		u32 timer = 0;
-		u32 lba_curr = 0;
-		u32 sector = offset_chunk_start * iter_curr;
-		u32 sector_num = 0x8000;       // 16MB chunks.
-		u32 data_remaining = 0x200000; // 1GB.
-
-		s_printf(txt_buf + strlen(txt_buf), "#C7EA46 %d/3# - Sector Offset #C7EA46 %08X#:\n", iter_curr + 1, sector);
-
-		u32 render_min_ms = 66;
-		u32 render_timer  = get_tmr_ms() + render_min_ms;
-		while (data_remaining)
-		{
-			u32 time_taken = get_tmr_us();
-			error = !sdmmc_storage_read(storage, sector + lba_curr, sector_num, (u8 *)MIXD_BUF_ALIGNED);
-			time_taken = get_tmr_us() - time_taken;
-			timer += time_taken;
+	u32 results_cnt = 0;
+	u32 workloads_cnt = 0;
+	while (bench_workloads[workloads_cnt].name)
+		workloads_cnt++;
 
-			manual_system_maintenance(false);
-			data_remaining -= sector_num;
-			lba_curr += sector_num;
+	bench_result_t *results = (bench_result_t *)zalloc(sizeof(bench_result_t) * workloads_cnt);
+	bench_ctxt_t *bench = (bench_ctxt_t *)zalloc(sizeof(bench_ctxt_t));
+	benchmark_ui_t ui;
 
-			pct = (lba_curr * 100) / 0x200000;
-			if (pct != prevPct && render_timer < get_tmr_ms())
-			{
-				lv_bar_set_value(bar, pct);
-				manual_system_maintenance(true);
-				render_timer = get_tmr_ms() + render_min_ms;
-
-				prevPct = pct;
+	ui.bar = bar;
 
-				if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
-					error = -1;
-			}
+	bench->storage       = storage;
+	bench->sector        = ALIGN_DOWN(storage->sec_cnt / 3, 0x8000); // Align to 16MB.
+	bench->area_sectors  = 0x200000; // 1GB.
+	bench->buf           = (u8 *)MIXD_BUF_ALIGNED;
+	bench->raw_write     = raw_write;
+	bench->progress      = _benchmark_progress;
+	bench->progress_data = &ui;
 
-			if (error)
-				goto error;
-		}
-		lv_bar_set_value(bar, 100);
-
-		u32 rate_1k = ((u64)1024 * 1000 * 1000 * 1000) / timer;
-		s_printf(txt_buf + strlen(txt_buf),
-			" Sequential 16MiB - Rate: #C7EA46 %3d.%02d MiB/s#\n",
-			rate_1k / 1000, (rate_1k % 1000) / 10);
-		lv_label_set_text(lbl_status, txt_buf);
-		lv_obj_align(lbl_status, NULL, LV_ALIGN_CENTER, 0, 0);
-		lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
-		manual_system_maintenance(true);
+	s_printf(txt_buf, "Sector Offset #C7EA46 %08X#:\n Test               MiB/s    IOPS  p50us  p99us  maxus\n",
+		bench->sector);
 
-		pct = 0;
-		prevPct = 200;
-		timer = 0;
-		lba_curr = 0;
-		sector_num = 8;            // 4KB chunks.
-		data_remaining = 0x100000; // 512MB.
+	for (u32 i = 0; i < workloads_cnt; i++)
+	{
+		const bench_workload_t *wl = &bench_workloads[i];
 
-		render_timer = get_tmr_ms() + render_min_ms;
-		while (data_remaining)
-		{
-			u32 time_taken = get_tmr_us();
-			error = !sdmmc_storage_read(storage, sector + lba_curr, sector_num, (u8 *)MIXD_BUF_ALIGNED);
-			time_taken = get_tmr_us() - time_taken;
-			timer += time_taken;
+		// File workloads need a mounted FAT volume.
+		if ((wl->flags & BENCH_FATFS) && !sd_bench)
+			continue;
 
-			manual_system_maintenance(false);
-			data_remaining -= sector_num;
-			lba_curr += sector_num;
+		// Raw writes only if user accepted them.
+		if (wl->type == BENCH_RAW && wl->write_pct && !raw_write)
+			continue;
 
-			pct = (lba_curr * 100) / 0x100000;
-			if (pct != prevPct && render_timer < get_tmr_ms())
-			{
-				lv_bar_set_value(bar, pct);
-				manual_system_maintenance(true);
-				render_timer = get_tmr_ms() + render_min_ms;
+		ui.render_timer = get_tmr_ms() + 66;
+		ui.prev_pct = 200;
+		lv_bar_set_value(bar, 0);
 
-				prevPct = pct;
-
-				if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
-					error = -1;
-			}
+		bench_result_t *result = &results[results_cnt];
+		error = bench_run(bench, wl, result);
+		if (error)
+			break;
+		results_cnt++;
 
-			if (error)
-				goto error;
-		}
 		lv_bar_set_value(bar, 100);
 
-		rate_1k = ((u64)512 * 1000 * 1000 * 1000) / timer;
-		u32 iops_1k = ((u64)512 * 1024 * 1000 * 1000 * 1000) / (4096 / 1024) / timer / 1000;
+		// Pad test name for table alignment.
+		u32 len = strlen(txt_buf);
+		s_printf(txt_buf + len, " %s", result->name);
+		while (strlen(txt_buf) < len + 18)
+			strcat(txt_buf, " ");
+
 		s_printf(txt_buf + strlen(txt_buf),
-			" Sequential  4KiB - Rate: #C7EA46 %3d.%02d MiB/s#, IOPS: #C7EA46 %4d#\n",
-			rate_1k / 1000, (rate_1k % 1000) / 10, iops_1k);
+			"#C7EA46 %4d.%02d# %7d %6d %6d %6d\n",
+			result->rate_1k / 1000, (result->rate_1k % 1000) / 10, result->iops,
+			result->p50_us, result->p99_us, result->max_us);
 		lv_label_set_text(lbl_status, txt_buf);
 		lv_obj_align(lbl_status, NULL, LV_ALIGN_CENTER, 0, 0);
 		lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
 		manual_system_maintenance(true);
+	}
 
-		u32 lba_idx = 0;
-		u32 *random_offsets = malloc(0x20000 * sizeof(u32));
-		u32  random_numbers[4];
-		for (u32 i = 0; i < 0x20000; i += 4)
-		{
-			// Generate new random numbers.
-			while (!se_gen_prng128(random_numbers))
-				;
-			// Clamp offsets to 512MB range.
-			random_offsets[i + 0] = random_numbers[0] % 0x100000;
-			random_offsets[i + 1] = random_numbers[1] % 0x100000;
-			random_offsets[i + 2] = random_numbers[2] % 0x100000;
-			random_offsets[i + 3] = random_numbers[3] % 0x100000;
-		}
-
-		pct = 0;
-		prevPct = 200;
-		timer = 0;
-		data_remaining = 0x100000; // 512MB.
-
-		render_timer = get_tmr_ms() + render_min_ms;
-		while (data_remaining)
-		{
-			u32 time_taken = get_tmr_us();
-			error = !sdmmc_storage_read(storage, sector + random_offsets[lba_idx], sector_num, (u8 *)MIXD_BUF_ALIGNED);
-			time_taken = get_tmr_us() - time_taken;
-			timer += time_taken;
-
-			manual_system_maintenance(false);
-			data_remaining -= sector_num;
-			lba_idx++;
-
-			pct = (lba_idx * 100) / 0x20000;
-			if (pct != prevPct && render_timer < get_tmr_ms())
-			{
-				lv_bar_set_value(bar, pct);
-				manual_system_maintenance(true);
-				render_timer = get_tmr_ms() + render_min_ms;
-
-				prevPct = pct;
+	free(bench);
 
-				if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
-					error = -1;
-			}
+	// Save results of all finished workloads.
+	if (results_cnt && (sd_bench || sd_mount()))
+	{
+		char path[64];
+		rtc_time_t time;
+		max77620_rtc_get_time_adjusted(&time);
+		s_printf(path, "bootloader/benchmarks/%s_%04d%02d%02d_%02d%02d%02d.csv", sd_bench ? "sd" : "emmc",
+			time.year, time.month, time.day, time.hour, time.min, time.sec);
 
-			if (error)
-			{
-				free(random_offsets);
-				goto error;
-			}
-		}
-		lv_bar_set_value(bar, 100);
+		if (!bench_save_csv(path, sd_bench ? "sd" : "emmc", results, results_cnt))
+			s_printf(txt_buf + strlen(txt_buf), "Saved to #C7EA46 %s#", path);
+		else
+			s_printf(txt_buf + strlen(txt_buf), "#FFDD00 Failed to save results!#");
 
-		// Calculate rate and IOPS for 512MB transfer.
-		rate_1k = ((u64)512 * 1000 * 1000 * 1000) / timer;
-		iops_1k = ((u64)512 * 1024 * 1000 * 1000 * 1000) / (4096 / 1024) / timer / 1000;
-		s_printf(txt_buf + strlen(txt_buf),
-			" Random      4KiB - Rate: #C7EA46 %3d.%02d MiB/s#, IOPS: #C7EA46 %4d#\n",
-			rate_1k / 1000, (rate_1k % 1000) / 10, iops_1k);
-		if (iter_curr == iters - 1)
-			txt_buf[strlen(txt_buf) - 1] = 0; // Cut off last line change.
-		lv_label_set_text(lbl_status, txt_buf);
-		lv_obj_align(lbl_status, NULL, LV_ALIGN_CENTER, 0, 0);
-		lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
-		manual_system_maintenance(true);
-		free(random_offsets);
+		if (!sd_bench)
+			sd_unmount();
 	}
+	else
+		txt_buf[strlen(txt_buf) - 1] = 0; // Cut off last line change.
+
+	free(results);
 
-error:
 	if (error)
 	{
 		if (error == -1)
 			s_printf(txt_buf + strlen(txt_buf), "\n#FFDD00 Aborted!#");
 		else
 			s_printf(txt_buf + strlen(txt_buf), "\n#FFDD00 IO Error occurred!#");
-
-		lv_label_set_text(lbl_status, txt_buf);
-		lv_obj_align(lbl_status, NULL, LV_ALIGN_CENTER, 0, 0);
 	}
 
+	lv_label_set_text(lbl_status, txt_buf);
+	lv_obj_align(lbl_status, NULL, LV_ALIGN_CENTER, 0, 0);
+
 	lv_obj_del(bar);
 
-	if (sd_bench && error && error != -1)
-		sd_end();
 	if (sd_bench)
 	{
 		if (error && error != -1)
@@ -1555,16 +1495,97 @@ out:
 	return LV_RES_OK;
 }
 
+static lv_res_t _emmc_bench_action(lv_obj_t *btns, const char *txt)
+{
+	int btn_idx = lv_btnm_get_pressed(btns);
+
+	mbox_action(btns, txt);
+
+	switch (btn_idx)
+	{
+	case 0:
+		_create_mbox_benchmark(false, false);
+		break;
+	case 1:
+		if (nyx_emmc_check_battery_enough())
+			_create_mbox_benchmark(false, true);
+		break;
+	}
+
+	return LV_RES_INV;
+}
+
 static lv_res_t _create_mbox_emmc_bench(lv_obj_t * btn)
 {
-	_create_mbox_benchmark(false);
+	lv_obj_t *dark_bg = lv_obj_create(lv_scr_act(), NULL);
+	lv_obj_set_style(dark_bg, &mbox_darken);
+	lv_obj_set_size(dark_bg, LV_HOR_RES, LV_VER_RES);
+
+	static const char * mbox_btn_map[] = { "\222Read Only", "\222Read & Write", "\222Cancel", "" };
+	lv_obj_t * mbox = lv_mbox_create(dark_bg, NULL);
+	lv_mbox_set_recolor_text(mbox, true);
+	lv_obj_set_width(mbox, LV_HOR_RES / 9 * 6);
+
+	lv_mbox_set_text(mbox,
+		"#FF8000 eMMC Benchmark#\n\n"
+		"#FF8000 Read Only# runs the raw read workloads.\n"
+		"#FF8000 Read & Write# also runs the raw write workloads.\n\n"
+		"#FFDD00 Warning:# Write workloads rewrite sysNAND sectors in place.\n"
+		"Data is read and written back, but a power loss or IO error\n"
+		"during them can corrupt sysNAND!\n"
+		"#FFDD00 Only use it with a recent eMMC backup!#");
+
+	lv_mbox_add_btns(mbox, mbox_btn_map, _emmc_bench_action);
+	lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
+	lv_obj_set_top(mbox, true);
 
 	return LV_RES_OK;
 }
 
+static lv_res_t _sd_bench_action(lv_obj_t *btns, const char *txt)
+{
+	int btn_idx = lv_btnm_get_pressed(btns);
+
+	mbox_action(btns, txt);
+
+	switch (btn_idx)
+	{
+	case 0:
+		_create_mbox_benchmark(true, false);
+		break;
+	case 1:
+		if (nyx_emmc_check_battery_enough())
+			_create_mbox_benchmark(true, true);
+		break;
+	}
+
+	return LV_RES_INV;
+}
+
 static lv_res_t _create_mbox_sd_bench(lv_obj_t * btn)
 {
-	_create_mbox_benchmark(true);
+	lv_obj_t *dark_bg = lv_obj_create(lv_scr_act(), NULL);
+	lv_obj_set_style(dark_bg, &mbox_darken);
+	lv_obj_set_size(dark_bg, LV_HOR_RES, LV_VER_RES);
+
+	static const char * mbox_btn_map[] = { "\222Read & File", "\222Read & Write", "\222Cancel", "" };
+	lv_obj_t * mbox = lv_mbox_create(dark_bg, NULL);
+	lv_mbox_set_recolor_text(mbox, true);
+	lv_obj_set_width(mbox, LV_HOR_RES / 9 * 6);
+
+	lv_mbox_set_text(mbox,
+		"#FF8000 SD Card Benchmark#\n\n"
+		"#FF8000 Read & File# runs the raw read workloads and the file\n"
+		"workloads, which use a temporary file.\n"
+		"#FF8000 Read & Write# also runs the raw write workloads.\n\n"
+		"#FFDD00 Warning:# Write workloads rewrite SD card sectors in place.\n"
+		"Data is read and written back, but a power loss or IO error\n"
+		"during them can corrupt files on the SD card!\n"
+		"#FFDD00 Only use it with a recent SD card backup!#");
+
+	lv_mbox_add_btns(mbox, mbox_btn_map, _sd_bench_action);
+	lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
+	lv_obj_set_top(mbox, true);
 
 	return LV_RES_OK;
 }
@@ -2608,7 +2629,7 @@ void create_tab_info(lv_theme_t *th, lv_obj_t *parent)
 	lv_label_set_recolor(label_txt5, true);
 	lv_label_set_static_text(label_txt5,
 		"View info about the eMMC or microSD and their partition list.\n"
-		"Additionally you can benchmark read speeds.");
+		"Additionally you can benchmark read and write speeds.");
 	lv_obj_set_style(label_txt5, &hint_small_style);
 	lv_obj_align(label_txt5, btn5, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 3);
 
@@ -218,6 +218,43 @@ static lv_res_t _create_mbox_hid(usb_ctxt_t *usbs)
 	return LV_RES_OK;
 }
 
+static lv_res_t _create_mbox_dump(usb_ctxt_t *usbs)
+{
+	lv_obj_t *dark_bg = lv_obj_create(lv_scr_act(), NULL);
+	lv_obj_set_style(dark_bg, &mbox_darken);
+	lv_obj_set_size(dark_bg, LV_HOR_RES, LV_VER_RES);
+
+	static const char *mbox_btn_map[] = { "\251", "\262Close", "\251", "" };
+	static const char *mbox_btn_map2[] = { "\251", "\222Close", "\251", "" };
+	lv_obj_t *mbox = lv_mbox_create(dark_bg, NULL);
+	lv_mbox_set_recolor_text(mbox, true);
+
+	lv_mbox_set_text(mbox, "#FF8000 USB Fast Dump#\n\n#C7EA46 Device:# eMMC & SD Card");
+
+	lv_obj_t *lbl_status = lv_label_create(mbox, NULL);
+	lv_label_set_recolor(lbl_status, true);
+	lv_label_set_text(lbl_status, " ");
+	usbs->label = (void *)lbl_status;
+
+	lv_obj_t *lbl_tip = lv_label_create(mbox, NULL);
+	lv_label_set_recolor(lbl_tip, true);
+	lv_label_set_static_text(lbl_tip,
+		"Note: Use the #C7EA46 fastdump# tool on the host to dump.\n"
+		"To end it, press #C7EA46 VOL+# + #C7EA46 VOL-# or remove the cable.");
+	lv_obj_set_style(lbl_tip, &hint_small_style);
+
+	lv_mbox_add_btns(mbox, mbox_btn_map, mbox_action);
+	lv_obj_set_width(mbox, LV_HOR_RES / 9 * 5);
+	lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
+	lv_obj_set_top(mbox, true);
+
+	usb_device_gadget_dump(usbs);
+
+	lv_mbox_add_btns(mbox, mbox_btn_map2, mbox_action);
+
+	return LV_RES_OK;
+}
+
 static lv_res_t _create_mbox_ums(usb_ctxt_t *usbs)
 {
 	lv_obj_t *dark_bg = lv_obj_create(lv_scr_act(), NULL);
@@ -380,6 +417,20 @@ static lv_res_t _action_hid_jc(lv_obj_t *btn)
 	return LV_RES_OK;
 }
 
+static lv_res_t _action_usb_dump(lv_obj_t *btn)
+{
+	if (!nyx_emmc_check_battery_enough())
+		return LV_RES_OK;
+
+	usb_ctxt_t usbs;
+	usbs.system_maintenance = &manual_system_maintenance;
+	usbs.set_text = &usb_gadget_set_text;
+
+	_create_mbox_dump(&usbs);
+
+	return LV_RES_OK;
+}
+
 /*
 static lv_res_t _action_hid_touch(lv_obj_t *btn)
 {
@@ -827,6 +878,22 @@ static lv_res_t _create_window_usb_tools(lv_obj_t *parent)
 
 	lv_obj_set_style(label_txt4, &hint_small_style);
 	lv_obj_align(label_txt4, btn3, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 3);
+
+	// Create Fast Dump button.
+	lv_obj_t *btn5 = lv_btn_create(h2, btn3);
+	label_btn = lv_label_create(btn5, NULL);
+	lv_label_set_static_text(label_btn, SYMBOL_DOWNLOAD"  Fast Dump");
+	lv_obj_align(btn5, label_txt4, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 2);
+	lv_btn_set_action(btn5, LV_BTN_ACTION_CLICK, _action_usb_dump);
+
+	lv_obj_t *label_txt5 = lv_label_create(h2, NULL);
+	lv_label_set_recolor(label_txt5, true);
+	lv_label_set_static_text(label_txt5,
+		"Stream eMMC or SD Card raw images to a PC\n"
+		"with the #C7EA46 fastdump# host tool.\n"
+		"#C7EA46 Access is# #FF8000 read-only.#");
+	lv_obj_set_style(label_txt5, &hint_small_style);
+	lv_obj_align(label_txt5, btn5, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 3);
 /*
 	// Create Touchpad button.
 	lv_obj_t *btn4 = lv_btn_create(h2, btn1);
@@ -21,6 +21,7 @@
 #include "gui.h"
 #include "gui_tools.h"
 #include "gui_tools_partition_manager.h"
+#include "fe_file_copy.h"
 #include <libs/fatfs/diskio.h>
 #include <libs/lvgl/lvgl.h>
 
@@ -85,186 +86,6 @@ l4t_flasher_ctxt_t l4t_flash_ctxt;
 lv_obj_t *btn_flash_l4t;
 lv_obj_t *btn_flash_android;
 
-int _copy_file(const char *src, const char *dst, char *path)
-{
-	FIL fp_src;
-	FIL fp_dst;
-	int res;
-
-	// Open file for reading.
-	f_chdrive(src);
-	res = f_open(&fp_src, path, FA_READ);
-	if (res != FR_OK)
-		return res;
-
-	u32 file_bytes_left = f_size(&fp_src);
-
-	// Open file for writing.
-	f_chdrive(dst);
-	f_open(&fp_dst, path, FA_CREATE_ALWAYS | FA_WRITE);
-	f_lseek(&fp_dst, f_size(&fp_src));
-	f_lseek(&fp_dst, 0);
-
-	while (file_bytes_left)
-	{
-		u32 chunk_size = MIN(file_bytes_left, SZ_4M); // 4MB chunks.
-		file_bytes_left -= chunk_size;
-
-		// Copy file to buffer.
-		f_read(&fp_src, (void *)SDXC_BUF_ALIGNED, chunk_size, NULL);
-
-		// Write file to disk.
-		f_write(&fp_dst, (void *)SDXC_BUF_ALIGNED, chunk_size, NULL);
-	}
-
-	f_close(&fp_dst);
-	f_chdrive(src);
-	f_close(&fp_src);
-
-	return FR_OK;
-}
-
-static int _stat_and_copy_files(const char *src, const char *dst, char *path, u32 *total_files, u32 *total_size, lv_obj_t **labels)
-{
-	FRESULT res;
-	FIL fp_src;
-	FIL fp_dst;
-	DIR dir;
-	u32 dirLength = 0;
-	static FILINFO fno;
-
-	f_chdrive(src);
-
-	// Open directory.
-	res = f_opendir(&dir, path);
-	if (res != FR_OK)
-		return res;
-
-	if (labels)
-		lv_label_set_text(labels[0], path);
-
-	dirLength = strlen(path);
-
-	// Hard limit path to 1024 characters. Do not result to error.
-	if (dirLength > 1024)
-		goto out;
-
-	for (;;)
-	{
-		// Clear file path.
-		path[dirLength] = 0;
-
-		// Read a directory item.
-		res = f_readdir(&dir, &fno);
-
-		// Break on error or end of dir.
-		if (res != FR_OK || fno.fname[0] == 0)
-			break;
-
-		// Set new directory or file.
-		memcpy(&path[dirLength], "/", 1);
-		strcpy(&path[dirLength + 1], fno.fname);
-
-		if (labels)
-		{
-			lv_label_set_text(labels[1], fno.fname);
-			manual_system_maintenance(true);
-		}
-
-		// Copy file to destination disk.
-		if (!(fno.fattrib & AM_DIR))
-		{
-			u32 file_size = fno.fsize > RAMDISK_CLUSTER_SZ ? fno.fsize : RAMDISK_CLUSTER_SZ; // Ramdisk cluster size.
-
-			// Check for overflow.
-			if ((file_size + *total_size) < *total_size)
-			{
-				// Set size to > 1GB, skip next folders and return.
-				*total_size = SZ_2G;
-				res = -1;
-				break;
-			}
-
-			*total_size += file_size;
-			*total_files += 1;
-
-			if (dst)
-			{
-				u32 file_bytes_left = fno.fsize;
-
-				// Open file for writing.
-				f_chdrive(dst);
-				f_open(&fp_dst, path, FA_CREATE_ALWAYS | FA_WRITE);
-				f_lseek(&fp_dst, fno.fsize);
-				f_lseek(&fp_dst, 0);
-
-				// Open file for reading.
-				f_chdrive(src);
-				f_open(&fp_src, path, FA_READ);
-
-				while (file_bytes_left)
-				{
-					u32 chunk_size = MIN(file_bytes_left, SZ_4M); // 4MB chunks.
-					file_bytes_left -= chunk_size;
-
-					// Copy file to buffer.
-					f_read(&fp_src, (void *)SDXC_BUF_ALIGNED, chunk_size, NULL);
-					manual_system_maintenance(true);
-
-					// Write file to disk.
-					f_write(&fp_dst, (void *)SDXC_BUF_ALIGNED, chunk_size, NULL);
-				}
-
-				// Finalize copied file.
-				f_close(&fp_dst);
-				f_chdrive(dst);
-				f_chmod(path, fno.fattrib, 0xFF);
-
-				f_chdrive(src);
-				f_close(&fp_src);
-			}
-
-			// If total is > 1GB exit.
-			if (*total_size > (RAM_DISK_SZ - SZ_16M)) // 0x2400000.
-			{
-				// Skip next folders and return.
-				res = -1;
-				break;
-			}
-		}
-		else // It's a directory.
-		{
-			if (!memcmp("System Volume Information", fno.fname, 25))
-				continue;
-
-			// Create folder to destination.
-			if (dst)
-			{
-				f_chdrive(dst);
-				f_mkdir(path);
-				f_chmod(path, fno.fattrib, 0xFF);
-			}
-
-			// Enter the directory.
-			res = _stat_and_copy_files(src, dst, path, total_files, total_size, labels);
-			if (res != FR_OK)
-				break;
-
-			if (labels)
-			{
-				// Clear folder path.
-				path[dirLength] = 0;
-				lv_label_set_text(labels[0], path);
-			}
-		}
-	}
-
-out:
-	f_closedir(&dir);
-
-	return res;
-}
-
 static void _create_gpt_partition(gpt_t *gpt, u8 *gpt_idx, u32 *curr_part_lba, u32 size_lba, char *name, int name_size)
 {
 	const u8 linux_part_guid[] = { 0xAF, 0x3D, 0xC6, 0x0F,  0x83, 0x84,  0x72, 0x47,  0x8E, 0x79,  0x3D, 0x69, 0xD8, 0x47, 0x7D, 0xE4 };
@@ -1365,11 +1186,14 @@ static int _backup_and_restore_files(bool backup, lv_obj_t **labels)
 	const char *dst_drv = backup ? "ram:" : "sd:";
 
 	int res = 0;
-	u32 total_size = 0;
-	u32 total_files = 0;
+	file_copy_ctxt_t copy;
 	char *path = malloc(0x1000);
 	path[0] = 0; // Set default as root folder.
 
+	file_copy_init(&copy, src_drv, dst_drv, labels);
+	copy.min_file_size  = RAMDISK_CLUSTER_SZ;
+	copy.max_total_size = RAM_DISK_SZ - SZ_16M;
+
 	// Check if Mariko Warmboot Storage exists in source drive.
 	f_chdrive(src_drv);
 	bool backup_mws = !part_info.backup_possible && !f_stat("warmboot_mariko", NULL);
@@ -1388,7 +1212,7 @@ static int _backup_and_restore_files(bool backup, lv_obj_t **labels)
 	}
 
 	// Copy all or hekate/Nyx files.
-	res = _stat_and_copy_files(src_drv, dst_drv, path, &total_files, &total_size, labels);
+	res = file_copy_dir(&copy, path);
 
 	// If incomplete backup mode, copy MWS and payload.bin also.
 	if (!res)
@@ -1396,16 +1220,31 @@ static int _backup_and_restore_files(bool backup, lv_obj_t **labels)
 		if (backup_mws)
 		{
 			strcpy(path, "warmboot_mariko");
-			res = _stat_and_copy_files(src_drv, dst_drv, path, &total_files, &total_size, labels);
+			res = file_copy_dir(&copy, path);
 		}
 
 		if (!res && backup_pld)
 		{
 			strcpy(path, "payload.bin");
-			res = _copy_file(src_drv, dst_drv, path);
+			res = file_copy_file(&copy, path);
 		}
 	}
 
+	// Write any batched files.
+	int res_end = file_copy_end(&copy);
+	if (!res)
+		res = res_end;
+
+	// Report files that failed to copy. The rest got copied.
+	if (copy.failed_files)
+	{
+		s_printf(path, "%d files failed to copy!", copy.failed_files);
+		lv_label_set_text(labels[1], path);
+		manual_system_maintenance(true);
+		if (!res)
+			res = FR_DISK_ERR;
+	}
+
 	free(path);
 
 	return res;
@@ -2083,12 +1922,18 @@ static void _create_mbox_check_files_total_size()
 	manual_system_maintenance(true);
 
 	char *path = malloc(0x1000);
-	u32 total_files = 0;
-	u32 total_size = 0;
+	file_copy_ctxt_t copy;
 	path[0] = 0;
 
 	// Check total size of files.
-	int res = _stat_and_copy_files("sd:", NULL, path, &total_files, &total_size, NULL);
+	file_copy_init(&copy, "sd:", NULL, NULL);
+	copy.min_file_size  = RAMDISK_CLUSTER_SZ;
+	copy.max_total_size = RAM_DISK_SZ - SZ_16M;
+	int res = file_copy_dir(&copy, path);
+	file_copy_end(&copy);
+
+	u32 total_files = copy.total_files;
+	u32 total_size  = copy.total_size;
 
 	// Not more than 1.0GB.
 	part_info.backup_possible = !res && !(total_size > (RAM_DISK_SZ - SZ_16M));
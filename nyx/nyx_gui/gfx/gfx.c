@@ -326,46 +326,10 @@ void gfx_puts(const char *s)
 
 static void _gfx_putn(u32 v, int base, char fill, int fcnt)
 {
-	static const char digits[] = "0123456789ABCDEF";
-
-	char *p;
 	char buf[65];
-	int c = fcnt;
-	bool negative = false;
-
-	if (base != 10 && base != 16)
-		return;
-
-	// Account for negative numbers.
-	if (base == 10 && v & 0x80000000)
-	{
-		negative = true;
-		v = (int)v * -1;
-		c--;
-	}
-
-	p = buf + 64;
-	*p = 0;
-	do
-	{
-		c--;
-		*--p = digits[v % base];
-		v /= base;
-	} while (v);
-
-	if (negative)
-		*--p = '-';
-
-	if (fill != 0)
-	{
-		while (c > 0 && p > buf)
-		{
-			*--p = fill;
-			c--;
-		}
-	}
 
-	gfx_puts(p);
+	s_putn(buf, v, base, fill, fcnt);
+	gfx_puts(buf);
 }
 
 void gfx_printf(const char *fmt, ...)
@@ -180,3 +180,19 @@ DRESULT disk_set_info (
 
 	return RES_OK;
 }
+
+/*-----------------------------------------------------------------------*/
+/* Get Memory Address of Sector(s)                                       */
+/*-----------------------------------------------------------------------*/
+void *disk_get_ptr (
+	BYTE pdrv,		/* Physical drive nmuber (0..) */
+	DWORD sector,	/* Start sector in LBA */
+	UINT count		/* Number of sectors */
+)
+{
+	// Only memory backed drives can be accessed directly.
+	if (pdrv == DRIVE_RAM)
+		return ram_disk_get_ptr(sector, count);
+
+	return NULL;
+}
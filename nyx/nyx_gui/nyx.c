@@ -242,6 +242,8 @@ static void _load_saved_configuration()
 					h_cfg.updater2p   = atoi(kv->val);
 				else if (!strcmp("bootprotect", kv->key))
 					h_cfg.bootprotect = atoi(kv->val);
+				else if (!strcmp("boottrace",   kv->key))
+					h_cfg.boottrace   = atoi(kv->val);
 			}
 
 			break;
@@ -408,6 +410,10 @@ error_occured:
 
 void nyx_init_load_res()
 {
+	// Continue boot trace from hekate if it exists.
+	btrace_init(BTRACE_STAGE_NYX, false);
+	btrace_begin("nyx_init");
+
 	bpmp_mmu_enable();
 	bpmp_clk_rate_get();
 
@@ -440,6 +446,7 @@ void nyx_init_load_res()
 	_show_errors(SD_NO_ERROR);
 
 	// Try 2 times to mount SD card.
+	btrace_begin("sd_mount");
 	if (!sd_mount())
 	{
 		// Restore speed to SDR104.
@@ -449,20 +456,30 @@ void nyx_init_load_res()
 		if (!sd_mount())
 			_show_errors(SD_MOUNT_ERROR); // Fatal.
 	}
+	btrace_end("sd_mount");
 
 	// Train DRAM and switch to max frequency.
+	btrace_begin("minerva_init");
 	minerva_init();
+	btrace_end("minerva_init");
 
 	// Load hekate/Nyx configuration.
+	btrace_begin("ini_parse");
 	_load_saved_configuration();
+	btrace_end("ini_parse");
+
+	// Enable boot trace saving if requested.
+	btrace_set_export(h_cfg.boottrace);
 
 	// Load Nyx resources.
+	btrace_begin("load_resources");
 	if (nyx_load_resources())
 	{
 		// Try again.
 		if (nyx_load_resources())
 			_show_errors(SD_FILE_ERROR); // Fatal since resources are mandatory.
 	}
+	btrace_end("load_resources");
 
 	// Initialize nyx cfg to lower clock on first boot.
 	// In case of lower binned SoC, this can help with hangs.
@@ -493,7 +510,13 @@ void nyx_init_load_res()
 	}
 
 	// Load default launch icons and background if it exists.
+	btrace_begin("load_bg_icons");
 	nyx_load_bg_icons();
+	btrace_end("load_bg_icons");
+
+	// Save boot trace if enabled.
+	btrace_end("nyx_init");
+	btrace_save(BTRACE_FILE_PATH);
 
 	// Unmount FAT partition.
 	sd_unmount();
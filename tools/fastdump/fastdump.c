@@ -0,0 +1,410 @@
+/*
+ * Nyx USB Fast Dump host client
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Streams raw eMMC/SD images from Nyx's Fast Dump USB gadget.
+ * If the output file exists, the dump resumes from its size.
+ *
+ * Usage: fastdump info
+ *        fastdump [-s] [-e] <gpp|boot0|boot1|sd> <out.bin>
+ *          -s: Verify each chunk with the SHA256 calculated by the device.
+ *          -e: End the gadget when done.
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <libusb.h>
+
+#include "../../bdk/usb/usb_gadget_dump.h"
+
+#define FD_VID 0x11EC
+#define FD_PID 0xA7E3
+
+#define FD_EP_IN  0x81
+#define FD_EP_OUT 0x01
+
+#define FD_TIMEOUT_MS 10000
+
+static const char *storage_names[FD_STORAGE_MAX] = { "gpp", "boot0", "boot1", "sd" };
+static const char *status_names[] = { "OK", "Invalid command", "Invalid argument", "No storage", "I/O error" };
+
+typedef struct _sha256_ctx_t
+{
+	uint32_t state[8];
+	uint8_t  buf[64];
+	uint64_t len;
+} sha256_ctx_t;
+
+static const uint32_t sha256_k[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void _sha256_block(sha256_ctx_t *ctx, const uint8_t *data)
+{
+	uint32_t w[64];
+	uint32_t s[8];
+
+	for (int i = 0; i < 16; i++)
+		w[i] = (data[i * 4] << 24) | (data[i * 4 + 1] << 16) | (data[i * 4 + 2] << 8) | data[i * 4 + 3];
+	for (int i = 16; i < 64; i++)
+	{
+		uint32_t s0 = ROR32(w[i - 15], 7) ^ ROR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		uint32_t s1 = ROR32(w[i - 2], 17) ^ ROR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	memcpy(s, ctx->state, sizeof(s));
+	for (int i = 0; i < 64; i++)
+	{
+		uint32_t t1 = s[7] + (ROR32(s[4], 6) ^ ROR32(s[4], 11) ^ ROR32(s[4], 25)) +
+			((s[4] & s[5]) ^ (~s[4] & s[6])) + sha256_k[i] + w[i];
+		uint32_t t2 = (ROR32(s[0], 2) ^ ROR32(s[0], 13) ^ ROR32(s[0], 22)) +
+			((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+		memmove(&s[1], &s[0], sizeof(uint32_t) * 7);
+		s[4] += t1;
+		s[0] = t1 + t2;
+	}
+
+	for (int i = 0; i < 8; i++)
+		ctx->state[i] += s[i];
+}
+
+static void _sha256(uint8_t *hash, const uint8_t *data, uint32_t size)
+{
+	static const uint32_t iv[8] =
+	{
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+	sha256_ctx_t ctx;
+	uint32_t rem = size & 63;
+
+	memcpy(ctx.state, iv, sizeof(iv));
+	ctx.len = (uint64_t)size * 8;
+
+	for (uint32_t i = 0; i < size - rem; i += 64)
+		_sha256_block(&ctx, data + i);
+
+	// Pad and append length.
+	memset(ctx.buf, 0, sizeof(ctx.buf));
+	memcpy(ctx.buf, data + size - rem, rem);
+	ctx.buf[rem] = 0x80;
+	if (rem >= 56)
+	{
+		_sha256_block(&ctx, ctx.buf);
+		memset(ctx.buf, 0, sizeof(ctx.buf));
+	}
+	for (int i = 0; i < 8; i++)
+		ctx.buf[63 - i] = ctx.len >> (i * 8);
+	_sha256_block(&ctx, ctx.buf);
+
+	for (int i = 0; i < 8; i++)
+	{
+		hash[i * 4]     = ctx.state[i] >> 24;
+		hash[i * 4 + 1] = ctx.state[i] >> 16;
+		hash[i * 4 + 2] = ctx.state[i] >> 8;
+		hash[i * 4 + 3] = ctx.state[i];
+	}
+}
+
+static int _fd_send_cmd(libusb_device_handle *dev, uint32_t cmd, uint32_t storage, uint32_t flags, uint32_t sector, uint32_t count)
+{
+	fd_cmd_t fd_cmd = { FD_MAGIC, cmd, storage, flags, sector, count, 0, 0 };
+	int bytes = 0;
+
+	int res = libusb_bulk_transfer(dev, FD_EP_OUT, (uint8_t *)&fd_cmd, sizeof(fd_cmd), &bytes, FD_TIMEOUT_MS);
+	if (!res && bytes != sizeof(fd_cmd))
+		res = LIBUSB_ERROR_IO;
+
+	return res;
+}
+
+static int _fd_recv(libusb_device_handle *dev, void *buf, int size, int *bytes)
+{
+	int len = 0;
+
+	// Data can arrive in several transfers. Headers always arrive in a short one.
+	*bytes = 0;
+	while (*bytes < size)
+	{
+		int res = libusb_bulk_transfer(dev, FD_EP_IN, (uint8_t *)buf + *bytes, size - *bytes, &len, FD_TIMEOUT_MS);
+		if (res)
+			return res;
+		*bytes += len;
+		if (len & (FD_SECTOR_SIZE - 1))
+			break;
+	}
+
+	return 0;
+}
+
+static int _fd_get_info(libusb_device_handle *dev, fd_info_t *info)
+{
+	uint8_t buf[FD_SECTOR_SIZE];
+	int bytes;
+
+	int res = _fd_send_cmd(dev, FD_CMD_INFO, 0, 0, 0, 0);
+	if (!res)
+		res = _fd_recv(dev, buf, sizeof(buf), &bytes);
+	if (res)
+		return res;
+
+	memcpy(info, buf, sizeof(fd_info_t));
+	if (bytes != sizeof(fd_info_t) || info->magic != FD_MAGIC || info->version != FD_VERSION)
+	{
+		fprintf(stderr, "Unsupported device protocol!\n");
+		return LIBUSB_ERROR_NOT_SUPPORTED;
+	}
+
+	return 0;
+}
+
+static int _fd_dump(libusb_device_handle *dev, fd_info_t *info, uint32_t storage, const char *path, int verify)
+{
+	uint8_t hdr_buf[FD_SECTOR_SIZE];
+	fd_chunk_hdr_t *hdr = (fd_chunk_hdr_t *)hdr_buf;
+	uint8_t hash[32];
+	int bytes;
+	int res = 0;
+
+	uint32_t total = info->sectors[storage];
+	if (!total)
+	{
+		fprintf(stderr, "Storage %s is not available!\n", storage_names[storage]);
+		return 1;
+	}
+
+	FILE *fp = fopen(path, "ab");
+	if (!fp)
+	{
+		fprintf(stderr, "Failed to open %s!\n", path);
+		return 1;
+	}
+
+	// Resume from the end of an existing dump.
+	fseeko(fp, 0, SEEK_END);
+	uint64_t size = ftello(fp);
+	uint32_t sector = size / FD_SECTOR_SIZE;
+	if (size % FD_SECTOR_SIZE || sector > total)
+	{
+		fprintf(stderr, "%s does not match the storage size!\n", path);
+		fclose(fp);
+		return 1;
+	}
+	if (sector)
+		printf("Resuming from sector %u.\n", sector);
+
+	if (sector == total)
+		goto out;
+
+	uint8_t *data = malloc(info->chunk_sectors_max * FD_SECTOR_SIZE);
+
+	res = _fd_send_cmd(dev, FD_CMD_READ, storage, verify ? FD_FLAG_SHA256 : 0, sector, total - sector);
+
+	time_t start = time(NULL);
+	uint32_t start_sector = sector;
+	while (!res && sector < total)
+	{
+		res = _fd_recv(dev, hdr_buf, sizeof(hdr_buf), &bytes);
+		if (res)
+			break;
+
+		if (bytes != sizeof(fd_chunk_hdr_t) || hdr->magic != FD_MAGIC || hdr->sector != sector)
+		{
+			fprintf(stderr, "\nProtocol error at sector %u!\n", sector);
+			res = 1;
+			break;
+		}
+
+		if (hdr->status)
+		{
+			fprintf(stderr, "\nDevice error at sector %u: %s!\n", hdr->sector,
+				hdr->status <= FD_STS_IO_ERROR ? status_names[hdr->status] : "Unknown");
+			res = 1;
+			break;
+		}
+
+		uint32_t len = hdr->count * FD_SECTOR_SIZE;
+		if (hdr->count > info->chunk_sectors_max)
+		{
+			fprintf(stderr, "\nProtocol error at sector %u!\n", sector);
+			res = 1;
+			break;
+		}
+
+		res = _fd_recv(dev, data, len, &bytes);
+		if (!res && (uint32_t)bytes != len)
+			res = LIBUSB_ERROR_IO;
+		if (res)
+			break;
+
+		if (verify)
+		{
+			_sha256(hash, data, len);
+			if (memcmp(hash, hdr->sha256, sizeof(hash)))
+			{
+				fprintf(stderr, "\nSHA256 mismatch at sector %u!\n", sector);
+				res = 1;
+				break;
+			}
+		}
+
+		if (fwrite(data, 1, len, fp) != len)
+		{
+			fprintf(stderr, "\nFailed to write %s!\n", path);
+			res = 1;
+			break;
+		}
+
+		sector += hdr->count;
+
+		time_t elapsed = time(NULL) - start;
+		printf("\r%u/%u MiB (%u MiB/s)", sector >> 11, total >> 11,
+			elapsed ? (uint32_t)(((sector - start_sector) >> 11) / elapsed) : 0);
+		fflush(stdout);
+	}
+	printf("\n");
+
+	free(data);
+
+	if (res && res != LIBUSB_ERROR_NO_DEVICE)
+		fprintf(stderr, "Run again to resume.\n");
+
+out:
+	fclose(fp);
+
+	if (res && res < 0)
+		fprintf(stderr, "USB error: %s\n", libusb_error_name(res));
+	else if (!res)
+		printf("Done.\n");
+
+	return res ? 1 : 0;
+}
+
+static void _usage()
+{
+	printf("Usage: fastdump info\n"
+		"       fastdump [-s] [-e] <gpp|boot0|boot1|sd> <out.bin>\n"
+		"         -s: Verify each chunk with SHA256.\n"
+		"         -e: End the gadget when done.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int verify = 0;
+	int end = 0;
+	int res = 1;
+	int argi = 1;
+	uint32_t storage = FD_STORAGE_MAX;
+	fd_info_t info;
+
+	for (; argi < argc && argv[argi][0] == '-'; argi++)
+	{
+		if (!strcmp(argv[argi], "-s"))
+			verify = 1;
+		else if (!strcmp(argv[argi], "-e"))
+			end = 1;
+		else
+		{
+			_usage();
+			return 1;
+		}
+	}
+
+	if (argi >= argc)
+	{
+		_usage();
+		return 1;
+	}
+
+	int info_only = !strcmp(argv[argi], "info");
+	if (!info_only)
+	{
+		for (storage = 0; storage < FD_STORAGE_MAX; storage++)
+			if (!strcmp(argv[argi], storage_names[storage]))
+				break;
+
+		if (storage == FD_STORAGE_MAX || argi + 1 >= argc)
+		{
+			_usage();
+			return 1;
+		}
+	}
+
+	if (libusb_init(NULL))
+	{
+		fprintf(stderr, "Failed to init libusb!\n");
+		return 1;
+	}
+
+	libusb_device_handle *dev = libusb_open_device_with_vid_pid(NULL, FD_VID, FD_PID);
+	if (!dev)
+	{
+		fprintf(stderr, "Device not found! Start Fast Dump in Nyx first.\n");
+		goto out;
+	}
+
+	libusb_set_auto_detach_kernel_driver(dev, 1);
+	if (libusb_claim_interface(dev, 0))
+	{
+		fprintf(stderr, "Failed to claim interface!\n");
+		goto out_close;
+	}
+
+	if (_fd_get_info(dev, &info))
+		goto out_release;
+
+	if (info_only)
+	{
+		for (uint32_t i = 0; i < FD_STORAGE_MAX; i++)
+		{
+			printf("%-6s %10u sectors (%u MiB)\n", storage_names[i],
+				info.sectors[i], info.sectors[i] >> 11);
+		}
+		res = 0;
+	}
+	else
+		res = _fd_dump(dev, &info, storage, argv[argi + 1], verify);
+
+	if (end)
+		_fd_send_cmd(dev, FD_CMD_END, 0, 0, 0, 0);
+
+out_release:
+	libusb_release_interface(dev, 0);
+out_close:
+	libusb_close(dev);
+out:
+	libusb_exit(NULL);
+
+	return res;
+}
@@ -0,0 +1,1578 @@
+/*
+ * BDK host microbenchmarks
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/utsname.h>
+
+#include <bdk.h>
+
+#include <memory_map.h>
+#include <libs/compr/blz.h>
+#include <libs/compr/lz.h>
+#include <libs/compr/lz4.h>
+#include <libs/fatfs/diskio.h>
+#include <libs/fatfs/ff.h>
+#include <storage/nx_emmc_bis.h>
+#include <storage/ramdisk.h>
+#include <utils/dirlist.h>
+#include <utils/ini.h>
+#include <utils/sprintf.h>
+
+#include "../../nyx/nyx_gui/frontend/fe_file_copy.h"
+
+#include "jc_uart.h"
+#include "sprintf_ref.h"
+#include "storage.h"
+#include "usb.h"
+
+#define BENCH_DATA_SZ      SZ_4M
+#define BENCH_CRC_SZ       SZ_16M
+#define BENCH_FILE_SZ      SZ_32M
+#define BENCH_FILE_CHUNK   SZ_1M
+#define BENCH_RAMDISK_SZ   SZ_64M
+#define BENCH_SD_SZ        SZ_512M
+#define BENCH_EMMC_SZ      SZ_128M
+#define BENCH_BIS_SZ       SZ_16M
+#define BENCH_BIS_CHUNK    SZ_16K // One BIS cluster.
+#define BENCH_UMS_LBA      (SZ_32M / SDMMC_DAT_BLOCKSIZE)
+#define BENCH_UMS_SZ       SZ_64M
+#define BENCH_UMS_XFER     (SZ_1M / SDMMC_DAT_BLOCKSIZE)
+#define BENCH_SMALL_FILES  256
+#define BENCH_DIR_FILES    2048
+#define BENCH_OPEN_FILES   10000
+#define BENCH_INI_SECTIONS 64
+#define BENCH_HASH_LINES   32768
+#define BENCH_EXFAT_SZ     SZ_1G
+#define BENCH_EXFAT_FILES  4096
+#define BENCH_EXFAT_RUN    SZ_512K
+#define BENCH_COPY_SD_SZ   SZ_2G
+#define BENCH_COPY_LARGE   24
+#define BENCH_COPY_LARGE_SZ (40 * SZ_1M)
+#define BENCH_COPY_SMALL   512
+#define BENCH_COPY_SMALL_SZ SZ_128K
+#define BENCH_GFX_WIDTH    720
+#define BENCH_GFX_HEIGHT   1280
+#define BENCH_GFX_SCREENS  64
+#define BENCH_JC_RPTS      65536
+
+#define BLZ_HASH_BITS 16
+#define BLZ_CHAIN_MAX 32
+
+// From tools/lz. Its decoder is renamed at build time.
+int LZ_CompressFast(unsigned char *in, unsigned char *out, unsigned int insize, unsigned int *work);
+
+// From hekate's console. Its header clashes with the host one.
+void gfx_init_ctxt(u32 *fb, u32 width, u32 height, u32 stride);
+void gfx_con_init();
+void gfx_con_setcol(u32 fgcol, int fillbg, u32 bgcol);
+void gfx_con_setpos(u32 x, u32 y);
+void gfx_putc(char c);
+
+typedef struct _bench_t
+{
+	const char *name;
+	int (*prepare)();
+	int (*run)(const void *arg, u64 *bytes);
+	const void *arg;
+} bench_t;
+
+typedef struct _bench_res_t
+{
+	u64 bytes;
+	u64 ns_min;
+	u64 ns_total;
+} bench_res_t;
+
+static u32 rng;
+static char img_dir[256];
+static char sd_img[300];
+static char emmc_img[300];
+
+static u8 *data;        // Semi compressible data.
+static u8 *cmp;         // Compressed data.
+static u8 *dec;         // Decompressed data.
+static u32 cmp_size;
+
+static u8 *bis_data;
+static u8 *ums_data;
+
+static FATFS ram_fs;
+static emmc_part_t bis_part;
+
+static void _rand_seed(u32 seed)
+{
+	rng = seed;
+}
+
+// Xorshift32. Results must not depend on the host.
+static u32 _rand()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+static void _rand_fill(u8 *buf, u32 size)
+{
+	for (u32 i = 0; i < size; i += 4)
+		*(u32 *)&buf[i] = _rand();
+}
+
+/*
+ * Fills with words from a small dictionary and some noise.
+ * Compresses about as well as the payloads BDK decompresses.
+ */
+static void _text_fill(u8 *buf, u32 size)
+{
+	static const char *words[] = {
+		"hekate", "nyx", "bdk", "sdmmc", "emmc", "fatfs", "cluster", "sector",
+		"payload", "kernel", "secmon", "warmboot", "[config]", "autoboot=", "0x", "\n",
+		"{", "}", " ", " ", "\t", "=1", "=0", "bootloader/",
+	};
+
+	u32 pos = 0;
+	while (pos < size)
+	{
+		u32 r = _rand();
+		if ((r & 0xF) == 0)
+			buf[pos++] = r >> 8;
+		else
+		{
+			const char *w = words[(r >> 4) % ARRAY_SIZE(words)];
+			while (*w && pos < size)
+				buf[pos++] = *w++;
+		}
+	}
+}
+
+/*
+ * Greedy backwards BLZ encoder. Only the decoder exists in BDK.
+ * Writes [raw head][compressed tail][footer] and returns the total size.
+ * The raw head is as long as needed for in place decompression to be safe.
+ */
+static u32 _blz_compress(const u8 *src, u32 size, u8 *dst)
+{
+	u8  *tmp  = malloc(size + size / 8 + 16); // Reversed stream.
+	u32 *head = malloc(sizeof(u32) << BLZ_HASH_BITS);
+	u32 *prev = malloc(sizeof(u32) * (size + 1));
+	memset(head, 0xFF, sizeof(u32) << BLZ_HASH_BITS);
+
+	u32 out = size;     // Source bytes left.
+	u32 emitted = 0;    // Stream bytes.
+	u32 ctrl_pos = 0;
+	u32 ctrl_bit = 0;
+	u32 inserted = size + 1;
+	s64 best_gain = 0;
+	u32 best_out = size;
+	u32 best_emitted = 0;
+
+	while (out)
+	{
+		// Index end positions that can be a match source.
+		while (inserted > out + 3 && inserted > 3)
+		{
+			inserted--;
+			u32 h = ((src[inserted - 1] << 16) | (src[inserted - 2] << 8) | src[inserted - 3]) * 2654435761u >> (32 - BLZ_HASH_BITS);
+			prev[inserted] = head[h];
+			head[h] = inserted;
+		}
+
+		if (!ctrl_bit)
+		{
+			ctrl_pos = emitted++;
+			tmp[ctrl_pos] = 0;
+			ctrl_bit = 0x80;
+		}
+
+		u32 best_len = 0;
+		u32 best_ofs = 0;
+		if (out >= 3)
+		{
+			u32 h = ((src[out - 1] << 16) | (src[out - 2] << 8) | src[out - 3]) * 2654435761u >> (32 - BLZ_HASH_BITS);
+			u32 q = head[h];
+			for (u32 depth = 0; q != 0xFFFFFFFF && depth < BLZ_CHAIN_MAX; depth++, q = prev[q])
+			{
+				u32 ofs = q - out;
+				if (ofs > 4098)
+					break;
+
+				// Source must be decoded already, so no overlap.
+				u32 max = MIN(MIN(ofs, 18), out);
+				u32 len = 0;
+				while (len < max && src[out - 1 - len] == src[q - 1 - len])
+					len++;
+
+				if (len > best_len)
+				{
+					best_len = len;
+					best_ofs = ofs;
+					if (len == max)
+						break;
+				}
+			}
+		}
+
+		if (best_len >= 3)
+		{
+			u16 val = ((best_len - 3) << 12) | (best_ofs - 3);
+			tmp[ctrl_pos] |= ctrl_bit;
+			tmp[emitted++] = val >> 8;
+			tmp[emitted++] = val & 0xFF;
+			out -= best_len;
+		}
+		else
+			tmp[emitted++] = src[--out];
+
+		ctrl_bit >>= 1;
+
+		// Best cut point keeps decoder writes above unread stream bytes.
+		s64 gain = (s64)(size - out) - emitted;
+		if (gain >= best_gain)
+		{
+			best_gain = gain;
+			best_out = out;
+			best_emitted = emitted;
+		}
+	}
+
+	// Raw head, then the stream in decoder order and the footer.
+	memcpy(dst, src, best_out);
+	for (u32 i = 0; i < best_emitted; i++)
+		dst[best_out + i] = tmp[best_emitted - 1 - i];
+
+	blz_footer footer;
+	footer.cmp_and_hdr_size = best_emitted + sizeof(blz_footer);
+	footer.header_size = sizeof(blz_footer);
+	footer.addl_size = (size - best_out) - footer.cmp_and_hdr_size;
+	memcpy(dst + best_out + best_emitted, &footer, sizeof(blz_footer));
+
+	free(prev);
+	free(head);
+	free(tmp);
+
+	return best_out + best_emitted + sizeof(blz_footer);
+}
+
+static int _prepare_data()
+{
+	if (data)
+		return 0;
+
+	data = malloc(BENCH_DATA_SZ);
+	cmp  = malloc(LZ4_compressBound(BENCH_DATA_SZ) + BENCH_DATA_SZ / 8);
+	dec  = malloc(BENCH_DATA_SZ);
+
+	_rand_seed(0x4B435548);
+	_text_fill(data, BENCH_DATA_SZ);
+
+	return 0;
+}
+
+static int _bench_heap(const void *arg, u64 *bytes)
+{
+	void *slots[256] = {0};
+	u64 total = 0;
+
+	_rand_seed(1);
+	for (u32 i = 0; i < 100000; i++)
+	{
+		u32 idx = _rand() & 0xFF;
+		free(slots[idx]);
+
+		u32 size = 16 << (_rand() % 12);
+		size += _rand() & (size - 1);
+		slots[idx] = malloc(size);
+		total += size;
+	}
+
+	for (u32 i = 0; i < ARRAY_SIZE(slots); i++)
+		free(slots[i]);
+
+	*bytes = total;
+
+	return 0;
+}
+
+typedef struct _bench_node_t
+{
+	u32 val;
+	link_t link;
+} bench_node_t;
+
+static int _bench_list(const void *arg, u64 *bytes)
+{
+	LIST_INIT(list);
+	const u32 count = 65536;
+
+	// One allocation. BDK heap walk would dominate otherwise.
+	bench_node_t *nodes = malloc(count * sizeof(bench_node_t));
+
+	for (u32 i = 0; i < count; i++)
+	{
+		nodes[i].val = i;
+		if (i & 1)
+			list_append(&list, &nodes[i].link);
+		else
+			list_prepend(&list, &nodes[i].link);
+	}
+
+	u64 sum = 0;
+	LIST_FOREACH_ENTRY(bench_node_t, node, &list, link)
+		sum += node->val;
+
+	while (!list_empty(&list))
+		list_remove(list.next);
+
+	free(nodes);
+
+	*bytes = (u64)count * sizeof(bench_node_t);
+
+	return sum != (u64)count * (count - 1) / 2;
+}
+
+static int _bench_sprintf(const void *arg, u64 *bytes)
+{
+	char buf[256];
+	u64 total = 0;
+
+	void (*fmt)(char *, const char *, ...) = arg ? ref_s_printf : s_printf;
+
+	for (u32 i = 0; i < 200000; i++)
+	{
+		fmt(buf, "%s %d: %08X %c %5d%% [%s]\n", "sector", i, i * 2654435761u,
+			'A' + (i % 26), i % 100, "bootloader/payloads");
+		total += strlen(buf);
+	}
+
+	*bytes = total;
+
+	return 0;
+}
+
+static int _bench_sprintf_check(const void *arg, u64 *bytes)
+{
+	char buf[256];
+	char ref[256];
+	char small[8];
+	u64 total = 0;
+
+	// Unknown specifiers are printed as is.
+	static const char *mixed = "%d %X %08X %5d %3d %c%s %% %q %016X %010d|%*";
+
+	_rand_seed(0x5EED);
+
+	for (u32 i = 0; i < 100000; i++)
+	{
+		u32 v = _rand();
+		u32 w = i & 1 ? v >> (i % 32) : -(int)(v >> (i % 32));
+		u32 pad = i % 24;
+
+		s_printf(buf, mixed, w, v, w, w, v & 0xFFF, 'a' + (i % 26), "str", v, w);
+		ref_s_printf(ref, mixed, w, v, w, w, v & 0xFFF, 'a' + (i % 26), "str", v, w);
+		if (strcmp(buf, ref))
+			return 1;
+		total += strlen(buf);
+
+		// Padding width from a runtime format.
+		char fmt[16];
+		ref_s_printf(fmt, "[%%0%dd][%% %dX]", pad, pad % 10);
+		s_printf(buf, fmt, w, v);
+		ref_s_printf(ref, fmt, w, v);
+		if (strcmp(buf, ref))
+			return 1;
+
+		// Same output as s_printf, just truncated.
+		int len = s_snprintf(small, sizeof(small), "%d", w);
+		s_printf(buf, "%d", w);
+		if (len != (int)MIN(strlen(buf), sizeof(small) - 1) || strncmp(small, buf, len) || small[len])
+			return 1;
+
+		// Public number formatter must match gfx_printf/s_printf padding.
+		len = s_putn(buf, w, i & 2 ? 16 : 10, '0', pad);
+		ref_s_printf(fmt, "%%0%d%c", pad, i & 2 ? 'X' : 'd');
+		ref_s_printf(ref, fmt, w);
+		if (strcmp(buf, ref) || len != (int)strlen(buf))
+			return 1;
+	}
+
+	if (s_snprintf(small, 0, "abc") != 0 || s_snprintf(small, 1, "abc") != 0 || small[0])
+		return 1;
+
+	*bytes = total;
+
+	return 0;
+}
+
+static void _hexstr_ref(char *out, const u8 *data, u32 size)
+{
+	static const char hexa[] = "0123456789abcdef";
+
+	for (u32 i = 0; i < size; i++)
+	{
+		*out++ = hexa[data[i] >> 4];
+		*out++ = hexa[data[i] & 0x0F];
+	}
+	*out = '\0';
+}
+
+static int _bench_hexstr(const void *arg, u64 *bytes)
+{
+	char buf[SZ_4K * 2 + 1];
+	char ref[SZ_4K * 2 + 1];
+
+	for (u32 pos = 0; pos < BENCH_DATA_SZ; pos += SZ_4K)
+		s_hexstr(buf, data + pos, SZ_4K);
+
+	_hexstr_ref(ref, data + BENCH_DATA_SZ - SZ_4K, SZ_4K);
+	*bytes = BENCH_DATA_SZ;
+
+	return strcmp(buf, ref);
+}
+
+static int _bench_crc32(const void *arg, u64 *bytes)
+{
+	u32 crc = 0;
+
+	for (u32 i = 0; i < BENCH_CRC_SZ / BENCH_DATA_SZ; i++)
+		crc = crc32_calc(crc, data, BENCH_DATA_SZ);
+
+	*bytes = BENCH_CRC_SZ;
+
+	return !crc;
+}
+
+static int _bench_lz4_compress(const void *arg, u64 *bytes)
+{
+	cmp_size = LZ4_compress_default((const char *)data, (char *)cmp, BENCH_DATA_SZ, LZ4_compressBound(BENCH_DATA_SZ));
+	*bytes = BENCH_DATA_SZ;
+
+	return !cmp_size;
+}
+
+static int _prepare_lz4()
+{
+	_prepare_data();
+
+	u64 bytes;
+	return _bench_lz4_compress(NULL, &bytes);
+}
+
+static int _bench_lz4_decompress(const void *arg, u64 *bytes)
+{
+	int res = LZ4_decompress_safe((const char *)cmp, (char *)dec, cmp_size, BENCH_DATA_SZ);
+	*bytes = BENCH_DATA_SZ;
+
+	return res != BENCH_DATA_SZ || memcmp(dec, data, BENCH_DATA_SZ);
+}
+
+static int _prepare_blz()
+{
+	_prepare_data();
+	cmp_size = _blz_compress(data, BENCH_DATA_SZ, cmp);
+
+	return !cmp_size;
+}
+
+static int _bench_blz_decompress(const void *arg, u64 *bytes)
+{
+	int res = blz_uncompress_srcdest(cmp, cmp_size, dec, BENCH_DATA_SZ);
+	*bytes = BENCH_DATA_SZ;
+
+	return !res || memcmp(dec, data, BENCH_DATA_SZ);
+}
+
+static int _prepare_lz()
+{
+	_prepare_data();
+
+	u32 *work = malloc(sizeof(u32) * (BENCH_DATA_SZ + 65536));
+	cmp_size = LZ_CompressFast(data, cmp, BENCH_DATA_SZ, work);
+	free(work);
+
+	return !cmp_size;
+}
+
+static int _bench_lz_decompress(const void *arg, u64 *bytes)
+{
+	u32 res = LZ_Uncompress(cmp, dec, cmp_size);
+	*bytes = BENCH_DATA_SZ;
+
+	return res != BENCH_DATA_SZ || memcmp(dec, data, BENCH_DATA_SZ);
+}
+
+static int _prepare_fs()
+{
+	static bool ready;
+
+	if (ready)
+		return 0;
+
+	_prepare_data();
+
+	s_printf(sd_img, "%s/bdk_bench_sd.img", img_dir);
+	if (host_storage_open(&sd_storage, sd_img, BENCH_SD_SZ / SDMMC_DAT_BLOCKSIZE))
+		return 1;
+
+	// Same layout as Nyx SD partitioning, only smaller.
+	u8 *work = malloc(SZ_4M);
+	int res = f_mkfs("sd:", FM_FAT32, SZ_4K, work, SZ_4M);
+	free(work);
+	if (res || !sd_mount())
+		return 1;
+
+	if (ram_disk_init(&ram_fs, BENCH_RAMDISK_SZ))
+		return 1;
+
+	f_mkdir("sd:/bench");
+	f_mkdir("ram:/bench");
+
+	ready = true;
+
+	return 0;
+}
+
+static int _bench_fs_write(const void *arg, u64 *bytes)
+{
+	FIL fp;
+	UINT bw;
+
+	if (f_open(&fp, arg, FA_CREATE_ALWAYS | FA_WRITE))
+		return 1;
+
+	for (u32 pos = 0; pos < BENCH_FILE_SZ; pos += BENCH_FILE_CHUNK)
+	{
+		if (f_write(&fp, data + pos % BENCH_DATA_SZ, BENCH_FILE_CHUNK, &bw) || bw != BENCH_FILE_CHUNK)
+		{
+			f_close(&fp);
+			return 1;
+		}
+	}
+
+	*bytes = BENCH_FILE_SZ;
+
+	return f_close(&fp);
+}
+
+static int _bench_fs_read(const void *arg, u64 *bytes)
+{
+	FIL fp;
+	UINT br;
+	int res = 0;
+
+	if (f_open(&fp, arg, FA_READ))
+		return 1;
+
+	for (u32 pos = 0; pos < BENCH_FILE_SZ; pos += BENCH_FILE_CHUNK)
+	{
+		if (f_read(&fp, dec, BENCH_FILE_CHUNK, &br) || br != BENCH_FILE_CHUNK ||
+			memcmp(dec, data + pos % BENCH_DATA_SZ, BENCH_FILE_CHUNK))
+		{
+			res = 1;
+			break;
+		}
+	}
+
+	f_close(&fp);
+	*bytes = BENCH_FILE_SZ;
+
+	return res;
+}
+
+static int _prepare_fs_file()
+{
+	u64 bytes;
+
+	if (_prepare_fs())
+		return 1;
+
+	// Read benches need the file in place, even when filtered alone.
+	if (f_stat("sd:/bench/big.bin", NULL) && _bench_fs_write("sd:/bench/big.bin", &bytes))
+		return 1;
+	if (f_stat("ram:/bench/big.bin", NULL) && _bench_fs_write("ram:/bench/big.bin", &bytes))
+		return 1;
+
+	return 0;
+}
+
+static int _bench_fs_small(const void *arg, u64 *bytes)
+{
+	char path[64];
+	FIL fp;
+	UINT bw;
+
+	f_mkdir("sd:/bench/small");
+
+	for (u32 i = 0; i < BENCH_SMALL_FILES; i++)
+	{
+		s_printf(path, "sd:/bench/small/%d.bin", i);
+		if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+			return 1;
+		f_write(&fp, data + i * SZ_4K, SZ_4K, &bw);
+		f_close(&fp);
+	}
+
+	for (u32 i = 0; i < BENCH_SMALL_FILES; i++)
+	{
+		s_printf(path, "sd:/bench/small/%d.bin", i);
+		if (f_unlink(path))
+			return 1;
+	}
+
+	*bytes = BENCH_SMALL_FILES * SZ_4K;
+
+	return f_unlink("sd:/bench/small");
+}
+
+// Unaligned and sub-cluster sizes, as dump/copy tails produce them.
+static const u32 fast_write_sizes[] = {
+	SZ_1M, SZ_4K, SZ_4K * 3 + 512 * 2, 512 * 3 + 100, 1000, SZ_1M + 7, SZ_64K
+};
+
+static int _fs_write_fast_check(const char *path, u32 total)
+{
+	FIL fp;
+	UINT br;
+	int res = 0;
+
+	if (f_open(&fp, path, FA_READ))
+		return 1;
+	if (f_read(&fp, dec, total, &br) || br != total || memcmp(dec, data, total))
+		res = 1;
+	f_close(&fp);
+
+	return res;
+}
+
+static int _bench_fs_write_fast(const void *arg, u64 *bytes)
+{
+	FIL fp;
+	UINT bw;
+	u32 total = 0;
+	bool fragmented = !strcmp(arg, "frag");
+	const char *path = "sd:/bench/fast.bin";
+
+	for (u32 i = 0; i < ARRAY_SIZE(fast_write_sizes); i++)
+		total += fast_write_sizes[i];
+
+	if (fragmented)
+	{
+		// Interleave clusters with another file so the chain is not contiguous.
+		FIL fp_pad;
+		if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+			return 1;
+		if (f_open(&fp_pad, "sd:/bench/fast_pad.bin", FA_CREATE_ALWAYS | FA_WRITE))
+		{
+			f_close(&fp);
+			return 1;
+		}
+		for (u32 pos = 0; pos < total; pos += SZ_4K)
+		{
+			f_write(&fp, dec, SZ_4K, &bw);
+			f_write(&fp_pad, dec, SZ_4K, &bw);
+		}
+		f_close(&fp_pad);
+		f_close(&fp);
+
+		if (f_open(&fp, path, FA_OPEN_EXISTING | FA_WRITE))
+			return 1;
+	}
+	else if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+		return 1;
+
+	DWORD *clmt = f_expand_cltbl(&fp, SZ_4M, fragmented ? f_size(&fp) : total);
+	if (!clmt || (fp.obj.stat == 2) == fragmented)
+	{
+		f_close(&fp);
+		return 1;
+	}
+
+	u32 pos = 0;
+	for (u32 i = 0; i < ARRAY_SIZE(fast_write_sizes); i++)
+	{
+		if (f_write_fast(&fp, data + pos, fast_write_sizes[i]) || f_tell(&fp) != pos + fast_write_sizes[i])
+		{
+			f_close(&fp);
+			return 1;
+		}
+		pos += fast_write_sizes[i];
+	}
+
+	ff_memfree(clmt);
+	if (f_close(&fp) || _fs_write_fast_check(path, total))
+		return 1;
+
+	*bytes = total;
+
+	if (fragmented && f_unlink("sd:/bench/fast_pad.bin"))
+		return 1;
+
+	return f_unlink(path);
+}
+
+// Same line layout as the eMMC backup sha256sums.
+static int _bench_fs_hashlog(const void *arg, u64 *bytes)
+{
+	FIL fp;
+	FPUTBUF pb;
+	u8 pb_buf[512];
+	char line[SE_SHA_256_SIZE * 2 + 2];
+	bool buffered = !strcmp(arg, "putbuf");
+	int res = 0;
+
+	if (f_open(&fp, "sd:/bench/hash.sha256sums", FA_CREATE_ALWAYS | FA_WRITE))
+		return 1;
+
+	f_putbuf_init(&pb, &fp, pb_buf, sizeof(pb_buf));
+	for (u32 i = 0; i < BENCH_HASH_LINES; i++)
+	{
+		s_hexstr(line, data + (i * SE_SHA_256_SIZE) % BENCH_DATA_SZ, SE_SHA_256_SIZE);
+		line[SE_SHA_256_SIZE * 2]     = '\n';
+		line[SE_SHA_256_SIZE * 2 + 1] = '\0';
+
+		if (buffered)
+			res = f_putbuf_puts(&pb, line) == EOF;
+		else
+			res = f_puts(line, &fp) == EOF;
+		if (res)
+			break;
+	}
+	if (buffered && f_putbuf_flush(&pb) == EOF)
+		res = 1;
+	f_close(&fp);
+
+	if (res)
+		return 1;
+
+	// Check content. Each line gets CRLF.
+	u32 line_sz = SE_SHA_256_SIZE * 2 + 2;
+	u8 *buf = malloc(line_sz * BENCH_HASH_LINES);
+	UINT br;
+
+	if (f_open(&fp, "sd:/bench/hash.sha256sums", FA_READ))
+	{
+		free(buf);
+		return 1;
+	}
+	if (f_read(&fp, buf, line_sz * BENCH_HASH_LINES, &br) || br != line_sz * BENCH_HASH_LINES || f_size(&fp) != br)
+		res = 1;
+	f_close(&fp);
+
+	for (u32 i = 0; !res && i < BENCH_HASH_LINES; i++)
+	{
+		_hexstr_ref(line, data + (i * SE_SHA_256_SIZE) % BENCH_DATA_SZ, SE_SHA_256_SIZE);
+		u8 *p = buf + i * line_sz;
+		if (memcmp(p, line, SE_SHA_256_SIZE * 2) || p[SE_SHA_256_SIZE * 2] != '\r' || p[SE_SHA_256_SIZE * 2 + 1] != '\n')
+			res = 1;
+	}
+	free(buf);
+
+	*bytes = (u64)line_sz * BENCH_HASH_LINES;
+
+	return res || f_unlink("sd:/bench/hash.sha256sums");
+}
+
+static int _prepare_ini()
+{
+	static bool ready;
+	char *buf;
+
+	if (ready)
+		return 0;
+
+	if (_prepare_fs())
+		return 1;
+
+	// Hekate style config with many boot entries.
+	buf = malloc(SZ_256K);
+	char *pos = buf;
+	pos += strlen(strcpy(pos, "[config]\nautoboot=0\nautoboot_list=0\nbootwait=3\nbacklight=100\n\n"));
+	for (u32 i = 0; i < BENCH_INI_SECTIONS; i++)
+	{
+		s_printf(pos, "{--- Entry %d ---}\n[Entry %d]\npkg3=atmosphere/package3\nkip1=atmosphere/kips/*\n"
+			"emummcforce=1\nkip1patch=nosigchk\nicon=bootloader/res/icon_%d.bmp\nid=ENT%d\n\n", i, i, i, i);
+		pos += strlen(pos);
+	}
+
+	FIL fp;
+	UINT bw;
+	int res = f_open(&fp, "sd:/bench/bench.ini", FA_CREATE_ALWAYS | FA_WRITE);
+	if (!res)
+	{
+		res = f_write(&fp, buf, pos - buf, &bw);
+		f_close(&fp);
+	}
+	free(buf);
+
+	if (res)
+		return 1;
+
+	// Directory with unsorted names for listing.
+	f_mkdir("sd:/bench/dir");
+	for (u32 i = 0; i < BENCH_DIR_FILES; i++)
+	{
+		char path[64];
+		s_printf(path, "sd:/bench/dir/entry_%d.%s", (i * 7919) % BENCH_DIR_FILES, (i & 3) ? "ini" : "bin");
+		if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+			return 1;
+		f_close(&fp);
+	}
+
+	ready = true;
+
+	return 0;
+}
+
+static int _bench_ini(const void *arg, u64 *bytes)
+{
+	FILINFO fno;
+
+	for (u32 i = 0; i < 20; i++)
+	{
+		LIST_INIT(ini_sections);
+		if (!ini_parse(&ini_sections, "sd:/bench/bench.ini", false))
+			return 1;
+		ini_free(&ini_sections);
+	}
+
+	f_stat("sd:/bench/bench.ini", &fno);
+	*bytes = fno.fsize * 20;
+
+	return 0;
+}
+
+static int _bench_dirlist(const void *arg, u64 *bytes)
+{
+	u32 count = 0;
+
+	for (u32 i = 0; i < 10; i++)
+	{
+		dirlist_t *list = dirlist("sd:/bench/dir", "*.ini", DIR_NATURAL_ORDER);
+		if (!list)
+			return 1;
+		count += list->count;
+		free(list);
+	}
+
+	*bytes = count * sizeof(FILINFO);
+
+	return count != 10 * (BENCH_DIR_FILES - BENCH_DIR_FILES / 4);
+}
+
+// Free clusters from the raw FAT, an entry at a time.
+static u32 _fat32_free_ref(FATFS *fs, const u8 *disk)
+{
+	const u32 *fat = (const u32 *)(disk + (u64)fs->fatbase * SDMMC_DAT_BLOCKSIZE);
+	u32 nfree = 0;
+
+	for (u32 i = 2; i < fs->n_fatent; i++)
+		nfree += !(fat[i] & 0x0FFFFFFF);
+
+	return nfree;
+}
+
+// Free clusters from the raw exFAT allocation bitmap, a bit at a time.
+static u32 _exfat_free_ref(FATFS *fs)
+{
+	const u8 *bitmap = ram_disk_get_ptr(fs->bitbase, 1);
+	u32 nfree = 0;
+
+	for (u32 i = 0; i < fs->n_fatent - 2; i++)
+		nfree += !(bitmap[i / 8] & BIT(i % 8));
+
+	return nfree;
+}
+
+static int _bench_fs_getfree(const void *arg, u64 *bytes)
+{
+	bool exfat = arg != NULL;
+	FATFS *fs = exfat ? &ram_fs : &sd_fs;
+	u32 nfree_ref = exfat ? _exfat_free_ref(fs) : _fat32_free_ref(fs, host_storage_disk(&sd_storage)->data);
+	FATFS *fs_out;
+	DWORD nfree;
+
+	// Drop the free count so each call scans the whole FAT or bitmap.
+	for (u32 i = 0; i < 20; i++)
+	{
+		fs->free_clst = 0xFFFFFFFF;
+		if (f_getfree(exfat ? "ram:" : "sd:", &nfree, &fs_out) || nfree != nfree_ref)
+			return 1;
+	}
+
+	*bytes = (u64)(exfat ? (fs->n_fatent - 2) / 8 : fs->n_fatent * sizeof(u32)) * 20;
+
+	return 0;
+}
+
+/*
+ * Formats the ramdisk as exFAT with small clusters and fills half of it with
+ * files of random sizes, then deletes every other one. Bitmap words end up
+ * mixed, like on a card that has been in use for a while.
+ * Replaces the ramdisk volume, so it must run after the other ramdisk benches.
+ */
+static int _prepare_exfat()
+{
+	static bool ready;
+	char path[64];
+	FIL fp;
+
+	if (ready)
+		return 0;
+
+	if (_prepare_fs())
+		return 1;
+
+	u32 sectors = BENCH_EXFAT_SZ / SDMMC_DAT_BLOCKSIZE;
+	ram_disk_init(NULL, BENCH_EXFAT_SZ);
+	disk_set_info(DRIVE_RAM, SET_SECTOR_COUNT, &sectors);
+
+	f_mount(NULL, "ram:", 1);
+	u8 *work = malloc(SZ_4M);
+	int res = f_mkfs("ram:", FM_EXFAT | FM_SFD, SZ_4K, work, SZ_4M);
+	free(work);
+	if (res || f_mount(&ram_fs, "ram:", 1))
+		return 1;
+
+	_rand_seed(0x45584654);
+	for (u32 i = 0; i < BENCH_EXFAT_FILES; i++)
+	{
+		if (!(i % 256))
+		{
+			s_printf(path, "ram:/%d", i / 256);
+			f_mkdir(path);
+		}
+
+		s_printf(path, "ram:/%d/%d.bin", i / 256, i);
+		if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+			return 1;
+		res = f_expand(&fp, (_rand() % 64 + 1) * SZ_4K, 1);
+		if (f_close(&fp) || res)
+			return 1;
+	}
+
+	for (u32 i = 0; i < BENCH_EXFAT_FILES; i += 2)
+	{
+		s_printf(path, "ram:/%d/%d.bin", i / 256, i);
+		if (f_unlink(path))
+			return 1;
+	}
+
+	ready = true;
+
+	return 0;
+}
+
+// Contiguous allocations need free runs longer than most holes.
+static int _bench_exfat_expand(const void *arg, u64 *bytes)
+{
+	char path[64];
+	FIL fp;
+	DWORD nfree, nfree_start;
+	FATFS *fs;
+
+	if (f_getfree("ram:", &nfree_start, &fs) || f_mkdir("ram:/runs"))
+		return 1;
+
+	// Search from the start, over the fragmented part.
+	ram_fs.last_clst = 2;
+
+	for (u32 i = 0; i < 64; i++)
+	{
+		s_printf(path, "ram:/runs/%d.bin", i);
+		if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+			return 1;
+		int res = f_expand(&fp, BENCH_EXFAT_RUN, 1);
+		if (f_close(&fp) || res)
+			return 1;
+	}
+
+	for (u32 i = 0; i < 64; i++)
+	{
+		s_printf(path, "ram:/runs/%d.bin", i);
+		if (f_unlink(path))
+			return 1;
+	}
+	if (f_unlink("ram:/runs"))
+		return 1;
+
+	*bytes = 64 * BENCH_EXFAT_RUN;
+
+	// Bitmap and free count must be back to where they were.
+	ram_fs.free_clst = 0xFFFFFFFF;
+	if (f_getfree("ram:", &nfree, &fs))
+		return 1;
+
+	return nfree != nfree_start || nfree != _exfat_free_ref(&ram_fs);
+}
+
+static int _prepare_open()
+{
+	static bool ready;
+	char path[64];
+	FIL fp;
+
+	if (ready)
+		return 0;
+
+	if (_prepare_fs())
+		return 1;
+
+	// Names with LFNs, like title folders and NCAs.
+	f_mkdir("sd:/bench/open");
+	for (u32 i = 0; i < BENCH_OPEN_FILES; i++)
+	{
+		s_printf(path, "sd:/bench/open/%08x%08x.nca", i * 0x9E3779B1, i);
+		if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+			return 1;
+		f_close(&fp);
+	}
+
+	ready = true;
+
+	return 0;
+}
+
+static int _bench_open(const void *arg, u64 *bytes)
+{
+	char path[64];
+	FIL fp;
+
+	for (u32 i = 0; i < BENCH_OPEN_FILES; i++)
+	{
+		s_printf(path, "sd:/bench/open/%08x%08x.nca", i * 0x9E3779B1, i);
+		if (f_open(&fp, path, FA_READ))
+			return 1;
+		f_close(&fp);
+	}
+
+	*bytes = BENCH_OPEN_FILES * sizeof(FILINFO);
+
+	return 0;
+}
+
+// File copy engine runs without labels.
+void lv_label_set_text(lv_obj_t *label, const char *text)
+{
+}
+
+void manual_system_maintenance(bool refresh)
+{
+}
+
+static void _copy_path(char *path, u32 idx)
+{
+	if (idx < BENCH_COPY_LARGE)
+		s_printf(path, "sd:/tree/large/%02d.bin", idx);
+	else
+		s_printf(path, "sd:/tree/small/%03d.bin", idx - BENCH_COPY_LARGE);
+}
+
+/*
+ * 1GiB tree on a bigger SD image, for the partition manager backup and restore.
+ * Replaces the SD and ramdisk volumes, so it must run after the other FatFs benches.
+ */
+static int _prepare_copy()
+{
+	static bool ready;
+	char path[64];
+	FIL fp;
+	UINT bw;
+
+	if (ready)
+		return 0;
+
+	_prepare_data();
+
+	sd_unmount();
+	host_storage_close(&sd_storage);
+	if (*sd_img)
+		unlink(sd_img);
+
+	s_printf(sd_img, "%s/bdk_bench_copy_sd.img", img_dir);
+	if (host_storage_open(&sd_storage, sd_img, BENCH_COPY_SD_SZ / SDMMC_DAT_BLOCKSIZE))
+		return 1;
+
+	u8 *work = malloc(SZ_4M);
+	int res = f_mkfs("sd:", FM_FAT32, SZ_4K, work, SZ_4M);
+	free(work);
+	if (res || !sd_mount())
+		return 1;
+
+	f_mkdir("sd:/tree");
+	f_mkdir("sd:/tree/large");
+	f_mkdir("sd:/tree/small");
+	for (u32 i = 0; i < BENCH_COPY_LARGE + BENCH_COPY_SMALL; i++)
+	{
+		u32 size = i < BENCH_COPY_LARGE ? BENCH_COPY_LARGE_SZ : BENCH_COPY_SMALL_SZ;
+
+		_copy_path(path, i);
+		if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+			return 1;
+		for (u32 pos = 0; pos < size && !res; pos += BENCH_COPY_SMALL_SZ)
+			res = f_write(&fp, data + (i * BENCH_COPY_SMALL_SZ + pos) % BENCH_DATA_SZ, BENCH_COPY_SMALL_SZ, &bw) || bw != BENCH_COPY_SMALL_SZ;
+		if (f_close(&fp) || res)
+			return 1;
+	}
+
+	ready = true;
+
+	return 0;
+}
+
+static int _bench_copy(const char *src, const char *dst)
+{
+	file_copy_ctxt_t copy;
+	char path[256] = "";
+
+	file_copy_init(&copy, src, dst, NULL);
+	int res = file_copy_dir(&copy, path);
+	int res_end = file_copy_end(&copy);
+
+	return res || res_end || copy.total_files != BENCH_COPY_LARGE + BENCH_COPY_SMALL;
+}
+
+// Backup to ramdisk, format SD and restore, like the partition manager does.
+static int _bench_copy_roundtrip(const void *arg, u64 *bytes)
+{
+	FIL fp;
+	UINT br;
+	char path[64];
+
+	if (ram_disk_init(&ram_fs, RAM_DISK_SZ) || _bench_copy("sd:", "ram:"))
+		return 1;
+
+	sd_unmount();
+	u8 *work = malloc(SZ_4M);
+	int res = f_mkfs("sd:", FM_FAT32, SZ_4K, work, SZ_4M);
+	free(work);
+	if (res || !sd_mount() || _bench_copy("ram:", "sd:"))
+		return 1;
+
+	*bytes = 2ULL * (BENCH_COPY_LARGE * BENCH_COPY_LARGE_SZ + BENCH_COPY_SMALL * BENCH_COPY_SMALL_SZ);
+
+	// Check size and the last block of each restored file.
+	for (u32 i = 0; i < BENCH_COPY_LARGE + BENCH_COPY_SMALL && !res; i++)
+	{
+		u32 size = i < BENCH_COPY_LARGE ? BENCH_COPY_LARGE_SZ : BENCH_COPY_SMALL_SZ;
+		u32 pos  = size - BENCH_COPY_SMALL_SZ;
+
+		_copy_path(path, i);
+		if (f_open(&fp, path, FA_READ))
+			return 1;
+		res = f_size(&fp) != size || f_lseek(&fp, pos) || f_read(&fp, dec, BENCH_COPY_SMALL_SZ, &br) ||
+			br != BENCH_COPY_SMALL_SZ || memcmp(dec, data + (i * BENCH_COPY_SMALL_SZ + pos) % BENCH_DATA_SZ, BENCH_COPY_SMALL_SZ);
+		f_close(&fp);
+	}
+
+	return res;
+}
+
+static int _prepare_emmc()
+{
+	static bool ready;
+
+	if (ready)
+		return 0;
+
+	s_printf(emmc_img, "%s/bdk_bench_emmc.img", img_dir);
+	if (host_storage_open(&emmc_storage, emmc_img, BENCH_EMMC_SZ / SDMMC_DAT_BLOCKSIZE))
+		return 1;
+
+	ready = true;
+
+	return 0;
+}
+
+static int _bench_bis_write(const void *arg, u64 *bytes)
+{
+	int res = 0;
+
+	nx_emmc_bis_init(&bis_part, arg != NULL, 0);
+	for (u32 pos = 0; pos < BENCH_BIS_SZ; pos += BENCH_BIS_CHUNK)
+	{
+		if (!nx_emmc_bis_write(pos / EMMC_BLOCKSIZE, BENCH_BIS_CHUNK / EMMC_BLOCKSIZE, bis_data + pos))
+		{
+			res = 1;
+			break;
+		}
+	}
+	nx_emmc_bis_end();
+
+	*bytes = BENCH_BIS_SZ;
+
+	return res;
+}
+
+static u32 *gfx_fb;
+
+static int _prepare_gfx()
+{
+	if (gfx_fb)
+		return 0;
+
+	gfx_fb = calloc(BENCH_GFX_WIDTH * BENCH_GFX_HEIGHT, sizeof(u32));
+	gfx_init_ctxt(gfx_fb, BENCH_GFX_WIDTH, BENCH_GFX_HEIGHT, BENCH_GFX_WIDTH);
+	gfx_con_init();
+
+	return 0;
+}
+
+// Full screens of 16px text, as the TUI prints them.
+static int _bench_gfx_putc(const void *arg, u64 *bytes)
+{
+	static const char text[] = "hekate - Launch / More configs / Payloads / Reboot (RCM) / Power off ";
+	bool fill = !strcmp(arg, "fill");
+	u32 cols = BENCH_GFX_WIDTH / 16;
+	u32 rows = BENCH_GFX_HEIGHT / 16;
+
+	for (u32 i = 0; i < BENCH_GFX_SCREENS; i++)
+	{
+		u32 pos = 0;
+
+		gfx_con_setcol(0xFFCCCCCC ^ i, fill, 0xFF1B1B1B);
+		gfx_con_setpos(0, 0);
+		for (u32 row = 0; row < rows; row++)
+		{
+			for (u32 col = 0; col < cols; col++)
+				gfx_putc(text[pos++ % (sizeof(text) - 1)]);
+			gfx_putc('\n');
+		}
+	}
+
+	*bytes = (u64)BENCH_GFX_SCREENS * cols * rows * 16 * 16 * sizeof(u32);
+
+	// Screens start with 'h'. Its stem is at the 2nd font column.
+	return gfx_fb[BENCH_GFX_WIDTH * 2 + 2] != (0xFFCCCCCC ^ (BENCH_GFX_SCREENS - 1));
+}
+
+static u8 *jc_capture;
+static u32 jc_capture_sz;
+
+static int _prepare_jc()
+{
+	if (jc_capture)
+		return 0;
+
+	jc_capture = malloc(BENCH_JC_RPTS * HOST_JC_PKT_SZ);
+	for (u32 i = 0; i < BENCH_JC_RPTS; i++)
+		jc_capture_sz += host_jc_input_rpt(jc_capture + jc_capture_sz, i, i * 0x10305, i & 0xFFF, (i * 7) & 0xFFF);
+
+	return 0;
+}
+
+// Wired input reports, received in chunks of the given size.
+static int _bench_jc_uart(const void *arg, u64 *bytes)
+{
+	host_jc_reset();
+	u32 pkts = host_jc_replay(jc_capture, jc_capture_sz, atoi(arg));
+
+	*bytes = jc_capture_sz;
+
+	return pkts != BENCH_JC_RPTS;
+}
+
+static int _prepare_bis()
+{
+	static bool ready;
+	u8 key[SE_KEY_128_SIZE];
+
+	if (ready)
+		return 0;
+
+	if (_prepare_emmc())
+		return 1;
+
+	// SYSTEM uses keyslots 4 and 5.
+	_rand_seed(0x534B4942);
+	_rand_fill(key, sizeof(key));
+	se_aes_key_set(4, key, sizeof(key));
+	_rand_fill(key, sizeof(key));
+	se_aes_key_set(5, key, sizeof(key));
+
+	bis_part.lba_start = 0;
+	bis_part.lba_end   = BENCH_BIS_SZ / EMMC_BLOCKSIZE - 1;
+	strcpy(bis_part.name, "SYSTEM");
+
+	bis_data = malloc(BENCH_BIS_SZ);
+	_rand_fill(bis_data, BENCH_BIS_SZ);
+
+	u64 bytes;
+	if (_bench_bis_write(NULL, &bytes))
+		return 1;
+
+	// Encrypted on disk.
+	ready = memcmp(host_storage_disk(&emmc_storage)->data, bis_data, BENCH_BIS_CHUNK) != 0;
+
+	return !ready;
+}
+
+static int _bench_bis_read(const void *arg, u64 *bytes)
+{
+	bool cached = arg != NULL;
+	u8 *buf = malloc(BENCH_BIS_CHUNK);
+	int res = 0;
+
+	// Cached reads go over the partition twice. Second pass is all hits.
+	nx_emmc_bis_init(&bis_part, cached, 0);
+	for (u32 pass = 0; pass < (cached ? 2 : 1); pass++)
+	{
+		for (u32 pos = 0; pos < BENCH_BIS_SZ; pos += BENCH_BIS_CHUNK)
+		{
+			if (!nx_emmc_bis_read(pos / EMMC_BLOCKSIZE, BENCH_BIS_CHUNK / EMMC_BLOCKSIZE, buf) ||
+				memcmp(buf, bis_data + pos, BENCH_BIS_CHUNK))
+			{
+				res = 1;
+				break;
+			}
+		}
+	}
+	nx_emmc_bis_end();
+	free(buf);
+
+	*bytes = (u64)BENCH_BIS_SZ * (cached ? 2 : 1);
+
+	return res;
+}
+
+static void _ums_set_text(void *label, const char *text)
+{
+}
+
+static void _ums_system_maintenance(bool refresh)
+{
+}
+
+static int _prepare_ums()
+{
+	static bool ready;
+
+	if (ready)
+		return 0;
+
+	if (_prepare_emmc())
+		return 1;
+
+	ums_data = malloc(BENCH_UMS_SZ);
+	_rand_seed(0x534D55);
+	_rand_fill(ums_data, BENCH_UMS_SZ);
+
+	// Read benches need the data in place, even when filtered alone.
+	memcpy(host_storage_disk(&emmc_storage)->data + (u64)BENCH_UMS_LBA * SDMMC_DAT_BLOCKSIZE, ums_data, BENCH_UMS_SZ);
+
+	ready = true;
+
+	return 0;
+}
+
+static int _bench_ums(const void *arg, u64 *bytes)
+{
+	const char *mode = arg;
+	usb_ctxt_t usbs = {0};
+	host_ums_script_t script = {0};
+
+	usbs.type = MMC_EMMC;
+	usbs.partition = EMMC_GPP + 1;
+	usbs.label = NULL;
+	usbs.set_text = _ums_set_text;
+	usbs.system_maintenance = _ums_system_maintenance;
+
+	script.write     = mode[0] == 'w';
+	script.lba       = BENCH_UMS_LBA;
+	script.sectors   = BENCH_UMS_SZ / SDMMC_DAT_BLOCKSIZE;
+	script.xfer_secs = BENCH_UMS_XFER;
+	script.data      = ums_data;
+
+	// T210B01 uses XUSB and its queued transfers.
+	host_chip_id = mode[1] == 'x' ? GP_HIDREV_MAJOR_T210B01 : GP_HIDREV_MAJOR_T210;
+	int res = host_usb_ums_run(&usbs, &script);
+	host_chip_id = GP_HIDREV_MAJOR_T210;
+
+	*bytes = BENCH_UMS_SZ;
+
+	if (!res && script.write)
+		res = memcmp(host_storage_disk(&emmc_storage)->data + (u64)BENCH_UMS_LBA * SDMMC_DAT_BLOCKSIZE, ums_data, BENCH_UMS_SZ);
+
+	return res;
+}
+
+static const bench_t benches[] = {
+	{ "heap",             NULL,             _bench_heap,           NULL },
+	{ "list",             NULL,             _bench_list,           NULL },
+	{ "sprintf",          NULL,             _bench_sprintf,        NULL },
+	{ "sprintf_ref",      NULL,             _bench_sprintf,        "ref" },
+	{ "sprintf_check",    NULL,             _bench_sprintf_check,  NULL },
+	{ "hexstr",           _prepare_data,    _bench_hexstr,         NULL },
+	{ "crc32",            _prepare_data,    _bench_crc32,          NULL },
+	{ "lz4_compress",     _prepare_data,    _bench_lz4_compress,   NULL },
+	{ "lz4_decompress",   _prepare_lz4,     _bench_lz4_decompress, NULL },
+	{ "blz_decompress",   _prepare_blz,     _bench_blz_decompress, NULL },
+	{ "lz_decompress",    _prepare_lz,      _bench_lz_decompress,  NULL },
+	{ "fatfs_sd_write",   _prepare_fs,      _bench_fs_write,       "sd:/bench/big.bin" },
+	{ "fatfs_sd_read",    _prepare_fs_file, _bench_fs_read,        "sd:/bench/big.bin" },
+	{ "fatfs_sd_small",   _prepare_fs,      _bench_fs_small,       NULL },
+	{ "fatfs_sd_wfast",   _prepare_fs,      _bench_fs_write_fast,  "contig" },
+	{ "fatfs_sd_wfrag",   _prepare_fs,      _bench_fs_write_fast,  "frag" },
+	{ "fatfs_sd_puts",    _prepare_fs,      _bench_fs_hashlog,     "puts" },
+	{ "fatfs_sd_putbuf",  _prepare_fs,      _bench_fs_hashlog,     "putbuf" },
+	{ "fatfs_ram_write",  _prepare_fs,      _bench_fs_write,       "ram:/bench/big.bin" },
+	{ "fatfs_ram_read",   _prepare_fs_file, _bench_fs_read,        "ram:/bench/big.bin" },
+	{ "fatfs_sd_getfree", _prepare_fs,      _bench_fs_getfree,     NULL },
+	{ "exfat_getfree",    _prepare_exfat,   _bench_fs_getfree,     "exfat" },
+	{ "exfat_expand",     _prepare_exfat,   _bench_exfat_expand,   NULL },
+	{ "ini_parse",        _prepare_ini,     _bench_ini,            NULL },
+	{ "dirlist",          _prepare_ini,     _bench_dirlist,        NULL },
+	{ "open",             _prepare_open,    _bench_open,           NULL },
+	{ "copy_roundtrip",   _prepare_copy,    _bench_copy_roundtrip, NULL },
+	{ "gfx_putc",         _prepare_gfx,     _bench_gfx_putc,       "fill" },
+	{ "gfx_putc_nofill",  _prepare_gfx,     _bench_gfx_putc,       "nofill" },
+	{ "jc_uart_parse",    _prepare_jc,      _bench_jc_uart,        "8" },
+	{ "jc_uart_parse_1",  _prepare_jc,      _bench_jc_uart,        "1" },
+	{ "bis_write",        _prepare_bis,     _bench_bis_write,      NULL },
+	{ "bis_write_cached", _prepare_bis,     _bench_bis_write,      "cached" },
+	{ "bis_read",         _prepare_bis,     _bench_bis_read,       NULL },
+	{ "bis_read_cached",  _prepare_bis,     _bench_bis_read,       "cached" },
+	{ "ums_write",        _prepare_ums,     _bench_ums,            "w" },
+	{ "ums_read",         _prepare_ums,     _bench_ums,            "r" },
+	{ "ums_read_xusb",    _prepare_ums,     _bench_ums,            "rx" },
+};
+
+static void _usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  -f, --filter <str>  Run benches whose name contains str\n"
+		"  -r, --repeat <num>  Runs per bench, best is reported (default 5)\n"
+		"  -d, --dir <path>    Directory for disk images (default $TMPDIR or /tmp)\n"
+		"  -j, --json          Print results as JSON\n"
+		"  -l, --list          List benches\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	const char *filter = NULL;
+	u32 repeat = 5;
+	bool json = false;
+	int failed = 0;
+
+	const char *dir = getenv("TMPDIR");
+	if (!dir || !*dir)
+		dir = "/tmp";
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char *opt = argv[i];
+		if ((!strcmp(opt, "-f") || !strcmp(opt, "--filter")) && i + 1 < argc)
+			filter = argv[++i];
+		else if ((!strcmp(opt, "-r") || !strcmp(opt, "--repeat")) && i + 1 < argc)
+		{
+			int num = atoi(argv[++i]);
+			repeat = num > 0 ? num : 1;
+		}
+		else if ((!strcmp(opt, "-d") || !strcmp(opt, "--dir")) && i + 1 < argc)
+			dir = argv[++i];
+		else if (!strcmp(opt, "-j") || !strcmp(opt, "--json"))
+			json = true;
+		else if (!strcmp(opt, "-l") || !strcmp(opt, "--list"))
+		{
+			for (u32 j = 0; j < ARRAY_SIZE(benches); j++)
+				printf("%s\n", benches[j].name);
+			return 0;
+		}
+		else
+		{
+			_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (strlen(dir) >= sizeof(img_dir))
+		return 1;
+	strcpy(img_dir, dir);
+
+	if (host_init())
+		return 1;
+
+	struct utsname uts;
+	uname(&uts);
+
+	if (json)
+		printf("{\n  \"arch\": \"%s\",\n  \"compiler\": \"%s\",\n  \"repeat\": %u,\n  \"results\": [", uts.machine, __VERSION__, repeat);
+	else
+		printf("%-18s %12s %12s %10s\n", "bench", "bytes", "best ns", "MB/s");
+
+	bool first = true;
+	for (u32 i = 0; i < ARRAY_SIZE(benches); i++)
+	{
+		const bench_t *bench = &benches[i];
+		bench_res_t res = { 0, ~0ULL, 0 };
+		int err = 0;
+
+		if (filter && !strstr(bench->name, filter))
+			continue;
+
+		if (bench->prepare)
+			err = bench->prepare();
+
+		for (u32 j = 0; j < repeat && !err; j++)
+		{
+			u64 start = host_time_ns();
+			err = bench->run(bench->arg, &res.bytes);
+			u64 elapsed = host_time_ns() - start;
+
+			res.ns_min = MIN(res.ns_min, elapsed);
+			res.ns_total += elapsed;
+		}
+
+		if (err)
+		{
+			res.ns_min = 0;
+			failed++;
+		}
+
+		double mbps = res.ns_min ? (double)res.bytes * 1000.0 / res.ns_min : 0;
+
+		if (json)
+		{
+			printf("%s\n    {\"name\": \"%s\", \"ok\": %s, \"iterations\": %u, \"bytes\": %llu, "
+				"\"ns\": %llu, \"ns_avg\": %llu, \"mbps\": %.2f}",
+				first ? "" : ",", bench->name, err ? "false" : "true", repeat,
+				(unsigned long long)res.bytes, (unsigned long long)res.ns_min,
+				(unsigned long long)(res.ns_total / repeat), mbps);
+		}
+		else if (err)
+			printf("%-18s %12s\n", bench->name, "FAILED");
+		else
+			printf("%-18s %12llu %12llu %10.2f\n", bench->name, (unsigned long long)res.bytes,
+				(unsigned long long)res.ns_min, mbps);
+
+		first = false;
+		fflush(stdout);
+	}
+
+	if (json)
+		printf("\n  ]\n}\n");
+
+	host_storage_close(&sd_storage);
+	host_storage_close(&emmc_storage);
+	if (*sd_img)
+		unlink(sd_img);
+	if (*emmc_img)
+		unlink(emmc_img);
+
+	return failed ? 2 : 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * BDK host build platform shim
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/mman.h>
+#include <time.h>
+
+#include <bdk.h>
+
+#include <memory_map.h>
+
+u8  host_btn_vol = 0;
+u32 host_chip_id = GP_HIDREV_MAJOR_T210;
+
+static u64 time_start;
+
+u64 host_time_ns()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int host_init()
+{
+	/*
+	 * Map the whole DRAM aperture at its real address, so BDK's fixed buffers
+	 * and 32-bit pointer math work as they are. Pages are only backed on use.
+	 */
+	void *dram = mmap((void *)HOST_DRAM_START, HOST_DRAM_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+	if (dram != (void *)HOST_DRAM_START)
+	{
+		fprintf(stderr, "Failed to map DRAM at 0x%08lX!\n", HOST_DRAM_START);
+		return 1;
+	}
+
+	heap_init((void *)IPL_HEAP_START);
+
+	time_start = host_time_ns();
+
+	return 0;
+}
+
+u32 get_tmr_us()
+{
+	return (host_time_ns() - time_start) / 1000;
+}
+
+u32 get_tmr_ms()
+{
+	return (host_time_ns() - time_start) / 1000000;
+}
+
+u32 get_tmr_s()
+{
+	return (host_time_ns() - time_start) / 1000000000;
+}
+
+// Sleeps only pace hardware. There is none here.
+void usleep(u32 us)
+{
+}
+
+void msleep(u32 ms)
+{
+}
+
+u8 btn_read_vol()
+{
+	return host_btn_vol;
+}
+
+u32 hw_get_chip_id()
+{
+	return host_chip_id;
+}
+
+void minerva_periodic_training()
+{
+}
+
+// Host caches are coherent with the emulated devices.
+void bpmp_mmu_maintenance(u32 op, bool force)
+{
+}
+
+// Fixed time keeps FatFs metadata identical across runs.
+void max77620_rtc_get_time_adjusted(rtc_time_t *time)
+{
+	time->weekday = 1;
+	time->sec     = 0;
+	time->min     = 0;
+	time->hour    = 0;
+	time->day     = 1;
+	time->month   = 1;
+	time->year    = 2024;
+}
@@ -0,0 +1,50 @@
+/*
+ * BDK host build prelude
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_H_
+#define _HOST_H_
+
+// Force included in every unit. Pull libc in before BDK can shadow it.
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <utils/types.h>
+
+// BDK heap replaces libc's allocator inside BDK code and the harness.
+#define malloc bdk_malloc
+#define calloc bdk_calloc
+#define free   bdk_free
+
+// Keep BDK timer API apart from libc's.
+#define usleep bdk_usleep
+
+// BDK DRAM windows are mapped at their real addresses.
+#define HOST_DRAM_START 0x80000000UL
+#define HOST_DRAM_SIZE  0x80000000UL
+
+extern u8  host_btn_vol;
+extern u32 host_chip_id;
+
+int  host_init();
+u64  host_time_ns();
+
+#endif
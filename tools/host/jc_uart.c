@@ -0,0 +1,179 @@
+/*
+ * Joy-Con UART replay
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Joy-Con driver is built in and fed through its receive ring. The IRQ side
+ * of the ring is played here, the reader side is the driver's.
+ */
+
+#include <bdk.h>
+
+#include "jc_uart.h"
+
+// Parsers stamp every packet with the time. Count them instead.
+static u32 jc_pkts;
+
+static u32 _jc_pkt_tick()
+{
+	return ++jc_pkts;
+}
+
+#define get_tmr_ms _jc_pkt_tick
+#include "../../bdk/input/joycon.c"
+#undef get_tmr_ms
+
+static u32 regulator_5v_devs;
+
+// Charging control. Nothing to power on the host.
+bool regulator_5v_get_dev_enabled(u8 dev)
+{
+	return regulator_5v_devs & dev;
+}
+
+void regulator_5v_enable(u8 dev)
+{
+	regulator_5v_devs |= dev;
+}
+
+void regulator_5v_disable(u8 dev)
+{
+	regulator_5v_devs &= ~dev;
+}
+
+void gpio_direction_output(u32 port, u32 pins, int high) {}
+void gpio_write(u32 port, u32 pins, int high) {}
+
+int gpio_read(u32 port, u32 pins)
+{
+	return GPIO_LOW;
+}
+
+u32 max17050_get_cached_batt_volt()
+{
+	return 4100;
+}
+
+void host_jc_reset()
+{
+	joycon_ctxt_t *jc = &jc_r;
+
+	memset(jc, 0, sizeof(joycon_ctxt_t));
+	memset(&jc_gamepad, 0, sizeof(jc_gamepad));
+
+	jc->uart     = UART_B;
+	jc->type     = JC_ID_R;
+	jc->detected = true;
+
+	// Enabled as by uart_rx_ring_enable, minus the IRQ.
+	jc->rx_ring.idx  = jc->uart;
+	jc->rx_ring.buf  = jc->rx_ring_buf;
+	jc->rx_ring.size = JC_RX_RING_SIZE;
+
+	jc_init_done = true;
+	regulator_5v_devs = 0;
+	jc_pkts = 0;
+}
+
+u32 host_jc_feed(const u8 *data, u32 len)
+{
+	uart_rx_ring_t *ring = &jc_r.rx_ring;
+	u32 head = ring->head;
+	u32 dropped = 0;
+
+	for (u32 i = 0; i < len; i++)
+	{
+		u32 next = (head + 1) & (ring->size - 1);
+		if (next == ring->tail)
+		{
+			dropped++;
+			continue;
+		}
+
+		ring->buf[head] = data[i];
+		head = next;
+	}
+
+	ring->dropped += dropped;
+	ring->head = head;
+
+	return dropped;
+}
+
+u32 host_jc_poll()
+{
+	_jc_rcv_pkt(&jc_r);
+
+	return jc_pkts;
+}
+
+u32 host_jc_wired_pkt(u8 *buf, u8 cmd, const u8 *data, const u8 *payload, u32 size)
+{
+	jc_wired_hdr_t *pkt = (jc_wired_hdr_t *)buf;
+	u32 total = sizeof(jc_wired_hdr_t) - sizeof(jc_uart_hdr_t) + size;
+
+	memcpy(pkt->uart_hdr.magic, "\x19\x81\x03", 3);
+	pkt->uart_hdr.total_size_lsb = total & 0xFF;
+	pkt->uart_hdr.total_size_msb = total >> 8;
+	pkt->cmd = cmd;
+
+	if (data)
+		memcpy(pkt->data, data, sizeof(pkt->data));
+	else
+	{
+		memset(pkt->data, 0, sizeof(pkt->data));
+		pkt->data[0] = size >> 8;
+		pkt->data[1] = size & 0xFF;
+	}
+
+	pkt->crc = _jc_crc(&pkt->uart_hdr.total_size_msb,
+					   sizeof(pkt->uart_hdr.total_size_msb) + sizeof(pkt->cmd) + sizeof(pkt->data), 0);
+
+	if (size)
+		memcpy(pkt->payload, payload, size);
+
+	return sizeof(jc_wired_hdr_t) + size;
+}
+
+u32 host_jc_input_rpt(u8 *buf, u8 pkt_id, u32 buttons, u16 stick_x, u16 stick_y)
+{
+	u8 rpt[HOST_JC_HID_RPT_SZ] = {0};
+	jc_hid_in_rpt_t *hid = (jc_hid_in_rpt_t *)rpt;
+
+	hid->cmd        = JC_HID_INPUT_RPT;
+	hid->pkt_id     = pkt_id;
+	hid->batt_info  = JC_BATT_MID; // Charging stays as is.
+	hid->btn_right  = buttons & 0xFF;
+	hid->btn_shared = (buttons >> 8) & 0xFF;
+	hid->btn_left   = buttons >> 16;
+	hid->stick_h_right = stick_x & 0xFF;
+	hid->stick_m_right = (stick_x >> 8) | ((stick_y & 0xF) << 4);
+	hid->stick_v_right = stick_y >> 4;
+
+	return host_jc_wired_pkt(buf, JC_WIRED_HID, NULL, rpt, sizeof(rpt));
+}
+
+u32 host_jc_replay(const u8 *data, u32 size, u32 chunk)
+{
+	for (u32 pos = 0; pos < size; pos += chunk)
+	{
+		host_jc_feed(data + pos, MIN(chunk, size - pos));
+		host_jc_poll();
+	}
+
+	return jc_pkts;
+}
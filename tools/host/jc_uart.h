@@ -0,0 +1,45 @@
+/*
+ * Joy-Con UART replay
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_JC_UART_H_
+#define _HOST_JC_UART_H_
+
+#include <utils/types.h>
+
+#define HOST_JC_HID_RPT_SZ 0x31 // Full size HID input report.
+#define HOST_JC_PKT_SZ     (5 + 7 + HOST_JC_HID_RPT_SZ)
+
+// Resets Joy-Con (R) to a detected controller that receives through its ring.
+void host_jc_reset();
+
+// Pushes bytes into the ring, as the UART IRQ handler does. Returns bytes dropped.
+u32 host_jc_feed(const u8 *data, u32 len);
+
+// Frames and parses all received bytes. Returns packets parsed since reset.
+u32 host_jc_poll();
+
+// Builds a wired packet. Without data, payload size goes into it. Returns packet size.
+u32 host_jc_wired_pkt(u8 *buf, u8 cmd, const u8 *data, const u8 *payload, u32 size);
+
+// Builds a wired HID input report of Joy-Con (R). Returns packet size.
+u32 host_jc_input_rpt(u8 *buf, u8 pkt_id, u32 buttons, u16 stick_x, u16 stick_y);
+
+// Replays a capture in chunks and parses after each one. Returns packets parsed.
+u32 host_jc_replay(const u8 *data, u32 size, u32 chunk);
+
+#endif
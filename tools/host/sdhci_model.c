@@ -0,0 +1,398 @@
+/*
+ * SDHCI controller and eMMC card model
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replaces sdmmc_driver.c under the real sdmmc.c and emmc.c. Commands are
+ * logged and executed against an eMMC with a volatile write cache, so
+ * command ordering and cache data loss on power off can be checked.
+ */
+
+#include <bdk.h>
+
+#include <storage/mmc.h>
+
+#include "sdhci_model.h"
+
+mmc_model_t mmc_model;
+
+int mmc_model_init(u32 sectors, u32 cache_size)
+{
+	memset(&mmc_model, 0, sizeof(mmc_model));
+
+	mmc_model.sectors = sectors;
+	mmc_model.media = (u8 *)calloc(sectors, SDMMC_DAT_BLOCKSIZE);
+	mmc_model.cache = (u8 *)calloc(sectors, SDMMC_DAT_BLOCKSIZE);
+	mmc_model.dirty = (u8 *)calloc(sectors, 1);
+	if (!mmc_model.media || !mmc_model.cache || !mmc_model.dirty)
+		return 0;
+
+	u8 *ext_csd = mmc_model.ext_csd;
+	ext_csd[EXT_CSD_REV]       = 8; // eMMC 5.1.
+	ext_csd[EXT_CSD_CARD_TYPE] = EXT_CSD_CARD_TYPE_HS_52;
+	memcpy(&ext_csd[EXT_CSD_SEC_CNT], &sectors, 4);
+	memcpy(&ext_csd[EXT_CSD_CACHE_SIZE], &cache_size, 4);
+
+	return 1;
+}
+
+void mmc_model_free()
+{
+	free(mmc_model.media);
+	free(mmc_model.cache);
+	free(mmc_model.dirty);
+	mmc_model.media = NULL;
+	mmc_model.cache = NULL;
+	mmc_model.dirty = NULL;
+}
+
+void mmc_model_log_clear()
+{
+	mmc_model.log_cnt = 0;
+}
+
+int mmc_model_log_find(u32 start, u16 cmd, u32 arg_mask, u32 arg)
+{
+	for (u32 i = start; i < mmc_model.log_cnt; i++)
+		if (mmc_model.log[i].cmd == cmd && (mmc_model.log[i].arg & arg_mask) == arg)
+			return i;
+
+	return -1;
+}
+
+u32 mmc_model_dirty_count()
+{
+	u32 count = 0;
+	for (u32 i = 0; i < mmc_model.sectors; i++)
+		count += mmc_model.dirty[i];
+
+	return count;
+}
+
+static void _model_log(u16 cmd, u32 arg, u32 blocks, bool auto_stop)
+{
+	if (mmc_model.log_cnt >= MODEL_LOG_MAX)
+	{
+		mmc_model.errors++;
+		return;
+	}
+
+	model_log_t *entry = &mmc_model.log[mmc_model.log_cnt++];
+	entry->cmd       = cmd;
+	entry->arg       = arg;
+	entry->blocks    = blocks;
+	entry->auto_stop = auto_stop;
+}
+
+static void _model_flush()
+{
+	for (u32 i = 0; i < mmc_model.sectors; i++)
+	{
+		if (!mmc_model.dirty[i])
+			continue;
+
+		memcpy(mmc_model.media + i * SDMMC_DAT_BLOCKSIZE, mmc_model.cache + i * SDMMC_DAT_BLOCKSIZE, SDMMC_DAT_BLOCKSIZE);
+		mmc_model.dirty[i] = 0;
+	}
+}
+
+static void _model_switch(u32 arg)
+{
+	u32 index = (arg >> 16) & 0xFF;
+	u32 value = (arg >> 8) & 0xFF;
+
+	switch (index)
+	{
+	case EXT_CSD_FLUSH_CACHE:
+		if (value & 1)
+			_model_flush();
+		break;
+
+	case EXT_CSD_CACHE_CTRL:
+		// Turning cache off flushes it on real cards. Hosts must not rely on it.
+		if (!value && mmc_model.ext_csd[EXT_CSD_CACHE_CTRL] && mmc_model_dirty_count())
+		{
+			mmc_model.errors++;
+			_model_flush();
+		}
+		mmc_model.ext_csd[EXT_CSD_CACHE_CTRL] = value & 1;
+		break;
+
+	default:
+		mmc_model.ext_csd[index] = value;
+		break;
+	}
+}
+
+static int _model_data(sdmmc_req_t *req, u32 sector, bool is_write)
+{
+	u32 blocks = req->num_sectors;
+
+	// Without CMD23 the transfer is open ended and needs a stop command.
+	if (mmc_model.blkcnt)
+	{
+		if (mmc_model.blkcnt != blocks || req->is_auto_stop_trn)
+			mmc_model.errors++;
+	}
+	else if (!req->is_auto_stop_trn)
+		mmc_model.errors++;
+	mmc_model.blkcnt = 0;
+
+	if (req->blksize != SDMMC_DAT_BLOCKSIZE || sector + blocks > mmc_model.sectors)
+		return 0;
+
+	for (u32 i = 0; i < blocks; i++)
+	{
+		u32 sct = sector + i;
+		u8 *buf = (u8 *)req->buf + i * SDMMC_DAT_BLOCKSIZE;
+
+		if (is_write)
+		{
+			if (mmc_model.ext_csd[EXT_CSD_CACHE_CTRL])
+			{
+				memcpy(mmc_model.cache + sct * SDMMC_DAT_BLOCKSIZE, buf, SDMMC_DAT_BLOCKSIZE);
+				mmc_model.dirty[sct] = 1;
+			}
+			else
+			{
+				memcpy(mmc_model.media + sct * SDMMC_DAT_BLOCKSIZE, buf, SDMMC_DAT_BLOCKSIZE);
+				mmc_model.dirty[sct] = 0;
+			}
+		}
+		else
+		{
+			u8 *src = mmc_model.dirty[sct] ? mmc_model.cache : mmc_model.media;
+			memcpy(buf, src + sct * SDMMC_DAT_BLOCKSIZE, SDMMC_DAT_BLOCKSIZE);
+		}
+	}
+
+	return 1;
+}
+
+int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type)
+{
+	if (id != SDMMC_4 || power != SDMMC_POWER_1_8)
+		return 0;
+
+	memset(sdmmc, 0, sizeof(sdmmc_t));
+	sdmmc->id = id;
+	sdmmc->card_clock = 400;
+	sdmmc->card_clock_enabled = 1;
+
+	mmc_model.powered   = true;
+	mmc_model.state     = R1_STATE_IDLE;
+	mmc_model.bus_width = bus_width;
+	mmc_model.blkcnt    = 0;
+	_model_log(MODEL_EV_POWER_ON, type, 0, false);
+
+	return 1;
+}
+
+void sdmmc_end(sdmmc_t *sdmmc)
+{
+	if (!sdmmc->card_clock_enabled)
+		return;
+
+	// Volatile cache is lost on power off.
+	mmc_model.lost += mmc_model_dirty_count();
+	memset(mmc_model.dirty, 0, mmc_model.sectors);
+	mmc_model.ext_csd[EXT_CSD_CACHE_CTRL] = 0;
+	mmc_model.powered = false;
+	_model_log(MODEL_EV_POWER_OFF, 0, 0, false);
+
+	sdmmc->card_clock_enabled = 0;
+}
+
+void sdmmc_init_cmd(sdmmc_cmd_t *cmdbuf, u16 cmd, u32 arg, u32 rsp_type, u32 check_busy)
+{
+	cmdbuf->cmd = cmd;
+	cmdbuf->arg = arg;
+	cmdbuf->rsp_type = rsp_type;
+	cmdbuf->check_busy = check_busy;
+}
+
+int sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out)
+{
+	if (!sdmmc->card_clock_enabled || !mmc_model.powered)
+		return 0;
+
+	_model_log(cmd->cmd, cmd->arg, req ? req->num_sectors : 0, req ? req->is_auto_stop_trn : false);
+
+	sdmmc->expected_rsp_type = cmd->rsp_type;
+	memset(sdmmc->rsp, 0, sizeof(sdmmc->rsp));
+
+	switch (cmd->cmd)
+	{
+	case MMC_GO_IDLE_STATE:
+		mmc_model.state = R1_STATE_IDLE;
+		mmc_model.blkcnt = 0;
+		return 1;
+
+	case MMC_SEND_OP_COND:
+		mmc_model.state = R1_STATE_READY;
+		sdmmc->rsp[0] = MMC_CARD_BUSY | cmd->arg;
+		return 1;
+
+	case MMC_ALL_SEND_CID:
+		mmc_model.state = R1_STATE_IDENT;
+		return 1;
+
+	case MMC_SET_RELATIVE_ADDR:
+		mmc_model.state = R1_STATE_STBY;
+		break;
+
+	case MMC_SEND_CSD:
+		sdmmc->rsp[0] = 4 << 26; // MMC v4 spec version.
+		return 1;
+
+	case MMC_SELECT_CARD:
+		mmc_model.state = R1_STATE_TRAN;
+		break;
+
+	case MMC_SET_BLOCKLEN:
+	case MMC_SEND_STATUS:
+		break;
+
+	case MMC_SWITCH:
+		_model_switch(cmd->arg);
+		break;
+
+	case MMC_SEND_EXT_CSD:
+		if (!req)
+			return 0;
+		memcpy(req->buf, mmc_model.ext_csd, SDMMC_DAT_BLOCKSIZE);
+		break;
+
+	case MMC_SET_BLOCK_COUNT:
+		mmc_model.blkcnt = cmd->arg & 0xFFFF;
+		break;
+
+	case MMC_READ_MULTIPLE_BLOCK:
+	case MMC_WRITE_MULTIPLE_BLOCK:
+		if (!req)
+			return 0;
+
+		if (req->is_write && mmc_model.fail_writes)
+		{
+			mmc_model.fail_writes--;
+			mmc_model.blkcnt = 0;
+			mmc_model.state = R1_STATE_RCV;
+			return 0;
+		}
+
+		if (!_model_data(req, cmd->arg, req->is_write))
+			return 0;
+		if (blkcnt_out)
+			*blkcnt_out = req->num_sectors;
+		break;
+
+	default:
+		sdmmc->rsp[0] = R1_ILLEGAL_COMMAND;
+		mmc_model.errors++;
+		return 1;
+	}
+
+	sdmmc->rsp[0] = R1_READY_FOR_DATA | R1_STATE(mmc_model.state);
+
+	return 1;
+}
+
+int sdmmc_get_rsp(sdmmc_t *sdmmc, u32 *rsp, u32 size, u32 type)
+{
+	if (!rsp || sdmmc->expected_rsp_type != type)
+		return 0;
+
+	if (type == SDMMC_RSP_TYPE_2)
+	{
+		if (size < 16)
+			return 0;
+		memcpy(rsp, sdmmc->rsp, 16);
+	}
+	else
+	{
+		if (size < 4)
+			return 0;
+		rsp[0] = sdmmc->rsp[0];
+	}
+
+	return 1;
+}
+
+int sdmmc_stop_transmission(sdmmc_t *sdmmc, u32 *rsp)
+{
+	if (!sdmmc->card_clock_enabled || !mmc_model.powered)
+		return 0;
+
+	_model_log(MMC_STOP_TRANSMISSION, 0, 0, false);
+	mmc_model.state = R1_STATE_TRAN;
+	*rsp = R1_READY_FOR_DATA | R1_STATE(mmc_model.state);
+
+	return 1;
+}
+
+int sdmmc_setup_clock(sdmmc_t *sdmmc, u32 type)
+{
+	return 1;
+}
+
+int sdmmc_get_io_power(sdmmc_t *sdmmc)
+{
+	return SDMMC_POWER_1_8;
+}
+
+u32 sdmmc_get_bus_width(sdmmc_t *sdmmc)
+{
+	return mmc_model.bus_width;
+}
+
+void sdmmc_set_bus_width(sdmmc_t *sdmmc, u32 bus_width)
+{
+	mmc_model.bus_width = bus_width;
+}
+
+void sdmmc_card_clock_powersave(sdmmc_t *sdmmc, int powersave_enable)
+{
+}
+
+int sdmmc_tuning_execute(sdmmc_t *sdmmc, u32 type, u32 cmd)
+{
+	return 1;
+}
+
+void sdmmc_save_tap_value(sdmmc_t *sdmmc)
+{
+}
+
+bool mc_client_has_access(void *address)
+{
+	return true;
+}
+
+// SD is not modeled.
+void sd_error_count_increment(u8 type)
+{
+}
+
+int sd_init_retry(bool power_cycle)
+{
+	return 0;
+}
+
+bool sd_initialize(bool power_cycle)
+{
+	return false;
+}
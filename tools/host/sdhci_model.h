@@ -0,0 +1,69 @@
+/*
+ * SDHCI controller and eMMC card model
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_SDHCI_MODEL_H_
+#define _HOST_SDHCI_MODEL_H_
+
+#include <storage/sdmmc_driver.h>
+#include <utils/types.h>
+
+#define MODEL_LOG_MAX 4096
+
+// Pseudo commands logged for controller events.
+#define MODEL_EV_POWER_ON  0x100
+#define MODEL_EV_POWER_OFF 0x101
+
+typedef struct _model_log_t
+{
+	u16 cmd;
+	u32 arg;
+	u32 blocks;
+	bool auto_stop;
+} model_log_t;
+
+typedef struct _mmc_model_t
+{
+	u8  *media; // Committed NAND contents.
+	u8  *cache; // Volatile cache contents.
+	u8  *dirty; // Per sector, set if cache holds newer data.
+	u32  sectors;
+
+	bool powered;
+	u32  state;
+	u32  bus_width;
+	u32  blkcnt; // Set by CMD23 for the next data command.
+	u8   ext_csd[SDMMC_DAT_BLOCKSIZE];
+
+	u32  fail_writes;  // Fail the next N write data commands.
+	u32  lost;         // Dirty sectors dropped by a power off.
+	u32  errors;       // Protocol violations seen by the card.
+
+	model_log_t log[MODEL_LOG_MAX];
+	u32 log_cnt;
+} mmc_model_t;
+
+extern mmc_model_t mmc_model;
+
+int  mmc_model_init(u32 sectors, u32 cache_size);
+void mmc_model_free();
+void mmc_model_log_clear();
+// Returns log index of the first cmd at or after start, or -1.
+int  mmc_model_log_find(u32 start, u16 cmd, u32 arg_mask, u32 arg);
+u32  mmc_model_dirty_count();
+
+#endif
@@ -0,0 +1,385 @@
+/*
+ * BDK host build software SE shim
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bdk.h>
+
+/*
+ * AES-128 only, with the same keyslot model as the SE.
+ * Round tables are built on first use. See FIPS-197.
+ * SHA256 is oneshot only. See FIPS-180-4.
+ */
+
+#define AES_ROUNDS   10
+#define AES_RK_WORDS (4 * (AES_ROUNDS + 1))
+
+typedef struct _host_ks_t
+{
+	u32 enc[AES_RK_WORDS];
+	u32 dec[AES_RK_WORDS];
+} host_ks_t;
+
+static host_ks_t keyslots[SE_AES_KEYSLOT_COUNT];
+
+static u8  sbox[256];
+static u8  sbox_inv[256];
+static u32 te[4][256];
+static u32 td[4][256];
+static bool tables_init = false;
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static u8 _gf_mul(u8 a, u8 b)
+{
+	u8 res = 0;
+
+	while (b)
+	{
+		if (b & 1)
+			res ^= a;
+		a = (a << 1) ^ ((a & 0x80) ? 0x1B : 0);
+		b >>= 1;
+	}
+
+	return res;
+}
+
+static void _aes_tables_init()
+{
+	// Generate S-box from the multiplicative inverse and the affine transform.
+	for (u32 i = 0; i < 256; i++)
+	{
+		u8 inv = 0;
+		for (u32 j = 1; j < 256 && i; j++)
+		{
+			if (_gf_mul(i, j) == 1)
+			{
+				inv = j;
+				break;
+			}
+		}
+
+		u8 s = inv;
+		for (u32 j = 1; j < 5; j++)
+			s ^= (inv << j) | (inv >> (8 - j));
+		s ^= 0x63;
+
+		sbox[i] = s;
+		sbox_inv[s] = i;
+	}
+
+	for (u32 i = 0; i < 256; i++)
+	{
+		u8 s  = sbox[i];
+		u8 si = sbox_inv[i];
+
+		te[0][i] = (_gf_mul(s, 2) << 24) | (s << 16) | (s << 8) | _gf_mul(s, 3);
+		td[0][i] = (_gf_mul(si, 14) << 24) | (_gf_mul(si, 9) << 16) | (_gf_mul(si, 13) << 8) | _gf_mul(si, 11);
+		for (u32 j = 1; j < 4; j++)
+		{
+			te[j][i] = ROR32(te[0][i], j * 8);
+			td[j][i] = ROR32(td[0][i], j * 8);
+		}
+	}
+
+	tables_init = true;
+}
+
+static inline u32 _load_be32(const u8 *p)
+{
+	return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static inline void _store_be32(u8 *p, u32 val)
+{
+	p[0] = val >> 24;
+	p[1] = val >> 16;
+	p[2] = val >> 8;
+	p[3] = val;
+}
+
+static inline u32 _sub_word(u32 w)
+{
+	return (sbox[w >> 24] << 24) | (sbox[(w >> 16) & 0xFF] << 16) | (sbox[(w >> 8) & 0xFF] << 8) | sbox[w & 0xFF];
+}
+
+void se_aes_key_set(u32 ks, void *key, u32 size)
+{
+	host_ks_t *slot = &keyslots[ks];
+	u32 *rk = slot->enc;
+	u8 rcon = 1;
+
+	if (!tables_init)
+		_aes_tables_init();
+
+	for (u32 i = 0; i < 4; i++)
+		rk[i] = _load_be32((u8 *)key + i * 4);
+
+	for (u32 i = 4; i < AES_RK_WORDS; i++)
+	{
+		u32 w = rk[i - 1];
+		if (!(i & 3))
+		{
+			w = _sub_word((w << 8) | (w >> 24)) ^ (rcon << 24);
+			rcon = _gf_mul(rcon, 2);
+		}
+		rk[i] = rk[i - 4] ^ w;
+	}
+
+	// Equivalent inverse cipher. Reverse round order and InvMixColumns the inner ones.
+	for (u32 r = 0; r <= AES_ROUNDS; r++)
+	{
+		for (u32 i = 0; i < 4; i++)
+		{
+			u32 w = rk[(AES_ROUNDS - r) * 4 + i];
+			if (r && r != AES_ROUNDS)
+			{
+				w = td[0][sbox[w >> 24]] ^ td[1][sbox[(w >> 16) & 0xFF]] ^
+					td[2][sbox[(w >> 8) & 0xFF]] ^ td[3][sbox[w & 0xFF]];
+			}
+			slot->dec[r * 4 + i] = w;
+		}
+	}
+}
+
+static void _aes_encrypt_block(const u32 *rk, u8 *dst, const u8 *src)
+{
+	u32 s0 = _load_be32(src)      ^ rk[0];
+	u32 s1 = _load_be32(src + 4)  ^ rk[1];
+	u32 s2 = _load_be32(src + 8)  ^ rk[2];
+	u32 s3 = _load_be32(src + 12) ^ rk[3];
+	u32 t0, t1, t2, t3;
+
+	for (u32 r = 1; r < AES_ROUNDS; r++)
+	{
+		rk += 4;
+		t0 = te[0][s0 >> 24] ^ te[1][(s1 >> 16) & 0xFF] ^ te[2][(s2 >> 8) & 0xFF] ^ te[3][s3 & 0xFF] ^ rk[0];
+		t1 = te[0][s1 >> 24] ^ te[1][(s2 >> 16) & 0xFF] ^ te[2][(s3 >> 8) & 0xFF] ^ te[3][s0 & 0xFF] ^ rk[1];
+		t2 = te[0][s2 >> 24] ^ te[1][(s3 >> 16) & 0xFF] ^ te[2][(s0 >> 8) & 0xFF] ^ te[3][s1 & 0xFF] ^ rk[2];
+		t3 = te[0][s3 >> 24] ^ te[1][(s0 >> 16) & 0xFF] ^ te[2][(s1 >> 8) & 0xFF] ^ te[3][s2 & 0xFF] ^ rk[3];
+		s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+	}
+
+	rk += 4;
+	_store_be32(dst,      ((sbox[s0 >> 24] << 24) | (sbox[(s1 >> 16) & 0xFF] << 16) | (sbox[(s2 >> 8) & 0xFF] << 8) | sbox[s3 & 0xFF]) ^ rk[0]);
+	_store_be32(dst + 4,  ((sbox[s1 >> 24] << 24) | (sbox[(s2 >> 16) & 0xFF] << 16) | (sbox[(s3 >> 8) & 0xFF] << 8) | sbox[s0 & 0xFF]) ^ rk[1]);
+	_store_be32(dst + 8,  ((sbox[s2 >> 24] << 24) | (sbox[(s3 >> 16) & 0xFF] << 16) | (sbox[(s0 >> 8) & 0xFF] << 8) | sbox[s1 & 0xFF]) ^ rk[2]);
+	_store_be32(dst + 12, ((sbox[s3 >> 24] << 24) | (sbox[(s0 >> 16) & 0xFF] << 16) | (sbox[(s1 >> 8) & 0xFF] << 8) | sbox[s2 & 0xFF]) ^ rk[3]);
+}
+
+static void _aes_decrypt_block(const u32 *rk, u8 *dst, const u8 *src)
+{
+	u32 s0 = _load_be32(src)      ^ rk[0];
+	u32 s1 = _load_be32(src + 4)  ^ rk[1];
+	u32 s2 = _load_be32(src + 8)  ^ rk[2];
+	u32 s3 = _load_be32(src + 12) ^ rk[3];
+	u32 t0, t1, t2, t3;
+
+	for (u32 r = 1; r < AES_ROUNDS; r++)
+	{
+		rk += 4;
+		t0 = td[0][s0 >> 24] ^ td[1][(s3 >> 16) & 0xFF] ^ td[2][(s2 >> 8) & 0xFF] ^ td[3][s1 & 0xFF] ^ rk[0];
+		t1 = td[0][s1 >> 24] ^ td[1][(s0 >> 16) & 0xFF] ^ td[2][(s3 >> 8) & 0xFF] ^ td[3][s2 & 0xFF] ^ rk[1];
+		t2 = td[0][s2 >> 24] ^ td[1][(s1 >> 16) & 0xFF] ^ td[2][(s0 >> 8) & 0xFF] ^ td[3][s3 & 0xFF] ^ rk[2];
+		t3 = td[0][s3 >> 24] ^ td[1][(s2 >> 16) & 0xFF] ^ td[2][(s1 >> 8) & 0xFF] ^ td[3][s0 & 0xFF] ^ rk[3];
+		s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+	}
+
+	rk += 4;
+	_store_be32(dst,      ((sbox_inv[s0 >> 24] << 24) | (sbox_inv[(s3 >> 16) & 0xFF] << 16) | (sbox_inv[(s2 >> 8) & 0xFF] << 8) | sbox_inv[s1 & 0xFF]) ^ rk[0]);
+	_store_be32(dst + 4,  ((sbox_inv[s1 >> 24] << 24) | (sbox_inv[(s0 >> 16) & 0xFF] << 16) | (sbox_inv[(s3 >> 8) & 0xFF] << 8) | sbox_inv[s2 & 0xFF]) ^ rk[1]);
+	_store_be32(dst + 8,  ((sbox_inv[s2 >> 24] << 24) | (sbox_inv[(s1 >> 16) & 0xFF] << 16) | (sbox_inv[(s0 >> 8) & 0xFF] << 8) | sbox_inv[s3 & 0xFF]) ^ rk[2]);
+	_store_be32(dst + 12, ((sbox_inv[s3 >> 24] << 24) | (sbox_inv[(s2 >> 16) & 0xFF] << 16) | (sbox_inv[(s1 >> 8) & 0xFF] << 8) | sbox_inv[s0 & 0xFF]) ^ rk[3]);
+}
+
+int se_aes_crypt_block_ecb(u32 ks, u32 enc, void *dst, const void *src)
+{
+	if (enc)
+		_aes_encrypt_block(keyslots[ks].enc, dst, src);
+	else
+		_aes_decrypt_block(keyslots[ks].dec, dst, src);
+
+	return 1;
+}
+
+int se_aes_crypt_ecb(u32 ks, u32 enc, void *dst, u32 dst_size, const void *src, u32 src_size)
+{
+	u8 *pdst = (u8 *)dst;
+	const u8 *psrc = (const u8 *)src;
+
+	for (u32 i = 0; i < (src_size >> 4); i++)
+		se_aes_crypt_block_ecb(ks, enc, pdst + i * SE_AES_BLOCK_SIZE, psrc + i * SE_AES_BLOCK_SIZE);
+
+	return 1;
+}
+
+static void _gf256_mul_x_le(void *block)
+{
+	u32 *pdata = (u32 *)block;
+	u32 carry = 0;
+
+	for (u32 i = 0; i < 4; i++)
+	{
+		u32 b = pdata[i];
+		pdata[i] = (b << 1) | carry;
+		carry = b >> 31;
+	}
+
+	if (carry)
+		pdata[0x0] ^= 0x87;
+}
+
+// Same flow as the SE driver. Sector number is big endian in the tweak.
+int se_aes_xts_crypt_sec_nx(u32 tweak_ks, u32 crypt_ks, u32 enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size)
+{
+	u32 *pdst = (u32 *)dst;
+	u32 *psrc = (u32 *)src;
+	u32 *ptweak = (u32 *)tweak;
+
+	if (regen_tweak)
+	{
+		for (int i = 0xF; i >= 0; i--)
+		{
+			tweak[i] = sec & 0xFF;
+			sec >>= 8;
+		}
+		se_aes_crypt_block_ecb(tweak_ks, ENCRYPT, tweak, tweak);
+	}
+
+	for (u32 i = 0; i < (tweak_exp << 5); i++)
+		_gf256_mul_x_le(tweak);
+
+	u8 orig_tweak[SE_KEY_128_SIZE] __attribute__((aligned(4)));
+	memcpy(orig_tweak, tweak, SE_KEY_128_SIZE);
+
+	for (u32 i = 0; i < (sec_size >> 4); i++)
+	{
+		for (u32 j = 0; j < 4; j++)
+			pdst[j] = psrc[j] ^ ptweak[j];
+
+		_gf256_mul_x_le(tweak);
+		psrc += 4;
+		pdst += 4;
+	}
+
+	se_aes_crypt_ecb(crypt_ks, enc, dst, sec_size, dst, sec_size);
+
+	pdst = (u32 *)dst;
+	ptweak = (u32 *)orig_tweak;
+	for (u32 i = 0; i < (sec_size >> 4); i++)
+	{
+		for (u32 j = 0; j < 4; j++)
+			pdst[j] = pdst[j] ^ ptweak[j];
+
+		_gf256_mul_x_le(orig_tweak);
+		pdst += 4;
+	}
+
+	return 1;
+}
+
+static const u32 sha256_k[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static void _sha256_block(u32 *state, const u8 *data)
+{
+	u32 w[64];
+	u32 s[8];
+
+	for (u32 i = 0; i < 16; i++)
+		w[i] = _load_be32(data + i * 4);
+	for (u32 i = 16; i < 64; i++)
+	{
+		u32 s0 = ROR32(w[i - 15], 7) ^ ROR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		u32 s1 = ROR32(w[i - 2], 17) ^ ROR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	memcpy(s, state, sizeof(s));
+	for (u32 i = 0; i < 64; i++)
+	{
+		u32 t1 = s[7] + (ROR32(s[4], 6) ^ ROR32(s[4], 11) ^ ROR32(s[4], 25)) +
+			((s[4] & s[5]) ^ (~s[4] & s[6])) + sha256_k[i] + w[i];
+		u32 t2 = (ROR32(s[0], 2) ^ ROR32(s[0], 13) ^ ROR32(s[0], 22)) +
+			((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+		memmove(&s[1], &s[0], sizeof(u32) * 7);
+		s[4] += t1;
+		s[0] = t1 + t2;
+	}
+
+	for (u32 i = 0; i < 8; i++)
+		state[i] += s[i];
+}
+
+int se_calc_sha256_oneshot(void *hash, const void *src, u32 src_size)
+{
+	u32 state[8] =
+	{
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+	u8 block[64];
+	const u8 *data = (const u8 *)src;
+	u32 rem = src_size & 63;
+
+	for (u32 i = 0; i < src_size - rem; i += 64)
+		_sha256_block(state, data + i);
+
+	// Pad and append length in bits.
+	memset(block, 0, sizeof(block));
+	memcpy(block, data + src_size - rem, rem);
+	block[rem] = 0x80;
+	if (rem >= 56)
+	{
+		_sha256_block(state, block);
+		memset(block, 0, sizeof(block));
+	}
+	_store_be32(block + 56, src_size >> 29);
+	_store_be32(block + 60, src_size << 3);
+	_sha256_block(state, block);
+
+	for (u32 i = 0; i < 8; i++)
+		_store_be32((u8 *)hash + i * 4, state[i]);
+
+	return 1;
+}
+
+// Fixed seed keeps host workloads identical across runs. Not for crypto use.
+int se_gen_prng128(void *dst)
+{
+	static u64 state = 0x9E3779B97F4A7C15ULL;
+
+	u32 *out = (u32 *)dst;
+	for (u32 i = 0; i < 4; i++)
+	{
+		// xorshift64*.
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		out[i] = (state * 0x2545F4914F6CDD1DULL) >> 32;
+	}
+
+	return 1;
+}
@@ -0,0 +1,380 @@
+/*
+ * BDK host build storage shim
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <bdk.h>
+
+#include <storage/mbr_gpt.h>
+
+#include "storage.h"
+
+// Defined here instead of the drivers.
+sdmmc_t sd_sdmmc;
+sdmmc_t emmc_sdmmc;
+sdmmc_storage_t sd_storage;
+sdmmc_storage_t emmc_storage;
+FATFS sd_fs;
+
+#define HOST_SIM_POLL_NS 200
+
+u64 host_sim_ns;
+
+static host_disk_t disks[2];
+static bool sd_mounted;
+
+static host_disk_t *_host_disk_get(sdmmc_storage_t *storage)
+{
+	if (storage == &sd_storage)
+		return &disks[0];
+	if (storage == &emmc_storage)
+		return &disks[1];
+
+	return NULL;
+}
+
+int host_storage_open(sdmmc_storage_t *storage, const char *path, u32 sectors)
+{
+	host_disk_t *disk = _host_disk_get(storage);
+	if (!disk)
+		return 1;
+
+	host_storage_close(storage);
+
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+		return 1;
+
+	// Images are sparse files, so only written sectors take space.
+	u64 size = (u64)sectors * SDMMC_DAT_BLOCKSIZE;
+	if (ftruncate(fd, size))
+	{
+		close(fd);
+		return 1;
+	}
+
+	void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return 1;
+
+	memset(disk, 0, sizeof(host_disk_t));
+	disk->data    = data;
+	disk->sectors = sectors;
+
+	memset(storage, 0, sizeof(sdmmc_storage_t));
+	storage->sdmmc   = storage == &sd_storage ? &sd_sdmmc : &emmc_sdmmc;
+	storage->sec_cnt = sectors;
+	storage->initialized = 1;
+
+	return 0;
+}
+
+void host_storage_close(sdmmc_storage_t *storage)
+{
+	host_disk_t *disk = _host_disk_get(storage);
+	if (!disk || !disk->data)
+		return;
+
+	munmap(disk->data, (u64)disk->sectors * SDMMC_DAT_BLOCKSIZE);
+	disk->data = NULL;
+	disk->sectors = 0;
+	storage->initialized = 0;
+}
+
+host_disk_t *host_storage_disk(sdmmc_storage_t *storage)
+{
+	return _host_disk_get(storage);
+}
+
+int host_image_open(sdmmc_storage_t *storage, const char *name, u32 sectors)
+{
+	char img[256];
+
+	const char *dir = getenv("TMPDIR");
+	if (!dir || !*dir)
+		dir = "/tmp";
+
+	snprintf(img, sizeof(img), "%s/bdk_test_%s.img", dir, name);
+	if (host_storage_open(storage, img, sectors))
+		return 1;
+
+	strcpy(_host_disk_get(storage)->img, img);
+
+	return 0;
+}
+
+void host_image_close(sdmmc_storage_t *storage)
+{
+	host_disk_t *disk = _host_disk_get(storage);
+	if (!disk)
+		return;
+
+	host_storage_close(storage);
+	if (disk->img[0])
+		unlink(disk->img);
+	disk->img[0] = 0;
+}
+
+int host_sd_format(u32 au_size)
+{
+	u8 *work = malloc(SZ_4M);
+	int res = f_mkfs("sd:", FM_FAT32, au_size, work, SZ_4M);
+	free(work);
+
+	return res || !sd_mount();
+}
+
+int host_sd_image_setup(const char *name, u32 sectors, u32 au_size)
+{
+	if (host_image_open(&sd_storage, name, sectors))
+		return 1;
+
+	return host_sd_format(au_size);
+}
+
+void host_sd_image_teardown()
+{
+	sd_unmount();
+	host_image_close(&sd_storage);
+}
+
+static int _host_disk_xfer(host_disk_t *disk, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
+	if (!disk || !disk->data || (u64)sector + num_sectors > disk->sectors)
+		return 0;
+
+	u8 *data = disk->data + (u64)sector * SDMMC_DAT_BLOCKSIZE;
+	if (is_write)
+	{
+		memcpy(data, buf, num_sectors * SDMMC_DAT_BLOCKSIZE);
+		disk->writes++;
+		disk->written += num_sectors;
+	}
+	else
+	{
+		memcpy(buf, data, num_sectors * SDMMC_DAT_BLOCKSIZE);
+		disk->reads++;
+		disk->read += num_sectors;
+	}
+
+	return 1;
+}
+
+static u64 _host_disk_latency(host_disk_t *disk, u32 num_sectors)
+{
+	return disk->sim_cmd_ns + (u64)num_sectors * disk->sim_sector_ns;
+}
+
+int sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	host_disk_t *disk = _host_disk_get(storage);
+	if (disk)
+		host_sim_ns += _host_disk_latency(disk, num_sectors);
+
+	return _host_disk_xfer(disk, sector, num_sectors, buf, 0);
+}
+
+int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	host_disk_t *disk = _host_disk_get(storage);
+	if (disk)
+		host_sim_ns += _host_disk_latency(disk, num_sectors);
+
+	return _host_disk_xfer(disk, sector, num_sectors, buf, 1);
+}
+
+int sdmmc_storage_xfer_start(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
+	host_disk_t *disk = _host_disk_get(storage);
+	if (!disk || !disk->data || disk->xfer_buf || !num_sectors || num_sectors > 0xFFFF || ((u32)buf % 8))
+		return 0;
+
+	if (++disk->xfers == disk->fail_start)
+		return 0;
+
+	disk->xfer_buf    = buf;
+	disk->xfer_sector = sector;
+	disk->xfer_num    = num_sectors;
+	disk->xfer_write  = is_write;
+	disk->xfer_end    = host_sim_ns + _host_disk_latency(disk, num_sectors);
+
+	// DMA reads write data while the transfer runs. Keep what it sees now.
+	if (is_write)
+	{
+		disk->xfer_data = malloc(num_sectors * SDMMC_DAT_BLOCKSIZE);
+		memcpy(disk->xfer_data, buf, num_sectors * SDMMC_DAT_BLOCKSIZE);
+	}
+
+	return 1;
+}
+
+int sdmmc_storage_xfer_poll(sdmmc_storage_t *storage)
+{
+	host_disk_t *disk = _host_disk_get(storage);
+	if (!disk || !disk->xfer_buf)
+		return SDMMC_XFER_ERROR;
+
+	host_sim_ns += HOST_SIM_POLL_NS;
+	if (host_sim_ns < disk->xfer_end)
+		return SDMMC_XFER_PENDING;
+
+	void *buf = disk->xfer_buf;
+	disk->xfer_buf = NULL;
+
+	int res = 0;
+	if (disk->xfer_write)
+	{
+		u32 size = disk->xfer_num * SDMMC_DAT_BLOCKSIZE;
+		if (memcmp(disk->xfer_data, buf, size))
+			disk->xfer_races++;
+
+		if (disk->xfers != disk->fail_xfer)
+			res = _host_disk_xfer(disk, disk->xfer_sector, disk->xfer_num, disk->xfer_data, 1);
+		free(disk->xfer_data);
+		disk->xfer_data = NULL;
+	}
+	else if (disk->xfers != disk->fail_xfer)
+	{
+		// Buffer is only filled on completion, so using it early gets stale data like DMA would.
+		res = _host_disk_xfer(disk, disk->xfer_sector, disk->xfer_num, buf, 0);
+	}
+
+	return res ? SDMMC_XFER_DONE : SDMMC_XFER_ERROR;
+}
+
+// Images have no write cache. Only track the mode.
+int sdmmc_storage_set_bulk_write(sdmmc_storage_t *storage, bool enable)
+{
+	if (!storage->initialized)
+		return 0;
+
+	storage->bulk_write = enable;
+
+	return 1;
+}
+
+bool sd_mount()
+{
+	if (sd_mounted)
+		return true;
+
+	if (!sd_storage.initialized)
+		return false;
+
+	sd_mounted = f_mount(&sd_fs, "0:", 1) == FR_OK; // Volume 0 is SD.
+
+	return sd_mounted;
+}
+
+void sd_unmount()
+{
+	if (sd_mounted)
+		f_mount(NULL, "0:", 1);
+	sd_mounted = false;
+}
+
+void sd_end()
+{
+	sd_unmount();
+}
+
+bool emmc_initialize(bool power_cycle)
+{
+	return emmc_storage.initialized;
+}
+
+int emmc_set_partition(u32 partition)
+{
+	emmc_storage.partition = partition;
+
+	return 1;
+}
+
+void emmc_end()
+{
+}
+
+void emmc_gpt_parse(link_t *gpt)
+{
+	gpt_t *gpt_buf = (gpt_t *)zalloc(GPT_NUM_BLOCKS * EMMC_BLOCKSIZE);
+
+	sdmmc_storage_read(&emmc_storage, GPT_FIRST_LBA, GPT_NUM_BLOCKS, gpt_buf);
+
+	// Check if no GPT or more than max allowed entries.
+	if (memcmp(&gpt_buf->header.signature, "EFI PART", 8) || gpt_buf->header.num_part_ents > 128)
+		goto out;
+
+	for (u32 i = 0; i < gpt_buf->header.num_part_ents; i++)
+	{
+		if (gpt_buf->entries[i].lba_start < gpt_buf->header.first_use_lba)
+			continue;
+
+		emmc_part_t *part = (emmc_part_t *)zalloc(sizeof(emmc_part_t));
+
+		part->index     = i;
+		part->lba_start = gpt_buf->entries[i].lba_start;
+		part->lba_end   = gpt_buf->entries[i].lba_end;
+		part->attrs     = gpt_buf->entries[i].attrs;
+
+		// ASCII conversion. Copy only the LSByte of the UTF-16LE name.
+		for (u32 j = 0; j < 36; j++)
+			part->name[j] = gpt_buf->entries[i].name[j];
+		part->name[35] = 0;
+
+		list_append(gpt, &part->link);
+	}
+
+out:
+	free(gpt_buf);
+}
+
+void emmc_gpt_free(link_t *gpt)
+{
+	LIST_FOREACH_SAFE(iter, gpt)
+		free(CONTAINER_OF(iter, emmc_part_t, link));
+}
+
+emmc_part_t *emmc_part_find(link_t *gpt, const char *name)
+{
+	LIST_FOREACH_ENTRY(emmc_part_t, part, gpt, link)
+		if (!strcmp(part->name, name))
+			return part;
+
+	return NULL;
+}
+
+int emmc_part_read(emmc_part_t *part, u32 sector_off, u32 num_sectors, void *buf)
+{
+	// The last LBA is inclusive.
+	if (part->lba_start + sector_off > part->lba_end)
+		return 0;
+
+	return sdmmc_storage_read(&emmc_storage, part->lba_start + sector_off, num_sectors, buf);
+}
+
+int emmc_part_write(emmc_part_t *part, u32 sector_off, u32 num_sectors, void *buf)
+{
+	// The last LBA is inclusive.
+	if (part->lba_start + sector_off > part->lba_end)
+		return 0;
+
+	return sdmmc_storage_write(&emmc_storage, part->lba_start + sector_off, num_sectors, buf);
+}
@@ -0,0 +1,67 @@
+/*
+ * BDK host build storage shim
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_STORAGE_H_
+#define _HOST_STORAGE_H_
+
+#include <storage/sdmmc.h>
+#include <utils/types.h>
+
+typedef struct _host_disk_t
+{
+	u8 *data;
+	u32 sectors;
+	u32 reads;
+	u32 writes;
+	u32 read;      // Sectors.
+	u32 written;   // Sectors.
+	// Async transfer. Reads land on completion. Writes take the data on start.
+	void *xfer_buf;
+	void *xfer_data;
+	u32 xfer_sector;
+	u32 xfer_num;
+	u32 xfer_write;
+	u64 xfer_end;    // Simulated time.
+	u32 xfers;       // Started.
+	u32 xfer_races;  // Write buffers changed while in flight.
+	// Simulated device. No latency unless set.
+	u32 sim_cmd_ns;
+	u32 sim_sector_ns;
+	u32 fail_start;  // Async transfer that fails to start. 1 based, 0 for none.
+	u32 fail_xfer;   // Async transfer that ends with an error.
+	char img[256];   // Test image deleted on close. Empty if kept.
+} host_disk_t;
+
+// Simulated time. Transfers add their device latency and async polls a fixed cost.
+extern u64 host_sim_ns;
+
+// Backs sd_storage or emmc_storage with an image file.
+int  host_storage_open(sdmmc_storage_t *storage, const char *path, u32 sectors);
+void host_storage_close(sdmmc_storage_t *storage);
+host_disk_t *host_storage_disk(sdmmc_storage_t *storage);
+
+// Test images are named bdk_test_<name>.img, in $TMPDIR or /tmp. Closing deletes them.
+int  host_image_open(sdmmc_storage_t *storage, const char *name, u32 sectors);
+void host_image_close(sdmmc_storage_t *storage);
+
+// Formats SD as FAT32 and mounts it.
+int  host_sd_format(u32 au_size);
+int  host_sd_image_setup(const char *name, u32 sectors, u32 au_size);
+void host_sd_image_teardown();
+
+#endif
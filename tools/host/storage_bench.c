@@ -0,0 +1,170 @@
+/*
+ * Nyx storage benchmark workloads on a host SD image
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Runs the same workload table as Nyx's SD benchmark against a FAT32 image
+ * file and prints the results in the same CSV format, for CI tracking.
+ */
+
+#include <bdk.h>
+
+#include <libs/fatfs/ff.h>
+
+#include "../../nyx/nyx_gui/frontend/fe_benchmark.h"
+#include "storage.h"
+
+#define SB_IMG_SZ_DEF   2048 // MiB.
+#define SB_AREA_SECTORS 0x200000 // 1GB, same as Nyx.
+
+static void _usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  -f, --filter <str>  Run workloads whose name contains str\n"
+		"  -s, --size <mib>    SD image size (default %d, min 1536)\n"
+		"  -d, --dir <path>    Directory for the SD image (default $TMPDIR or /tmp)\n"
+		"  -o, --out <path>    Write CSV to path instead of stdout\n"
+		"  -l, --list          List workloads\n", name, SB_IMG_SZ_DEF);
+}
+
+int main(int argc, char **argv)
+{
+	const char *filter = NULL;
+	const char *out = NULL;
+	u32 size_mb = SB_IMG_SZ_DEF;
+	char img[256];
+
+	const char *dir = getenv("TMPDIR");
+	if (!dir || !*dir)
+		dir = "/tmp";
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char *opt = argv[i];
+		if ((!strcmp(opt, "-f") || !strcmp(opt, "--filter")) && i + 1 < argc)
+			filter = argv[++i];
+		else if ((!strcmp(opt, "-s") || !strcmp(opt, "--size")) && i + 1 < argc)
+			size_mb = atoi(argv[++i]);
+		else if ((!strcmp(opt, "-d") || !strcmp(opt, "--dir")) && i + 1 < argc)
+			dir = argv[++i];
+		else if ((!strcmp(opt, "-o") || !strcmp(opt, "--out")) && i + 1 < argc)
+			out = argv[++i];
+		else if (!strcmp(opt, "-l") || !strcmp(opt, "--list"))
+		{
+			for (u32 j = 0; bench_workloads[j].name; j++)
+				printf("%s\n", bench_workloads[j].name);
+			return 0;
+		}
+		else
+		{
+			_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Test area starts at a third of the card, like in Nyx.
+	if (size_mb < 1536 || size_mb > 0x3FFFFF)
+	{
+		_usage(argv[0]);
+		return 1;
+	}
+
+	if (snprintf(img, sizeof(img), "%s/bdk_storage_bench_sd.img", dir) >= (int)sizeof(img))
+		return 1;
+
+	if (host_init())
+		return 1;
+
+	if (host_storage_open(&sd_storage, img, size_mb * (SZ_1M / SDMMC_DAT_BLOCKSIZE)))
+	{
+		fprintf(stderr, "Failed to open %s!\n", img);
+		return 1;
+	}
+
+	// Fresh FAT32 volume. Cluster size is picked by volume size.
+	u8 *work = malloc(SZ_4M);
+	int res = f_mkfs("sd:", FM_FAT32, 0, work, SZ_4M);
+	free(work);
+	if (res || !sd_mount())
+	{
+		fprintf(stderr, "Failed to format %s!\n", img);
+		host_storage_close(&sd_storage);
+		unlink(img);
+		return 1;
+	}
+
+	// Nyx keeps results and temporary files under it.
+	f_mkdir("bootloader");
+
+	u32 workloads_cnt = 0;
+	while (bench_workloads[workloads_cnt].name)
+		workloads_cnt++;
+
+	bench_result_t *results = (bench_result_t *)zalloc(sizeof(bench_result_t) * workloads_cnt);
+	bench_ctxt_t *bench = (bench_ctxt_t *)zalloc(sizeof(bench_ctxt_t));
+
+	bench->storage      = &sd_storage;
+	bench->sector       = ALIGN_DOWN(sd_storage.sec_cnt / 3, 0x8000); // Align to 16MB.
+	bench->area_sectors = SB_AREA_SECTORS;
+	bench->buf          = (u8 *)MIXD_BUF_ALIGNED;
+	bench->raw_write    = true; // Image is scratch storage.
+
+	int error = 0;
+	u32 results_cnt = 0;
+	for (u32 i = 0; i < workloads_cnt; i++)
+	{
+		const bench_workload_t *wl = &bench_workloads[i];
+
+		// Read workloads of files depend on the append one.
+		if (filter && !strstr(wl->name, filter) && wl->type != BENCH_FILE_APPEND)
+			continue;
+
+		error = bench_run(bench, wl, &results[results_cnt]);
+		if (error)
+		{
+			fprintf(stderr, "Workload %s failed (%d)!\n", wl->name, error);
+			break;
+		}
+
+		// Keep only requested ones.
+		if (!filter || strstr(wl->name, filter))
+			results_cnt++;
+	}
+
+	char *csv = bench_csv_create("host_sd", results, results_cnt);
+	if (out)
+	{
+		FILE *fp = fopen(out, "w");
+		if (!fp || fputs(csv, fp) < 0)
+			error = 1;
+		if (fp)
+			fclose(fp);
+	}
+	else
+		fputs(csv, stdout);
+
+	free(csv);
+	free(bench);
+	free(results);
+
+	sd_unmount();
+	host_storage_close(&sd_storage);
+	unlink(img);
+
+	return error ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * BDK host test runner
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bdk.h>
+
+#include "test.h"
+
+static void _usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  -f, --filter <str>  Run tests whose name contains str\n"
+		"  -l, --list          List tests\n", name);
+}
+
+int host_test_main(const host_test_t *tests, u32 count, int argc, char **argv)
+{
+	const char *filter = NULL;
+	const char *name = strrchr(argv[0], '/') ? strrchr(argv[0], '/') + 1 : argv[0];
+	u32 passed = 0;
+	u32 failed = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char *opt = argv[i];
+		if ((!strcmp(opt, "-f") || !strcmp(opt, "--filter")) && i + 1 < argc)
+			filter = argv[++i];
+		else if (!strcmp(opt, "-l") || !strcmp(opt, "--list"))
+		{
+			for (u32 j = 0; j < count; j++)
+				printf("%s\n", tests[j].name);
+			return 0;
+		}
+		else
+		{
+			_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (host_init())
+		return 1;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		if (filter && !strstr(tests[i].name, filter))
+			continue;
+
+		int err = tests[i].run();
+		printf("%-8s %s.%s\n", err ? "FAIL" : "ok", name, tests[i].name);
+
+		if (err)
+			failed++;
+		else
+			passed++;
+	}
+
+	printf("%s: %u passed, %u failed\n", name, passed, failed);
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * BDK host test runner
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+#include <utils/types.h>
+
+typedef struct _host_test_t
+{
+	const char *name;
+	int (*run)(); // Returns 0 on pass.
+} host_test_t;
+
+// Fails the running test with the checked expression and its location.
+#define TEST_ASSERT(cond) \
+	do { \
+		if (!(cond)) \
+		{ \
+			fprintf(stderr, "  %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+			return 1; \
+		} \
+	} while (0)
+
+int host_test_main(const host_test_t *tests, u32 count, int argc, char **argv);
+
+#endif
@@ -0,0 +1,499 @@
+/*
+ * File copy engine tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Does what the partition manager does: backs up an SD tree to the ramdisk,
+ * formats SD and restores the tree from the ramdisk. The tree has files on
+ * both sides of the batch and chunk limits, so every copy path runs.
+ */
+
+#include <bdk.h>
+
+#include <libs/fatfs/diskio.h>
+#include <libs/fatfs/ff.h>
+#include <storage/ramdisk.h>
+
+#include "storage.h"
+#include "test.h"
+
+#include "../../nyx/nyx_gui/frontend/fe_file_copy.c"
+
+// No GUI. Copies run without labels.
+void lv_label_set_text(lv_obj_t *label, const char *text) {}
+void manual_system_maintenance(bool refresh) {}
+
+#define SD_SECTORS  (SZ_512M / SDMMC_DAT_BLOCKSIZE)
+#define FS_AU_SIZE  SZ_4K
+#define RAM_SZ      SZ_256M
+
+#define SMALL_FILES 300
+#define MID_FILES   48
+#define FILE_BUF_SZ SZ_1M
+#define PATH_SZ     96
+
+typedef struct _copy_file_t
+{
+	char path[PATH_SZ];
+	u32  size;
+	u8   attr;
+} copy_file_t;
+
+// Folders get created in order, so parents come first.
+static const struct
+{
+	const char *path;
+	u8 attr;
+} copy_dirs[] = {
+	{ "/bootloader",                    0 },
+	{ "/bootloader/small",              0 },
+	{ "/bootloader/mid",                0 },
+	{ "/bootloader/sys",                AM_HID },
+	{ "/bootloader/sys/l4t",            0 },
+	{ "/bootloader/sys/l4t/deep",       AM_RDO },
+	{ "/bootloader/payloads",           0 },
+	{ "/bootloader/empty",              0 },
+	{ "/warmboot_mariko",               0 },
+};
+
+static const struct
+{
+	const char *path;
+	u32 size;
+	u8 attr;
+} copy_large[] = {
+	{ "/payload.bin",                                         SZ_256K,                0 },
+	{ "/bootloader/payloads/just_over_batch_limit.bin",       SZ_256K + 1,            0 },
+	{ "/bootloader/payloads/one_cluster_tail.bin",            SZ_1M + 7,              AM_RDO },
+	{ "/bootloader/sys/l4t/one_chunk.bin",                    SZ_8M,                  AM_HID | AM_SYS },
+	{ "/bootloader/sys/l4t/chunk_and_tail.bin",               SZ_8M + SZ_32K + 3,     0 },
+	{ "/bootloader/sys/l4t/deep/a rather long file name.bin", 2 * SZ_8M + 513,        0 },
+	{ "/bootloader/sys/l4t/deep/sub_cluster_tail.bin",        SZ_8M + SZ_32K + SZ_8K, 0 },
+};
+
+static copy_file_t *files;
+static u32 files_cnt;
+static u8 *file_buf;
+static FATFS *ram_fs;
+
+static u32 _seed(const char *path)
+{
+	u32 seed = 0x811C9DC5;
+	while (*path)
+		seed = (seed ^ (u8)*path++) * 0x01000193;
+
+	return seed;
+}
+
+static void _fill(u8 *buf, u32 offset, u32 size, u32 seed)
+{
+	for (u32 i = offset; i < offset + size; i++)
+		buf[i - offset] = (u8)(seed + i * 13 + (i >> 12) * 5);
+}
+
+static void _file_add(const char *path, u32 size, u8 attr)
+{
+	copy_file_t *cf = &files[files_cnt++];
+
+	strcpy(cf->path, path);
+	cf->size = size;
+	cf->attr = attr;
+}
+
+static int _file_create(const char *vol, copy_file_t *cf)
+{
+	FIL fp;
+	UINT bw;
+	char path[PATH_SZ + 8];
+
+	s_printf(path, "%s%s", vol, cf->path);
+	if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+		return 1;
+
+	int res = 0;
+	u32 seed = _seed(cf->path);
+	for (u32 offset = 0; offset < cf->size && !res; offset += FILE_BUF_SZ)
+	{
+		u32 chunk = MIN(cf->size - offset, FILE_BUF_SZ);
+		_fill(file_buf, offset, chunk, seed);
+		res = f_write(&fp, file_buf, chunk, &bw) || bw != chunk;
+	}
+	res |= f_close(&fp);
+	if (!res && cf->attr)
+		res = f_chmod(path, cf->attr, AM_RDO | AM_HID | AM_SYS);
+
+	return res;
+}
+
+static int _file_verify(const char *vol, copy_file_t *cf)
+{
+	FIL fp;
+	UINT br;
+	FILINFO fno;
+	char path[PATH_SZ + 8];
+
+	s_printf(path, "%s%s", vol, cf->path);
+	if (f_stat(path, &fno) || fno.fattrib != (cf->attr | AM_ARC))
+		return 1;
+	if (f_open(&fp, path, FA_READ) || f_size(&fp) != cf->size)
+		return 1;
+
+	int res = 0;
+	u32 seed = _seed(cf->path);
+	u8 *ref = file_buf + FILE_BUF_SZ;
+	for (u32 offset = 0; offset < cf->size && !res; offset += FILE_BUF_SZ)
+	{
+		u32 chunk = MIN(cf->size - offset, FILE_BUF_SZ);
+		_fill(ref, offset, chunk, seed);
+		res = f_read(&fp, file_buf, chunk, &br) || br != chunk || memcmp(file_buf, ref, chunk);
+	}
+	f_close(&fp);
+
+	return res;
+}
+
+static u32 _dir_entries(const char *path)
+{
+	DIR dir;
+	FILINFO fno;
+	u32 cnt = 0;
+
+	if (f_opendir(&dir, path))
+		return 0;
+	while (!f_readdir(&dir, &fno) && fno.fname[0])
+		cnt++;
+	f_closedir(&dir);
+
+	return cnt;
+}
+
+static int _tree_verify(const char *vol)
+{
+	FILINFO fno;
+	char path[PATH_SZ + 8];
+
+	for (u32 i = 0; i < ARRAY_SIZE(copy_dirs); i++)
+	{
+		s_printf(path, "%s%s", vol, copy_dirs[i].path);
+		TEST_ASSERT(!f_stat(path, &fno));
+		TEST_ASSERT(fno.fattrib == (AM_DIR | copy_dirs[i].attr));
+	}
+
+	for (u32 i = 0; i < files_cnt; i++)
+		TEST_ASSERT(!_file_verify(vol, &files[i]));
+
+	// Nothing more than the tree.
+	s_printf(path, "%s/bootloader/small", vol);
+	TEST_ASSERT(_dir_entries(path) == SMALL_FILES);
+	s_printf(path, "%s/bootloader/mid", vol);
+	TEST_ASSERT(_dir_entries(path) == MID_FILES);
+	s_printf(path, "%s/bootloader/empty", vol);
+	TEST_ASSERT(_dir_entries(path) == 0);
+
+	return 0;
+}
+
+
+static int _setup()
+{
+	char path[PATH_SZ];
+
+	if (!files)
+	{
+		files    = (copy_file_t *)malloc(sizeof(copy_file_t) * (SMALL_FILES + MID_FILES + ARRAY_SIZE(copy_large) + 2));
+		file_buf = (u8 *)malloc(FILE_BUF_SZ * 2);
+		ram_fs   = (FATFS *)malloc(sizeof(FATFS));
+	}
+	files_cnt = 0;
+
+	// Tiny files fill batches by count and mid ones by size.
+	for (u32 i = 0; i < SMALL_FILES; i++)
+	{
+		s_printf(path, "/bootloader/small/file_%03d.ini", i);
+		_file_add(path, (i * 997) % 4099, (i % 50) ? 0 : AM_HID);
+	}
+	for (u32 i = 0; i < MID_FILES; i++)
+	{
+		s_printf(path, "/bootloader/mid/module_%02d.kip", i);
+		_file_add(path, i ? SZ_256K - (i * 3613) % SZ_64K : SZ_256K, 0);
+	}
+	for (u32 i = 0; i < ARRAY_SIZE(copy_large); i++)
+		_file_add(copy_large[i].path, copy_large[i].size, copy_large[i].attr);
+	_file_add("/warmboot_mariko/wb_84.bin", 2216, 0);
+	_file_add("/hekate_ipl.ini", 0, AM_SYS);
+
+	if (host_sd_image_setup("copy_sd", SD_SECTORS, FS_AU_SIZE))
+		return 1;
+
+	for (u32 i = 0; i < ARRAY_SIZE(copy_dirs); i++)
+	{
+		s_printf(path, "sd:%s", copy_dirs[i].path);
+		if (f_mkdir(path) || (copy_dirs[i].attr && f_chmod(path, copy_dirs[i].attr, AM_RDO | AM_HID | AM_SYS)))
+			return 1;
+	}
+	for (u32 i = 0; i < files_cnt; i++)
+		if (_file_create("sd:", &files[i]))
+			return 1;
+
+	// Never gets copied.
+	if (f_mkdir("sd:/System Volume Information"))
+		return 1;
+	copy_file_t svi = { "/System Volume Information/IndexerVolumeGuid", 76, 0 };
+	if (_file_create("sd:", &svi))
+		return 1;
+
+	return ram_disk_init(ram_fs, RAM_SZ);
+}
+
+static void _teardown()
+{
+	f_mount(NULL, "ram:", 1);
+	host_sd_image_teardown();
+}
+
+static int _copy_tree(const char *src, const char *dst, file_copy_ctxt_t *copy)
+{
+	char *path = malloc(0x1000);
+	path[0] = 0;
+
+	file_copy_init(copy, src, dst, NULL);
+	copy->min_file_size = RAMDISK_CLUSTER_SZ;
+
+	int res = file_copy_dir(copy, path);
+	int res_end = file_copy_end(copy);
+	free(path);
+
+	return res ? res : res_end;
+}
+
+static u32 _total_size()
+{
+	u32 size = 0;
+	for (u32 i = 0; i < files_cnt; i++)
+		size += MAX(files[i].size, RAMDISK_CLUSTER_SZ);
+
+	return size;
+}
+
+static int _test_roundtrip()
+{
+	file_copy_ctxt_t copy;
+
+	TEST_ASSERT(!_setup());
+
+	// Backup.
+	TEST_ASSERT(!_copy_tree("sd:", "ram:", &copy));
+	TEST_ASSERT(copy.total_files == files_cnt);
+	TEST_ASSERT(copy.total_size == _total_size());
+	TEST_ASSERT(!_tree_verify("ram:"));
+	TEST_ASSERT(f_stat("ram:/System Volume Information", NULL) == FR_NO_FILE);
+
+	// Restore to a clean SD.
+	sd_unmount();
+	TEST_ASSERT(!host_sd_format(FS_AU_SIZE));
+	TEST_ASSERT(!_copy_tree("ram:", "sd:", &copy));
+	TEST_ASSERT(copy.total_files == files_cnt);
+
+	// From the media.
+	sd_unmount();
+	TEST_ASSERT(sd_mount());
+	TEST_ASSERT(!_tree_verify("sd:"));
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_file()
+{
+	file_copy_ctxt_t copy;
+
+	TEST_ASSERT(!_setup());
+
+	file_copy_init(&copy, "sd:", "ram:", NULL);
+	TEST_ASSERT(!f_mkdir("ram:/bootloader"));
+	TEST_ASSERT(!f_mkdir("ram:/bootloader/payloads"));
+	TEST_ASSERT(!file_copy_file(&copy, "payload.bin"));
+	TEST_ASSERT(!file_copy_file(&copy, "bootloader/payloads/one_cluster_tail.bin"));
+	TEST_ASSERT(!file_copy_file(&copy, "hekate_ipl.ini"));
+
+	// Batched files are only written on end.
+	TEST_ASSERT(f_stat("ram:/payload.bin", NULL) == FR_NO_FILE);
+	TEST_ASSERT(!file_copy_end(&copy));
+	TEST_ASSERT(copy.total_files == 3);
+
+	for (u32 i = 0; i < files_cnt; i++)
+		if (!strcmp(files[i].path, "/payload.bin") || !strcmp(files[i].path, "/hekate_ipl.ini") ||
+			!strcmp(files[i].path, "/bootloader/payloads/one_cluster_tail.bin"))
+			TEST_ASSERT(!_file_verify("ram:", &files[i]));
+
+	_teardown();
+
+	return 0;
+}
+
+// Batches get written when full by count or by size, before the next file is read.
+static int _test_batch()
+{
+	file_copy_ctxt_t copy;
+	char path[PATH_SZ];
+
+	TEST_ASSERT(!_setup());
+
+	file_copy_init(&copy, "sd:", "ram:", NULL);
+	TEST_ASSERT(!f_mkdir("ram:/bootloader"));
+	TEST_ASSERT(!f_mkdir("ram:/bootloader/small"));
+	TEST_ASSERT(!f_mkdir("ram:/bootloader/mid"));
+
+	for (u32 i = 0; i < COPY_BATCH_FILES; i++)
+	{
+		s_printf(path, "bootloader/small/file_%03d.ini", i);
+		TEST_ASSERT(!file_copy_file(&copy, path));
+	}
+	TEST_ASSERT(copy.batch_cnt == COPY_BATCH_FILES);
+	TEST_ASSERT(f_stat("ram:/bootloader/small/file_000.ini", NULL) == FR_NO_FILE);
+
+	TEST_ASSERT(!file_copy_file(&copy, "bootloader/small/file_128.ini"));
+	TEST_ASSERT(copy.batch_cnt == 1);
+	TEST_ASSERT(_dir_entries("ram:/bootloader/small") == COPY_BATCH_FILES);
+
+	// 256KB files. The last one that fits leaves no room for the next.
+	u32 mid = 0;
+	while (copy.batch_cnt > 1 || !mid)
+	{
+		s_printf(path, "bootloader/mid/module_%02d.kip", mid++);
+		TEST_ASSERT(!file_copy_file(&copy, path));
+		TEST_ASSERT(copy.batch_size <= COPY_BATCH_BUF_SZ);
+	}
+	TEST_ASSERT(mid > 1 && mid < MID_FILES);
+	TEST_ASSERT(_dir_entries("ram:/bootloader/mid") == mid - 1);
+
+	TEST_ASSERT(!file_copy_end(&copy));
+	TEST_ASSERT(_dir_entries("ram:/bootloader/small") == COPY_BATCH_FILES + 1);
+	TEST_ASSERT(_dir_entries("ram:/bootloader/mid") == mid);
+
+	for (u32 i = 0; i < files_cnt; i++)
+		if (!strncmp(files[i].path, "/bootloader/small/file_", 23) && atoi(files[i].path + 23) <= COPY_BATCH_FILES)
+			TEST_ASSERT(!_file_verify("ram:", &files[i]));
+		else if (!strncmp(files[i].path, "/bootloader/mid/module_", 23) && (u32)atoi(files[i].path + 23) < mid)
+			TEST_ASSERT(!_file_verify("ram:", &files[i]));
+
+	_teardown();
+
+	return 0;
+}
+
+static bool _file_in(const copy_file_t *cf, const char *dir)
+{
+	return !strncmp(cf->path, dir, strlen(dir)) && cf->path[strlen(dir)] == '/';
+}
+
+// Failed files get counted and the rest still copied.
+static int _test_errors()
+{
+	file_copy_ctxt_t copy;
+	FIL fp;
+
+	TEST_ASSERT(!_setup());
+
+	// Files in place of folders. Small files fail on flush, large ones on open.
+	TEST_ASSERT(!f_mkdir("ram:/bootloader"));
+	TEST_ASSERT(!f_open(&fp, "ram:/bootloader/mid", FA_CREATE_NEW | FA_WRITE) && !f_close(&fp));
+	TEST_ASSERT(!f_open(&fp, "ram:/bootloader/payloads", FA_CREATE_NEW | FA_WRITE) && !f_close(&fp));
+
+	TEST_ASSERT(!_copy_tree("sd:", "ram:", &copy));
+	TEST_ASSERT(copy.total_files == files_cnt);
+	TEST_ASSERT(copy.failed_files == MID_FILES + 2);
+
+	for (u32 i = 0; i < files_cnt; i++)
+		if (!_file_in(&files[i], "/bootloader/mid") && !_file_in(&files[i], "/bootloader/payloads"))
+			TEST_ASSERT(!_file_verify("ram:", &files[i]));
+
+	_teardown();
+
+	return 0;
+}
+
+// Copy stops once destination is full.
+static int _test_full()
+{
+	file_copy_ctxt_t copy;
+
+	TEST_ASSERT(!_setup());
+	TEST_ASSERT(!ram_disk_init(ram_fs, SZ_16M));
+
+	TEST_ASSERT(_copy_tree("sd:", "ram:", &copy) == FR_DENIED);
+	TEST_ASSERT(copy.failed_files && copy.total_files < files_cnt);
+
+	_teardown();
+
+	return 0;
+}
+
+// Backup size check of the partition manager.
+static int _test_stats()
+{
+	file_copy_ctxt_t copy;
+	char path[PATH_SZ] = "";
+	u32 total = 0;
+
+	TEST_ASSERT(!_setup());
+
+	for (u32 limit = 0; limit < 3; limit++)
+	{
+		file_copy_init(&copy, "sd:", NULL, NULL);
+		copy.min_file_size = RAMDISK_CLUSTER_SZ;
+		if (limit)
+			copy.max_total_size = total - 2 + limit;
+
+		int res = file_copy_dir(&copy, path);
+		TEST_ASSERT(!file_copy_end(&copy));
+		path[0] = 0;
+
+		if (limit == 1)
+			TEST_ASSERT(res == -1 && copy.total_size > copy.max_total_size);
+		else
+		{
+			TEST_ASSERT(!res);
+			TEST_ASSERT(copy.total_files == files_cnt);
+			TEST_ASSERT(copy.total_size == _total_size());
+		}
+		if (!limit)
+			total = copy.total_size;
+	}
+
+	// Nothing gets written.
+	TEST_ASSERT(_dir_entries("ram:") == 0);
+
+	_teardown();
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "roundtrip", _test_roundtrip },
+	{ "file",      _test_file },
+	{ "batch",     _test_batch },
+	{ "stats",     _test_stats },
+	{ "errors",    _test_errors },
+	{ "full",      _test_full },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
@@ -0,0 +1,256 @@
+/*
+ * Directory listing tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bdk.h>
+
+#include <libs/fatfs/ff.h>
+#include <utils/dirlist.h>
+
+#include "storage.h"
+#include "test.h"
+
+#define SD_SECTORS  (SZ_512M / SDMMC_DAT_BLOCKSIZE)
+#define FS_AU_SIZE  SZ_4K
+
+#define ORDER_FILES 1500
+#define LONG_FILES  200
+#define NAME_SZ     256
+
+static char (*names)[NAME_SZ];
+static u32 names_cnt;
+
+// Digit runs by value, with strtoull instead of length and memcmp.
+static int _natural_ref(const char *a, const char *b)
+{
+	while (*a && *b)
+	{
+		if (*a >= '0' && *a <= '9' && *b >= '0' && *b <= '9')
+		{
+			char *end_a, *end_b;
+			unsigned long long val_a = strtoull(a, &end_a, 10);
+			unsigned long long val_b = strtoull(b, &end_b, 10);
+			if (val_a != val_b)
+				return val_a < val_b ? -1 : 1;
+
+			a = end_a;
+			b = end_b;
+		}
+		else
+		{
+			if (*a != *b)
+				return (u8)*a - (u8)*b;
+			a++;
+			b++;
+		}
+	}
+
+	return (u8)*a - (u8)*b;
+}
+
+static int _qsort_cmp(const void *a, const void *b)
+{
+	return strcmp(a, b);
+}
+
+static int _file_create(const char *dir, const char *name, u8 attr)
+{
+	FIL fp;
+	char path[NAME_SZ + 32];
+
+	s_printf(path, "%s/%s", dir, name);
+	if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE) || f_close(&fp))
+		return 1;
+
+	return attr && f_chmod(path, attr, attr);
+}
+
+// Same names as expected, in an order the comparator accepts.
+static int _list_check(dirlist_t *list, int (*cmp)(const char *, const char *))
+{
+	TEST_ASSERT(list && list->count == names_cnt && !list->name[names_cnt]);
+
+	for (u32 i = 1; i < list->count; i++)
+		TEST_ASSERT(cmp(list->name[i - 1], list->name[i]) <= 0);
+
+	char (*sorted)[NAME_SZ] = calloc(names_cnt, NAME_SZ);
+	for (u32 i = 0; i < list->count; i++)
+		strcpy(sorted[i], list->name[i]);
+	qsort(sorted, names_cnt, NAME_SZ, _qsort_cmp);
+	qsort(names, names_cnt, NAME_SZ, _qsort_cmp);
+	int res = memcmp(sorted, names, names_cnt * NAME_SZ);
+	free(sorted);
+
+	return res;
+}
+
+static int _setup()
+{
+	if (!names)
+		names = calloc(ORDER_FILES * 2, NAME_SZ);
+	memset(names, 0, ORDER_FILES * 2 * NAME_SZ);
+	names_cnt = 0;
+
+	return host_sd_image_setup("dirlist_sd", SD_SECTORS, FS_AU_SIZE);
+}
+
+static void _teardown()
+{
+	host_sd_image_teardown();
+}
+
+static int _test_order()
+{
+	TEST_ASSERT(!_setup());
+	TEST_ASSERT(!f_mkdir("sd:/order"));
+
+	// Payload, version and padded names, created out of order.
+	for (u32 i = 0; i < ORDER_FILES; i++)
+	{
+		u32 idx = (i * 7919) % ORDER_FILES;
+		char *name = names[names_cnt++];
+
+		switch (idx % 5)
+		{
+		case 0:
+			s_printf(name, "payload_%d.bin", idx);
+			break;
+		case 1:
+			s_printf(name, "v%d.%d.%d.ini", idx / 100, (idx / 10) % 10, idx % 10);
+			break;
+		case 2:
+			s_printf(name, "pad_%05d", idx);
+			break;
+		case 3:
+			s_printf(name, "%d", idx * 104729);
+			break;
+		default:
+			s_printf(name, "Entry %d Of %d", idx, ORDER_FILES - idx);
+			break;
+		}
+		TEST_ASSERT(!_file_create("sd:/order", name, 0));
+	}
+	strcpy(names[names_cnt++], "12345678901234567890123");
+	TEST_ASSERT(!_file_create("sd:/order", "12345678901234567890123", 0));
+
+	dirlist_t *list = dirlist("sd:/order", NULL, 0);
+	TEST_ASSERT(!_list_check(list, strcmp));
+	free(list);
+
+	list = dirlist("sd:/order", NULL, DIR_NATURAL_ORDER);
+	TEST_ASSERT(!_list_check(list, _natural_ref));
+
+	// Digit runs, not characters.
+	u32 pos2 = 0, pos10 = 0;
+	for (u32 i = 0; i < list->count; i++)
+	{
+		if (!strcmp(list->name[i], "payload_2.bin"))
+			pos2 = i;
+		else if (!strcmp(list->name[i], "payload_10.bin"))
+			pos10 = i;
+	}
+	TEST_ASSERT(pos2 < pos10);
+	free(list);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_flags()
+{
+	TEST_ASSERT(!_setup());
+	TEST_ASSERT(!f_mkdir("sd:/flags"));
+
+	TEST_ASSERT(!_file_create("sd:/flags", "a.ini", 0));
+	TEST_ASSERT(!_file_create("sd:/flags", "b.bin", 0));
+	TEST_ASSERT(!_file_create("sd:/flags", "hidden.ini", AM_HID));
+	TEST_ASSERT(!_file_create("sd:/flags", ".dot.ini", 0));
+	TEST_ASSERT(!f_mkdir("sd:/flags/folder.ini"));
+	TEST_ASSERT(!f_mkdir("sd:/flags/hidden_folder"));
+	TEST_ASSERT(!f_chmod("sd:/flags/hidden_folder", AM_HID, AM_HID));
+
+	dirlist_t *list = dirlist("sd:/flags", NULL, 0);
+	TEST_ASSERT(list && list->count == 2);
+	TEST_ASSERT(!strcmp(list->name[0], "a.ini") && !strcmp(list->name[1], "b.bin"));
+	free(list);
+
+	list = dirlist("sd:/flags", NULL, DIR_SHOW_HIDDEN);
+	TEST_ASSERT(list && list->count == 3 && !strcmp(list->name[2], "hidden.ini"));
+	free(list);
+
+	list = dirlist("sd:/flags", NULL, DIR_SHOW_DIRS);
+	TEST_ASSERT(list && list->count == 1 && !strcmp(list->name[0], "folder.ini"));
+	free(list);
+
+	list = dirlist("sd:/flags", NULL, DIR_SHOW_DIRS | DIR_SHOW_HIDDEN);
+	TEST_ASSERT(list && list->count == 2 && !strcmp(list->name[1], "hidden_folder"));
+	free(list);
+
+	// Patterns match files only.
+	list = dirlist("sd:/flags", "*.ini", DIR_SHOW_DIRS | DIR_SHOW_HIDDEN);
+	TEST_ASSERT(list && list->count == 2);
+	TEST_ASSERT(!strcmp(list->name[0], "a.ini") && !strcmp(list->name[1], "hidden.ini"));
+	free(list);
+
+	TEST_ASSERT(!dirlist("sd:/flags", "*.txt", 0));
+	TEST_ASSERT(!dirlist("sd:/missing", NULL, 0));
+
+	TEST_ASSERT(!f_mkdir("sd:/empty"));
+	TEST_ASSERT(!dirlist("sd:/empty", NULL, DIR_SHOW_DIRS | DIR_SHOW_HIDDEN));
+
+	_teardown();
+
+	return 0;
+}
+
+// Names and index outgrow their initial sizes many times over.
+static int _test_grow()
+{
+	TEST_ASSERT(!_setup());
+	TEST_ASSERT(!f_mkdir("sd:/long"));
+
+	for (u32 i = 0; i < LONG_FILES; i++)
+	{
+		char *name = names[names_cnt++];
+		u32 len = 200 + i % 55;
+
+		for (u32 j = 0; j < len; j++)
+			name[j] = 'a' + (i + j) % 26;
+		s_printf(name + len - 4, "%04d", i);
+		TEST_ASSERT(!_file_create("sd:/long", name, 0));
+	}
+
+	dirlist_t *list = dirlist("sd:/long", NULL, DIR_NATURAL_ORDER);
+	TEST_ASSERT(!_list_check(list, _natural_ref));
+	free(list);
+
+	_teardown();
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "order", _test_order },
+	{ "flags", _test_flags },
+	{ "grow",  _test_grow },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
@@ -0,0 +1,531 @@
+/*
+ * USB Fast Dump gadget protocol tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Runs the gadget against a loopback host that speaks the wire protocol.
+ * Bulk IN transfers complete only when the gadget waits for them, and their
+ * data is taken at completion. So a buffer reused while still queued shows up
+ * as corrupted data on the host side.
+ */
+
+#include <bdk.h>
+
+#include <usb/usb_gadget_dump.h>
+
+#include "storage.h"
+#include "test.h"
+
+#define HOST_CMDS_MAX   16
+#define HOST_QUEUE_MAX  64
+#define HOST_STREAM_SZ  SZ_32M
+#define EMMC_SECTORS    0x8000 // 16MB.
+#define SD_SECTORS      0x4000 // Not formatted. Gadget can't mount it.
+#define BOOT_MULT       1      // 128KB.
+
+typedef struct _host_xfer_t
+{
+	const u8 *buf;
+	u32 len;
+} host_xfer_t;
+
+typedef struct _dump_host_t
+{
+	// Commands sent to Bulk OUT. Zero cmd_len sends a full command.
+	fd_cmd_t cmds[HOST_CMDS_MAX];
+	u32 cmd_len[HOST_CMDS_MAX];
+	u32 cmds_cnt;
+	u32 cmd;
+
+	// Bulk IN queue. Completed in order.
+	host_xfer_t queue[HOST_QUEUE_MAX];
+	u32 queued;
+	u32 queue_limit;
+	u32 queued_peak;
+
+	// Received data and where each command's reply starts.
+	u8 *stream;
+	u32 stream_len;
+	u32 reply[HOST_CMDS_MAX + 1];
+
+	u32 errors; // Protocol violations seen by the host.
+} dump_host_t;
+
+static dump_host_t host;
+static u8 *emmc_data;
+
+static void _xfer_complete(u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+	{
+		host_xfer_t *xfer = &host.queue[i];
+		if (host.stream_len + xfer->len > HOST_STREAM_SZ)
+		{
+			host.errors++;
+			continue;
+		}
+
+		memcpy(host.stream + host.stream_len, xfer->buf, xfer->len);
+		host.stream_len += xfer->len;
+	}
+
+	host.queued -= count;
+	memmove(host.queue, &host.queue[count], host.queued * sizeof(host_xfer_t));
+}
+
+static int _usbd_flush_endpoint(u32 ep)
+{
+	return USB_RES_OK;
+}
+
+static int _usbd_set_ep_stall(u32 ep, int stall)
+{
+	return USB_RES_OK;
+}
+
+static int _usbd_handle_ep0_ctrl_setup()
+{
+	return USB_RES_OK;
+}
+
+static void _usbd_end(bool reset_ep, bool only_controller)
+{
+}
+
+static int _usb_device_init()
+{
+	return USB_RES_OK;
+}
+
+static int _usb_device_enumerate(usb_gadget_type gadget)
+{
+	if (gadget != USB_GADGET_DUMP)
+		host.errors++;
+
+	return USB_RES_OK;
+}
+
+static int _usb_device_ep1_out_read(u8 *buf, u32 len, u32 *actual, u32 sync_timeout)
+{
+	// Host reads the whole reply before it sends the next command.
+	if (host.queued)
+		host.errors++;
+
+	host.reply[host.cmd] = host.stream_len;
+
+	if (host.cmd >= host.cmds_cnt)
+	{
+		// Script is done. Exit with the button combo.
+		host_btn_vol = BTN_VOL_UP | BTN_VOL_DOWN;
+		if (actual)
+			*actual = 0;
+
+		return USB_ERROR_TIMEOUT;
+	}
+
+	u32 cmd_len = host.cmd_len[host.cmd] ? host.cmd_len[host.cmd] : sizeof(fd_cmd_t);
+	if (cmd_len > len)
+	{
+		host.errors++;
+		return USB_ERROR_XFER_ERROR;
+	}
+
+	memcpy(buf, &host.cmds[host.cmd], cmd_len);
+	host.cmd++;
+	if (actual)
+		*actual = cmd_len;
+
+	return USB_RES_OK;
+}
+
+static int _usb_device_ep1_out_reading_finish(u32 *actual, u32 sync_timeout)
+{
+	return _usb_device_ep1_out_read(NULL, 0, actual, sync_timeout);
+}
+
+static int _usb_device_ep1_in_write(u8 *buf, u32 len, u32 *actual, u32 sync_timeout)
+{
+	// Only queued transfers are expected. Max transfer size is what the controller takes.
+	if (sync_timeout != USB_XFER_START || len > USB_EP_BUFFER_MAX_SIZE ||
+		host.queued >= host.queue_limit)
+	{
+		host.errors++;
+		return USB_ERROR_XFER_ERROR;
+	}
+
+	host.queue[host.queued].buf = buf;
+	host.queue[host.queued].len = len;
+	host.queued++;
+	host.queued_peak = MAX(host.queued_peak, host.queued);
+
+	return USB_RES_OK;
+}
+
+static int _usb_device_ep1_in_writing_wait(u32 queued_max, u32 sync_timeout)
+{
+	if (host.queued > queued_max)
+		_xfer_complete(host.queued - queued_max);
+
+	return USB_RES_OK;
+}
+
+static int _usb_device_ep1_in_writing_finish(u32 *pending_bytes, u32 sync_timeout)
+{
+	_xfer_complete(host.queued);
+	if (pending_bytes)
+		*pending_bytes = 0;
+
+	return USB_RES_OK;
+}
+
+static bool _usb_device_get_suspended()
+{
+	return false;
+}
+
+void usb_device_get_ops(usb_ops_t *ops)
+{
+	memset(ops, 0, sizeof(usb_ops_t));
+	ops->usbd_flush_endpoint               = _usbd_flush_endpoint;
+	ops->usbd_set_ep_stall                 = _usbd_set_ep_stall;
+	ops->usbd_handle_ep0_ctrl_setup        = _usbd_handle_ep0_ctrl_setup;
+	ops->usbd_end                          = _usbd_end;
+	ops->usb_device_init                   = _usb_device_init;
+	ops->usb_device_enumerate              = _usb_device_enumerate;
+	ops->usb_device_ep1_out_read           = _usb_device_ep1_out_read;
+	ops->usb_device_ep1_out_reading_finish = _usb_device_ep1_out_reading_finish;
+	ops->usb_device_ep1_in_write           = _usb_device_ep1_in_write;
+	ops->usb_device_ep1_in_writing_finish  = _usb_device_ep1_in_writing_finish;
+	ops->usb_device_ep1_in_writing_wait    = _usb_device_ep1_in_writing_wait;
+	ops->usb_device_get_suspended          = _usb_device_get_suspended;
+}
+
+void xusb_device_get_ops(usb_ops_t *ops)
+{
+	usb_device_get_ops(ops);
+}
+
+static void _set_text(void *label, const char *text)
+{
+}
+
+static void _system_maintenance(bool refresh)
+{
+}
+
+static void _host_cmd(u32 cmd, u32 storage, u32 flags, u32 sector, u32 count, u32 chunk_sectors)
+{
+	fd_cmd_t *c = &host.cmds[host.cmds_cnt++];
+
+	memset(c, 0, sizeof(fd_cmd_t));
+	c->magic   = FD_MAGIC;
+	c->cmd     = cmd;
+	c->storage = storage;
+	c->flags   = flags;
+	c->sector  = sector;
+	c->count   = count;
+	c->chunk_sectors = chunk_sectors;
+}
+
+static int _setup(u32 chip_id)
+{
+	if (!host.stream)
+		host.stream = (u8 *)malloc(HOST_STREAM_SZ);
+	u8 *stream = host.stream;
+	memset(&host, 0, sizeof(dump_host_t));
+	host.stream = stream;
+	host.queue_limit = chip_id == GP_HIDREV_MAJOR_T210 ? 1 : FD_XUSB_IN_QUEUE;
+	host_chip_id = chip_id;
+
+	if (host_image_open(&emmc_storage, "dump_emmc", EMMC_SECTORS) ||
+		host_image_open(&sd_storage, "dump_sd", SD_SECTORS))
+		return 1;
+	emmc_storage.ext_csd.boot_mult = BOOT_MULT;
+
+	// Pattern unique per sector.
+	emmc_data = host_storage_disk(&emmc_storage)->data;
+	for (u32 i = 0; i < EMMC_SECTORS * SDMMC_DAT_BLOCKSIZE / sizeof(u32); i++)
+		((u32 *)emmc_data)[i] = i * 0x9E3779B1;
+
+	return 0;
+}
+
+static void _teardown()
+{
+	host_image_close(&emmc_storage);
+	host_image_close(&sd_storage);
+
+	host_btn_vol = 0;
+	host_chip_id = GP_HIDREV_MAJOR_T210;
+}
+
+static int _run()
+{
+	usb_ctxt_t usbs = {0};
+
+	usbs.label = NULL;
+	usbs.set_text = _set_text;
+	usbs.system_maintenance = _system_maintenance;
+
+	host_btn_vol = 0;
+
+	return usb_device_gadget_dump(&usbs);
+}
+
+// Checks a READ reply. Returns sectors received or -1 on a malformed reply.
+static int _check_read(u32 idx, u32 *status)
+{
+	const fd_cmd_t *cmd = &host.cmds[idx];
+	u32 pos = host.reply[idx];
+	u32 end = host.reply[idx + 1];
+	u32 chunk = cmd->chunk_sectors ? MIN(cmd->chunk_sectors, FD_CHUNK_SECTORS_MAX) : FD_CHUNK_SECTORS_MAX;
+	u32 sector = cmd->sector;
+	u32 left = cmd->count;
+
+	*status = FD_STS_OK;
+	while (pos < end)
+	{
+		fd_chunk_hdr_t *hdr = (fd_chunk_hdr_t *)(host.stream + pos);
+		pos += sizeof(fd_chunk_hdr_t);
+
+		if (pos > end || hdr->magic != FD_MAGIC || hdr->sector != sector)
+			return -1;
+
+		// Error header ends the reply.
+		if (hdr->status)
+		{
+			*status = hdr->status;
+			return pos == end ? (int)(sector - cmd->sector) : -1;
+		}
+
+		u32 bytes = hdr->count * SDMMC_DAT_BLOCKSIZE;
+		if (hdr->count != MIN(left, chunk) || pos + bytes > end)
+			return -1;
+
+		const u8 *data = host.stream + pos;
+		if (memcmp(data, emmc_data + sector * SDMMC_DAT_BLOCKSIZE, bytes))
+			return -1;
+
+		u8 sha[SE_SHA_256_SIZE] = {0};
+		if (cmd->flags & FD_FLAG_SHA256)
+			se_calc_sha256_oneshot(sha, emmc_data + sector * SDMMC_DAT_BLOCKSIZE, bytes);
+		if (memcmp(sha, hdr->sha256, SE_SHA_256_SIZE))
+			return -1;
+
+		pos += bytes;
+		sector += hdr->count;
+		left -= hdr->count;
+	}
+
+	return left ? -1 : (int)(sector - cmd->sector);
+}
+
+static int _test_sha256()
+{
+	// FIPS-180-2 test vector for the host SE.
+	static const u8 abc_sha256[SE_SHA_256_SIZE] = {
+		0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+		0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+	};
+	u8 sha[SE_SHA_256_SIZE];
+
+	se_calc_sha256_oneshot(sha, "abc", 3);
+	TEST_ASSERT(!memcmp(sha, abc_sha256, SE_SHA_256_SIZE));
+
+	return 0;
+}
+
+static int _test_info()
+{
+	TEST_ASSERT(!_setup(GP_HIDREV_MAJOR_T210B01));
+
+	_host_cmd(FD_CMD_INFO, 0, 0, 0, 0, 0);
+	TEST_ASSERT(!_run());
+
+	TEST_ASSERT(host.reply[1] - host.reply[0] == sizeof(fd_info_t));
+	fd_info_t *info = (fd_info_t *)(host.stream + host.reply[0]);
+	TEST_ASSERT(info->magic == FD_MAGIC && info->version == FD_VERSION && info->status == FD_STS_OK);
+	TEST_ASSERT(info->chunk_sectors_max == FD_CHUNK_SECTORS_MAX);
+	TEST_ASSERT(info->sectors[FD_STORAGE_EMMC_GPP] == EMMC_SECTORS);
+	TEST_ASSERT(info->sectors[FD_STORAGE_EMMC_BOOT0] == (BOOT_MULT << 17) / SDMMC_DAT_BLOCKSIZE);
+	TEST_ASSERT(info->sectors[FD_STORAGE_EMMC_BOOT1] == (BOOT_MULT << 17) / SDMMC_DAT_BLOCKSIZE);
+	TEST_ASSERT(!info->sectors[FD_STORAGE_SD]);
+	TEST_ASSERT(!host.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_read(u32 chip_id)
+{
+	u32 status;
+
+	TEST_ASSERT(!_setup(chip_id));
+
+	// Unaligned range with a partial last chunk.
+	_host_cmd(FD_CMD_READ, FD_STORAGE_EMMC_GPP, FD_FLAG_SHA256, 123, 5000, 0);
+	TEST_ASSERT(!_run());
+
+	TEST_ASSERT(_check_read(0, &status) == 5000 && status == FD_STS_OK);
+	TEST_ASSERT(host.queued_peak <= host.queue_limit);
+	TEST_ASSERT(!host.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_read_xusb()
+{
+	TEST_ASSERT(!_test_read(GP_HIDREV_MAJOR_T210B01));
+
+	// A whole chunk stays queued while the next one is read and queued.
+	TEST_ASSERT(host.queued_peak == 2 * (SZ_1M / USB_EP_BUFFER_MAX_SIZE + 1));
+
+	return 0;
+}
+
+static int _test_read_t210()
+{
+	TEST_ASSERT(!_test_read(GP_HIDREV_MAJOR_T210));
+	TEST_ASSERT(host.queued_peak == 1);
+
+	return 0;
+}
+
+static int _test_read_resume()
+{
+	u32 status;
+
+	TEST_ASSERT(!_setup(GP_HIDREV_MAJOR_T210B01));
+
+	// Host resumes from the last sector it got, with another chunk size.
+	_host_cmd(FD_CMD_READ, FD_STORAGE_EMMC_GPP, 0, 0, 3000, 0);
+	_host_cmd(FD_CMD_READ, FD_STORAGE_EMMC_GPP, FD_FLAG_SHA256, 3000, EMMC_SECTORS - 3000, 777);
+	_host_cmd(FD_CMD_READ, FD_STORAGE_EMMC_BOOT0, 0, 0, (BOOT_MULT << 17) / SDMMC_DAT_BLOCKSIZE, 0);
+	TEST_ASSERT(!_run());
+
+	TEST_ASSERT(_check_read(0, &status) == 3000 && status == FD_STS_OK);
+	TEST_ASSERT(_check_read(1, &status) == EMMC_SECTORS - 3000 && status == FD_STS_OK);
+	TEST_ASSERT(_check_read(2, &status) == (BOOT_MULT << 17) / SDMMC_DAT_BLOCKSIZE && status == FD_STS_OK);
+	TEST_ASSERT(emmc_storage.partition == FD_STORAGE_EMMC_BOOT0);
+	TEST_ASSERT(!host.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_errors()
+{
+	u32 status;
+
+	TEST_ASSERT(!_setup(GP_HIDREV_MAJOR_T210B01));
+
+	// Bad magic, short command, unknown command, bad ranges and missing storage.
+	_host_cmd(FD_CMD_INFO, 0, 0, 0, 0, 0);
+	host.cmds[0].magic = 0;
+	_host_cmd(FD_CMD_INFO, 0, 0, 0, 0, 0);
+	host.cmd_len[1] = 16;
+	_host_cmd(7, 0, 0, 0, 0, 0);
+	_host_cmd(FD_CMD_READ, FD_STORAGE_EMMC_GPP, 0, EMMC_SECTORS - 10, 11, 0);
+	_host_cmd(FD_CMD_READ, FD_STORAGE_EMMC_GPP, 0, 0, 0, 0);
+	_host_cmd(FD_CMD_READ, FD_STORAGE_SD, 0, 0, 1, 0);
+	_host_cmd(FD_CMD_READ, FD_STORAGE_MAX, 0, 0, 1, 0);
+
+	// Still serves requests afterwards.
+	_host_cmd(FD_CMD_READ, FD_STORAGE_EMMC_GPP, 0, EMMC_SECTORS - 10, 10, 0);
+	TEST_ASSERT(!_run());
+
+	static const u32 expected[] = {
+		FD_STS_INVALID_CMD, FD_STS_INVALID_CMD, FD_STS_INVALID_CMD,
+		FD_STS_INVALID_ARG, FD_STS_INVALID_ARG, FD_STS_NO_STORAGE, FD_STS_NO_STORAGE
+	};
+	for (u32 i = 0; i < ARRAY_SIZE(expected); i++)
+	{
+		TEST_ASSERT(host.reply[i + 1] - host.reply[i] == sizeof(fd_chunk_hdr_t));
+		fd_chunk_hdr_t *hdr = (fd_chunk_hdr_t *)(host.stream + host.reply[i]);
+		TEST_ASSERT(hdr->magic == FD_MAGIC && hdr->status == expected[i] && !hdr->count);
+	}
+
+	TEST_ASSERT(_check_read(7, &status) == 10 && status == FD_STS_OK);
+	TEST_ASSERT(!host.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_io_error()
+{
+	u32 status;
+
+	TEST_ASSERT(!_setup(GP_HIDREV_MAJOR_T210B01));
+
+	// Storage reports more sectors than it can read. Second chunk fails.
+	emmc_storage.sec_cnt = EMMC_SECTORS + FD_CHUNK_SECTORS_MAX * 2;
+	u32 start = EMMC_SECTORS - FD_CHUNK_SECTORS_MAX - 100;
+	_host_cmd(FD_CMD_READ, FD_STORAGE_EMMC_GPP, FD_FLAG_SHA256, start, FD_CHUNK_SECTORS_MAX * 3, 0);
+	_host_cmd(FD_CMD_INFO, 0, 0, 0, 0, 0);
+	TEST_ASSERT(!_run());
+
+	// Error header carries the failed chunk's sector.
+	TEST_ASSERT(_check_read(0, &status) == FD_CHUNK_SECTORS_MAX && status == FD_STS_IO_ERROR);
+	TEST_ASSERT(host.reply[2] - host.reply[1] == sizeof(fd_info_t));
+	TEST_ASSERT(!host.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_end()
+{
+	TEST_ASSERT(!_setup(GP_HIDREV_MAJOR_T210B01));
+
+	// Gadget exits on END and does not take further commands.
+	_host_cmd(FD_CMD_INFO, 0, 0, 0, 0, 0);
+	_host_cmd(FD_CMD_END, 0, 0, 0, 0, 0);
+	_host_cmd(FD_CMD_INFO, 0, 0, 0, 0, 0);
+	TEST_ASSERT(!_run());
+
+	TEST_ASSERT(host.cmd == 2);
+	TEST_ASSERT(host.stream_len == sizeof(fd_info_t));
+	TEST_ASSERT(!host_btn_vol);
+	TEST_ASSERT(!host.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "sha256",      _test_sha256 },
+	{ "info",        _test_info },
+	{ "read_xusb",   _test_read_xusb },
+	{ "read_t210",   _test_read_t210 },
+	{ "read_resume", _test_read_resume },
+	{ "errors",      _test_errors },
+	{ "io_error",    _test_io_error },
+	{ "end",         _test_end },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
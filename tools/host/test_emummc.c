@@ -0,0 +1,567 @@
+/*
+ * emuMMC raw clone tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Builds a GPP image with XTS encrypted SYSTEM and USER FAT32 volumes, clones
+ * it to an SD image and reads the clone back through the BIS layer. Free space
+ * of the source holds stale data, so anything the used data mapping skips by
+ * mistake shows up as a mismatch.
+ */
+
+#include <bdk.h>
+
+#include <libs/fatfs/diskio.h>
+#include <libs/fatfs/ff.h>
+#include <storage/mbr_gpt.h>
+
+#include "storage.h"
+#include "test.h"
+
+// Not used by the tested paths. Only in Nyx's libc.
+char *itoa(int value, char *str, int base);
+
+#include "../../nyx/nyx_gui/frontend/fe_emummc_tools.c"
+
+#define GPP_SECTORS  0x60800
+#define SD_PART_OFF  0x8000
+#define SD_SECTORS   (SD_PART_OFF + 0x4000 + GPP_SECTORS)
+#define FS_AU_SIZE   1024 // Keeps FAT32 volumes small.
+
+#define EMU_PART_ACTIVE 2
+#define EMU_SECTOR_OFF  (SD_PART_OFF + 0x2000 * EMU_PART_ACTIVE)
+
+typedef struct _gpp_part_t
+{
+	const char *name;
+	u32 lba_start;
+	u32 sectors;
+} gpp_part_t;
+
+static const gpp_part_t gpp_parts[] = {
+	{ "PRODINFO",             0x800,   0x2000  },
+	{ "BCPKG2-1-Normal-Main", 0x2800,  0x4000  },
+	{ "SYSTEM",               0x8000,  0x28000 },
+	{ "USER",                 0x30000, 0x30000 },
+};
+
+typedef struct _gpp_file_t
+{
+	u32 part; // Index in gpp_parts.
+	const char *path;
+	u32 size;
+	bool stale; // Deleted after all files are written.
+} gpp_file_t;
+
+// Stale files sit between kept ones, so they leave holes in the data area.
+static const gpp_file_t gpp_files[] = {
+	{ 2, "Contents/registered/0.nca", SZ_4M - SZ_16K, false },
+	{ 2, "stale0",                    SZ_4M,          true  },
+	{ 2, "Contents/registered/1.nca", SZ_1M + 777,    false },
+	{ 3, "Album/0.jpg",               SZ_2M + 123,    false },
+	{ 3, "stale1",                    SZ_8M - SZ_1K,  true  },
+	{ 3, "Album/1.jpg",               SZ_4M + SZ_1M,  false },
+};
+
+#define SMALL_FILES     48
+#define SMALL_FILE_SIZE (SZ_8K + 100)
+
+typedef struct _gpp_fs_info_t
+{
+	u32 data_start;
+	u32 data_end;
+	u32 free_clst;
+	u32 stale_lba;
+	u32 stale_cnt;
+} gpp_fs_info_t;
+
+static gpp_fs_info_t gpp_fs[2];
+static u8 *file_buf;
+static emmc_tool_gui_t *gui;
+static u32 clone_maps;
+
+// Nyx GUI.
+void lv_label_ins_text(lv_obj_t *label, uint32_t pos, const char *txt) {}
+void lv_label_set_text(lv_obj_t *label, const char *text) {}
+void lv_bar_set_value(lv_obj_t *bar, int16_t value) {}
+void lv_obj_set_opa_scale(lv_obj_t *obj, lv_opa_t opa_scale) {}
+void manual_system_maintenance(bool refresh) {}
+void hos_bis_keys_clear() {}
+
+static void _fill(u8 *buf, u32 size, u32 seed)
+{
+	for (u32 i = 0; i < size; i++)
+		buf[i] = (u8)(seed + i * 13 + (i >> 9) * 7);
+}
+
+// Same seed on any volume.
+static u32 _seed(const char *path)
+{
+	u32 seed = 0;
+	path = strchr(path, ':') + 1;
+	while (*path)
+		seed = seed * 31 + *path++;
+
+	return seed;
+}
+
+static void _part_get(u32 idx, emmc_part_t *part)
+{
+	memset(part, 0, sizeof(emmc_part_t));
+	part->index     = idx;
+	part->lba_start = gpp_parts[idx].lba_start;
+	part->lba_end   = gpp_parts[idx].lba_start + gpp_parts[idx].sectors - 1;
+	strcpy(part->name, gpp_parts[idx].name);
+}
+
+static void _gpt_write()
+{
+	gpt_t *gpt = (gpt_t *)zalloc(sizeof(gpt_t));
+
+	memcpy(&gpt->header.signature, "EFI PART", 8);
+	gpt->header.revision      = 0x10000;
+	gpt->header.size          = 92;
+	gpt->header.my_lba        = GPT_FIRST_LBA;
+	gpt->header.alt_lba       = GPP_SECTORS - 1;
+	gpt->header.first_use_lba = 0x22;
+	gpt->header.last_use_lba  = GPP_SECTORS - 0x22;
+	gpt->header.part_ent_lba  = 2;
+	gpt->header.num_part_ents = ARRAY_SIZE(gpp_parts);
+	gpt->header.part_ent_size = sizeof(gpt_entry_t);
+
+	for (u32 i = 0; i < ARRAY_SIZE(gpp_parts); i++)
+	{
+		gpt->entries[i].lba_start = gpp_parts[i].lba_start;
+		gpt->entries[i].lba_end   = gpp_parts[i].lba_start + gpp_parts[i].sectors - 1;
+		for (u32 j = 0; gpp_parts[i].name[j]; j++)
+			gpt->entries[i].name[j] = gpp_parts[i].name[j];
+	}
+
+	sdmmc_storage_write(&emmc_storage, GPT_FIRST_LBA, sizeof(gpt_t) >> 9, gpt);
+	free(gpt);
+}
+
+static int _file_write(const char *path, u32 size, FIL *fp)
+{
+	_fill(file_buf, size, _seed(path));
+
+	UINT bw;
+	if (f_open(fp, path, FA_CREATE_ALWAYS | FA_WRITE) || f_write(fp, file_buf, size, &bw) || bw != size)
+		return 1;
+
+	return 0;
+}
+
+static int _fs_build(u32 idx)
+{
+	emmc_part_t part;
+	FATFS *fs = (FATFS *)malloc(sizeof(FATFS));
+	FIL fp;
+	char path[64];
+	int res = 1;
+
+	_part_get(idx, &part);
+	gpp_fs_info_t *info = &gpp_fs[idx - 2];
+
+	// Partitions are written encrypted through the emuMMC drive.
+	u32 sectors = gpp_parts[idx].sectors;
+	disk_set_info(DRIVE_EMU, SET_SECTOR_COUNT, &sectors);
+	nx_emmc_bis_init(&part, true, 0);
+
+	u8 *work = malloc(SZ_4M);
+	int mkfs_error = f_mkfs("emu:", FM_FAT32 | FM_SFD, FS_AU_SIZE, work, SZ_4M);
+	free(work);
+	if (mkfs_error || f_mount(fs, "emu:", 1))
+		goto out;
+
+	f_mkdir("emu:/Contents");
+	f_mkdir("emu:/Contents/registered");
+	f_mkdir("emu:/Album");
+	f_mkdir("emu:/save");
+
+	for (u32 i = 0; i < ARRAY_SIZE(gpp_files); i++)
+	{
+		if (gpp_files[i].part != idx)
+			continue;
+
+		s_printf(path, "emu:/%s", gpp_files[i].path);
+		if (_file_write(path, gpp_files[i].size, &fp))
+			goto out;
+
+		// Fresh volume, so the file is contiguous.
+		if (gpp_files[i].stale)
+		{
+			info->stale_lba = part.lba_start + fs->database + (fp.obj.sclust - 2) * fs->csize;
+			info->stale_cnt = ALIGN(gpp_files[i].size, EMMC_BLOCKSIZE) / EMMC_BLOCKSIZE;
+		}
+		f_close(&fp);
+	}
+
+	// Small files with small gaps between them.
+	for (u32 i = 0; i < SMALL_FILES; i++)
+	{
+		s_printf(path, "emu:/save/%08X", i);
+		if (_file_write(path, SMALL_FILE_SIZE, &fp))
+			goto out;
+		f_close(&fp);
+	}
+	for (u32 i = 1; i < SMALL_FILES; i += 2)
+	{
+		s_printf(path, "emu:/save/%08X", i);
+		f_unlink(path);
+	}
+
+	for (u32 i = 0; i < ARRAY_SIZE(gpp_files); i++)
+	{
+		if (gpp_files[i].part == idx && gpp_files[i].stale)
+		{
+			s_printf(path, "emu:/%s", gpp_files[i].path);
+			f_unlink(path);
+		}
+	}
+
+	DWORD free_clst;
+	FATFS *fs_free;
+	if (f_getfree("emu:", &free_clst, &fs_free) || !info->stale_cnt)
+		goto out;
+
+	info->data_start = part.lba_start + fs->database;
+	info->data_end   = info->data_start + (fs->n_fatent - 2) * fs->csize;
+	info->free_clst  = free_clst;
+
+	res = 0;
+
+out:
+	f_mount(NULL, "emu:", 1);
+	nx_emmc_bis_end();
+	free(fs);
+
+	return res;
+}
+
+static int _setup()
+{
+	if (!file_buf)
+		file_buf = (u8 *)malloc(SZ_8M);
+
+	if (host_image_open(&emmc_storage, "emummc_emmc", GPP_SECTORS) ||
+		host_image_open(&sd_storage, "emummc_sd", SD_SECTORS))
+		return 1;
+
+	// Stale data everywhere. Raw partitions keep it.
+	u32 *data = (u32 *)host_storage_disk(&emmc_storage)->data;
+	for (u32 i = 0; i < GPP_SECTORS * EMMC_BLOCKSIZE / sizeof(u32); i++)
+		data[i] = i * 0x9E3779B1;
+
+	_gpt_write();
+
+	u8 key[SE_KEY_128_SIZE];
+	memset(key, 0x4B, sizeof(key));
+	se_aes_key_set(4, key, sizeof(key));
+	memset(key, 0x54, sizeof(key));
+	se_aes_key_set(5, key, sizeof(key));
+
+	if (_fs_build(2) || _fs_build(3))
+		return 1;
+
+	gui = (emmc_tool_gui_t *)zalloc(sizeof(emmc_tool_gui_t));
+	gui->txt_buf   = (char *)malloc(SZ_16K);
+	gui->base_path = "emuMMC/RAW1";
+
+	// Only count clone writes.
+	host_storage_disk(&sd_storage)->written = 0;
+
+	return 0;
+}
+
+static void _teardown()
+{
+	host_image_close(&emmc_storage);
+	host_image_close(&sd_storage);
+
+	free(gui->txt_buf);
+	free(gui);
+	gui = NULL;
+
+	_emummc_alloc_map_end();
+}
+
+static int _clone()
+{
+	emmc_part_t gpp = {0};
+	gpp.lba_end = GPP_SECTORS - 1;
+	strcpy(gpp.name, "GPP");
+
+	_emummc_alloc_map_init(gui, true);
+	clone_maps = emummc_alloc_cnt;
+	int res = _dump_emummc_raw_part(gui, EMU_PART_ACTIVE, 0, SD_PART_OFF, &gpp, 0);
+	_emummc_alloc_map_end();
+
+	return res;
+}
+
+static u8 *_src_sector(u32 lba)
+{
+	return host_storage_disk(&emmc_storage)->data + (u64)lba * EMMC_BLOCKSIZE;
+}
+
+static u8 *_dst_sector(u32 lba)
+{
+	return host_storage_disk(&sd_storage)->data + (u64)(EMU_SECTOR_OFF + lba) * EMMC_BLOCKSIZE;
+}
+
+static bool _sector_zero(const u8 *buf)
+{
+	for (u32 i = 0; i < EMMC_BLOCKSIZE; i++)
+		if (buf[i])
+			return false;
+
+	return true;
+}
+
+static int _file_verify(const char *path, u32 size)
+{
+	FIL fp;
+	UINT br;
+
+	if (f_open(&fp, path, FA_READ) || f_size(&fp) != size)
+		return 1;
+
+	int res = f_read(&fp, file_buf, size, &br) || br != size;
+	f_close(&fp);
+	if (res)
+		return 1;
+
+	u8 *ref = (u8 *)malloc(size);
+	_fill(ref, size, _seed(path));
+	res = memcmp(ref, file_buf, size) != 0;
+	free(ref);
+
+	return res;
+}
+
+// Mounts the clone through BIS and compares all files with the source ones.
+static int _clone_verify(u32 idx)
+{
+	emmc_part_t part;
+	FATFS *fs = (FATFS *)malloc(sizeof(FATFS));
+	char path[64];
+	int res = 1;
+
+	_part_get(idx, &part);
+	nx_emmc_bis_init(&part, false, EMU_SECTOR_OFF);
+	if (f_mount(fs, "bis:", 1))
+		goto out;
+
+	for (u32 i = 0; i < ARRAY_SIZE(gpp_files); i++)
+	{
+		if (gpp_files[i].part != idx)
+			continue;
+
+		s_printf(path, "bis:/%s", gpp_files[i].path);
+		if (gpp_files[i].stale ? f_stat(path, NULL) != FR_NO_FILE : _file_verify(path, gpp_files[i].size))
+			goto out;
+	}
+
+	for (u32 i = 0; i < SMALL_FILES; i++)
+	{
+		s_printf(path, "bis:/save/%08X", i);
+		if ((i & 1) ? f_stat(path, NULL) != FR_NO_FILE : _file_verify(path, SMALL_FILE_SIZE))
+			goto out;
+	}
+
+	DWORD free_clst;
+	FATFS *fs_free;
+	if (f_getfree("bis:", &free_clst, &fs_free) || free_clst != gpp_fs[idx - 2].free_clst)
+		goto out;
+
+	res = 0;
+
+out:
+	f_mount(NULL, "bis:", 1);
+	nx_emmc_bis_end();
+	free(fs);
+
+	return res;
+}
+
+static int _test_clone_full()
+{
+	TEST_ASSERT(!_setup());
+
+	// Without used data mapping, it's a plain copy.
+	gui->alloc_only = false;
+	TEST_ASSERT(_clone());
+	TEST_ASSERT(!clone_maps);
+	TEST_ASSERT(!memcmp(_src_sector(0), _dst_sector(0), (u64)GPP_SECTORS * EMMC_BLOCKSIZE));
+	TEST_ASSERT(host_storage_disk(&sd_storage)->written == GPP_SECTORS + 1);
+
+	mbr_t mbr;
+	sdmmc_storage_read(&sd_storage, 0, 1, &mbr);
+	TEST_ASSERT(mbr.partitions[0].type == 0xE0);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_clone_used()
+{
+	TEST_ASSERT(!_setup());
+
+	gui->alloc_only = true;
+	TEST_ASSERT(_clone());
+	TEST_ASSERT(clone_maps == 2);
+
+	// Skipped sectors stay zero and must be in free space of SYSTEM or USER.
+	u32 skipped = 0;
+	for (u32 lba = 0; lba < GPP_SECTORS; lba++)
+	{
+		if (!memcmp(_src_sector(lba), _dst_sector(lba), EMMC_BLOCKSIZE))
+			continue;
+
+		TEST_ASSERT(_sector_zero(_dst_sector(lba)));
+
+		bool in_data = false;
+		for (u32 i = 0; i < ARRAY_SIZE(gpp_fs); i++)
+			in_data |= lba >= gpp_fs[i].data_start && lba < gpp_fs[i].data_end;
+		TEST_ASSERT(in_data);
+
+		skipped++;
+	}
+
+	// Stale files are skipped. Only their edges can share a copied block.
+	for (u32 i = 0; i < ARRAY_SIZE(gpp_fs); i++)
+	{
+		u32 start = ALIGN(gpp_fs[i].stale_lba, ALLOC_RAW_ALIGN);
+		u32 end   = ALIGN_DOWN(gpp_fs[i].stale_lba + gpp_fs[i].stale_cnt, ALLOC_RAW_ALIGN);
+		for (u32 lba = start; lba < end; lba++)
+		{
+			TEST_ASSERT(!_sector_zero(_src_sector(lba)));
+			TEST_ASSERT(_sector_zero(_dst_sector(lba)));
+		}
+	}
+
+	TEST_ASSERT(skipped);
+	TEST_ASSERT(host_storage_disk(&sd_storage)->written + skipped == GPP_SECTORS + 1);
+
+	// Clone must decrypt to the same volumes.
+	TEST_ASSERT(!_clone_verify(2));
+	TEST_ASSERT(!_clone_verify(3));
+
+	_teardown();
+
+	return 0;
+}
+
+static u64 _busy_ns(host_disk_t *disk)
+{
+	return (u64)(disk->reads + disk->writes) * disk->sim_cmd_ns + (u64)(disk->read + disk->written) * disk->sim_sector_ns;
+}
+
+// eMMC reads and SD writes overlap, with independent latencies and failing transfers.
+static int _test_clone_sim()
+{
+	TEST_ASSERT(!_setup());
+
+	host_disk_t *emmc = host_storage_disk(&emmc_storage);
+	host_disk_t *sd   = host_storage_disk(&sd_storage);
+
+	// SD writes take 1.5 times as long as eMMC reads.
+	emmc->sim_cmd_ns    = 20000;
+	emmc->sim_sector_ns = 2000;
+	sd->sim_cmd_ns      = 30000;
+	sd->sim_sector_ns   = 3000;
+
+	// Retried through the blocking path.
+	emmc->fail_start = 3;
+	emmc->fail_xfer  = 6;
+	sd->fail_start   = 2;
+	sd->fail_xfer    = 5;
+
+	// Only count the clone.
+	emmc->reads = emmc->writes = emmc->read = emmc->written = 0;
+	sd->reads = sd->writes = sd->read = sd->written = 0;
+	u64 start = host_sim_ns;
+
+	gui->alloc_only = false;
+	TEST_ASSERT(_clone());
+	u64 elapsed = host_sim_ns - start;
+
+	TEST_ASSERT(!memcmp(_src_sector(0), _dst_sector(0), (u64)GPP_SECTORS * EMMC_BLOCKSIZE));
+	TEST_ASSERT(sd->written == GPP_SECTORS + 1);
+	TEST_ASSERT(!sd->xfer_races);
+	TEST_ASSERT(emmc->xfers > 6 && sd->xfers > 5);
+
+	// Bound by the slower device, instead of the sum of both. Ideal is 1.67x here.
+	u64 emmc_busy = _busy_ns(emmc);
+	u64 sd_busy   = _busy_ns(sd);
+	TEST_ASSERT(emmc_busy < sd_busy && elapsed >= sd_busy);
+	TEST_ASSERT(elapsed * 10 < sd_busy * 11);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_alloc_run()
+{
+	// Data area not aligned to the raw copy block.
+	u32 used[2] = { 0xF, 0xF0000000 };
+	emummc_alloc_part_t *map = &emummc_alloc[0];
+	map->data_start = 0x1005;
+	map->data_end   = 0x1005 + 64 * 8;
+	map->csize      = 8;
+	map->used       = used;
+	emummc_alloc_cnt = 1;
+
+	// Clusters 0 to 3 are used and end at 0x1025. Block with their tail is copied.
+	bool is_used;
+	u32 lba = 0x1000;
+	u32 num = _emummc_alloc_run(lba, 0x400, ALLOC_RAW_ALIGN, &is_used);
+	TEST_ASSERT(is_used && num == 0x40);
+
+	// Cluster 60 starts at 0x11E5, in block 0x11E0.
+	lba += num;
+	num = _emummc_alloc_run(lba, 0x400, ALLOC_RAW_ALIGN, &is_used);
+	TEST_ASSERT(!is_used && num == 0x11E0 - lba);
+
+	// Partial block at the end of the data area isn't free.
+	lba += num;
+	num = _emummc_alloc_run(lba, 0x400, ALLOC_RAW_ALIGN, &is_used);
+	TEST_ASSERT(is_used && num == 0x400);
+
+	// Unaligned start is checked up to the next block.
+	num = _emummc_alloc_run(0x1041, 0x100, ALLOC_RAW_ALIGN, &is_used);
+	TEST_ASSERT(!is_used && num == 0x100);
+
+	emummc_alloc_cnt = 0;
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "alloc_run",  _test_alloc_run },
+	{ "clone_full", _test_clone_full },
+	{ "clone_used", _test_clone_used },
+	{ "clone_sim",  _test_clone_sim },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
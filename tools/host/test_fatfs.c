@@ -0,0 +1,529 @@
+/*
+ * FatFs metadata cache tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Runs a scripted workload on the SD volume, which has the metadata cache, and
+ * tracks the expected tree in a model. After each phase the SD image is copied
+ * to the ramdisk, which has no cache, and checked from there. So anything the
+ * cache holds back or writes back stale shows up in the on-disk state.
+ */
+
+#include <bdk.h>
+
+#include <libs/fatfs/diskio.h>
+#include <libs/fatfs/ff.h>
+#include <storage/ramdisk.h>
+
+#include "storage.h"
+#include "test.h"
+
+#define SD_SECTORS  (SZ_512M / SDMMC_DAT_BLOCKSIZE)
+#define FS_AU_SIZE  SZ_4K
+
+#define MODEL_DIRS   12
+#define MODEL_FILES  960
+#define FILE_SZ_MAX  SZ_32K
+#define BIG_FILE_SZ  (300 * SZ_1M)
+#define PATH_SZ      48
+
+typedef struct _model_file_t
+{
+	char path[PATH_SZ];
+	u32  size;
+	u32  seed;
+	bool exists;
+} model_file_t;
+
+typedef struct _model_t
+{
+	model_file_t files[MODEL_FILES];
+	model_file_t big;
+	bool dir_removed[MODEL_DIRS];
+	u32 rand;
+} model_t;
+
+static model_t *model;
+static u8 *file_buf;
+static FATFS *ram_fs;
+
+static u32 _rand()
+{
+	model->rand = model->rand * 1103515245 + 12345;
+
+	return model->rand >> 8;
+}
+
+static void _fill(u8 *buf, u32 offset, u32 size, u32 seed)
+{
+	for (u32 i = offset; i < offset + size; i++)
+		buf[i - offset] = (u8)(seed + i * 7 + (i >> 9) * 3);
+}
+
+static u32 _reads()
+{
+	return host_storage_disk(&sd_storage)->reads;
+}
+
+static void _file_path(char *path, const char *vol, u32 idx)
+{
+	s_printf(path, "%s/d%02d/file_%03d_data.bin", vol, idx % MODEL_DIRS, idx);
+}
+
+static int _file_append(model_file_t *mf, u32 size)
+{
+	FIL fp;
+	UINT bw;
+	char path[PATH_SZ];
+
+	s_printf(path, "sd:%s", mf->path);
+	if (f_open(&fp, path, FA_OPEN_APPEND | FA_WRITE))
+		return 1;
+
+	int res = 0;
+	while (size && !res)
+	{
+		u32 chunk = MIN(size, FILE_SZ_MAX);
+		_fill(file_buf, mf->size, chunk, mf->seed);
+		res = f_write(&fp, file_buf, chunk, &bw) || bw != chunk;
+
+		mf->size += chunk;
+		size -= chunk;
+	}
+	res |= f_close(&fp);
+	mf->exists = true;
+
+	return res;
+}
+
+static int _file_verify(const char *vol, model_file_t *mf)
+{
+	FIL fp;
+	UINT br;
+	char path[PATH_SZ];
+
+	s_printf(path, "%s%s", vol, mf->path);
+	if (!mf->exists)
+	{
+		// Files of removed folders have no path.
+		int res = f_stat(path, NULL);
+		return res != FR_NO_FILE && res != FR_NO_PATH;
+	}
+
+	if (f_open(&fp, path, FA_READ) || f_size(&fp) != mf->size)
+		return 1;
+
+	int res = 0;
+	u8 *ref = file_buf + FILE_SZ_MAX * 2;
+	for (u32 offset = 0; offset < mf->size && !res; offset += FILE_SZ_MAX)
+	{
+		u32 chunk = MIN(mf->size - offset, FILE_SZ_MAX);
+		_fill(ref, offset, chunk, mf->seed);
+		res = f_read(&fp, file_buf, chunk, &br) || br != chunk || memcmp(file_buf, ref, chunk);
+	}
+	f_close(&fp);
+
+	return res;
+}
+
+// Checks the on-disk state through an uncached volume.
+static int _disk_verify()
+{
+	// Both FAT copies must be the same.
+	u8 *sd = host_storage_disk(&sd_storage)->data;
+	u8 *fat1 = sd + (u64)sd_fs.fatbase * SDMMC_DAT_BLOCKSIZE;
+	TEST_ASSERT(sd_fs.n_fats == 2);
+	TEST_ASSERT(!memcmp(fat1, fat1 + (u64)sd_fs.fsize * SDMMC_DAT_BLOCKSIZE, (u64)sd_fs.fsize * SDMMC_DAT_BLOCKSIZE));
+
+	memcpy((void *)RAM_DISK_ADDR, sd, (u64)SD_SECTORS * SDMMC_DAT_BLOCKSIZE);
+	TEST_ASSERT(!f_mount(ram_fs, "ram:", 1));
+
+	for (u32 i = 0; i < MODEL_FILES; i++)
+		TEST_ASSERT(!_file_verify("ram:", &model->files[i]));
+	TEST_ASSERT(!_file_verify("ram:", &model->big));
+
+	for (u32 i = 0; i < MODEL_DIRS; i++)
+	{
+		char path[PATH_SZ];
+		s_printf(path, "ram:/d%02d", i);
+		TEST_ASSERT((f_stat(path, NULL) == FR_NO_FILE) == model->dir_removed[i]);
+	}
+
+	// Free count from FSInfo must match a full FAT scan.
+	DWORD free_sd, free_ram;
+	FATFS *fs;
+	TEST_ASSERT(!f_getfree("sd:", &free_sd, &fs));
+	ram_fs->free_clst = 0xFFFFFFFF;
+	TEST_ASSERT(!f_getfree("ram:", &free_ram, &fs));
+	TEST_ASSERT(free_sd == free_ram);
+
+	f_mount(NULL, "ram:", 1);
+
+	return 0;
+}
+
+static int _setup()
+{
+	if (!model)
+	{
+		model    = (model_t *)malloc(sizeof(model_t));
+		file_buf = (u8 *)malloc(FILE_SZ_MAX * 4);
+		ram_fs   = (FATFS *)malloc(sizeof(FATFS));
+	}
+	memset(model, 0, sizeof(model_t));
+	model->rand = 1;
+
+	for (u32 i = 0; i < MODEL_FILES; i++)
+	{
+		_file_path(model->files[i].path, "", i);
+		model->files[i].seed = i * 0x9E3779B1;
+	}
+	strcpy(model->big.path, "/big.bin");
+	model->big.seed = 0x5A;
+
+	ram_disk_init(NULL, SD_SECTORS * SDMMC_DAT_BLOCKSIZE);
+	if (host_sd_image_setup("fatfs_sd", SD_SECTORS, FS_AU_SIZE))
+		return 1;
+
+	for (u32 i = 0; i < MODEL_DIRS; i++)
+	{
+		char path[PATH_SZ];
+		s_printf(path, "sd:/d%02d", i);
+		if (f_mkdir(path))
+			return 1;
+	}
+
+	return 0;
+}
+
+static void _teardown()
+{
+	host_sd_image_teardown();
+}
+
+// Files of all folders grow in turns, so FAT and directory sectors alternate.
+static int _phase_create()
+{
+	for (u32 pass = 0; pass < 3; pass++)
+		for (u32 i = 0; i < MODEL_FILES; i++)
+			if (_file_append(&model->files[i], _rand() % (FILE_SZ_MAX / 3) + 1))
+				return 1;
+
+	return 0;
+}
+
+static int _phase_delete()
+{
+	char path[PATH_SZ];
+
+	for (u32 i = 0; i < MODEL_FILES; i++)
+	{
+		model_file_t *mf = &model->files[i];
+		if (_rand() % 3)
+			continue;
+
+		s_printf(path, "sd:%s", mf->path);
+		if (f_unlink(path))
+			return 1;
+		mf->exists = false;
+		mf->size = 0;
+	}
+
+	return 0;
+}
+
+// Removes a folder and reuses its clusters for file data.
+static int _phase_rmdir()
+{
+	char path[PATH_SZ];
+	u32 dir = 5;
+
+	for (u32 i = dir; i < MODEL_FILES; i += MODEL_DIRS)
+	{
+		model_file_t *mf = &model->files[i];
+		if (!mf->exists)
+			continue;
+
+		s_printf(path, "sd:%s", mf->path);
+		if (f_unlink(path))
+			return 1;
+		mf->exists = false;
+		mf->size = 0;
+	}
+
+	s_printf(path, "sd:/d%02d", dir);
+	if (f_rmdir(path))
+		return 1;
+	model->dir_removed[dir] = true;
+
+	// Next free cluster search wraps around to the freed ones.
+	sd_fs.last_clst = 2;
+	for (u32 i = 0; i < MODEL_FILES; i++)
+	{
+		model_file_t *mf = &model->files[i];
+		if (i % MODEL_DIRS != dir && !mf->exists && _file_append(mf, FILE_SZ_MAX))
+			return 1;
+	}
+
+	return 0;
+}
+
+static int _phase_truncate()
+{
+	FIL fp;
+	char path[PATH_SZ];
+
+	for (u32 i = 0; i < MODEL_FILES; i++)
+	{
+		model_file_t *mf = &model->files[i];
+		if (!mf->exists || (_rand() % 4))
+			continue;
+
+		s_printf(path, "sd:%s", mf->path);
+		if (f_open(&fp, path, FA_WRITE))
+			return 1;
+		mf->size /= 2;
+		int res = f_lseek(&fp, mf->size) || f_truncate(&fp);
+		if (f_close(&fp) || res)
+			return 1;
+	}
+
+	return 0;
+}
+
+static int _test_coherency()
+{
+	TEST_ASSERT(!_setup());
+
+	TEST_ASSERT(!_phase_create());
+	TEST_ASSERT(!_disk_verify());
+	TEST_ASSERT(!_phase_delete());
+	TEST_ASSERT(!_disk_verify());
+	TEST_ASSERT(!_phase_rmdir());
+	TEST_ASSERT(!_disk_verify());
+	TEST_ASSERT(!_phase_truncate());
+	TEST_ASSERT(!_disk_verify());
+
+	// Remount drops the cache. Same tree through it.
+	sd_unmount();
+	TEST_ASSERT(sd_mount());
+	for (u32 i = 0; i < MODEL_FILES; i++)
+		TEST_ASSERT(!_file_verify("sd:", &model->files[i]));
+	TEST_ASSERT(!_disk_verify());
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_hits()
+{
+	FILINFO fno;
+	char path[PATH_SZ];
+
+	TEST_ASSERT(!_setup());
+	TEST_ASSERT(!_phase_create());
+
+	sd_unmount();
+	TEST_ASSERT(sd_mount());
+
+	// Path walks of cached folders need no reads.
+	u32 reads = _reads();
+	for (u32 i = 0; i < 4; i++)
+	{
+		_file_path(path, "sd:", MODEL_FILES - 1 - i);
+		TEST_ASSERT(!f_stat(path, &fno));
+	}
+	u32 cold = _reads() - reads;
+
+	reads = _reads();
+	for (u32 i = 0; i < 4; i++)
+	{
+		_file_path(path, "sd:", MODEL_FILES - 1 - i);
+		TEST_ASSERT(!f_stat(path, &fno));
+	}
+	TEST_ASSERT(cold && _reads() == reads);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_readahead()
+{
+	DIR dir;
+	FILINFO fno;
+
+	TEST_ASSERT(!_setup());
+	TEST_ASSERT(!_phase_create());
+
+	sd_unmount();
+	TEST_ASSERT(sd_mount());
+
+	// Files with LFNs take 3 entries each. One read per cache line instead of per sector.
+	u32 reads = _reads();
+	u32 entries = 0;
+	TEST_ASSERT(!f_opendir(&dir, "sd:/d00"));
+	while (!f_readdir(&dir, &fno) && fno.fname[0])
+		entries++;
+	f_closedir(&dir);
+
+	u32 dir_sectors = ALIGN((MODEL_FILES / MODEL_DIRS) * 3 * 32, SDMMC_DAT_BLOCKSIZE) / SDMMC_DAT_BLOCKSIZE;
+	TEST_ASSERT(entries == MODEL_FILES / MODEL_DIRS);
+	TEST_ASSERT(_reads() - reads < dir_sectors / 2);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_evict()
+{
+	TEST_ASSERT(!_setup());
+	TEST_ASSERT(!_phase_create());
+
+	// The FAT chain of the file spans more lines than the cache has. Dirty ones get evicted before sync.
+	TEST_ASSERT(!_file_append(&model->big, BIG_FILE_SZ));
+	TEST_ASSERT(!_disk_verify());
+
+	_teardown();
+
+	return 0;
+}
+
+#define IDX_NAMES 1200
+#define IDX_DIR_A "/d00"
+#define IDX_DIR_B "/d01"
+
+typedef struct _idx_name_t
+{
+	char name[32];
+	const char *dir;
+	bool exists;
+} idx_name_t;
+
+static int _idx_stat(const char *vol, idx_name_t *n)
+{
+	char path[64];
+
+	s_printf(path, "%s%s/%s", vol, n->dir, n->name);
+	int res = f_stat(path, NULL);
+
+	return n->exists ? res != FR_OK : res != FR_NO_FILE;
+}
+
+// Lookups on the indexed SD folder must match the model and the unindexed ramdisk copy.
+static int _idx_check(idx_name_t *names, u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+		TEST_ASSERT(!_idx_stat("sd:", &names[i]));
+
+	memcpy((void *)RAM_DISK_ADDR, host_storage_disk(&sd_storage)->data, (u64)SD_SECTORS * SDMMC_DAT_BLOCKSIZE);
+	TEST_ASSERT(!f_mount(ram_fs, "ram:", 1));
+	for (u32 i = 0; i < count; i++)
+		TEST_ASSERT(!_idx_stat("ram:", &names[i]));
+	f_mount(NULL, "ram:", 1);
+
+	return 0;
+}
+
+static int _test_dirindex()
+{
+	FIL fp;
+	char path[64], path_new[64];
+
+	TEST_ASSERT(!_setup());
+
+	// Old names, then names that renames and lookups use.
+	idx_name_t *names = calloc(IDX_NAMES * 2, sizeof(idx_name_t));
+	for (u32 i = 0; i < IDX_NAMES; i++)
+	{
+		// Upper case 8.3 names have no LFN entries.
+		if (i % 4)
+			s_printf(names[i].name, "Entry file %d.dat", i);
+		else
+			s_printf(names[i].name, "F%04d.BIN", i);
+		names[i].dir = IDX_DIR_A;
+
+		s_printf(names[IDX_NAMES + i].name, (i % 3) ? "renamed_%d.bin" : "R%04d.TXT", i);
+		names[IDX_NAMES + i].dir = (i % 5) ? IDX_DIR_A : IDX_DIR_B;
+	}
+
+	for (u32 i = 0; i < IDX_NAMES; i++)
+	{
+		s_printf(path, "sd:%s/%s", names[i].dir, names[i].name);
+		TEST_ASSERT(!f_open(&fp, path, FA_CREATE_NEW | FA_WRITE));
+		TEST_ASSERT(!f_close(&fp));
+		names[i].exists = true;
+	}
+	TEST_ASSERT(!_idx_check(names, IDX_NAMES * 2));
+
+	// Renames in the same folder and to another one.
+	for (u32 i = 0; i < IDX_NAMES; i += 3)
+	{
+		idx_name_t *n_new = &names[IDX_NAMES + i];
+		s_printf(path, "sd:%s/%s", names[i].dir, names[i].name);
+		s_printf(path_new, "sd:%s/%s", n_new->dir, n_new->name);
+		TEST_ASSERT(!f_rename(path, path_new));
+		names[i].exists = false;
+		n_new->exists = true;
+	}
+	TEST_ASSERT(!_idx_check(names, IDX_NAMES * 2));
+
+	// Unlinks, then some of the names come back.
+	for (u32 i = 1; i < IDX_NAMES; i += 3)
+	{
+		s_printf(path, "sd:%s/%s", names[i].dir, names[i].name);
+		TEST_ASSERT(!f_unlink(path));
+		names[i].exists = false;
+	}
+	for (u32 i = 1; i < IDX_NAMES; i += 6)
+	{
+		s_printf(path, "sd:%s/%s", names[i].dir, names[i].name);
+		TEST_ASSERT(!f_open(&fp, path, FA_CREATE_NEW | FA_WRITE));
+		TEST_ASSERT(!f_close(&fp));
+		names[i].exists = true;
+	}
+	TEST_ASSERT(!_idx_check(names, IDX_NAMES * 2));
+
+	// Names match without case.
+	for (u32 i = 2; i < IDX_NAMES; i += 3)
+	{
+		s_printf(path, "sd:%s/%s", names[i].dir, names[i].name);
+		for (char *c = path; *c; c++)
+			*c = (*c >= 'a' && *c <= 'z') ? *c - 'a' + 'A' : ((*c >= 'A' && *c <= 'Z') ? *c - 'A' + 'a' : *c);
+		TEST_ASSERT(f_stat(path, NULL) == (names[i].exists ? FR_OK : FR_NO_FILE));
+	}
+
+	free(names);
+	_teardown();
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "coherency", _test_coherency },
+	{ "hits",      _test_hits },
+	{ "readahead", _test_readahead },
+	{ "evict",     _test_evict },
+	{ "dirindex",  _test_dirindex },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
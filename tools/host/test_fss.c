@@ -0,0 +1,371 @@
+/*
+ * FSS0 loader tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Writes a synthetic package3 to a FAT32 SD image and loads it with the
+ * bootloader's FSS0 parser. Checks that selected contents end up in the
+ * launch context and counts the disk commands and sectors it takes.
+ */
+
+#include <bdk.h>
+
+#include <libs/fatfs/ff.h>
+
+#include "storage.h"
+#include "test.h"
+
+#include "../../bootloader/hos/fss.c"
+
+#define SD_SECTORS  (SZ_128M / SDMMC_DAT_BLOCKSIZE)
+#define FS_AU_SIZE  SZ_1K // Keeps FAT32 volume small.
+
+#define PKG3_PATH     "sd:/package3"
+#define PKG3_META_OFF 0x10
+#define PKG3_CNT_OFF  0x100
+#define PKG3_CNT_BASE SZ_4K
+
+#define CNT_EXP CNT_FLAG0_EXPERIMENTAL
+
+hekate_config h_cfg;
+emummc_cfg_t emu_cfg;
+
+bool is_ipl_updated(void *buf, char *path, bool force)
+{
+	return true;
+}
+
+void *hos_prefetch_get_fss0(const char *path, u32 *size)
+{
+	return NULL;
+}
+
+void *sd_file_read(const char *path, u32 *fsize)
+{
+	return NULL;
+}
+
+typedef struct _pkg3_cnt_t
+{
+	u8 type;
+	u8 flags0;
+	u32 size;
+} pkg3_cnt_t;
+
+// Same order as Atmosphère packs them. Unselected ones leave gaps.
+static const pkg3_cnt_t pkg3_cnts[] = {
+	{ CNT_TYPE_EXO, 0,       SZ_64K + 0x1230 },
+	{ CNT_TYPE_WBT, 0,       SZ_8K   },
+	{ CNT_TYPE_EXF, 0,       SZ_16K + 0x40 },
+	{ CNT_TYPE_KRN, 0,       SZ_512K + 0x800 },
+	{ CNT_TYPE_KIP, 0,       SZ_128K },
+	{ CNT_TYPE_KIP, 0,       SZ_64K + 0x10 },
+	{ CNT_TYPE_KIP, 0,       SZ_256K + 0x300 },
+	{ CNT_TYPE_KIP, CNT_EXP, SZ_256K },
+	{ CNT_TYPE_BMP, 0,       SZ_1M   },
+	{ CNT_TYPE_KIP, 0,       SZ_64K  },
+	{ CNT_TYPE_EMC, 0,       SZ_16K  },
+	{ CNT_TYPE_KIP, 0,       SZ_32K + 0x20 },
+};
+
+static u8 *pkg3;
+static u32 pkg3_size;
+static u32 pkg3_secs;
+static u32 cnt_offsets[ARRAY_SIZE(pkg3_cnts)];
+static launch_ctxt_t ctxt;
+static ini_sec_t cfg;
+static ini_kv_t cfg_kvs[2];
+static pkg1_id_t pkg1_id;
+
+static int _setup()
+{
+	if (host_sd_image_setup("fss_sd", SD_SECTORS, FS_AU_SIZE))
+		return 1;
+
+	// Header, meta and content table, then contents back to back.
+	pkg3_size = PKG3_CNT_BASE;
+	for (u32 i = 0; i < ARRAY_SIZE(pkg3_cnts); i++)
+	{
+		cnt_offsets[i] = pkg3_size;
+		pkg3_size = ALIGN(pkg3_size + pkg3_cnts[i].size, 0x10);
+	}
+
+	pkg3_secs = ALIGN(pkg3_size, SDMMC_DAT_BLOCKSIZE) / SDMMC_DAT_BLOCKSIZE;
+	pkg3 = malloc(pkg3_size);
+	for (u32 i = 0; i < pkg3_size; i += 4)
+		*(u32 *)(pkg3 + i) = i * 0x9E3779B1;
+
+	*(u32 *)(pkg3 + FSS0_META_OFFSET) = PKG3_META_OFF;
+	fss_meta_t *meta = (fss_meta_t *)(pkg3 + PKG3_META_OFF);
+	memset(meta, 0, sizeof(fss_meta_t));
+	meta->magic     = FSS0_MAGIC;
+	meta->size      = pkg3_size;
+	meta->cnt_off   = PKG3_CNT_OFF;
+	meta->cnt_count = ARRAY_SIZE(pkg3_cnts);
+	meta->version   = FSS0_VERSION_0_17_0;
+
+	fss_content_t *cnt = (fss_content_t *)(pkg3 + PKG3_CNT_OFF);
+	memset(cnt, 0, sizeof(fss_content_t) * ARRAY_SIZE(pkg3_cnts));
+	for (u32 i = 0; i < ARRAY_SIZE(pkg3_cnts); i++)
+	{
+		cnt[i].offset = cnt_offsets[i];
+		cnt[i].size   = pkg3_cnts[i].size;
+		cnt[i].type   = pkg3_cnts[i].type;
+		cnt[i].flags0 = pkg3_cnts[i].flags0;
+		s_printf(cnt[i].name, "cnt%d", i);
+	}
+
+	FIL fp;
+	UINT bw;
+	if (f_open(&fp, PKG3_PATH, FA_CREATE_ALWAYS | FA_WRITE))
+		return 1;
+	int res = f_write(&fp, pkg3, pkg3_size, &bw) || bw != pkg3_size;
+	res |= f_close(&fp);
+
+	return res;
+}
+
+static void _teardown()
+{
+	free(pkg3);
+	host_sd_image_teardown();
+}
+
+static void _ctxt_init(bool stock, bool experimental)
+{
+	memset(&ctxt, 0, sizeof(ctxt));
+	memset(&cfg, 0, sizeof(cfg));
+
+	list_init(&cfg.kvs);
+	cfg_kvs[0].key = "stock";
+	cfg_kvs[0].val = stock ? "1" : "0";
+	cfg_kvs[1].key = "fss0experimental";
+	cfg_kvs[1].val = experimental ? "1" : "0";
+	list_append(&cfg.kvs, &cfg_kvs[0].link);
+	list_append(&cfg.kvs, &cfg_kvs[1].link);
+
+	// Stock on 7.0.0 and up still needs Exosphere.
+	pkg1_id.kb = HOS_KB_VERSION_1210;
+
+	ctxt.cfg = &cfg;
+	ctxt.pkg1_id = &pkg1_id;
+	list_init(&ctxt.kip1_list);
+}
+
+static bool _cnt_selected(u32 idx, bool stock, bool experimental)
+{
+	const pkg3_cnt_t *cnt = &pkg3_cnts[idx];
+
+	if ((cnt->flags0 & CNT_EXP) && !experimental)
+		return false;
+
+	switch (cnt->type)
+	{
+	case CNT_TYPE_KIP:
+	case CNT_TYPE_KRN:
+		return !stock;
+	case CNT_TYPE_EXO:
+	case CNT_TYPE_EXF:
+	case CNT_TYPE_WBT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static int _cnt_check(void *ptr, u32 size, u32 idx)
+{
+	u8 *fss = ctxt.fss0;
+
+	return ptr != fss + cnt_offsets[idx] || size != pkg3_cnts[idx].size || memcmp(ptr, pkg3 + cnt_offsets[idx], size);
+}
+
+// Loads the package and checks the launch context against the table.
+static int _fss_load(bool stock, bool experimental, u32 *reads, u32 *read_secs)
+{
+	host_disk_t *disk = host_storage_disk(&sd_storage);
+
+	_ctxt_init(stock, experimental);
+
+	u32 reads_start = disk->reads;
+	u32 read_start  = disk->read;
+	TEST_ASSERT(parse_fss(&ctxt, PKG3_PATH) == 1);
+	*reads = disk->reads - reads_start;
+	*read_secs = disk->read - read_start;
+
+	TEST_ASSERT(ctxt.atmosphere && ctxt.fss0);
+
+	u32 kips = 0;
+	for (u32 i = 0; i < ARRAY_SIZE(pkg3_cnts); i++)
+	{
+		if (!_cnt_selected(i, stock, experimental))
+			continue;
+
+		switch (pkg3_cnts[i].type)
+		{
+		case CNT_TYPE_EXO:
+			TEST_ASSERT(!_cnt_check(ctxt.secmon, ctxt.secmon_size, i));
+			break;
+		case CNT_TYPE_EXF:
+			TEST_ASSERT(!_cnt_check(ctxt.exofatal, ctxt.exofatal_size, i));
+			break;
+		case CNT_TYPE_WBT:
+			TEST_ASSERT(!_cnt_check(ctxt.warmboot, ctxt.warmboot_size, i));
+			break;
+		case CNT_TYPE_KRN:
+			TEST_ASSERT(!_cnt_check(ctxt.kernel, ctxt.kernel_size, i));
+			break;
+		case CNT_TYPE_KIP:
+			kips++;
+			break;
+		}
+	}
+
+	// KIPs are listed in package order.
+	u32 kip_idx = 0;
+	LIST_FOREACH_ENTRY(merge_kip_t, mkip, &ctxt.kip1_list, link)
+	{
+		while (pkg3_cnts[kip_idx].type != CNT_TYPE_KIP || !_cnt_selected(kip_idx, stock, experimental))
+			kip_idx++;
+		TEST_ASSERT(!_cnt_check(mkip->kip1, pkg3_cnts[kip_idx].size, kip_idx));
+		kip_idx++;
+		kips--;
+	}
+	TEST_ASSERT(!kips);
+
+	if (!stock)
+		TEST_ASSERT(ctxt.kernel);
+
+	return 0;
+}
+
+// Sectors of the selected contents, as a loader reading each one alone would need.
+static u32 _cnt_sectors(bool stock, bool experimental)
+{
+	u32 sectors = 0;
+
+	for (u32 i = 0; i < ARRAY_SIZE(pkg3_cnts); i++)
+	{
+		if (!_cnt_selected(i, stock, experimental))
+			continue;
+
+		u32 start = cnt_offsets[i] / SDMMC_DAT_BLOCKSIZE;
+		u32 end = ALIGN(cnt_offsets[i] + pkg3_cnts[i].size, SDMMC_DAT_BLOCKSIZE) / SDMMC_DAT_BLOCKSIZE;
+		sectors += end - start;
+	}
+
+	return sectors;
+}
+
+static int _test_runs()
+{
+	u32 reads, read_secs;
+
+	TEST_ASSERT(!_setup());
+
+	// The experimental KIP and the bitmap split contents in 2 runs. Small EMC gap is read through.
+	TEST_ASSERT(!_fss_load(false, false, &reads, &read_secs));
+
+	// Each run takes up to 3 commands for its unaligned head, body and tail.
+	// Rest is the header, the folder lookup and the FAT chain.
+	TEST_ASSERT(reads <= 2 * 3 + 4);
+
+	// The skipped gaps are not read.
+	u32 gap_secs = (pkg3_cnts[7].size + pkg3_cnts[8].size) / SDMMC_DAT_BLOCKSIZE;
+	TEST_ASSERT(read_secs < pkg3_secs - gap_secs + 16);
+	TEST_ASSERT(read_secs >= _cnt_sectors(false, false));
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_experimental()
+{
+	u32 reads, read_secs;
+
+	TEST_ASSERT(!_setup());
+
+	// Experimental KIP joins the first run.
+	TEST_ASSERT(!_fss_load(false, true, &reads, &read_secs));
+	TEST_ASSERT(reads <= 2 * 3 + 4);
+	TEST_ASSERT(read_secs < pkg3_secs - pkg3_cnts[8].size / SDMMC_DAT_BLOCKSIZE + 16);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_stock()
+{
+	u32 reads, read_secs;
+
+	TEST_ASSERT(!_setup());
+
+	// Only Exosphere, warmboot and fatal. One run and no kernel or KIPs.
+	TEST_ASSERT(!_fss_load(true, false, &reads, &read_secs));
+	TEST_ASSERT(reads <= 1 * 3 + 4);
+	TEST_ASSERT(!ctxt.kernel && list_empty(&ctxt.kip1_list));
+	TEST_ASSERT(read_secs < _cnt_sectors(true, false) + 16);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_bounds()
+{
+	TEST_ASSERT(!_setup());
+
+	// A content past the package end is dropped and does not stretch a run.
+	FIL fp;
+	UINT bw;
+	fss_content_t *cnt = (fss_content_t *)(pkg3 + PKG3_CNT_OFF);
+	cnt[5].size = pkg3_size;
+	TEST_ASSERT(!f_open(&fp, PKG3_PATH, FA_WRITE));
+	TEST_ASSERT(!f_lseek(&fp, PKG3_CNT_OFF + 5 * sizeof(fss_content_t)));
+	TEST_ASSERT(!f_write(&fp, &cnt[5], sizeof(fss_content_t), &bw));
+	TEST_ASSERT(!f_close(&fp));
+
+	_ctxt_init(false, false);
+	TEST_ASSERT(parse_fss(&ctxt, PKG3_PATH) == 1);
+
+	u32 kips = 0;
+	LIST_FOREACH_ENTRY(merge_kip_t, mkip, &ctxt.kip1_list, link)
+	{
+		TEST_ASSERT(mkip->kip1 != ctxt.fss0 + cnt_offsets[5]);
+		kips++;
+	}
+	TEST_ASSERT(kips == 4);
+	TEST_ASSERT(!_cnt_check(ctxt.kernel, ctxt.kernel_size, 3));
+
+	_teardown();
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "runs",         _test_runs },
+	{ "experimental", _test_experimental },
+	{ "stock",        _test_stock },
+	{ "bounds",       _test_bounds },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
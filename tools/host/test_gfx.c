@@ -0,0 +1,263 @@
+/*
+ * Hekate TUI console tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Draws into a memory framebuffer. Glyphs are compared against the bit by bit
+ * renderer and menu frames after partial redraws against full redraws.
+ */
+
+// Before BDK headers, so hekate's console is used instead of the host's.
+// Its own abs() is renamed, away from libc's.
+#define abs _gfx_abs
+#include "../../bootloader/gfx/gfx.c"
+#undef abs
+#include "../../bootloader/gfx/tui.c"
+
+#include "test.h"
+
+#define FB_WIDTH  720
+#define FB_HEIGHT 1280
+#define FB_SZ     (FB_WIDTH * FB_HEIGHT * sizeof(u32))
+
+#define MENU_MOVES 24
+
+hekate_config h_cfg;
+
+static u32 *fb;
+static u32 *fb_ref;
+
+// Hekate hardware.
+int max17050_get_property(enum MAX17050_reg reg, int *value)
+{
+	*value = reg == MAX17050_RepSOC ? 0x4E00 : 4012;
+
+	return 0;
+}
+
+void display_backlight_brightness(u32 brightness, u32 step_delay) {}
+bool hos_prefetch_step() { return false; }
+
+// Bit by bit renderer, from before the expanded masks.
+static void _putc_ref(u32 *out, char c)
+{
+	u32 scale = gfx_con.fntsz == 16 ? 2 : 1;
+
+	if (c == '\n')
+	{
+		gfx_con.x = 0;
+		gfx_con.y += gfx_con.fntsz;
+		if (gfx_con.y > gfx_ctxt.height - gfx_con.fntsz)
+			gfx_con.y = 0;
+		return;
+	}
+	if (c < 32 || c > 126)
+		return;
+
+	const u8 *cbuf = &_gfx_font[8 * (c - 32)];
+	for (u32 i = 0; i < 8 * scale; i++)
+	{
+		u8 v = cbuf[i / scale];
+		u32 *line = out + gfx_con.x + (gfx_con.y + i) * gfx_ctxt.stride;
+		for (u32 j = 0; j < 8 * scale; j++)
+		{
+			if (v & BIT(j / scale))
+				line[j] = gfx_con.fgcol;
+			else if (gfx_con.fillbg)
+				line[j] = gfx_con.bgcol;
+		}
+	}
+	gfx_con.x += gfx_con.fntsz;
+}
+
+// Noise below, so transparent pixels must be left alone.
+static void _fb_reset()
+{
+	for (u32 i = 0; i < FB_WIDTH * FB_HEIGHT; i++)
+		fb[i] = i * 0x9E3779B1;
+	memcpy(fb_ref, fb, FB_SZ);
+}
+
+static void _setup()
+{
+	if (!fb)
+	{
+		fb     = (u32 *)malloc(FB_SZ);
+		fb_ref = (u32 *)malloc(FB_SZ);
+	}
+
+	gfx_init_ctxt(fb, FB_WIDTH, FB_HEIGHT, FB_WIDTH);
+	gfx_con_init();
+}
+
+static int _test_glyphs()
+{
+	static const char *lines[] = {
+		" !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~",
+		"hekate v6 - Launch\tCFW (emuMMC)\x7F\x01",
+	};
+
+	_setup();
+
+	for (u32 fntsz = 8; fntsz <= 16; fntsz += 8)
+	{
+		for (u32 fill = 0; fill < 2; fill++)
+		{
+			_fb_reset();
+
+			for (u32 pass = 0; pass < 2; pass++)
+			{
+				gfx_con.fntsz = fntsz;
+				gfx_con_setpos(0, 0);
+				for (u32 row = 0; row < FB_HEIGHT / fntsz + 2; row++)
+				{
+					// Colors with all bits differing or equal in places.
+					gfx_con_setcol(0xFF000000 | row * 0x10101, fill, ~(row * 0x30507));
+					gfx_con.x = (row % 3) * 4;
+
+					const char *s = lines[row & 1];
+					for (u32 i = 0; s[i] && gfx_con.x + fntsz <= FB_WIDTH; i++)
+					{
+						if (pass)
+							_putc_ref(fb_ref, s[i]);
+						else
+							gfx_putc(s[i]);
+					}
+					if (pass)
+						_putc_ref(fb_ref, '\n');
+					else
+						gfx_putc('\n');
+				}
+			}
+
+			TEST_ASSERT(!memcmp(fb, fb_ref, FB_SZ));
+		}
+	}
+
+	return 0;
+}
+
+// Entries run their handler and stay, until the script ends.
+#define MDEF_STAY(caption) { MENT_HDLR_RE, caption, 0, (void *)1, { .handler = _handler } }
+
+static bool menu_quit;
+
+static void _handler(void *data)
+{
+	ment_t *ent = (ment_t *)data;
+
+	if (menu_quit)
+		ent->data = NULL;
+}
+
+static ment_t menu_ents[] = {
+	MDEF_CAPTION("---- Launch ----", TXT_CLR_CYAN_L),
+	MDEF_STAY("Launch"),
+	MDEF_STAY("More configs"),
+	MDEF_STAY("Launch a config with a caption too long to fit in one line"),
+	MDEF_CHGLINE(),
+	MDEF_CAPTION("---- Tools -----", TXT_CLR_CYAN_L),
+	MDEF_STAY("Payloads"),
+	MDEF_STAY("Reboot (Normal)"),
+	MDEF_STAY("Reboot (RCM)"),
+	MDEF_STAY("Power off"),
+	MDEF_END()
+};
+
+static menu_t menu = { menu_ents, "hekate", 0, 0 };
+
+// Button presses fed to the menu. Frames get saved when it waits.
+static const u8 *btn_script;
+static u32 btn_cnt;
+static u32 btn_pos;
+static u32 *frames;
+static u32 frames_cnt;
+
+u8 btn_wait_idle(bool (*idle)())
+{
+	memcpy(frames + frames_cnt++ * FB_WIDTH * FB_HEIGHT, fb, FB_SZ);
+
+	if (btn_pos < btn_cnt)
+		return btn_script[btn_pos++];
+
+	menu_quit = true;
+
+	return BTN_POWER;
+}
+
+static void _menu_run(const u8 *script, u32 cnt)
+{
+	for (u32 i = 0; menu_ents[i].type != MENT_END; i++)
+		if (menu_ents[i].type == MENT_HDLR_RE)
+			menu_ents[i].data = (void *)1;
+
+	_fb_reset();
+	gfx_con.fntsz = 16;
+	btn_script = script;
+	btn_cnt    = cnt;
+	btn_pos    = 0;
+	frames_cnt = 0;
+	menu_quit  = false;
+
+	tui_do_menu(&menu);
+}
+
+static int _test_menu()
+{
+	u8 moves[MENU_MOVES];
+	u8 moves_full[MENU_MOVES * 2];
+
+	_setup();
+	frames = (u32 *)malloc(FB_SZ * (MENU_MOVES * 2 + 1));
+	u32 *full = (u32 *)malloc(FB_SZ * (MENU_MOVES + 1));
+
+	// Wraps around both ways and over captions.
+	for (u32 i = 0; i < MENU_MOVES; i++)
+	{
+		moves[i] = (i % 7) < 4 ? BTN_VOL_DOWN : BTN_VOL_UP;
+		moves_full[i * 2]     = moves[i];
+		moves_full[i * 2 + 1] = BTN_POWER; // Handler returns, so all gets drawn again.
+	}
+
+	_menu_run(moves_full, MENU_MOVES * 2);
+	TEST_ASSERT(frames_cnt == MENU_MOVES * 2 + 1);
+	for (u32 i = 0; i <= MENU_MOVES; i++)
+		memcpy(full + i * FB_WIDTH * FB_HEIGHT, frames + i * 2 * FB_WIDTH * FB_HEIGHT, FB_SZ);
+
+	_menu_run(moves, MENU_MOVES);
+	TEST_ASSERT(frames_cnt == MENU_MOVES + 1);
+	for (u32 i = 0; i <= MENU_MOVES; i++)
+		TEST_ASSERT(!memcmp(full + i * FB_WIDTH * FB_HEIGHT, frames + i * FB_WIDTH * FB_HEIGHT, FB_SZ));
+
+	// Selection moved, so frames differ.
+	TEST_ASSERT(memcmp(frames, frames + FB_WIDTH * FB_HEIGHT, FB_SZ));
+
+	free(full);
+	free(frames);
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "glyphs", _test_glyphs },
+	{ "menu",   _test_menu },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
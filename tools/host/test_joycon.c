@@ -0,0 +1,264 @@
+/*
+ * Joy-Con UART framing tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Captures are replayed through the receive ring in odd sized chunks. After
+ * every chunk, exactly the packets received whole must have been parsed, and
+ * the gamepad must hold the last one of them.
+ */
+
+#include "jc_uart.c"
+
+#include "test.h"
+
+#define STREAM_SZ   SZ_256K
+#define STREAM_RPTS 400
+
+typedef struct _rpt_expect_t
+{
+	u32 end; // Stream offset where the packet is whole.
+	u32 buttons;
+	u16 stick_x;
+	u16 stick_y;
+} rpt_expect_t;
+
+static u8 *stream;
+static u32 stream_sz;
+static rpt_expect_t expects[STREAM_RPTS * 2];
+static u32 expects_cnt;
+static u32 rand_state;
+
+static u32 _rand()
+{
+	rand_state = rand_state * 1103515245 + 12345;
+
+	return rand_state >> 8;
+}
+
+static void _stream_reset(u32 seed)
+{
+	if (!stream)
+		stream = malloc(STREAM_SZ);
+
+	stream_sz   = 0;
+	expects_cnt = 0;
+	rand_state  = seed;
+
+	host_jc_reset();
+}
+
+// Appends a report. It's expected to parse, unless it gets corrupted later.
+static rpt_expect_t *_stream_rpt(u32 seq)
+{
+	rpt_expect_t *exp = &expects[expects_cnt++];
+
+	exp->buttons = (seq * 0x10305) ^ (seq << 20);
+	exp->stick_x = (seq * 37 + 5) & 0xFFF;
+	exp->stick_y = (seq * 91 + 7) & 0xFFF;
+
+	stream_sz += host_jc_input_rpt(stream + stream_sz, seq, exp->buttons, exp->stick_x, exp->stick_y);
+	exp->end = stream_sz;
+
+	return exp;
+}
+
+// Random bytes that never start a header.
+static void _stream_garbage(u32 len)
+{
+	for (u32 i = 0; i < len; i++)
+	{
+		u8 val = _rand();
+		stream[stream_sz++] = val == 0x19 ? 0x18 : val;
+	}
+}
+
+static void _stream_raw(const void *data, u32 len)
+{
+	memcpy(stream + stream_sz, data, len);
+	stream_sz += len;
+}
+
+static int _gamepad_check(const rpt_expect_t *exp)
+{
+	TEST_ASSERT(jc_gamepad.buttons == (exp->buttons & JC_BTN_MASK_R));
+	TEST_ASSERT(jc_gamepad.rstick_x == exp->stick_x);
+	TEST_ASSERT(jc_gamepad.rstick_y == exp->stick_y);
+	TEST_ASSERT(jc_gamepad.batt_info_r == JC_BATT_MID);
+
+	return 0;
+}
+
+// Replays the stream and checks it after every chunk. First packets are not reports.
+static int _stream_replay(u32 pkts_before, u32 chunk_max)
+{
+	u32 done = 0;
+	u32 pos = 0;
+
+	while (pos < stream_sz)
+	{
+		u32 chunk = MIN(1 + _rand() % chunk_max, stream_sz - pos);
+		TEST_ASSERT(!host_jc_feed(stream + pos, chunk));
+		pos += chunk;
+
+		while (done < expects_cnt && expects[done].end <= pos)
+			done++;
+
+		TEST_ASSERT(host_jc_poll() == pkts_before + done);
+		if (done)
+			TEST_ASSERT(!_gamepad_check(&expects[done - 1]));
+	}
+
+	TEST_ASSERT(done == expects_cnt && !jc_r.rx_ring.dropped);
+
+	return 0;
+}
+
+static int _test_framing()
+{
+	static const u8 info[] = { JC_ID_R, 0x7C, 0xBB, 0x8A, 0x9C, 0x67, 0x31 };
+	static const u8 info_cmd[5] = { JC_WIRED_CMD_GET_INFO };
+	u8 *pkt;
+
+	for (u32 chunk_max = 1; chunk_max <= 2 * HOST_JC_PKT_SZ; chunk_max += 13)
+	{
+		_stream_reset(chunk_max);
+
+		// Init replies come first.
+		pkt = stream + stream_sz;
+		stream_sz += host_jc_wired_pkt(pkt, JC_INIT_HANDSHAKE, NULL, NULL, 0);
+		pkt = stream + stream_sz;
+		stream_sz += host_jc_wired_pkt(pkt, JC_WIRED_INIT_REPLY, info_cmd, info, sizeof(info));
+		host_jc_feed(stream, stream_sz);
+		TEST_ASSERT(host_jc_poll() == 2);
+		TEST_ASSERT(jc_r.state == JC_STATE_HANDSHAKED && jc_r.connected);
+		for (u32 i = 0; i < 6; i++)
+			TEST_ASSERT(jc_r.mac[i] == info[6 - i]);
+
+		stream_sz = 0;
+		for (u32 i = 0; i < STREAM_RPTS; i++)
+			_stream_rpt(i);
+		TEST_ASSERT(expects[0].end == HOST_JC_PKT_SZ);
+		TEST_ASSERT(!_stream_replay(2, chunk_max));
+		TEST_ASSERT(jc_gamepad.conn_r && !jc_gamepad.conn_l);
+	}
+
+	return 0;
+}
+
+static int _test_garbage()
+{
+	// Headers cut short or too big for the packet buffer.
+	static const u8 magic_cut[] = { 0x19, 0x81 };
+	static const u8 hdr_big[]   = { 0x19, 0x81, 0x03, 0x00, 0x01 };
+
+	_stream_reset(7);
+
+	for (u32 i = 0; i < STREAM_RPTS; i++)
+	{
+		switch (i % 4)
+		{
+		case 1:
+			_stream_garbage(1 + _rand() % 96);
+			break;
+		case 2:
+			_stream_raw(magic_cut, sizeof(magic_cut));
+			break;
+		case 3:
+			_stream_raw(hdr_big, sizeof(hdr_big));
+			_stream_garbage(_rand() % 8);
+			break;
+		default:
+			break;
+		}
+		_stream_rpt(i);
+	}
+
+	return _stream_replay(0, 3 * HOST_JC_PKT_SZ);
+}
+
+static int _test_corrupt()
+{
+	_stream_reset(11);
+
+	for (u32 i = 0; i < STREAM_RPTS; i++)
+	{
+		u8 *pkt = stream + stream_sz;
+		rpt_expect_t *exp = _stream_rpt(i);
+
+		switch (i % 8)
+		{
+		case 2: // Bad magic. Lost.
+			pkt[1] ^= 0x80;
+			expects_cnt--;
+			break;
+		case 4: // Size over the packet buffer. Lost.
+			pkt[4] = 1;
+			expects_cnt--;
+			break;
+		case 6: // Size past the packet. Parsed with the next one's head, which is lost.
+			pkt[3] += 20;
+			exp->end += 20;
+			_stream_rpt(++i);
+			expects_cnt--;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return _stream_replay(0, 2 * HOST_JC_PKT_SZ);
+}
+
+// Bytes past a full ring are dropped, until the reader catches up.
+static int _test_overflow()
+{
+	u32 ring_pkts = (JC_RX_RING_SIZE - 1) / HOST_JC_PKT_SZ;
+
+	_stream_reset(13);
+
+	for (u32 i = 0; i < ring_pkts * 3; i++)
+		_stream_rpt(i);
+	TEST_ASSERT(host_jc_feed(stream, stream_sz) == stream_sz - (JC_RX_RING_SIZE - 1));
+	TEST_ASSERT(host_jc_poll() == ring_pkts);
+	TEST_ASSERT(!_gamepad_check(&expects[ring_pkts - 1]));
+
+	// Partial packet left in the buffer takes the head of the next one. Its report is whole.
+	rpt_expect_t partial = expects[ring_pkts];
+	partial.end = HOST_JC_PKT_SZ - (JC_RX_RING_SIZE - 1) % HOST_JC_PKT_SZ;
+
+	jc_r.rx_ring.dropped = 0;
+	stream_sz = 0;
+	expects_cnt = 0;
+	for (u32 i = 0; i < STREAM_RPTS; i++)
+		_stream_rpt(1000 + i);
+	expects[0] = partial;
+
+	return _stream_replay(ring_pkts, HOST_JC_PKT_SZ);
+}
+
+static const host_test_t tests[] = {
+	{ "framing",  _test_framing },
+	{ "garbage",  _test_garbage },
+	{ "corrupt",  _test_corrupt },
+	{ "overflow", _test_overflow },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
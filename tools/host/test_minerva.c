@@ -0,0 +1,442 @@
+/*
+ * Minerva saved training tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Boots minerva_init against a Minerva model that trains a table only when it
+ * is asked to and it's not already trained. Saved files are checked by a
+ * separate validator of the file format, then altered to check that every key
+ * change or corruption falls back to full training.
+ */
+
+#include <bdk.h>
+
+#include <soc/fuse.h>
+#include <soc/t210.h>
+
+#include "test.h"
+
+static u32 clock_regs[SZ_4K / sizeof(u32)];
+static u32 fuse_regs[SZ_4K / sizeof(u32)];
+
+#undef CLOCK
+#define CLOCK(off) clock_regs[(off) / sizeof(u32)]
+#undef FUSE
+#define FUSE(off)  fuse_regs[(off) / sizeof(u32)]
+
+// Host build has its own stub.
+#define minerva_periodic_training minerva_periodic_training_bdk
+
+#include "../../bdk/mem/minerva.c"
+
+#define MODEL_ENTRIES  7
+#define MODEL_REV      7
+#define MODEL_DRAM_ID  4
+
+static const u32 model_rates[MODEL_ENTRIES] = {
+	204000, 408000, 665600, 800000, 1065600, 1331200, 1600000
+};
+
+typedef struct _minerva_model_t
+{
+	u32 boots;
+	u32 rev;
+	u32 trains;
+	u32 errors; // Switches to untrained tables.
+} minerva_model_t;
+
+typedef struct _sd_file_t
+{
+	bool mounted;
+	u8  *data;
+	u32  size;
+	u32  saves;
+} sd_file_t;
+
+volatile nyx_storage_t *nyx_str;
+
+static minerva_model_t model;
+static sd_file_t sd_file;
+static u32 soc_temp;
+static u32 dram_id;
+
+static emc_table_t *_model_table_find(mtc_config_t *mtc_cfg, u32 rate_khz)
+{
+	for (u32 i = 0; i < mtc_cfg->table_entries; i++)
+		if (mtc_cfg->mtc_table[i].rate_khz == rate_khz)
+			return &mtc_cfg->mtc_table[i];
+
+	return NULL;
+}
+
+static void _model_minerva(mtc_config_t *mtc_cfg, void *bp)
+{
+	emc_table_t *dst = _model_table_find(mtc_cfg, mtc_cfg->rate_to);
+	if (!dst)
+	{
+		model.errors++;
+		return;
+	}
+
+	switch (mtc_cfg->train_mode)
+	{
+	case OP_TRAIN:
+		// Results differ per boot, so reused ones can be told apart.
+		if (!dst->trained)
+		{
+			dst->trained = 1;
+			dst->trained_dram_clktree_c0d0u0 = model.boots << 24 | (dst->rate_khz / 1000);
+			model.trains++;
+		}
+		break;
+	case OP_SWITCH:
+		if (!dst->trained)
+			model.errors++;
+		mtc_cfg->rate_from = mtc_cfg->rate_to;
+		break;
+	}
+}
+
+// Generates fresh untrained tables, like Minerva on MTC_NEW_MAGIC.
+uintptr_t ianos_loader(char *path, elfType_t type, void *config)
+{
+	mtc_config_t *mtc_cfg = (mtc_config_t *)config;
+
+	if (mtc_cfg->init_done != MTC_NEW_MAGIC)
+		return 0;
+
+	model.boots++;
+	for (u32 i = 0; i < MODEL_ENTRIES; i++)
+	{
+		emc_table_t *table = &mtc_cfg->mtc_table[i];
+
+		memset(table, 0, sizeof(emc_table_t));
+		table->rev         = model.rev;
+		table->rate_khz    = model_rates[i];
+		table->clk_src_emc = i + 1;
+		table->needs_training = model_rates[i] >= 800000;
+	}
+
+	mtc_cfg->table_entries = MODEL_ENTRIES;
+	mtc_cfg->init_done = MTC_INIT_MAGIC;
+
+	return (uintptr_t)_model_minerva;
+}
+
+u32 fuse_read_dramid(bool raw_id)
+{
+	return dram_id;
+}
+
+u16 tmp451_get_soc_temp(bool integer)
+{
+	return soc_temp;
+}
+
+bool sd_get_card_mounted()
+{
+	return sd_file.mounted;
+}
+
+void *sd_file_read(const char *path, u32 *fsize)
+{
+	if (!sd_file.mounted || !sd_file.data || strcmp(path, MTC_TRAIN_CACHE_PATH))
+		return NULL;
+
+	void *buf = malloc(sd_file.size);
+	memcpy(buf, sd_file.data, sd_file.size);
+	*fsize = sd_file.size;
+
+	return buf;
+}
+
+int sd_save_to_file(void *buf, u32 size, const char *filename)
+{
+	if (!sd_file.mounted || strcmp(filename, MTC_TRAIN_CACHE_PATH))
+		return 1;
+
+	free(sd_file.data);
+	sd_file.data = (u8 *)malloc(size);
+	memcpy(sd_file.data, buf, size);
+	sd_file.size = size;
+	sd_file.saves++;
+
+	return 0;
+}
+
+static void _setup()
+{
+	if (!nyx_str)
+		nyx_str = (nyx_storage_t *)zalloc(sizeof(nyx_storage_t));
+
+	memset(&model, 0, sizeof(model));
+	model.rev = MODEL_REV;
+
+	free(sd_file.data);
+	memset(&sd_file, 0, sizeof(sd_file));
+	sd_file.mounted = true;
+
+	soc_temp = 40;
+	dram_id  = MODEL_DRAM_ID;
+
+	memset(fuse_regs, 0, sizeof(fuse_regs));
+	FUSE(FUSE_OPT_LOT_CODE_0)   = 0x12345678;
+	FUSE(FUSE_OPT_WAFER_ID)     = 0x11;
+	FUSE(FUSE_OPT_X_COORDINATE) = 0x22;
+	FUSE(FUSE_OPT_Y_COORDINATE) = 0x33;
+
+	// Boot rate is 204 MHz.
+	CLOCK(CLK_RST_CONTROLLER_CLK_SOURCE_EMC) = 1;
+}
+
+// Cold boot. Returns trainings done.
+static u32 _boot()
+{
+	u32 trains = model.trains;
+
+	memset((void *)nyx_str->mtc_table, 0, sizeof(nyx_str->mtc_table));
+	if (minerva_init())
+		return 0xFFFFFFFF;
+
+	return model.trains - trains;
+}
+
+static mtc_config_t *_mtc_cfg()
+{
+	return (mtc_config_t *)&nyx_str->mtc_cfg;
+}
+
+static mtc_train_cache_t *_file_hdr()
+{
+	return (mtc_train_cache_t *)sd_file.data;
+}
+
+static void _file_crc_update()
+{
+	_file_hdr()->crc32 = crc32_calc(0, sd_file.data + MTC_TRAIN_CACHE_CRC_OFF, sd_file.size - MTC_TRAIN_CACHE_CRC_OFF);
+}
+
+static emc_table_t *_file_table(u32 idx)
+{
+	return (emc_table_t *)(sd_file.data + sizeof(mtc_train_cache_t)) + idx;
+}
+
+// Validates a saved file against the cache format, without the loader.
+static int _file_validate()
+{
+	mtc_train_cache_t *hdr = _file_hdr();
+
+	// Header layout is part of the file format.
+	TEST_ASSERT(sizeof(mtc_train_cache_t) == 0x40);
+	TEST_ASSERT(MTC_TRAIN_CACHE_CRC_OFF == offsetof(mtc_train_cache_t, entry_size));
+
+	TEST_ASSERT(sd_file.data);
+	TEST_ASSERT(sd_file.size == sizeof(mtc_train_cache_t) + MODEL_ENTRIES * sizeof(emc_table_t));
+
+	TEST_ASSERT(hdr->magic == MTC_TRAIN_CACHE_MAGIC);
+	TEST_ASSERT(hdr->version == MTC_TRAIN_CACHE_VERSION);
+	TEST_ASSERT(hdr->crc32 == crc32_calc(0, sd_file.data + MTC_TRAIN_CACHE_CRC_OFF, sd_file.size - MTC_TRAIN_CACHE_CRC_OFF));
+	TEST_ASSERT(hdr->entry_size == sizeof(emc_table_t));
+	TEST_ASSERT(hdr->table_entries == MODEL_ENTRIES);
+	TEST_ASSERT(hdr->sdram_id == dram_id);
+	TEST_ASSERT(hdr->chip_uid[0] == FUSE(FUSE_OPT_LOT_CODE_0));
+	TEST_ASSERT(hdr->chip_uid[1] == FUSE(FUSE_OPT_WAFER_ID));
+	TEST_ASSERT(hdr->chip_uid[2] == FUSE(FUSE_OPT_X_COORDINATE));
+	TEST_ASSERT(hdr->chip_uid[3] == FUSE(FUSE_OPT_Y_COORDINATE));
+
+	for (u32 i = 0; i < ARRAY_SIZE(hdr->rsvd); i++)
+		TEST_ASSERT(!hdr->rsvd[i]);
+
+	// Tables are saved as they are after init.
+	for (u32 i = 0; i < MODEL_ENTRIES; i++)
+	{
+		emc_table_t *table = _file_table(i);
+		bool init_rate = table->rate_khz == 204000 || table->rate_khz == 800000 || table->rate_khz == 1600000;
+
+		TEST_ASSERT(table->rev == model.rev && table->rate_khz == model_rates[i]);
+		TEST_ASSERT(table->trained == init_rate);
+	}
+
+	return 0;
+}
+
+static int _test_save()
+{
+	_setup();
+
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!model.errors);
+	TEST_ASSERT(_mtc_cfg()->rate_from == 1600000);
+
+	TEST_ASSERT(sd_file.saves == 1);
+	TEST_ASSERT(!_file_validate());
+	TEST_ASSERT(_file_hdr()->soc_temp == soc_temp);
+	TEST_ASSERT(!memcmp(_file_table(0), (void *)nyx_str->mtc_table, MODEL_ENTRIES * sizeof(emc_table_t)));
+
+	return 0;
+}
+
+static int _test_reuse()
+{
+	_setup();
+
+	TEST_ASSERT(_boot() == 3);
+	u8 *saved = (u8 *)malloc(sd_file.size);
+	memcpy(saved, sd_file.data, sd_file.size);
+
+	// Next boot skips training and keeps the file.
+	TEST_ASSERT(_boot() == 0);
+	TEST_ASSERT(!model.errors);
+	TEST_ASSERT(model.boots == 2);
+	TEST_ASSERT(sd_file.saves == 1);
+	TEST_ASSERT(!memcmp(saved, sd_file.data, sd_file.size));
+
+	// Training results are the ones from the first boot.
+	emc_table_t *table = _model_table_find(_mtc_cfg(), 1600000);
+	TEST_ASSERT(table->trained_dram_clktree_c0d0u0 == (1 << 24 | 1600));
+	TEST_ASSERT(_mtc_cfg()->rate_from == 1600000);
+
+	free(saved);
+
+	return 0;
+}
+
+static int _test_temp()
+{
+	_setup();
+
+	TEST_ASSERT(_boot() == 3);
+
+	// Saved temperature stays the reference while reused.
+	soc_temp = 50;
+	TEST_ASSERT(_boot() == 0);
+	soc_temp = 30;
+	TEST_ASSERT(_boot() == 0);
+	TEST_ASSERT(_file_hdr()->soc_temp == 40);
+
+	soc_temp = 51;
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(sd_file.saves == 2);
+	TEST_ASSERT(!_file_validate());
+	TEST_ASSERT(_file_hdr()->soc_temp == 51);
+
+	soc_temp = 40;
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!model.errors);
+
+	return 0;
+}
+
+static int _test_keys()
+{
+	static const u32 fuses[] = {
+		FUSE_OPT_LOT_CODE_0, FUSE_OPT_WAFER_ID, FUSE_OPT_X_COORDINATE, FUSE_OPT_Y_COORDINATE
+	};
+
+	_setup();
+
+	TEST_ASSERT(_boot() == 3);
+
+	// Another SoC.
+	for (u32 i = 0; i < ARRAY_SIZE(fuses); i++)
+	{
+		FUSE(fuses[i]) ^= 0x100;
+		TEST_ASSERT(_boot() == 3);
+		TEST_ASSERT(!_file_validate());
+		TEST_ASSERT(_boot() == 0);
+	}
+
+	// Another DRAM.
+	dram_id = MODEL_DRAM_ID + 1;
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!_file_validate());
+	TEST_ASSERT(_boot() == 0);
+
+	// Minerva with other tables.
+	model.rev++;
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!_file_validate());
+	TEST_ASSERT(_boot() == 0);
+
+	TEST_ASSERT(!model.errors);
+
+	return 0;
+}
+
+static int _test_corrupt()
+{
+	_setup();
+
+	TEST_ASSERT(_boot() == 3);
+
+	// Data corruption.
+	_file_table(3)->trained_dram_clktree_c0d0u1 ^= 1;
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!_file_validate());
+
+	// Truncated.
+	sd_file.size -= sizeof(emc_table_t);
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!_file_validate());
+
+	// Unknown version.
+	_file_hdr()->version = MTC_TRAIN_CACHE_VERSION + 1;
+	_file_crc_update();
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!_file_validate());
+
+	// Init rate not trained.
+	_file_table(3)->trained = 0;
+	_file_crc_update();
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!_file_validate());
+
+	// Other rates don't need to be.
+	TEST_ASSERT(!_file_table(1)->trained);
+	TEST_ASSERT(_boot() == 0);
+
+	TEST_ASSERT(!model.errors);
+
+	return 0;
+}
+
+static int _test_no_sd()
+{
+	_setup();
+
+	sd_file.mounted = false;
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(_boot() == 3);
+	TEST_ASSERT(!sd_file.saves);
+	TEST_ASSERT(!model.errors);
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "save",    _test_save },
+	{ "reuse",   _test_reuse },
+	{ "temp",    _test_temp },
+	{ "keys",    _test_keys },
+	{ "corrupt", _test_corrupt },
+	{ "no_sd",   _test_no_sd },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
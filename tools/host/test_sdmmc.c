@@ -0,0 +1,244 @@
+/*
+ * SDMMC storage command sequence tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bdk.h>
+
+#include <storage/mmc.h>
+
+#include "sdhci_model.h"
+#include "test.h"
+
+#define MODEL_SECTORS 0x4000
+#define MODEL_CACHE   0x400 // In KB.
+#define XFER_SECTORS  64
+
+#define SWITCH_IDX_MASK (0xFF << 16)
+#define SWITCH_MASK     (0xFFFF << 8)
+#define SWITCH_CACHE(v) ((EXT_CSD_CACHE_CTRL << 16) | ((v) << 8))
+#define SWITCH_FLUSH    ((EXT_CSD_FLUSH_CACHE << 16) | (1 << 8))
+
+static u8 *xfer_buf;
+
+static void _fill(u8 *buf, u32 sectors, u32 seed)
+{
+	for (u32 i = 0; i < sectors * SDMMC_DAT_BLOCKSIZE; i++)
+		buf[i] = (u8)(seed + i * 31 + (i >> 9));
+}
+
+static int _media_matches(u32 sector, u32 sectors, const u8 *buf)
+{
+	return !memcmp(mmc_model.media + sector * SDMMC_DAT_BLOCKSIZE, buf, sectors * SDMMC_DAT_BLOCKSIZE);
+}
+
+static int _setup()
+{
+	if (!mmc_model_init(MODEL_SECTORS, MODEL_CACHE))
+		return 1;
+
+	if (!xfer_buf)
+		xfer_buf = (u8 *)malloc(XFER_SECTORS * SDMMC_DAT_BLOCKSIZE);
+
+	if (!emmc_initialize(false))
+		return 1;
+	mmc_model_log_clear();
+
+	return 0;
+}
+
+static void _teardown()
+{
+	emmc_end();
+	mmc_model_free();
+}
+
+static int _test_init()
+{
+	TEST_ASSERT(!_setup());
+
+	TEST_ASSERT(emmc_storage.initialized);
+	TEST_ASSERT(emmc_storage.sec_cnt == MODEL_SECTORS);
+	TEST_ASSERT(emmc_storage.ext_csd.cache_size == MODEL_CACHE);
+	TEST_ASSERT(!emmc_storage.cache_enabled);
+	TEST_ASSERT(!mmc_model.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_write_plain()
+{
+	TEST_ASSERT(!_setup());
+
+	// Without bulk mode, writes are open ended and stopped by the controller.
+	_fill(xfer_buf, XFER_SECTORS, 1);
+	TEST_ASSERT(sdmmc_storage_write(&emmc_storage, 0x100, XFER_SECTORS, xfer_buf));
+
+	int idx = mmc_model_log_find(0, MMC_WRITE_MULTIPLE_BLOCK, 0xFFFFFFFF, 0x100);
+	TEST_ASSERT(idx >= 0);
+	TEST_ASSERT(mmc_model.log[idx].auto_stop);
+	TEST_ASSERT(mmc_model_log_find(0, MMC_SET_BLOCK_COUNT, 0, 0) < 0);
+	TEST_ASSERT(_media_matches(0x100, XFER_SECTORS, xfer_buf));
+	TEST_ASSERT(!mmc_model.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_bulk_cmd23()
+{
+	TEST_ASSERT(!_setup());
+
+	TEST_ASSERT(sdmmc_storage_set_bulk_write(&emmc_storage, true));
+	TEST_ASSERT(emmc_storage.cache_enabled);
+	TEST_ASSERT(mmc_model_log_find(0, MMC_SWITCH, SWITCH_IDX_MASK | SWITCH_MASK, SWITCH_CACHE(1)) >= 0);
+
+	_fill(xfer_buf, XFER_SECTORS, 2);
+	mmc_model_log_clear();
+	TEST_ASSERT(sdmmc_storage_write(&emmc_storage, 0x200, XFER_SECTORS, xfer_buf));
+
+	// CMD23 with the exact count goes right before CMD25 and the card stops on its own.
+	TEST_ASSERT(mmc_model.log_cnt == 2);
+	TEST_ASSERT(mmc_model.log[0].cmd == MMC_SET_BLOCK_COUNT && mmc_model.log[0].arg == XFER_SECTORS);
+	TEST_ASSERT(mmc_model.log[1].cmd == MMC_WRITE_MULTIPLE_BLOCK && mmc_model.log[1].arg == 0x200);
+	TEST_ASSERT(!mmc_model.log[1].auto_stop);
+
+	// Data sits in the card cache until flushed.
+	TEST_ASSERT(mmc_model_dirty_count() == XFER_SECTORS);
+	memset(xfer_buf, 0, XFER_SECTORS * SDMMC_DAT_BLOCKSIZE);
+	TEST_ASSERT(sdmmc_storage_read(&emmc_storage, 0x200, XFER_SECTORS, xfer_buf));
+	u8 *ref = (u8 *)malloc(XFER_SECTORS * SDMMC_DAT_BLOCKSIZE);
+	_fill(ref, XFER_SECTORS, 2);
+	TEST_ASSERT(!memcmp(ref, xfer_buf, XFER_SECTORS * SDMMC_DAT_BLOCKSIZE));
+	free(ref);
+
+	// Reads never use CMD23.
+	int idx = mmc_model_log_find(2, MMC_READ_MULTIPLE_BLOCK, 0xFFFFFFFF, 0x200);
+	TEST_ASSERT(idx == 2 && mmc_model.log[idx].auto_stop);
+	TEST_ASSERT(!mmc_model.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_bulk_disable()
+{
+	TEST_ASSERT(!_setup());
+
+	TEST_ASSERT(sdmmc_storage_set_bulk_write(&emmc_storage, true));
+	_fill(xfer_buf, XFER_SECTORS, 3);
+	TEST_ASSERT(sdmmc_storage_write(&emmc_storage, 0x300, XFER_SECTORS, xfer_buf));
+
+	mmc_model_log_clear();
+	TEST_ASSERT(sdmmc_storage_set_bulk_write(&emmc_storage, false));
+
+	// Flush commits the cache before it's turned off.
+	int flush = mmc_model_log_find(0, MMC_SWITCH, SWITCH_IDX_MASK | SWITCH_MASK, SWITCH_FLUSH);
+	int off   = mmc_model_log_find(0, MMC_SWITCH, SWITCH_IDX_MASK | SWITCH_MASK, SWITCH_CACHE(0));
+	TEST_ASSERT(flush >= 0 && off > flush);
+	TEST_ASSERT(!emmc_storage.cache_enabled && !emmc_storage.bulk_write);
+	TEST_ASSERT(_media_matches(0x300, XFER_SECTORS, xfer_buf));
+	TEST_ASSERT(!mmc_model.errors);
+
+	_teardown();
+
+	return 0;
+}
+
+static int _test_end_flush()
+{
+	TEST_ASSERT(!_setup());
+
+	TEST_ASSERT(sdmmc_storage_set_bulk_write(&emmc_storage, true));
+	_fill(xfer_buf, XFER_SECTORS, 4);
+	TEST_ASSERT(sdmmc_storage_write(&emmc_storage, 0x400, XFER_SECTORS, xfer_buf));
+
+	mmc_model_log_clear();
+	emmc_end();
+
+	int flush = mmc_model_log_find(0, MMC_SWITCH, SWITCH_IDX_MASK | SWITCH_MASK, SWITCH_FLUSH);
+	int off   = mmc_model_log_find(0, MODEL_EV_POWER_OFF, 0, 0);
+	TEST_ASSERT(flush >= 0 && off > flush);
+	TEST_ASSERT(!mmc_model.lost);
+	TEST_ASSERT(_media_matches(0x400, XFER_SECTORS, xfer_buf));
+
+	mmc_model_free();
+
+	return 0;
+}
+
+static int _test_reinit()
+{
+	TEST_ASSERT(!_setup());
+
+	TEST_ASSERT(sdmmc_storage_set_bulk_write(&emmc_storage, true));
+
+	// Cached data from an earlier write must survive the power cycle.
+	u8 *prev = (u8 *)malloc(XFER_SECTORS * SDMMC_DAT_BLOCKSIZE);
+	_fill(prev, XFER_SECTORS, 5);
+	TEST_ASSERT(sdmmc_storage_write(&emmc_storage, 0x500, XFER_SECTORS, prev));
+	TEST_ASSERT(mmc_model_dirty_count() == XFER_SECTORS);
+
+	// Exhaust all retries so storage gets reinitialized.
+	mmc_model_log_clear();
+	mmc_model.fail_writes = 5;
+	_fill(xfer_buf, XFER_SECTORS, 6);
+	TEST_ASSERT(sdmmc_storage_write(&emmc_storage, 0x600, XFER_SECTORS, xfer_buf));
+
+	int flush = mmc_model_log_find(0, MMC_SWITCH, SWITCH_IDX_MASK | SWITCH_MASK, SWITCH_FLUSH);
+	int off   = mmc_model_log_find(0, MODEL_EV_POWER_OFF, 0, 0);
+	int on    = mmc_model_log_find(0, MODEL_EV_POWER_ON, 0, 0);
+	TEST_ASSERT(flush >= 0 && off > flush && on > off);
+	TEST_ASSERT(!mmc_model.lost);
+	TEST_ASSERT(_media_matches(0x500, XFER_SECTORS, prev));
+	free(prev);
+
+	// Bulk mode and cache are applied again before the retried write.
+	int cache = mmc_model_log_find(on, MMC_SWITCH, SWITCH_IDX_MASK | SWITCH_MASK, SWITCH_CACHE(1));
+	int cmd23 = mmc_model_log_find(on, MMC_SET_BLOCK_COUNT, 0xFFFFFFFF, XFER_SECTORS);
+	int cmd25 = mmc_model_log_find(on, MMC_WRITE_MULTIPLE_BLOCK, 0xFFFFFFFF, 0x600);
+	TEST_ASSERT(cache >= 0 && cmd23 > cache && cmd25 == cmd23 + 1);
+	TEST_ASSERT(!mmc_model.log[cmd25].auto_stop);
+	TEST_ASSERT(emmc_storage.bulk_write && emmc_storage.cache_enabled);
+
+	// Retried data reaches the card and gets committed on end.
+	emmc_end();
+	TEST_ASSERT(!mmc_model.lost);
+	TEST_ASSERT(_media_matches(0x600, XFER_SECTORS, xfer_buf));
+	TEST_ASSERT(!mmc_model.errors);
+
+	mmc_model_free();
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "init",         _test_init },
+	{ "write_plain",  _test_write_plain },
+	{ "bulk_cmd23",   _test_bulk_cmd23 },
+	{ "bulk_disable", _test_bulk_disable },
+	{ "end_flush",    _test_end_flush },
+	{ "reinit",       _test_reinit },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
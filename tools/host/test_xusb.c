@@ -0,0 +1,583 @@
+/*
+ * XUSB device bulk TRB ring tests
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bdk.h>
+
+#include <soc/t210.h>
+
+// Route the driver's XHCI register accesses through the controller model.
+static vu32 *_xhci_reg(u32 off);
+#undef  XUSB_DEV_XHCI
+#define XUSB_DEV_XHCI(off) (*_xhci_reg(off))
+
+// Build the driver in this unit so its ring internals can be inspected.
+#include "../../bdk/usb/xusbd.c"
+
+#include "test.h"
+
+#define EVT_RING_SLOTS (XUSB_EVENT_TRB_SLOTS * 2)
+
+typedef struct _xhci_model_ep_t
+{
+	data_trb_t *deq;
+	u32 ccs;
+	u32 tds;
+} xhci_model_ep_t;
+
+typedef struct _xhci_model_t
+{
+	u32 regs[SZ_4K / sizeof(u32)];
+	u32 st;
+
+	event_trb_t *evt_enq;
+	u32 evt_pcs;
+
+	xhci_model_ep_t ep[USB_EP_BULK_IN + 1];
+
+	// Host side of the bulk pipes.
+	u8 *in_data;  // Data received from Bulk IN.
+	u32 in_len;
+	u8 *out_data; // Data sent to Bulk OUT.
+	u32 out_len;
+	u32 out_pos;
+
+	u32 tds_per_poll; // TDs completed per status poll. 0 for all.
+	bool hold;        // Controller does not run.
+	u32 errors;       // Malformed TDs seen by the controller.
+	u32 evt_stalls;   // Times TDs waited for event ring space.
+} xhci_model_t;
+
+static xhci_model_t xhci;
+static void *evtq_mem;
+
+static u32 _evt_idx(u32 addr)
+{
+	return ((event_trb_t *)addr - xusb_evtq->xusb_event_ring_seg0) % EVT_RING_SLOTS;
+}
+
+static u32 _evt_pending()
+{
+	u32 enq = _evt_idx((u32)xhci.evt_enq);
+	u32 deq = _evt_idx(xhci.regs[XUSB_DEV_XHCI_ERDPLO / 4] & 0xFFFFFFF0);
+
+	return (enq - deq + EVT_RING_SLOTS) % EVT_RING_SLOTS;
+}
+
+static void _evt_post(u32 ep_idx, data_trb_t *trb, u32 residue, u32 comp_code)
+{
+	transfer_event_trb_t *evt = (transfer_event_trb_t *)xhci.evt_enq;
+
+	memset(evt, 0, sizeof(transfer_event_trb_t));
+	evt->trb_pointer_lo = (u32)trb;
+	evt->trb_tx_len     = residue;
+	evt->comp_code      = comp_code;
+	evt->trb_type       = XUSB_TRB_TRANSFER;
+	evt->ep_id          = ep_idx;
+	evt->cycle          = xhci.evt_pcs;
+
+	// Segments are contiguous. Wrap after the second one.
+	if (++xhci.evt_enq == &xusb_evtq->xusb_event_ring_seg1[XUSB_EVENT_LAST_TRB_IDX + 1])
+	{
+		xhci.evt_enq = xusb_evtq->xusb_event_ring_seg0;
+		xhci.evt_pcs ^= 1;
+	}
+
+	xhci.regs[XUSB_DEV_XHCI_EREPLO / 4] = (u32)xhci.evt_enq | XCHI_ECS;
+}
+
+// Returns next TRB owned by the controller, following links. NULL if not owned.
+static data_trb_t *_ring_fetch(xhci_model_ep_t *ep, bool in_td)
+{
+	data_trb_t *trb = ep->deq;
+
+	if (trb->trb_type == XUSB_TRB_LINK)
+	{
+		link_trb_t *link = (link_trb_t *)trb;
+		if (link->cycle != ep->ccs)
+			return NULL;
+
+		// Link must carry chain inside a TD, otherwise the TD gets split.
+		if (in_td && !link->chain)
+			xhci.errors++;
+
+		if (link->toggle_cycle)
+			ep->ccs ^= 1;
+		trb = (data_trb_t *)((u32)link->ring_seg_ptrlo << 4);
+		ep->deq = trb;
+	}
+
+	if (trb->cycle != ep->ccs)
+		return NULL;
+
+	return trb;
+}
+
+// Processes one TD. Returns 0 if there's none.
+static int _xhci_run_td(u32 ep_idx)
+{
+	xhci_model_ep_t *ep = &xhci.ep[ep_idx];
+	u32 mps = xusb_evtq->xusb_ep_ctxt[ep_idx].max_packet_size;
+
+	data_trb_t *trb = _ring_fetch(ep, false);
+	if (!trb)
+		return 0;
+
+	// Get TD length first. Its TRBs must all be owned already.
+	data_trb_t *curr = trb;
+	xhci_model_ep_t walk = *ep;
+	u32 td_len = 0;
+	while (true)
+	{
+		td_len += curr->trb_tx_len;
+		if (!curr->chain)
+			break;
+		walk.deq = &curr[1];
+		curr = _ring_fetch(&walk, true);
+		if (!curr)
+		{
+			// TD published before all of its TRBs.
+			xhci.errors++;
+			return 0;
+		}
+	}
+
+	u32 len_left = td_len;
+	u32 residue = 0;
+	bool short_pkt = false;
+	while (true)
+	{
+		normal_trb_t *ntrb = (normal_trb_t *)trb;
+		u32 addr = ntrb->databufptr_lo;
+		u32 len  = ntrb->trb_tx_len;
+		len_left -= len;
+
+		if (ntrb->trb_type != XUSB_TRB_NORMAL ||
+			(addr & (XUSB_TRB_MAX_SIZE - 1)) + len > XUSB_TRB_MAX_SIZE ||
+			ntrb->td_size != MIN((len_left + mps - 1) / mps, 31) ||
+			ntrb->ioc != !ntrb->chain || !ntrb->isp)
+			xhci.errors++;
+
+		if (!short_pkt)
+		{
+			if (ep_idx == USB_EP_BULK_IN)
+			{
+				memcpy(xhci.in_data + xhci.in_len, (void *)addr, len);
+				xhci.in_len += len;
+			}
+			else
+			{
+				u32 bytes = MIN(len, xhci.out_len - xhci.out_pos);
+				memcpy((void *)addr, xhci.out_data + xhci.out_pos, bytes);
+				xhci.out_pos += bytes;
+
+				// Host sent less. Report it and skip the rest of the TD.
+				if (bytes < len)
+				{
+					_evt_post(ep_idx, trb, len - bytes, XUSB_COMP_SHORT_PKT);
+					short_pkt = true;
+					residue = len - bytes;
+				}
+			}
+		}
+
+		ep->deq = &trb[1];
+		if (!ntrb->chain)
+			break;
+		trb = _ring_fetch(ep, true);
+	}
+
+	if (!short_pkt)
+		_evt_post(ep_idx, trb, residue, XUSB_COMP_SUCCESS);
+	ep->tds++;
+
+	return 1;
+}
+
+static bool _td_ready(u32 ep_idx)
+{
+	xhci_model_ep_t walk = xhci.ep[ep_idx];
+
+	return _ring_fetch(&walk, false) != NULL;
+}
+
+static void _xhci_run()
+{
+	u32 tds = 0;
+	bool busy = true;
+
+	if (xhci.hold)
+		return;
+
+	// Keep one event slot free, like a real event ring.
+	while (busy && _evt_pending() < EVT_RING_SLOTS - 1)
+	{
+		if (xhci.tds_per_poll && tds >= xhci.tds_per_poll)
+			break;
+
+		busy = false;
+		for (u32 ep_idx = USB_EP_BULK_OUT; ep_idx <= USB_EP_BULK_IN; ep_idx++)
+		{
+			if (_evt_pending() < EVT_RING_SLOTS - 1 && _xhci_run_td(ep_idx))
+			{
+				busy = true;
+				tds++;
+			}
+		}
+	}
+
+	// Event ring got full with TDs still queued.
+	if (_evt_pending() >= EVT_RING_SLOTS - 1 && (_td_ready(USB_EP_BULK_OUT) || _td_ready(USB_EP_BULK_IN)))
+		xhci.evt_stalls++;
+}
+
+static vu32 *_xhci_reg(u32 off)
+{
+	// Controller works while the driver polls for events.
+	if (off == XUSB_DEV_XHCI_ST)
+	{
+		_xhci_run();
+		xhci.st = _evt_pending() ? XHCI_ST_IP : 0;
+
+		return &xhci.st;
+	}
+
+	return &xhci.regs[off / 4];
+}
+
+static int _setup(u32 port_speed)
+{
+	memset(&xhci, 0, sizeof(xhci_model_t));
+
+	// Rings must be 16 bytes aligned and in 32-bit address space.
+	if (!evtq_mem)
+		evtq_mem = zalloc(sizeof(xusbd_event_queues_t) + 0x10);
+	xusb_evtq = (xusbd_event_queues_t *)ALIGN((u32)evtq_mem, 0x10);
+	memset(xusb_evtq, 0, sizeof(xusbd_event_queues_t));
+
+	usbd_xotg = &usbd_xotg_controller_ctxt;
+	memset(usbd_xotg, 0, sizeof(xusbd_controller_t));
+	usbd_xotg->desc = &usb_gadget_ums_descriptors;
+	usbd_xotg->gadget = USB_GADGET_UMS;
+	usbd_xotg->port_speed = port_speed;
+
+	usbd_xotg->event_dequeue_ptr = xusb_evtq->xusb_event_ring_seg0;
+	usbd_xotg->event_enqueue_ptr = xusb_evtq->xusb_event_ring_seg0;
+	usbd_xotg->event_ccs = 1;
+	xhci.regs[XUSB_DEV_XHCI_ERDPLO / 4] = (u32)xusb_evtq->xusb_event_ring_seg0;
+	xhci.regs[XUSB_DEV_XHCI_EREPLO / 4] = (u32)xusb_evtq->xusb_event_ring_seg0 | XCHI_ECS;
+	xhci.evt_enq = xusb_evtq->xusb_event_ring_seg0;
+	xhci.evt_pcs = 1;
+
+	if (_xusb_ep_init_context(USB_EP_BULK_OUT) || _xusb_ep_init_context(USB_EP_BULK_IN))
+		return 1;
+
+	for (u32 ep_idx = USB_EP_BULK_OUT; ep_idx <= USB_EP_BULK_IN; ep_idx++)
+	{
+		xhci.ep[ep_idx].deq = (data_trb_t *)((u32)xusb_evtq->xusb_ep_ctxt[ep_idx].trd_dequeueptr_lo << 4);
+		xhci.ep[ep_idx].ccs = xusb_evtq->xusb_ep_ctxt[ep_idx].dcs;
+	}
+
+	return 0;
+}
+
+static void _fill(u8 *buf, u32 len, u32 seed)
+{
+	for (u32 i = 0; i < len; i++)
+		buf[i] = (u8)(seed + i * 7 + (i >> 12));
+}
+
+static bool _ring_idle(u32 ep_idx)
+{
+	data_trb_t *enq = ep_idx == USB_EP_BULK_IN ? usbd_xotg->bulkin_epenqueue_ptr : usbd_xotg->bulkout_epenqueue_ptr;
+	data_trb_t *deq = ep_idx == USB_EP_BULK_IN ? usbd_xotg->bulkin_epdequeue_ptr : usbd_xotg->bulkout_epdequeue_ptr;
+
+	// Driver and controller must agree on where the ring is, modulo the link TRB.
+	data_trb_t *ctrl = xhci.ep[ep_idx].deq;
+	if (ctrl->trb_type == XUSB_TRB_LINK)
+		ctrl = (data_trb_t *)((u32)((link_trb_t *)ctrl)->ring_seg_ptrlo << 4);
+
+	return enq == deq && deq == ctrl;
+}
+
+static int _test_td_split()
+{
+	TEST_ASSERT(!_setup(XUSB_HIGH_SPEED));
+
+	// Unaligned max sized buffer crosses a 64KB boundary.
+	const u32 len = USB_EP_BUFFER_MAX_SIZE;
+	u8 *mem = (u8 *)malloc(SZ_256K);
+	u8 *buf = (u8 *)ALIGN((u32)mem, SZ_64K) + SZ_64K - 0x200;
+	_fill(buf, len, 1);
+
+	xhci.in_data = (u8 *)malloc(SZ_256K);
+	u32 written = 0;
+	TEST_ASSERT(!xusb_device_ep1_in_write(buf, len, &written, USB_XFER_SYNCED_DATA));
+
+	TEST_ASSERT(written == len);
+	TEST_ASSERT(usbd_xotg->bulkin_epenqueue_ptr == &xusb_evtq->xusb_bulkin_event_queue[2]);
+	TEST_ASSERT(xhci.ep[USB_EP_BULK_IN].tds == 1);
+	TEST_ASSERT(xhci.in_len == len && !memcmp(xhci.in_data, buf, len));
+	TEST_ASSERT(_ring_idle(USB_EP_BULK_IN));
+	TEST_ASSERT(!xhci.errors);
+
+	free(xhci.in_data);
+	free(mem);
+
+	return 0;
+}
+
+static int _test_in_queue_wrap()
+{
+	TEST_ASSERT(!_setup(XUSB_HIGH_SPEED));
+
+	// Two TRBs per TD on an odd ring size, so TDs straddle the link TRB.
+	const u32 len = SZ_32K;
+	const u32 tds = 200;
+	u8 *mem = (u8 *)malloc(SZ_1M + SZ_64K);
+	u8 *src = (u8 *)ALIGN((u32)mem, SZ_64K);
+	_fill(src, SZ_1M, 2);
+
+	xhci.in_data = (u8 *)malloc(len * tds);
+	xhci.tds_per_poll = 1;
+
+	u32 total = 0;
+	for (u32 i = 0; i < tds; i++)
+	{
+		// Place every buffer across a 64KB boundary.
+		u8 *buf = src + ((i % 15) + 1) * SZ_64K - SZ_16K;
+		TEST_ASSERT(!xusb_device_ep1_in_write(buf, len, NULL, 0));
+		total += len;
+
+		// Keep a few TDs in flight.
+		TEST_ASSERT(!xusb_device_ep1_in_writing_wait(8, USB_XFER_SYNCED_DATA));
+		TEST_ASSERT(usbd_xotg->tx_count[USB_DIR_IN] <= 8);
+	}
+
+	u32 pending = 0;
+	TEST_ASSERT(!xusb_device_ep1_in_writing_finish(&pending, USB_XFER_SYNCED_DATA));
+	TEST_ASSERT(xhci.ep[USB_EP_BULK_IN].tds == tds);
+	TEST_ASSERT(xhci.in_len == total);
+
+	for (u32 i = 0; i < tds; i++)
+	{
+		u8 *buf = src + ((i % 15) + 1) * SZ_64K - SZ_16K;
+		TEST_ASSERT(!memcmp(xhci.in_data + i * len, buf, len));
+	}
+	TEST_ASSERT(_ring_idle(USB_EP_BULK_IN));
+	TEST_ASSERT(!xhci.errors);
+
+	free(xhci.in_data);
+	free(mem);
+
+	return 0;
+}
+
+static int _test_in_ring_full()
+{
+	TEST_ASSERT(!_setup(XUSB_HIGH_SPEED));
+
+	// Controller only completes TDs while the driver waits, so the ring fills.
+	const u32 len = SZ_64K;
+	const u32 tds = 40;
+	u8 *mem = (u8 *)malloc(SZ_64K * (tds + 2));
+	u8 *src = (u8 *)ALIGN((u32)mem, SZ_64K) + 0x1000;
+	_fill(src, len * tds, 3);
+
+	xhci.in_data = (u8 *)malloc(len * tds);
+	xhci.tds_per_poll = 1;
+
+	for (u32 i = 0; i < tds; i++)
+	{
+		TEST_ASSERT(!xusb_device_ep1_in_write(src + i * len, len, NULL, 0));
+
+		// Never more TRBs queued than the ring can hold.
+		TEST_ASSERT(usbd_xotg->tx_count[USB_DIR_IN] * 2 <= XUSB_BULK_TRB_SLOTS - 2);
+	}
+
+	// Ring holds 31 TDs of 2 TRBs. Later ones waited for completions.
+	TEST_ASSERT(xhci.ep[USB_EP_BULK_IN].tds >= tds - 31);
+	TEST_ASSERT(usbd_xotg->tx_count[USB_DIR_IN] <= 31);
+
+	TEST_ASSERT(!xusb_device_ep1_in_writing_finish(NULL, USB_XFER_SYNCED_DATA));
+	TEST_ASSERT(xhci.in_len == len * tds);
+	TEST_ASSERT(!memcmp(xhci.in_data, src, len * tds));
+	TEST_ASSERT(_ring_idle(USB_EP_BULK_IN));
+	TEST_ASSERT(!xhci.errors);
+
+	free(xhci.in_data);
+	free(mem);
+
+	return 0;
+}
+
+static int _test_in_zlp()
+{
+	TEST_ASSERT(!_setup(XUSB_HIGH_SPEED));
+
+	// Max packet sized async transfer gets terminated with a zero length TD.
+	u8 *buf = (u8 *)malloc(512);
+	_fill(buf, 512, 4);
+	xhci.in_data = (u8 *)malloc(512);
+
+	TEST_ASSERT(!xusb_device_ep1_in_write(buf, 512, NULL, 0));
+	TEST_ASSERT(usbd_xotg->tx_count[USB_DIR_IN] == 2);
+
+	u32 pending = 0;
+	TEST_ASSERT(!xusb_device_ep1_in_writing_finish(&pending, USB_XFER_SYNCED_DATA));
+	TEST_ASSERT(pending == 512);
+	TEST_ASSERT(xhci.ep[USB_EP_BULK_IN].tds == 2);
+	TEST_ASSERT(xhci.in_len == 512 && !memcmp(xhci.in_data, buf, 512));
+	TEST_ASSERT(_ring_idle(USB_EP_BULK_IN));
+	TEST_ASSERT(!xhci.errors);
+
+	free(xhci.in_data);
+	free(buf);
+
+	return 0;
+}
+
+static int _test_out_short()
+{
+	TEST_ASSERT(!_setup(XUSB_HIGH_SPEED));
+
+	// Host sends less than requested. Transfer ends in the middle of the second TD.
+	const u32 len = SZ_4M;
+	const u32 sent = SZ_1M + SZ_512K + 123;
+	u8 *mem = (u8 *)malloc(len + SZ_128K);
+	u8 *buf = (u8 *)ALIGN((u32)mem, SZ_64K) + 0x1000;
+	memset(buf, 0, len);
+
+	xhci.out_data = (u8 *)malloc(sent + SZ_4K);
+	xhci.out_len = sent;
+	_fill(xhci.out_data, sent + SZ_4K, 5);
+
+	u32 bytes_read = 0;
+	TEST_ASSERT(!xusb_device_ep1_out_read_big(buf, len, &bytes_read));
+	TEST_ASSERT(bytes_read == sent);
+	TEST_ASSERT(!memcmp(buf, xhci.out_data, sent));
+	TEST_ASSERT(xhci.ep[USB_EP_BULK_OUT].tds == 2);
+
+	// Rest of the short TD was skipped on both sides.
+	TEST_ASSERT(_ring_idle(USB_EP_BULK_OUT));
+
+	// Ring keeps working after the skip.
+	xhci.out_len = sent + SZ_4K;
+	TEST_ASSERT(!xusb_device_ep1_out_read(buf, SZ_4K, &bytes_read, USB_XFER_SYNCED_DATA));
+	TEST_ASSERT(bytes_read == SZ_4K);
+	TEST_ASSERT(!memcmp(buf, xhci.out_data + sent, SZ_4K));
+	TEST_ASSERT(_ring_idle(USB_EP_BULK_OUT));
+	TEST_ASSERT(!xhci.errors);
+
+	free(xhci.out_data);
+	free(mem);
+
+	return 0;
+}
+
+static int _test_out_wrap()
+{
+	TEST_ASSERT(!_setup(XUSB_HIGH_SPEED));
+
+	// Short reads wrap both the transfer and the event ring many times.
+	const u32 reads = 300;
+	const u32 len = 512;
+	u8 *buf = (u8 *)malloc(SZ_4K);
+
+	xhci.out_data = (u8 *)malloc(reads * 100);
+	_fill(xhci.out_data, reads * 100, 6);
+
+	u32 pos = 0;
+	for (u32 i = 0; i < reads; i++)
+	{
+		u32 bytes_read = 0;
+		u32 bytes = (i * 37) % 101;
+		xhci.out_len = pos + bytes;
+
+		TEST_ASSERT(!xusb_device_ep1_out_read(buf, len, &bytes_read, USB_XFER_SYNCED_DATA));
+		TEST_ASSERT(bytes_read == bytes);
+		TEST_ASSERT(!memcmp(buf, xhci.out_data + pos, bytes));
+		TEST_ASSERT(_ring_idle(USB_EP_BULK_OUT));
+		pos += bytes;
+	}
+
+	TEST_ASSERT(xhci.ep[USB_EP_BULK_OUT].tds == reads);
+	TEST_ASSERT(!xhci.errors);
+
+	free(xhci.out_data);
+	free(buf);
+
+	return 0;
+}
+
+static int _test_evt_ring_full()
+{
+	TEST_ASSERT(!_setup(XUSB_HIGH_SPEED));
+
+	// Both bulk rings get filled before the controller runs. Every TD posts an event.
+	const u32 len = 100;
+	const u32 tds = XUSB_BULK_TRBS_QUEUED;
+	u8 *buf = (u8 *)malloc(len * tds);
+	u8 *out = (u8 *)malloc(len);
+	_fill(buf, len * tds, 7);
+
+	xhci.in_data  = (u8 *)malloc(len * tds);
+	xhci.out_data = (u8 *)malloc(len * tds);
+	xhci.out_len  = len * tds;
+	_fill(xhci.out_data, len * tds, 8);
+
+	xhci.hold = true;
+	for (u32 i = 0; i < tds; i++)
+	{
+		TEST_ASSERT(!xusb_device_ep1_in_write(buf + i * len, len, NULL, 0));
+		TEST_ASSERT(!xusb_device_ep1_out_read(out, len, NULL, 0));
+	}
+
+	// All complete without waiting for event ring space.
+	xhci.hold = false;
+	_xhci_run();
+	TEST_ASSERT(_evt_pending() == tds * 2);
+	TEST_ASSERT(!xhci.evt_stalls);
+
+	TEST_ASSERT(!xusb_device_ep1_in_writing_finish(NULL, USB_XFER_SYNCED_DATA));
+	TEST_ASSERT(xhci.in_len == len * tds && !memcmp(xhci.in_data, buf, len * tds));
+	TEST_ASSERT(xhci.out_pos == len * tds && !memcmp(out, xhci.out_data + len * (tds - 1), len));
+	TEST_ASSERT(_ring_idle(USB_EP_BULK_IN) && _ring_idle(USB_EP_BULK_OUT));
+	TEST_ASSERT(!xhci.errors);
+
+	free(xhci.out_data);
+	free(xhci.in_data);
+	free(out);
+	free(buf);
+
+	return 0;
+}
+
+static const host_test_t tests[] = {
+	{ "td_split",      _test_td_split },
+	{ "in_queue_wrap", _test_in_queue_wrap },
+	{ "in_ring_full",  _test_in_ring_full },
+	{ "in_zlp",        _test_in_zlp },
+	{ "out_short",     _test_out_short },
+	{ "out_wrap",      _test_out_wrap },
+	{ "evt_ring_full", _test_evt_ring_full },
+};
+
+int main(int argc, char **argv)
+{
+	return host_test_main(tests, ARRAY_SIZE(tests), argc, argv);
+}
@@ -0,0 +1,333 @@
+/*
+ * BDK host build USB shim
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bdk.h>
+
+#include "usb.h"
+
+#define CBW_SIG 0x43425355 // USBC.
+#define CSW_SIG 0x53425355 // USBS.
+#define CBW_LEN 31
+#define CSW_LEN 13
+
+#define SC_TEST_UNIT_READY  0x00
+#define SC_REQUEST_SENSE    0x03
+#define SC_INQUIRY          0x12
+#define SC_READ_CAPACITY    0x25
+#define SC_READ_10          0x28
+#define SC_WRITE_10         0x2A
+
+// Unit ready, sense, inquiry and capacity run before the data commands.
+#define HOST_UMS_SETUP_CMDS 4
+
+typedef struct _host_ums_t
+{
+	const host_ums_script_t *script;
+	u32 cmd;       // Current command index.
+	u32 cmds;      // Total commands.
+	u32 lba;       // Current data command LBA.
+	u32 len;       // Current data phase length.
+	u32 done;      // Current data phase bytes done.
+	u32 errors;
+	u8 *cbw_buf;   // Last CBW buffer, for queued reads.
+	u32 sectors;   // Disk size reported by the gadget.
+} host_ums_t;
+
+static host_ums_t host;
+
+static void _put_be32(u8 *buf, u32 val)
+{
+	buf[0] = val >> 24;
+	buf[1] = val >> 16;
+	buf[2] = val >> 8;
+	buf[3] = val;
+}
+
+static u32 _get_be32(const u8 *buf)
+{
+	return (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+}
+
+static void _cbw_build(u8 *buf)
+{
+	const host_ums_script_t *script = host.script;
+	u8 *cdb = buf + 15;
+	u8 flags = 0x80; // Data IN.
+	u8 cdb_len = 6;
+	u32 idx, secs;
+
+	memset(buf, 0, CBW_LEN);
+
+	host.done = 0;
+	switch (host.cmd)
+	{
+	case 0:
+		cdb[0] = SC_TEST_UNIT_READY;
+		host.len = 0;
+		flags = 0;
+		break;
+	case 1:
+		cdb[0] = SC_REQUEST_SENSE;
+		cdb[4] = host.len = 18;
+		break;
+	case 2:
+		cdb[0] = SC_INQUIRY;
+		cdb[4] = host.len = 36;
+		break;
+	case 3:
+		cdb[0] = SC_READ_CAPACITY;
+		cdb_len = 10;
+		host.len = 8;
+		break;
+	default:
+		idx  = host.cmd - HOST_UMS_SETUP_CMDS;
+		secs = MIN(script->xfer_secs, script->sectors - idx * script->xfer_secs);
+
+		host.lba = script->lba + idx * script->xfer_secs;
+		host.len = secs * SDMMC_DAT_BLOCKSIZE;
+
+		cdb[0] = script->write ? SC_WRITE_10 : SC_READ_10;
+		_put_be32(&cdb[2], host.lba);
+		cdb[7] = secs >> 8;
+		cdb[8] = secs;
+		cdb_len = 10;
+		if (script->write)
+			flags = 0;
+		break;
+	}
+
+	*(u32 *)&buf[0] = CBW_SIG;
+	*(u32 *)&buf[4] = host.cmd + 1; // Tag.
+	*(u32 *)&buf[8] = host.len;
+	buf[12] = flags;
+	buf[13] = 0; // LUN.
+	buf[14] = cdb_len;
+}
+
+static int _cbw_send(u8 *buf, u32 *actual)
+{
+	if (host.cmd >= host.cmds)
+	{
+		// Script is done. Eject with the button combo.
+		host_btn_vol = BTN_VOL_UP | BTN_VOL_DOWN;
+		if (actual)
+			*actual = 0;
+
+		return USB_ERROR_TIMEOUT;
+	}
+
+	_cbw_build(buf);
+	if (actual)
+		*actual = CBW_LEN;
+
+	return USB_RES_OK;
+}
+
+static void _csw_check(const u8 *buf)
+{
+	u32 tag     = *(u32 *)&buf[4];
+	u32 residue = *(u32 *)&buf[8];
+	u8  status  = buf[12];
+
+	// First command gets the reset unit attention.
+	if (tag != host.cmd + 1 || (host.cmd && (status || residue)) || host.done != host.len)
+		host.errors++;
+
+	host.cmd++;
+}
+
+static void _data_in(const u8 *buf, u32 len)
+{
+	const host_ums_script_t *script = host.script;
+
+	if (host.done + len > host.len)
+	{
+		host.errors++;
+		return;
+	}
+
+	if (host.cmd == 3)
+		host.sectors = _get_be32(buf) + 1;
+	else if (host.cmd >= HOST_UMS_SETUP_CMDS && script->data)
+	{
+		u64 offset = (u64)(host.lba - script->lba) * SDMMC_DAT_BLOCKSIZE + host.done;
+		if (memcmp(buf, script->data + offset, len))
+			host.errors++;
+	}
+
+	host.done += len;
+}
+
+static int _usbd_flush_endpoint(u32 ep)
+{
+	return USB_RES_OK;
+}
+
+static int _usbd_set_ep_stall(u32 ep, int stall)
+{
+	// Scripted commands are all valid.
+	if (stall == USB_EP_CFG_STALL)
+		host.errors++;
+
+	return USB_RES_OK;
+}
+
+static int _usbd_handle_ep0_ctrl_setup()
+{
+	return USB_RES_OK;
+}
+
+static void _usbd_end(bool reset_ep, bool only_controller)
+{
+}
+
+static int _usb_device_init()
+{
+	return USB_RES_OK;
+}
+
+static int _usb_device_enumerate(usb_gadget_type gadget)
+{
+	return USB_RES_OK;
+}
+
+static int _usb_device_class_send_max_lun(u8 max_lun)
+{
+	return USB_RES_OK;
+}
+
+static int _usb_device_ep1_out_read(u8 *buf, u32 len, u32 *actual, u32 sync_timeout)
+{
+	host.cbw_buf = buf;
+
+	if (len != CBW_LEN)
+	{
+		host.errors++;
+		return USB_ERROR_XFER_ERROR;
+	}
+
+	return _cbw_send(buf, actual);
+}
+
+static int _usb_device_ep1_out_read_big(u8 *buf, u32 len, u32 *actual)
+{
+	const host_ums_script_t *script = host.script;
+
+	if (!script->write || host.done + len > host.len)
+	{
+		host.errors++;
+		*actual = 0;
+		return USB_ERROR_XFER_ERROR;
+	}
+
+	u64 offset = (u64)(host.lba - script->lba) * SDMMC_DAT_BLOCKSIZE + host.done;
+	memcpy(buf, script->data + offset, len);
+	host.done += len;
+	*actual = len;
+
+	return USB_RES_OK;
+}
+
+static int _usb_device_ep1_out_reading_finish(u32 *actual, u32 sync_timeout)
+{
+	return _cbw_send(host.cbw_buf, actual);
+}
+
+static int _usb_device_ep1_in_write(u8 *buf, u32 len, u32 *actual, u32 sync_timeout)
+{
+	if (len == CSW_LEN && *(u32 *)buf == CSW_SIG)
+		_csw_check(buf);
+	else
+		_data_in(buf, len);
+
+	// Transfers complete instantly.
+	if (actual)
+		*actual = len;
+
+	return USB_RES_OK;
+}
+
+static int _usb_device_ep1_in_writing_finish(u32 *pending_bytes, u32 sync_timeout)
+{
+	*pending_bytes = 0;
+
+	return USB_RES_OK;
+}
+
+static int _usb_device_ep1_in_writing_wait(u32 queued_max, u32 sync_timeout)
+{
+	return USB_RES_OK;
+}
+
+static bool _usb_device_get_suspended()
+{
+	return false;
+}
+
+static bool _usb_device_get_port_in_sleep()
+{
+	return false;
+}
+
+void usb_device_get_ops(usb_ops_t *ops)
+{
+	ops->usbd_flush_endpoint               = _usbd_flush_endpoint;
+	ops->usbd_set_ep_stall                 = _usbd_set_ep_stall;
+	ops->usbd_handle_ep0_ctrl_setup        = _usbd_handle_ep0_ctrl_setup;
+	ops->usbd_end                          = _usbd_end;
+	ops->usb_device_init                   = _usb_device_init;
+	ops->usb_device_enumerate              = _usb_device_enumerate;
+	ops->usb_device_class_send_max_lun     = _usb_device_class_send_max_lun;
+	ops->usb_device_class_send_hid_report  = NULL;
+	ops->usb_device_ep1_out_read           = _usb_device_ep1_out_read;
+	ops->usb_device_ep1_out_read_big       = _usb_device_ep1_out_read_big;
+	ops->usb_device_ep1_out_reading_finish = _usb_device_ep1_out_reading_finish;
+	ops->usb_device_ep1_in_write           = _usb_device_ep1_in_write;
+	ops->usb_device_ep1_in_writing_finish  = _usb_device_ep1_in_writing_finish;
+	ops->usb_device_ep1_in_writing_wait    = _usb_device_ep1_in_writing_wait;
+	ops->usb_device_get_suspended          = _usb_device_get_suspended;
+	ops->usb_device_get_port_in_sleep      = _usb_device_get_port_in_sleep;
+}
+
+// Both controllers behave the same. The gadget still takes its XUSB paths.
+void xusb_device_get_ops(usb_ops_t *ops)
+{
+	usb_device_get_ops(ops);
+}
+
+int host_usb_ums_run(usb_ctxt_t *usbs, const host_ums_script_t *script)
+{
+	if (script->write && !script->data)
+		return -1;
+
+	memset(&host, 0, sizeof(host_ums_t));
+	host.script = script;
+	host.cmds   = HOST_UMS_SETUP_CMDS + (script->sectors + script->xfer_secs - 1) / script->xfer_secs;
+
+	host_btn_vol = 0;
+	int res = usb_device_gadget_ums(usbs);
+	host_btn_vol = 0;
+
+	if (res)
+		return -1;
+
+	if (host.cmd != host.cmds || script->lba + script->sectors > host.sectors)
+		host.errors++;
+
+	return host.errors;
+}
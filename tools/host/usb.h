@@ -0,0 +1,40 @@
+/*
+ * BDK host build USB shim
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_USB_H_
+#define _HOST_USB_H_
+
+#include <usb/usbd.h>
+#include <utils/types.h>
+
+typedef struct _host_ums_script_t
+{
+	bool write;      // WRITE(10) instead of READ(10).
+	u32  lba;        // First LBA.
+	u32  sectors;    // Total sectors.
+	u32  xfer_secs;  // Sectors per command.
+	const u8 *data;  // Write source or expected read data. Optional for reads.
+} host_ums_script_t;
+
+/*
+ * Runs the UMS gadget against a scripted Bulk-Only host.
+ * Returns the failed command count, or -1 if the gadget failed.
+ */
+int host_usb_ums_run(usb_ctxt_t *usbs, const host_ums_script_t *script);
+
+#endif
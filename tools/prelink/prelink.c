@@ -0,0 +1,414 @@
+/*
+ * ianos module prelinker
+ *
+ * Copyright (c) 2026 hekate contributors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Converts a .bso module to the ianos prelinked format. The image is laid out
+ * and relocated ahead of time, so the loader only reads it to its place.
+ * The result is verified against an ELF load and relocation like the one
+ * the runtime loader does, before anything is written.
+ *
+ * Usage: prelink [-a load_addr] <in.bso> [out.bso]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PRELINK_MAGIC   0x4C504E49 // INPL.
+#define PRELINK_VERSION 1
+#define PRELINK_CRC_OFF 12
+
+#define PT_LOAD    1
+#define PT_DYNAMIC 2
+
+#define DT_NULL   0
+#define DT_REL    17
+#define DT_RELSZ  18
+#define DT_RELENT 19
+
+#define R_ARM_NONE      0
+#define R_ARM_ABS32     2
+#define R_ARM_GLOB_DAT  21
+#define R_ARM_JUMP_SLOT 22
+#define R_ARM_RELATIVE  23
+
+#define EM_ARM 40
+
+// Both bases are used for verification. They must differ from each other.
+#define VERIFY_BASE_0 0x90000010
+#define VERIFY_BASE_1 0xE0000000
+
+typedef struct _prelink_hdr_t
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t crc32;
+	uint32_t image_size;
+	uint32_t mem_size;
+	uint32_t entry;
+	uint32_t load_addr;
+	uint32_t reloc_cnt;
+} prelink_hdr_t;
+
+typedef struct _elf32_ehdr_t
+{
+	uint8_t  e_ident[16];
+	uint16_t e_type;
+	uint16_t e_machine;
+	uint32_t e_version;
+	uint32_t e_entry;
+	uint32_t e_phoff;
+	uint32_t e_shoff;
+	uint32_t e_flags;
+	uint16_t e_ehsize;
+	uint16_t e_phentsize;
+	uint16_t e_phnum;
+	uint16_t e_shentsize;
+	uint16_t e_shnum;
+	uint16_t e_shstrndx;
+} elf32_ehdr_t;
+
+typedef struct _elf32_phdr_t
+{
+	uint32_t p_type;
+	uint32_t p_offset;
+	uint32_t p_vaddr;
+	uint32_t p_paddr;
+	uint32_t p_filesz;
+	uint32_t p_memsz;
+	uint32_t p_flags;
+	uint32_t p_align;
+} elf32_phdr_t;
+
+typedef struct _elf32_dyn_t
+{
+	int32_t  d_tag;
+	uint32_t d_val;
+} elf32_dyn_t;
+
+typedef struct _elf32_rel_t
+{
+	uint32_t r_offset;
+	uint32_t r_info;
+} elf32_rel_t;
+
+typedef struct _elf_t
+{
+	uint8_t *data;
+	uint32_t size;
+	elf32_ehdr_t *ehdr;
+	uint32_t mem_size;
+	uint32_t rel_off;
+	uint32_t rel_size;
+} elf_t;
+
+static uint32_t _crc32(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+	crc = ~crc;
+	for (uint32_t i = 0; i < len; i++)
+	{
+		crc ^= buf[i];
+		for (uint32_t j = 0; j < 8; j++)
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+	}
+
+	return ~crc;
+}
+
+static elf32_phdr_t *_elf_phdr(elf_t *elf, uint32_t idx)
+{
+	return (elf32_phdr_t *)(elf->data + elf->ehdr->e_phoff + idx * elf->ehdr->e_phentsize);
+}
+
+static int _elf_parse(elf_t *elf)
+{
+	elf32_ehdr_t *ehdr = (elf32_ehdr_t *)elf->data;
+	elf->ehdr = ehdr;
+
+	if (elf->size < sizeof(elf32_ehdr_t) || memcmp(ehdr->e_ident, "\x7F" "ELF", 4))
+		return 1;
+
+	// 32-bit little endian ARM executable or PIE.
+	if (ehdr->e_ident[4] != 1 || ehdr->e_ident[5] != 1 || ehdr->e_machine != EM_ARM ||
+		(ehdr->e_type != 2 && ehdr->e_type != 3) || ehdr->e_phentsize != sizeof(elf32_phdr_t) ||
+		ehdr->e_phoff + ehdr->e_phnum * sizeof(elf32_phdr_t) > elf->size)
+		return 1;
+
+	uint32_t dyn_off = 0;
+	uint32_t dyn_size = 0;
+	for (uint32_t i = 0; i < ehdr->e_phnum; i++)
+	{
+		elf32_phdr_t *ph = _elf_phdr(elf, i);
+		if (ph->p_type == PT_LOAD)
+		{
+			if (ph->p_offset + ph->p_filesz > elf->size || ph->p_filesz > ph->p_memsz)
+				return 1;
+			if (ph->p_vaddr + ph->p_memsz > elf->mem_size)
+				elf->mem_size = ph->p_vaddr + ph->p_memsz;
+		}
+		else if (ph->p_type == PT_DYNAMIC)
+		{
+			dyn_off = ph->p_offset;
+			dyn_size = ph->p_filesz;
+		}
+	}
+
+	if (!elf->mem_size || ehdr->e_entry >= elf->mem_size || dyn_off + dyn_size > elf->size)
+		return 1;
+
+	// Find the relocation table. Static executables have none.
+	uint32_t rel_ent = 0;
+	elf32_dyn_t *dyn = (elf32_dyn_t *)(elf->data + dyn_off);
+	for (uint32_t i = 0; i < dyn_size / sizeof(elf32_dyn_t) && dyn[i].d_tag != DT_NULL; i++)
+	{
+		switch (dyn[i].d_tag)
+		{
+		case DT_REL:
+			elf->rel_off = dyn[i].d_val;
+			break;
+		case DT_RELSZ:
+			elf->rel_size = dyn[i].d_val;
+			break;
+		case DT_RELENT:
+			rel_ent = dyn[i].d_val;
+			break;
+		}
+	}
+
+	if (ehdr->e_type != 3)
+		elf->rel_size = 0;
+
+	if (elf->rel_size && (rel_ent != sizeof(elf32_rel_t) || elf->rel_off + elf->rel_size > elf->mem_size))
+		return 1;
+
+	return 0;
+}
+
+// Loads and relocates the ELF the same way the runtime loader does.
+static int _elf_load(elf_t *elf, uint8_t *mem, uint32_t base)
+{
+	memset(mem, 0, elf->mem_size);
+
+	for (uint32_t i = 0; i < elf->ehdr->e_phnum; i++)
+	{
+		elf32_phdr_t *ph = _elf_phdr(elf, i);
+		if (ph->p_type == PT_LOAD)
+			memcpy(mem + ph->p_vaddr, elf->data + ph->p_offset, ph->p_filesz);
+	}
+
+	elf32_rel_t *rel = (elf32_rel_t *)(mem + elf->rel_off);
+	for (uint32_t i = 0; i < elf->rel_size / sizeof(elf32_rel_t); i++)
+	{
+		switch (rel[i].r_info & 0xFF)
+		{
+		case R_ARM_NONE:
+		case R_ARM_ABS32:
+		case R_ARM_GLOB_DAT:
+		case R_ARM_JUMP_SLOT:
+			break; // Stubbed in the runtime loader.
+		case R_ARM_RELATIVE:
+			if ((rel[i].r_info >> 8) || rel[i].r_offset > elf->mem_size - 4)
+				return 1;
+			*(uint32_t *)(mem + rel[i].r_offset) += base;
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Loads a prelinked image the same way the runtime loader does.
+static int _prelink_load(const uint8_t *file, uint32_t size, uint8_t *mem, uint32_t base)
+{
+	prelink_hdr_t *hdr = (prelink_hdr_t *)file;
+	const uint8_t *image = file + sizeof(prelink_hdr_t);
+	const uint32_t *relocs = (const uint32_t *)(image + hdr->image_size);
+
+	if (hdr->magic != PRELINK_MAGIC || hdr->version != PRELINK_VERSION || hdr->image_size > hdr->mem_size ||
+		hdr->entry >= hdr->image_size || size != sizeof(prelink_hdr_t) + hdr->image_size + hdr->reloc_cnt * 4)
+		return 1;
+
+	if (hdr->crc32 != _crc32(0, file + PRELINK_CRC_OFF, size - PRELINK_CRC_OFF))
+		return 1;
+
+	memcpy(mem, image, hdr->image_size);
+	memset(mem + hdr->image_size, 0, hdr->mem_size - hdr->image_size);
+
+	uint32_t delta = base - hdr->load_addr;
+	for (uint32_t i = 0; delta && i < hdr->reloc_cnt; i++)
+	{
+		if (relocs[i] > hdr->mem_size - 4)
+			return 1;
+		*(uint32_t *)(mem + relocs[i]) += delta;
+	}
+
+	return 0;
+}
+
+static uint8_t *_prelink(elf_t *elf, uint32_t load_addr, uint32_t *out_size)
+{
+	uint8_t *mem = malloc(elf->mem_size);
+	uint32_t *relocs = malloc(elf->rel_size / sizeof(elf32_rel_t) * 4 + 4);
+	uint32_t reloc_cnt = 0;
+
+	// Load at 0 first, so the relocation table is read unmodified.
+	if (_elf_load(elf, mem, 0))
+		goto error;
+
+	// Only relative relocations change with the load address.
+	elf32_rel_t *rel = (elf32_rel_t *)(mem + elf->rel_off);
+	for (uint32_t i = 0; i < elf->rel_size / sizeof(elf32_rel_t); i++)
+	{
+		if ((rel[i].r_info & 0xFF) == R_ARM_RELATIVE)
+			relocs[reloc_cnt++] = rel[i].r_offset;
+	}
+
+	for (uint32_t i = 0; i < reloc_cnt; i++)
+		*(uint32_t *)(mem + relocs[i]) += load_addr;
+
+	// Trim zeroes at the end, including bss. Loader clears them.
+	uint32_t image_size = elf->mem_size;
+	while (image_size > elf->ehdr->e_entry + 4 && !mem[image_size - 1])
+		image_size--;
+	image_size = (image_size + 3) & ~3;
+	if (image_size > elf->mem_size)
+		image_size = elf->mem_size;
+
+	*out_size = sizeof(prelink_hdr_t) + image_size + reloc_cnt * 4;
+	uint8_t *out = calloc(1, *out_size);
+	prelink_hdr_t *hdr = (prelink_hdr_t *)out;
+
+	hdr->magic      = PRELINK_MAGIC;
+	hdr->version    = PRELINK_VERSION;
+	hdr->image_size = image_size;
+	hdr->mem_size   = elf->mem_size;
+	hdr->entry      = elf->ehdr->e_entry;
+	hdr->load_addr  = load_addr;
+	hdr->reloc_cnt  = reloc_cnt;
+	memcpy(out + sizeof(prelink_hdr_t), mem, image_size);
+	memcpy(out + sizeof(prelink_hdr_t) + image_size, relocs, reloc_cnt * 4);
+	hdr->crc32 = _crc32(0, out + PRELINK_CRC_OFF, *out_size - PRELINK_CRC_OFF);
+
+	free(mem);
+	free(relocs);
+
+	return out;
+
+error:
+	free(mem);
+	free(relocs);
+
+	return NULL;
+}
+
+static int _verify(elf_t *elf, const uint8_t *file, uint32_t size, uint32_t base)
+{
+	uint8_t *ref = malloc(elf->mem_size);
+	uint8_t *mem = malloc(elf->mem_size);
+	int res = 1;
+
+	if (!_elf_load(elf, ref, base) && !_prelink_load(file, size, mem, base))
+		res = memcmp(ref, mem, elf->mem_size) ? 1 : 0;
+
+	free(ref);
+	free(mem);
+
+	return res;
+}
+
+int main(int argc, char *argv[])
+{
+	elf_t elf;
+	uint32_t load_addr = 0;
+	int arg = 1;
+
+	memset(&elf, 0, sizeof(elf_t));
+
+	if (argc > 2 && !strcmp(argv[1], "-a"))
+	{
+		load_addr = strtoul(argv[2], NULL, 0);
+		arg += 2;
+	}
+
+	if (argc - arg < 1 || argc - arg > 2)
+	{
+		printf("Usage: %s [-a load_addr] <in.bso> [out.bso]\n", argv[0]);
+		return 1;
+	}
+
+	const char *in_path = argv[arg];
+	const char *out_path = (argc - arg == 2) ? argv[arg + 1] : in_path;
+
+	FILE *fp = fopen(in_path, "rb");
+	if (!fp)
+	{
+		printf("prelink: cannot open %s\n", in_path);
+		return 1;
+	}
+	fseek(fp, 0, SEEK_END);
+	elf.size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	elf.data = malloc(elf.size + sizeof(elf32_ehdr_t));
+	elf.size = fread(elf.data, 1, elf.size, fp);
+	fclose(fp);
+
+	if (elf.size >= 4 && *(uint32_t *)elf.data == PRELINK_MAGIC)
+	{
+		printf("prelink: %s is already prelinked\n", in_path);
+		return 0;
+	}
+
+	if (_elf_parse(&elf))
+	{
+		printf("prelink: %s is not a supported ELF\n", in_path);
+		return 1;
+	}
+
+	uint32_t size;
+	uint8_t *out = _prelink(&elf, load_addr, &size);
+	if (!out)
+	{
+		printf("prelink: %s has unsupported relocations\n", in_path);
+		return 1;
+	}
+
+	// Check that rebased and in place loads match the ELF loader.
+	if (_verify(&elf, out, size, load_addr) ||
+		_verify(&elf, out, size, VERIFY_BASE_0) ||
+		_verify(&elf, out, size, VERIFY_BASE_1))
+	{
+		printf("prelink: %s verification failed\n", in_path);
+		return 1;
+	}
+
+	fp = fopen(out_path, "wb");
+	if (!fp || fwrite(out, 1, size, fp) != size)
+	{
+		printf("prelink: cannot write %s\n", out_path);
+		return 1;
+	}
+	fclose(fp);
+
+	free(out);
+	free(elf.data);
+
+	return 0;
+}